@@ -36,9 +36,10 @@
 //		These are active for the life of each call to
 //		annRangeSearch().  They are set to save the number of
 //		variables that need to be passed among the various search
-//		procedures.
+//		procedures. They are thread local such that concurrent
+//		searches in one tree do not interfere.
 //----------------------------------------------------------------------
 
-extern ANNpoint			ANNkdFRQ;			// query point (static copy)
+extern thread_local ANNpoint			ANNkdFRQ;			// query point (static copy)
 
 #endif
@@ -2,6 +2,7 @@
 #include "named.h"
 #include "node.h"
 #include "group.h"
+#include "reflection_schema.h"
 #include <cgv/reflect/get_reflection_handler.h>
 #include <cgv/reflect/set_reflection_handler.h>
 #include <cgv/type/variant.h>
@@ -180,6 +181,15 @@ bool base::call_void(const std::string& method,
 /// abstract interface for the setter, by default it simply returns false
 bool base::set_void(const std::string& property, const std::string& value_type, const void* value_ptr)
 {
+	if (use_reflection_schema()) {
+		const reflection_schema::entry* e = get_reflection_schema(this).find(property);
+		if (e) {
+			if (!e->set(this, value_type, value_ptr))
+				return false;
+			on_set(e->access(this));
+			return true;
+		}
+	}
 	set_reflection_handler ssrh(property, value_type, value_ptr);
 	self_reflect(ssrh);
 	if (ssrh.found_valid_target()) {
@@ -211,9 +221,20 @@ void base::on_set(void* member_ptr)
 {
 }
 
+/// by default the reflection schema is not used
+bool base::use_reflection_schema() const
+{
+	return false;
+}
+
 /// abstract interface for the getter, by default it simply returns false
 bool base::get_void(const std::string& property, const std::string& value_type, void* value_ptr)
 {
+	if (use_reflection_schema()) {
+		const reflection_schema::entry* e = get_reflection_schema(this).find(property);
+		if (e)
+			return e->get(this, value_type, value_ptr);
+	}
 	get_reflection_handler gsrh(property, value_type, value_ptr);
 	self_reflect(gsrh);
 	if (gsrh.found_valid_target())
@@ -330,6 +351,25 @@ void base::multi_set(const std::string& property_assignments, bool report_error)
 	}
 }
 
+/// set several properties in one batch and return the number of successfully set properties
+unsigned base::set_properties(const std::vector<property_assignment>& assignments)
+{
+	const reflection_schema* schema = use_reflection_schema() ? &get_reflection_schema(this) : 0;
+	unsigned nr_set = 0;
+	for (const auto& a : assignments) {
+		const reflection_schema::entry* e = schema ? schema->find(a.property) : 0;
+		if (e) {
+			if (e->set(this, a.value_type, a.value_ptr)) {
+				on_set(e->access(this));
+				++nr_set;
+			}
+		}
+		else if (set_void(a.property, a.value_type, a.value_ptr))
+			++nr_set;
+	}
+	return nr_set;
+}
+
 //! check if the given name specifies a property.
 /*! If the type name string pointer is provided, the type of the
     property is copied to the referenced string. */
@@ -359,6 +399,14 @@ bool base::is_property(const std::string& property_name, std::string* type_name)
     property is copied to the referenced string.*/
 void* base::find_member_ptr(const std::string& property_name, std::string* type_name)
 {
+	if (use_reflection_schema()) {
+		const reflection_schema::entry* e = get_reflection_schema(this).find(property_name);
+		if (e) {
+			if (type_name)
+				*type_name = e->rt->get_type_name();
+			return e->access(this);
+		}
+	}
 	find_reflection_handler fsrh(property_name);
 	self_reflect(fsrh);
 	if (!fsrh.found_target())
@@ -159,6 +159,12 @@ public:
 	    uses the self_reflect() method to find a member with the given property as name. If
 		not found, the set_void method returns false. */
 	virtual bool set_void(const std::string& property, const std::string& value_type, const void* value_ptr);
+	//! return whether set_void, get_void, set_properties and find_member_ptr look up members in the cached reflection schema of the type.
+	/*! The schema is built once per type by reflecting the first instance, see cgv::base::reflection_schema. The default
+	    implementation returns false. Overload it to return true only if self_reflect() reflects the same members independent
+		of the state of the instance and all reflected members are stored inside of the instance, i.e. not accessed through
+		pointers or copied into local variables. Properties not found in the schema are handled by the reflection handlers. */
+	virtual bool use_reflection_schema() const;
 	/// this callback is called when the set_void method has changed a member and can be overloaded in derived class
 	virtual void on_set(void* member_ptr);
 	//! abstract interface for the getter of a dynamic property. 
@@ -195,6 +201,18 @@ public:
 	    where the types are derived automatically to bool, int, 
 		double or std::string. */
 	void multi_set(const std::string& property_assignments, bool report_error = true);
+	/// assignment of a value of given type to a property as used by set_properties()
+	struct property_assignment
+	{
+		std::string property;
+		std::string value_type;
+		const void* value_ptr;
+	};
+	//! set several properties in one batch and return the number of successfully set properties
+	/*! If use_reflection_schema() returns true, the schema is queried once for all assignments and
+	    properties found in the schema are set directly followed by a call to on_set(). All other
+		properties are set with set_void(). */
+	unsigned set_properties(const std::vector<property_assignment>& assignments);
 	//! check if the given name specifies a property.
 	/*! If the type name string pointer is provided, the type of the
 	    property is copied to the referenced string. */
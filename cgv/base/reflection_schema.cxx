@@ -0,0 +1,202 @@
+#include "reflection_schema.h"
+#include "base.h"
+#include <cgv/type/variant.h>
+#include <cgv/type/info/type_id.h>
+#include <typeindex>
+#include <mutex>
+#include <memory>
+#include <string.h>
+
+using namespace cgv::type;
+using namespace cgv::type::info;
+using namespace cgv::reflect;
+
+namespace cgv {
+	namespace base {
+
+/// setter for members of fundamental type T that avoids the dispatch over the member type name
+template <typename T>
+bool set_fundamental_member(void* member_ptr, abst_reflection_traits*, const std::string& value_type, const void* value_ptr)
+{
+	if (value_type == type_name<T>::get_name())
+		*static_cast<T*>(member_ptr) = *static_cast<const T*>(value_ptr);
+	else
+		*static_cast<T*>(member_ptr) = variant<T>::get(value_type, value_ptr);
+	return true;
+}
+
+/// getter for members of fundamental type T that avoids the dispatch over the member type name
+template <typename T>
+bool get_fundamental_member(void* member_ptr, abst_reflection_traits*, const std::string& value_type, void* value_ptr)
+{
+	if (value_type == type_name<T>::get_name())
+		*static_cast<T*>(value_ptr) = *static_cast<const T*>(member_ptr);
+	else
+		variant<T>::set(*static_cast<const T*>(member_ptr), value_type, value_ptr);
+	return true;
+}
+
+/// setter for all other members that follows cgv::reflect::set_reflection_handler
+static bool set_compound_member(void* member_ptr, abst_reflection_traits* rt, const std::string& value_type, const void* value_ptr)
+{
+	if (value_type == rt->get_type_name()) {
+		memcpy(member_ptr, value_ptr, rt->size());
+		return true;
+	}
+	if (value_type == "string" && rt->has_string_conversions())
+		return rt->set_from_string(member_ptr, *static_cast<const std::string*>(value_ptr));
+	return false;
+}
+
+/// getter for all other members that follows cgv::reflect::get_reflection_handler
+static bool get_compound_member(void* member_ptr, abst_reflection_traits* rt, const std::string& value_type, void* value_ptr)
+{
+	if (value_type == rt->get_type_name()) {
+		memcpy(value_ptr, member_ptr, rt->size());
+		return true;
+	}
+	if (value_type == type_name<std::string>::get_name() && rt->has_string_conversions()) {
+		rt->get_to_string(member_ptr, *static_cast<std::string*>(value_ptr));
+		return true;
+	}
+	return false;
+}
+
+/// reflection handler that collects the members with fixed offsets into the entries of a schema
+class schema_reflection_handler : public reflection_handler
+{
+protected:
+	char* base_ptr;
+	std::unordered_map<std::string, reflection_schema::entry>& entries;
+	/// path prefixes of the completely traversed groups
+	std::vector<std::string> prefixes;
+	///
+	template <typename T>
+	static void set_callbacks(reflection_schema::entry& e)
+	{
+		e.setter = &set_fundamental_member<T>;
+		e.getter = &get_fundamental_member<T>;
+	}
+	/// add an entry unless the name is already used by a member reflected earlier, which is the one found by the reflection handlers
+	void add_entry(const std::string& member_name, void* member_ptr, abst_reflection_traits* rt)
+	{
+		std::string path = prefixes.empty() ? member_name : prefixes.back() + member_name;
+		if (entries.find(path) != entries.end())
+			return;
+		reflection_schema::entry e;
+		e.offset = static_cast<char*>(member_ptr) - base_ptr;
+		e.rt = rt->clone();
+		switch (rt->get_type_id()) {
+		case TI_BOOL: set_callbacks<bool>(e); break;
+		case TI_INT8: set_callbacks<int8_type>(e); break;
+		case TI_INT16: set_callbacks<int16_type>(e); break;
+		case TI_INT32: set_callbacks<int32_type>(e); break;
+		case TI_INT64: set_callbacks<int64_type>(e); break;
+		case TI_UINT8: set_callbacks<uint8_type>(e); break;
+		case TI_UINT16: set_callbacks<uint16_type>(e); break;
+		case TI_UINT32: set_callbacks<uint32_type>(e); break;
+		case TI_UINT64: set_callbacks<uint64_type>(e); break;
+		case TI_FLT32: set_callbacks<flt32_type>(e); break;
+		case TI_FLT64: set_callbacks<flt64_type>(e); break;
+		case TI_WCHAR: set_callbacks<wchar_type>(e); break;
+		case TI_STRING: set_callbacks<std::string>(e); break;
+		case TI_WSTRING: set_callbacks<std::wstring>(e); break;
+		default:
+			e.setter = &set_compound_member;
+			e.getter = &get_compound_member;
+			break;
+		}
+		entries[path] = e;
+	}
+public:
+	schema_reflection_handler(base* instance, std::unordered_map<std::string, reflection_schema::entry>& _entries)
+		: base_ptr(reinterpret_cast<char*>(instance)), entries(_entries) {}
+	/// traverse base classes and structures, where the latter extend the path prefix, and add vectors and arrays only as a whole
+	int reflect_group_begin(GroupKind group_kind, const std::string& group_name, void* group_ptr, abst_reflection_traits* rt, unsigned grp_size)
+	{
+		std::string prefix = prefixes.empty() ? std::string() : prefixes.back();
+		switch (group_kind) {
+		case GK_BASE_CLASS:
+			prefixes.push_back(prefix);
+			return GT_COMPLETE;
+		case GK_STRUCTURE:
+			if (group_name.empty()) {
+				prefixes.push_back(prefix);
+				return GT_COMPLETE;
+			}
+			add_entry(group_name, group_ptr, rt);
+			prefixes.push_back(prefix + group_name + ".");
+			return GT_COMPLETE;
+		case GK_ARRAY:
+		case GK_VECTOR:
+			add_entry(group_name, group_ptr, rt);
+			return GT_SKIP;
+		default:
+			return GT_SKIP;
+		}
+	}
+	///
+	void reflect_group_end(GroupKind group_kind)
+	{
+		prefixes.pop_back();
+	}
+	///
+	bool reflect_member_void(const std::string& member_name, void* member_ptr, abst_reflection_traits* rt)
+	{
+		add_entry(member_name, member_ptr, rt);
+		return true;
+	}
+	/// methods are dispatched by the call reflection handler
+	bool reflect_method_void(const std::string& method_name, method_interface* mi_ptr,
+							 abst_reflection_traits* return_traits, const std::vector<abst_reflection_traits*>& param_value_traits)
+	{
+		return true;
+	}
+};
+
+/// build the schema by reflecting the given instance
+reflection_schema::reflection_schema(base* instance)
+{
+	schema_reflection_handler srh(instance, entries);
+	instance->self_reflect(srh);
+}
+
+/// destruct reflection traits of entries
+reflection_schema::~reflection_schema()
+{
+	for (auto& e : entries)
+		delete e.second.rt;
+}
+
+/// return entry of member with given name or 0 if the member is not part of the schema
+const reflection_schema::entry* reflection_schema::find(const std::string& member_name) const
+{
+	auto iter = entries.find(member_name);
+	if (iter == entries.end())
+		return 0;
+	return &iter->second;
+}
+
+/// return the schema of the dynamic type of the given instance, which is built on first access to the type and cached in a thread safe way
+const reflection_schema& get_reflection_schema(base* instance)
+{
+	static std::mutex mtx;
+	static std::unordered_map<std::type_index, std::unique_ptr<reflection_schema> > schemas;
+	std::type_index type(typeid(*instance));
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		auto iter = schemas.find(type);
+		if (iter != schemas.end())
+			return *iter->second;
+	}
+	// reflect without holding the lock as self_reflect might access properties of other instances
+	std::unique_ptr<reflection_schema> schema(new reflection_schema(instance));
+	std::lock_guard<std::mutex> lock(mtx);
+	auto iter = schemas.find(type);
+	if (iter == schemas.end())
+		iter = schemas.emplace(type, std::move(schema)).first;
+	return *iter->second;
+}
+
+	}
+}
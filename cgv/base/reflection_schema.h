@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cgv/reflect/reflection_handler.h>
+#include <unordered_map>
+#include <cstddef>
+#include <string>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace base {
+
+class CGV_API base;
+
+/** the reflection schema of a type maps the names of the members reflected by self_reflect() to their
+    offsets relative to the base pointer, their reflection traits and setter and getter callbacks. It is
+	built once per dynamic type by reflecting the first instance and allows to replace the linear
+	traversal of the reflection handlers by a hashed lookup. Members of structures are stored under their
+	dotted path names like "color.r". Members of vectors, arrays and pointed to objects as well as
+	methods are not part of the schema and are handled by the reflection handlers. Only types that
+	overload base::use_reflection_schema() to return true use the schema. */
+class CGV_API reflection_schema
+{
+public:
+	/// signature of callbacks that convert a value of the given type into a member and return whether this succeeded
+	typedef bool (*setter_type)(void* member_ptr, cgv::reflect::abst_reflection_traits* rt, const std::string& value_type, const void* value_ptr);
+	/// signature of callbacks that convert a member into a value of the given type and return whether this succeeded
+	typedef bool (*getter_type)(void* member_ptr, cgv::reflect::abst_reflection_traits* rt, const std::string& value_type, void* value_ptr);
+	/// schema entry of a reflected member
+	struct entry
+	{
+		/// offset of member in bytes relative to the base pointer of the instance
+		std::ptrdiff_t offset;
+		/// reflection traits of the member type, owned by the schema
+		cgv::reflect::abst_reflection_traits* rt;
+		/// callback used to set the member
+		setter_type setter;
+		/// callback used to get the member
+		getter_type getter;
+		/// return pointer to member of given instance
+		void* access(base* instance) const { return reinterpret_cast<char*>(instance) + offset; }
+		/// set member of instance from value with the same conversions as cgv::reflect::set_reflection_handler
+		bool set(base* instance, const std::string& value_type, const void* value_ptr) const { return setter(access(instance), rt, value_type, value_ptr); }
+		/// get member of instance into value with the same conversions as cgv::reflect::get_reflection_handler
+		bool get(base* instance, const std::string& value_type, void* value_ptr) const { return getter(access(instance), rt, value_type, value_ptr); }
+	};
+protected:
+	/// entries hashed by member name
+	std::unordered_map<std::string, entry> entries;
+	/// schemas own their reflection traits and cannot be copied
+	reflection_schema(const reflection_schema&) = delete;
+	reflection_schema& operator = (const reflection_schema&) = delete;
+public:
+	/// build the schema by reflecting the given instance
+	reflection_schema(base* instance);
+	/// destruct reflection traits of entries
+	~reflection_schema();
+	/// return entry of member with given name or 0 if the member is not part of the schema
+	const entry* find(const std::string& member_name) const;
+	/// return the number of entries
+	size_t get_nr_entries() const { return entries.size(); }
+};
+
+/// return the schema of the dynamic type of the given instance, which is built on first access to the type and cached in a thread safe way
+extern CGV_API const reflection_schema& get_reflection_schema(base* instance);
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
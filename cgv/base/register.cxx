@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <vector>
 #include <set>
+#include <unordered_map>
 
 #if defined(_WIN32)
 #include <Windows.h>
@@ -59,19 +60,65 @@ struct registration_order_info
 
 struct object_collection
 {
+	/// registered objects in order of registration
 	std::vector<base_ptr> objects;
+	/// objects indexed by their name at registration time in order of registration
+	std::unordered_map<std::string, std::vector<base*> > objects_by_name;
+	/// objects indexed by their type name in order of registration
+	std::unordered_map<std::string, std::vector<base*> > objects_by_type;
+	/// named objects in order of registration together with the name under which they are indexed
+	std::vector<std::pair<named*, std::string> > named_objects;
+	/// number of times an object is contained in the objects vector
+	std::unordered_map<base*, unsigned> registration_counts;
+	static void remove_from_index(std::unordered_map<std::string, std::vector<base*> >& index, const std::string& key, base* object)
+	{
+		auto iter = index.find(key);
+		if (iter == index.end())
+			return;
+		std::vector<base*>& V = iter->second;
+		V.erase(std::remove(V.begin(), V.end(), object), V.end());
+		if (V.empty())
+			index.erase(iter);
+	}
 	void add_object(base_ptr object)
 	{
+		base* b = &(*object);
 		objects.push_back(object);
+		if (++registration_counts[b] > 1)
+			return;
+		named_ptr np = object->cast<named>();
+		if (np) {
+			objects_by_name[np->get_name()].push_back(b);
+			named_objects.push_back(std::make_pair(&(*np), np->get_name()));
+		}
+		objects_by_type[object->get_type_name()].push_back(b);
 	}
 	void remove_object(base_ptr object)
 	{
-		for (unsigned int i = 0; i < objects.size(); ++i) {
-			if (object == objects[i]) {
-				objects.erase(objects.begin() + i);
-				++i;
+		base* b = &(*object);
+		auto count_iter = registration_counts.find(b);
+		if (count_iter == registration_counts.end())
+			return;
+		unsigned count = count_iter->second;
+		registration_counts.erase(count_iter);
+		// objects are typically removed in reverse order of registration such that search starts at the end
+		for (size_t i = objects.size(); count > 0 && i > 0; --i) {
+			if (objects[i - 1] == object) {
+				objects.erase(objects.begin() + (i - 1));
+				--count;
+			}
+		}
+		named_ptr np = object->cast<named>();
+		if (np) {
+			for (size_t i = named_objects.size(); i > 0; --i) {
+				if (named_objects[i - 1].first == &(*np)) {
+					remove_from_index(objects_by_name, named_objects[i - 1].second, b);
+					named_objects.erase(named_objects.begin() + (i - 1));
+					break;
+				}
 			}
 		}
+		remove_from_index(objects_by_type, object->get_type_name(), b);
 	}
 	void unregister_all_objects()
 	{
@@ -81,21 +128,34 @@ struct object_collection
 	}
 	named_ptr find_object_by_name(const std::string& name)
 	{
-		for (unsigned int oi = 0; oi < objects.size(); ++oi) {
-			named_ptr np = objects[oi]->cast<named>();
-			if (np && np->get_name() == name)
-				return np;
+		auto iter = objects_by_name.find(name);
+		if (iter != objects_by_name.end()) {
+			for (base* b : iter->second) {
+				named_ptr np = b->cast<named>();
+				if (np && np->get_name() == name)
+					return np;
+			}
 		}
-		return named_ptr();
+		// objects renamed after registration are not indexed under their current name, such that
+		// the names are compared directly and the index is updated for renamed objects
+		named* found = 0;
+		for (auto& no : named_objects) {
+			if (no.first->get_name() == no.second)
+				continue;
+			remove_from_index(objects_by_name, no.second, no.first);
+			no.second = no.first->get_name();
+			objects_by_name[no.second].push_back(no.first);
+			if (!found && no.second == name)
+				found = no.first;
+		}
+		return named_ptr(found);
 	}
 	base_ptr find_object_by_type(const std::string& type_name)
 	{
-		for (unsigned int oi = 0; oi < objects.size(); ++oi) {
-			base_ptr bp = objects[oi];
-			if (type_name == bp->get_type_name())
-				return bp;
-		}
-		return base_ptr();
+		auto iter = objects_by_type.find(type_name);
+		if (iter == objects_by_type.end())
+			return base_ptr();
+		return base_ptr(iter->second.front());
 	}
 	bool request_exit_from_all_objects()
 	{
@@ -277,6 +337,8 @@ void sort_registration_events(bool before_contructor_execution)
 	std::vector<std::set<unsigned>> combined_partial_order;
 	combined_partial_order.resize(N);
 	unsigned nr_partial_orders = 0;
+	// index of first registration event per type name, which is built on first use
+	std::unordered_map<std::string, unsigned> event_index_by_type;
 
 	// iterate all registration order infos
 	for (auto roi : ref_registration_order_infos()) {
@@ -303,20 +365,19 @@ void sort_registration_events(bool before_contructor_execution)
 		cgv::utils::tokenizer(roi.partial_order).set_ws(";").bite_all(toks);
 
 		// first construct a vector with indices of registration events
+		if (event_index_by_type.empty()) {
+			for (unsigned i = 0; i < N; ++i)
+				event_index_by_type.emplace(ref_registration_events()[i].first->get_type_name(), i);
+		}
 		std::vector<unsigned> event_indices;
 		unsigned nr_matched = 0;
 		for (auto t : toks) {
-			bool found = false;
-			for (unsigned i = 0; i < N; ++i) {
-				std::string tn = ref_registration_events()[i].first->get_type_name();
-				if (t == tn) {
-					event_indices.push_back(i);
-					++nr_matched;
-					found = true;
-					break;
-				}
+			auto iter = event_index_by_type.find(to_string(t));
+			if (iter != event_index_by_type.end()) {
+				event_indices.push_back(iter->second);
+				++nr_matched;
 			}
-			if (!found) {
+			else {
 				std::cout << "REG ORDER: could not find event <" << t << ">" << std::endl;
 			}
 		}
@@ -36,15 +36,8 @@ bool chol(const mat<T> &a, low_tri_mat<T> &l)
 
 			{
 
-				T sum= a(i, j);
-
-				for(int k = i - 1; k >= 0;k--)
-
-				{
-
-					sum -=  l(i, k) * l(j, k);
-
-				}
+				//rows of the packed lower triangular matrix are contiguous
+				T sum= a(i, j) - dot_kernel(i, &l(i, 0), &l(j, 0));
 
  
 
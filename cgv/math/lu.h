@@ -16,30 +16,20 @@ namespace math {
 template <typename T>
 bool lu(const mat<T> &a,perm_mat& p, low_tri_mat<T>& l, up_tri_mat<T>& u) 
 {
-
-	
 	unsigned n = a.nrows();
 	unsigned m = a.ncols();
 	assert(n==m);
 	l.resize(n);
 	u.resize(n);
 	p.resize(n);
-		
-	for(unsigned i =0; i < a.ncols();i++)
-		for(unsigned j = 0; j < a.nrows();j++)
-		{
-			if(i > j)
-				l(i,j) = a(i,j);
-			else
-				u(i,j) = a(i,j);
-		}
-			
 	
+	//eliminate in a dense copy such that the updates of the remaining submatrix run over contiguous columns
+	mat<T> w = a;
 
 	const T eps=std::numeric_limits<T>::epsilon();
 	unsigned i,imax,j,k;
 	T big,temp;
-	vec<T> vv(n);
+	vec<T> vv(n), row(n);
 	T d=1.0;
 
 	for (i=0;i<n;i++) 
@@ -47,18 +37,8 @@ bool lu(const mat<T> &a,perm_mat& p, low_tri_mat<T>& l, up_tri_mat<T>& u)
 		big=0.0;
 		for (j=0;j<n;j++)
 		{
-			if(i > j)
-			{
-				if ((temp=std::abs(l(i,j))) > big) 
-					big=temp;
-			}
-			else
-			{
-				if ((temp=std::abs(u(i,j))) > big) 
-					big=temp;
-			}
-
-			
+			if ((temp=std::abs(w(i,j))) > big) 
+				big=temp;
 		}
 		if (big == 0.0) return false;
 		vv[i]=(T)1.0/big;
@@ -66,13 +46,10 @@ bool lu(const mat<T> &a,perm_mat& p, low_tri_mat<T>& l, up_tri_mat<T>& u)
 	for (k=0;k<n;k++) 
 	{
 		big=0.0;
+		imax=k;
 		for (i=k;i<n;i++) 
 		{
-			if(i > k)
-				temp=vv[i]*std::abs(l(i,k));
-			else
-				temp=vv[i]*std::abs(u(i,k));
-
+			temp=vv[i]*std::abs(w(i,k));
 			if (temp > big) 
 			{
 				big=temp;
@@ -82,73 +59,34 @@ bool lu(const mat<T> &a,perm_mat& p, low_tri_mat<T>& l, up_tri_mat<T>& u)
 		if (k != imax) 
 		{
 			for (j=0;j<n;j++) 
-			{
-				if(imax > j)
-				{
-					temp=l(imax,j);
-					if(k > j)
-					{
-						l(imax,j)=l(k,j);
-						l(k,j)=temp;
-					}
-					else
-					{
-						l(imax,j)=u(k,j);
-						u(k,j)=temp;
-					}
-
-				}
-				else
-				{
-					temp=u(imax,j);
-					if(k > j)
-					{
-						u(imax,j)=l(k,j);
-						l(k,j)=temp;
-					}
-					else
-					{
-						u(imax,j)=u(k,j);
-						u(k,j)=temp;
-					}
-				}
-
-				
-			}
+				std::swap(w(imax,j),w(k,j));
 			d = -d;
 			vv[imax]=vv[k];
-			
 		}
 		p.swap(imax,k);
 		
-		if (u(k,k) == 0.0) u(k,k)=eps;
-		for (i=k+1;i<n;i++) 
+		if (w(k,k) == 0.0) w(k,k)=eps;
+		if (k+1 < n)
 		{
-		
-			temp=l(i,k) /= u(k,k);
-		
+			for (i=k+1;i<n;i++) 
+				w(i,k) /= w(k,k);
 			for (j=k+1;j<n;j++)
-			{
-				if(i > j)
-					l(i,j) -= temp*u(k,j);
-				else
-					u(i,j) -= temp*u(k,j);
-			}
+				row[j] = w(k,j);
+			ger_kernel(n-k-1, n-k-1, (T)-1, &w(k+1,k), &row[k+1], &w(k+1,k+1), n);
 		}
 	}
-	for(unsigned i = 0; i < n; i++)
-		{
-			
-			l(i,i)=(T)1;
-			
-		}
-
-	
+	for(i = 0; i < n; i++)
+	{
+		for(j = 0; j < i; j++)
+			l(i,j) = w(i,j);
+		l(i,i)=(T)1;
+		for(j = i; j < n; j++)
+			u(i,j) = w(i,j);
+	}
 	return true;
 }
 
 
-
 }
 
 }
@@ -1,6 +1,7 @@
 #pragma	once
 
 #include "vec.h"
+#include "mat_kernels.h"
 #include <limits> 
 #include <cassert>
 
@@ -755,50 +756,45 @@ public:
 	const mat<T> operator*=(const mat<S>& m2) 
 	{
 		assert(ncols() == m2.ncols() && nrows() == m2.nrows() && ncols() == nrows());
-		mat<T> r(_nrows,_ncols,(T)0);
-	
-		for(unsigned i = 0; i < _nrows; i++)
-			for(unsigned j = 0; j < _ncols;j++)
-				for(unsigned k = 0; k < _ncols; k++)
-					r(i,j) += operator()(i,k) * (T)(m2(k,j)); 
-		(*this)=r;
-	
+		(*this) = (*this) * m2;
 		return *this;
 	}
 
 	
 
 	///multiplication with a ncols x M matrix m2
-	template <typename S>
-	const mat<T> operator*(const mat<S>& m2) const
+	const mat<T> operator*(const mat<T>& m2) const
 	{
 		assert(m2.nrows() == _ncols);
-		unsigned M = m2.ncols();
-		mat<T> r(_nrows,M,(T)0);
-		for(unsigned i = 0; i < _nrows; i++)
-			for(unsigned j = 0; j < M;j++)
-				for(unsigned k = 0; k < _ncols; k++)
-					r(i,j) += operator()(i,k) * (T)(m2(k,j)); 
-	
+		mat<T> r(_nrows,m2.ncols());
+		gemm_kernel(false, false, _nrows, m2.ncols(), _ncols, (T)1, (const T*)_data, _nrows, (const T*)m2, m2.nrows(), (T)0, (T*)r, _nrows);
 		return r;
 	}
 
+	///multiplication with a ncols x M matrix m2 of different element type
+	template <typename S>
+	const mat<T> operator*(const mat<S>& m2) const
+	{
+		return (*this) * mat<T>(m2);
+	}
+
 
 	///matrix vector multiplication
-	template < typename S>
-	const vec<T> operator*(const vec<S>& v) const
+	const vec<T> operator*(const vec<T>& v) const
 	{
 		assert(_ncols==v.size());		
-		vec<T> r;
-		r.zeros(_nrows);
-	
-		for(unsigned j = 0; j < _ncols; j++)
-			for(unsigned i = 0; i < _nrows; i++)
-				r(i) += operator()(i,j) * (T)(v(j)); 
-	
+		vec<T> r(_nrows);
+		gemv_kernel(false, _nrows, _ncols, (T)1, (const T*)_data, _nrows, (const T*)v, (T)0, (T*)r);
 		return r;
 	}
 
+	///matrix vector multiplication with vector of different element type
+	template < typename S>
+	const vec<T> operator*(const vec<S>& v) const
+	{
+		return (*this) * vec<T>(v);
+	}
+
 	///create submatrix m(top,left)...m(top+rows,left+cols)
 	mat<T> sub_mat(unsigned top, unsigned left, unsigned rows, unsigned cols) const
 	{
@@ -1287,35 +1283,14 @@ template <typename T>
 void AtA(const mat<T>& a, mat<T>& ata)
 {
 	ata.resize(a.ncols(),a.ncols());
-	ata.zeros();
-	for(unsigned r = 0; r < a.nrows();r++)
-	{
-		for(unsigned i = 0; i < a.ncols();i++)
-		{
-			for(unsigned j = 0; j < a.ncols();j++)
-			{
-				ata(i,j)+=a(r,i)*a(r,j);
-			}
-		}
-	}
+	gemm_kernel(true, false, a.ncols(), a.ncols(), a.nrows(), (T)1, (const T*)a, a.nrows(), (const T*)a, a.nrows(), (T)0, (T*)ata, a.ncols());
 }
 //compute A*transpose(A)
 template <typename T>
 void AAt(const mat<T>& a, mat<T>& aat)
 {
 	aat.resize(a.nrows(),a.nrows());
-	aat.zeros();
-	for(unsigned c = 0; c < a.ncols();c++)
-	{
-		for(unsigned i = 0; i < a.nrows();i++)
-		{
-			for(unsigned j = 0; j < a.nrows();j++)
-			{
-				aat(i,j)+=a(i,c)*a(j,c);
-			}
-		}
-	}
-	
+	gemm_kernel(false, true, a.nrows(), a.nrows(), a.ncols(), (T)1, (const T*)a, a.nrows(), (const T*)a, a.nrows(), (T)0, (T*)aat, a.nrows());
 }
 
 template <typename T>
@@ -1336,14 +1311,9 @@ mat<T> reshape(const mat<T>& m,unsigned r,unsigned c)
 template <typename T>
 void AtB(const mat<T>& a,const mat<T>& b, mat<T>& atb)
 {
+	assert(a.nrows() == b.nrows());
 	atb.resize(a.ncols(),b.ncols());
-	atb.zeros();
-	
-	for(unsigned i = 0; i < a.ncols(); i++)
-		for(unsigned j = 0; j < b.ncols();j++)
-			for(unsigned k = 0; k < a.nrows(); k++)
-				atb(i,j) += a(k,i)*b(k,j); 
-	
+	gemm_kernel(true, false, a.ncols(), b.ncols(), a.nrows(), (T)1, (const T*)a, a.nrows(), (const T*)b, b.nrows(), (T)0, (T*)atb, a.ncols());
 }
 
 ///multiply A^T*x 
@@ -1351,14 +1321,9 @@ void AtB(const mat<T>& a,const mat<T>& b, mat<T>& atb)
 template <typename T>
 void Atx(const mat<T>& a,const vec<T>& x, vec<T>& atx)
 {
+	assert(a.nrows() == x.size());
 	atx.resize(a.ncols());
-	atx.zeros();
-	
-	for(unsigned i = 0; i < a.ncols(); i++)
-		for(unsigned j = 0; j < a.nrows(); j++)
-			atx(i) += a(j,i) * (T)(x(j)); 
-	
-	
+	gemv_kernel(true, a.nrows(), a.ncols(), (T)1, (const T*)a, a.nrows(), (const T*)x, (T)0, (T*)atx);
 }
 
 
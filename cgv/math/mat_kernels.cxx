@@ -0,0 +1,22 @@
+#include "mat_kernels.h"
+#include <atomic>
+
+namespace cgv {
+	namespace math {
+
+/// maximum number of threads used by the dense kernels
+static std::atomic<unsigned> mat_kernel_nr_threads(1);
+
+/// return the maximum number of threads used by the dense kernels, which defaults to 1
+unsigned get_mat_kernel_nr_threads()
+{
+	return mat_kernel_nr_threads.load(std::memory_order_relaxed);
+}
+/// set the maximum number of threads used for large products, where 0 corresponds to the hardware concurrency
+void set_mat_kernel_nr_threads(unsigned nr_threads)
+{
+	mat_kernel_nr_threads.store(nr_threads == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : nr_threads, std::memory_order_relaxed);
+}
+
+	}
+}
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace math {
+
+/**@name dense matrix kernels
+   Kernels on column major storage that are used by mat<T> for products and by the dense decompositions.
+   Loops are written over contiguous memory with independent accumulators such that the compiler can
+   vectorize them. Large products are blocked for the caches and can be distributed over several threads. */
+//@{
+
+/// return the maximum number of threads used by the dense kernels, which defaults to 1
+extern CGV_API unsigned get_mat_kernel_nr_threads();
+/// set the maximum number of threads used for large products, where 0 corresponds to the hardware concurrency
+extern CGV_API void set_mat_kernel_nr_threads(unsigned nr_threads);
+
+namespace mat_kernel_detail {
+	/// rows of the register block computed by the gemm micro kernel
+	const unsigned MR = 8;
+	/// columns of the register block computed by the gemm micro kernel
+	const unsigned NR = 4;
+	/// rows of a block of op(A) that is packed to stay in the L2 cache
+	const unsigned MC = 128;
+	/// inner dimension of a packed block
+	const unsigned KC = 256;
+	/// minimum number of multiply adds before gemm uses blocking
+	const double min_blocked_work = 32.0 * 32.0 * 32.0;
+	/// minimum number of multiply adds per thread, which keeps the cost of starting threads in the order of a percent
+	const double min_thread_work = 256.0 * 256.0 * 256.0;
+
+	/// return number of threads to be used for the given amount of multiply adds and at most max_parts parallel parts, products below 2*min_thread_work run on the calling thread only
+	inline unsigned get_nr_threads(double work, unsigned max_parts)
+	{
+		if (work < 2 * min_thread_work)
+			return 1;
+		unsigned nr_threads = get_mat_kernel_nr_threads();
+		if (nr_threads <= 1)
+			return 1;
+		nr_threads = std::min(nr_threads, unsigned(work / min_thread_work));
+		return std::max(1u, std::min(nr_threads, max_parts));
+	}
+
+	/// call f(begin, end) for nr_parts ranges of [0,n) whose boundaries are multiples of align, using one thread per range
+	template <typename F>
+	void parallel_ranges(unsigned n, unsigned nr_parts, unsigned align, const F& f)
+	{
+		if (nr_parts <= 1) {
+			f(0u, n);
+			return;
+		}
+		unsigned nr_units = (n + align - 1) / align;
+		std::vector<std::thread> threads;
+		for (unsigned t = 1; t < nr_parts; ++t) {
+			unsigned begin = std::min(n, nr_units*t / nr_parts * align);
+			unsigned end = std::min(n, nr_units*(t + 1) / nr_parts * align);
+			threads.push_back(std::thread(f, begin, end));
+		}
+		f(0u, std::min(n, nr_units / nr_parts * align));
+		for (auto& t : threads)
+			t.join();
+	}
+
+	/// pack a mc x kc block of op(A) starting at (i0,p0) into micro panels of MR rows that are zero padded
+	template <typename T>
+	void pack_a(bool trans_a, const T* A, unsigned lda, unsigned i0, unsigned p0, unsigned mc, unsigned kc, T* buf)
+	{
+		for (unsigned ir = 0; ir < mc; ir += MR) {
+			unsigned mr = std::min(MR, mc - ir);
+			for (unsigned p = 0; p < kc; ++p) {
+				if (trans_a) {
+					for (unsigned i = 0; i < mr; ++i)
+						buf[i] = A[size_t(i0 + ir + i)*lda + p0 + p];
+				}
+				else {
+					const T* a = A + size_t(p0 + p)*lda + i0 + ir;
+					for (unsigned i = 0; i < mr; ++i)
+						buf[i] = a[i];
+				}
+				for (unsigned i = mr; i < MR; ++i)
+					buf[i] = T(0);
+				buf += MR;
+			}
+		}
+	}
+
+	/// pack a kc x nc block of op(B) starting at (p0,j0) into micro panels of NR columns that are zero padded
+	template <typename T>
+	void pack_b(bool trans_b, const T* B, unsigned ldb, unsigned p0, unsigned j0, unsigned kc, unsigned nc, T* buf)
+	{
+		for (unsigned jr = 0; jr < nc; jr += NR) {
+			unsigned nr = std::min(NR, nc - jr);
+			for (unsigned p = 0; p < kc; ++p) {
+				for (unsigned j = 0; j < nr; ++j)
+					buf[j] = trans_b ? B[size_t(p0 + p)*ldb + j0 + jr + j] : B[size_t(j0 + jr + j)*ldb + p0 + p];
+				for (unsigned j = nr; j < NR; ++j)
+					buf[j] = T(0);
+				buf += NR;
+			}
+		}
+	}
+
+	/// compute MR x NR block of alpha * a_panel * b_panel and add the mr x nr valid part to C
+	template <typename T>
+	void micro_kernel(unsigned kc, const T* a_panel, const T* b_panel, T alpha, T* C, unsigned ldc, unsigned mr, unsigned nr)
+	{
+		T acc[NR][MR];
+		for (unsigned j = 0; j < NR; ++j)
+			for (unsigned i = 0; i < MR; ++i)
+				acc[j][i] = T(0);
+		for (unsigned p = 0; p < kc; ++p) {
+			const T* a = a_panel + p*MR;
+			const T* b = b_panel + p*NR;
+			for (unsigned j = 0; j < NR; ++j) {
+				T bj = b[j];
+				for (unsigned i = 0; i < MR; ++i)
+					acc[j][i] += a[i] * bj;
+			}
+		}
+		for (unsigned j = 0; j < nr; ++j) {
+			T* c = C + size_t(j)*ldc;
+			for (unsigned i = 0; i < mr; ++i)
+				c[i] += alpha*acc[j][i];
+		}
+	}
+
+	/// blocked computation of C(:,j_begin:j_end) += alpha*op(A)*op(B)(:,j_begin:j_end)
+	template <typename T>
+	void gemm_blocked(bool trans_a, bool trans_b, unsigned m, unsigned j_begin, unsigned j_end, unsigned k, T alpha,
+		const T* A, unsigned lda, const T* B, unsigned ldb, T* C, unsigned ldc)
+	{
+		unsigned n = j_end - j_begin;
+		if (n == 0)
+			return;
+		std::vector<T> a_buf(size_t(MC)*KC);
+		std::vector<T> b_buf(size_t((n + NR - 1) / NR * NR)*KC);
+		for (unsigned p0 = 0; p0 < k; p0 += KC) {
+			unsigned kc = std::min(KC, k - p0);
+			pack_b(trans_b, B, ldb, p0, j_begin, kc, n, &b_buf[0]);
+			for (unsigned i0 = 0; i0 < m; i0 += MC) {
+				unsigned mc = std::min(MC, m - i0);
+				pack_a(trans_a, A, lda, i0, p0, mc, kc, &a_buf[0]);
+				for (unsigned jr = 0; jr < n; jr += NR) {
+					unsigned nr = std::min(NR, n - jr);
+					for (unsigned ir = 0; ir < mc; ir += MR)
+						micro_kernel(kc, &a_buf[size_t(ir)*kc], &b_buf[size_t(jr)*kc], alpha,
+							C + size_t(j_begin + jr)*ldc + i0 + ir, ldc, std::min(MR, mc - ir), nr);
+				}
+			}
+		}
+	}
+}
+
+/// return x^T*y for vectors of length n using four independent partial sums
+template <typename T>
+T dot_kernel(unsigned n, const T* x, const T* y)
+{
+	T s0 = T(0), s1 = T(0), s2 = T(0), s3 = T(0);
+	unsigned i = 0;
+	for (; i + 4 <= n; i += 4) {
+		s0 += x[i] * y[i];
+		s1 += x[i + 1] * y[i + 1];
+		s2 += x[i + 2] * y[i + 2];
+		s3 += x[i + 3] * y[i + 3];
+	}
+	for (; i < n; ++i)
+		s0 += x[i] * y[i];
+	return (s0 + s1) + (s2 + s3);
+}
+
+/// compute y += alpha*x for vectors of length n
+template <typename T>
+void axpy_kernel(unsigned n, T alpha, const T* x, T* y)
+{
+	for (unsigned i = 0; i < n; ++i)
+		y[i] += alpha*x[i];
+}
+
+/// apply the plane rotation (x,y) <- (c*x+s*y, c*y-s*x) to the vectors x and y of length n
+template <typename T>
+void rot_kernel(unsigned n, T* x, T* y, T c, T s)
+{
+	for (unsigned i = 0; i < n; ++i) {
+		T xi = x[i], yi = y[i];
+		x[i] = xi*c + yi*s;
+		y[i] = yi*c - xi*s;
+	}
+}
+
+/// compute y = alpha*op(A)*x + beta*y for the m x n matrix A with column stride lda, where op(A) is A^T if trans_a is true
+template <typename T>
+void gemv_kernel(bool trans_a, unsigned m, unsigned n, T alpha, const T* A, unsigned lda, const T* x, T beta, T* y)
+{
+	unsigned ny = trans_a ? n : m;
+	if (beta == T(0))
+		std::fill(y, y + ny, T(0));
+	else if (beta != T(1))
+		for (unsigned i = 0; i < ny; ++i)
+			y[i] *= beta;
+	unsigned nr_threads = mat_kernel_detail::get_nr_threads(double(m)*n, ny / 64);
+	if (trans_a) {
+		// one dot product per column
+		mat_kernel_detail::parallel_ranges(n, nr_threads, 1, [&](unsigned begin, unsigned end) {
+			for (unsigned j = begin; j < end; ++j)
+				y[j] += alpha*dot_kernel(m, A + size_t(j)*lda, x);
+		});
+	}
+	else {
+		// update y with four columns at a time to reduce passes over y
+		mat_kernel_detail::parallel_ranges(m, nr_threads, 64, [&](unsigned begin, unsigned end) {
+			unsigned j = 0;
+			for (; j + 4 <= n; j += 4) {
+				const T* a0 = A + size_t(j)*lda;
+				const T* a1 = a0 + lda;
+				const T* a2 = a1 + lda;
+				const T* a3 = a2 + lda;
+				T x0 = alpha*x[j], x1 = alpha*x[j + 1], x2 = alpha*x[j + 2], x3 = alpha*x[j + 3];
+				for (unsigned i = begin; i < end; ++i)
+					y[i] += a0[i] * x0 + a1[i] * x1 + a2[i] * x2 + a3[i] * x3;
+			}
+			for (; j < n; ++j)
+				axpy_kernel(end - begin, alpha*x[j], A + size_t(j)*lda + begin, y + begin);
+		});
+	}
+}
+
+/// compute the rank one update A += alpha*x*y^T of the m x n matrix A with column stride lda
+template <typename T>
+void ger_kernel(unsigned m, unsigned n, T alpha, const T* x, const T* y, T* A, unsigned lda)
+{
+	unsigned nr_threads = mat_kernel_detail::get_nr_threads(double(m)*n, n);
+	mat_kernel_detail::parallel_ranges(n, nr_threads, 1, [&](unsigned begin, unsigned end) {
+		for (unsigned j = begin; j < end; ++j)
+			axpy_kernel(m, alpha*y[j], x, A + size_t(j)*lda);
+	});
+}
+
+//! compute C = alpha*op(A)*op(B) + beta*C, where op(A) is m x k, op(B) is k x n and C is m x n.
+/*! All matrices are stored in column major order with column strides lda, ldb and ldc. op(X) is the
+    transpose of X if the corresponding trans flag is set. Small products are computed with simple loops
+	and large ones with packed cache blocks, where the columns of C are distributed over threads. */
+template <typename T>
+void gemm_kernel(bool trans_a, bool trans_b, unsigned m, unsigned n, unsigned k, T alpha,
+	const T* A, unsigned lda, const T* B, unsigned ldb, T beta, T* C, unsigned ldc)
+{
+	for (unsigned j = 0; j < n; ++j) {
+		T* c = C + size_t(j)*ldc;
+		if (beta == T(0))
+			std::fill(c, c + m, T(0));
+		else if (beta != T(1))
+			for (unsigned i = 0; i < m; ++i)
+				c[i] *= beta;
+	}
+	if (m == 0 || n == 0 || k == 0 || alpha == T(0))
+		return;
+	double work = double(m)*n*k;
+	if (work < mat_kernel_detail::min_blocked_work) {
+		for (unsigned j = 0; j < n; ++j) {
+			T* c = C + size_t(j)*ldc;
+			if (trans_a) {
+				for (unsigned i = 0; i < m; ++i) {
+					const T* a = A + size_t(i)*lda;
+					T sum = T(0);
+					for (unsigned p = 0; p < k; ++p)
+						sum += a[p] * (trans_b ? B[size_t(p)*ldb + j] : B[size_t(j)*ldb + p]);
+					c[i] += alpha*sum;
+				}
+			}
+			else {
+				for (unsigned p = 0; p < k; ++p)
+					axpy_kernel(m, alpha*(trans_b ? B[size_t(p)*ldb + j] : B[size_t(j)*ldb + p]), A + size_t(p)*lda, c);
+			}
+		}
+		return;
+	}
+	unsigned nr_threads = mat_kernel_detail::get_nr_threads(work, (n + mat_kernel_detail::NR - 1) / mat_kernel_detail::NR);
+	mat_kernel_detail::parallel_ranges(n, nr_threads, mat_kernel_detail::NR, [&](unsigned begin, unsigned end) {
+		mat_kernel_detail::gemm_blocked(trans_a, trans_b, m, begin, end, k, alpha, A, lda, B, ldb, C, ldc);
+	});
+}
+//@}
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
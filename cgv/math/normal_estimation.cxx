@@ -3,6 +3,9 @@
 #include <cgv/math/mat.h>
 #include <cgv/math/eig.h>
 #include <cgv/math/point_operations.h>
+#include <cmath>
+#include <limits>
+#include <algorithm>
 
 namespace cgv {
 	namespace math {
@@ -91,5 +94,101 @@ void estimate_normal_wls(unsigned nr_points, const float* _points, const float*
 	}
 }
 
+/// diagonalize the symmetric 3x3 matrix a with cyclic jacobi rotations, on return the diagonal of a holds the eigenvalues and the columns of v the eigenvectors
+static void jacobi_sym_3x3(double a[3][3], double v[3][3])
+{
+	for (int i = 0; i < 3; ++i)
+		for (int j = 0; j < 3; ++j)
+			v[i][j] = i == j ? 1.0 : 0.0;
+	for (unsigned sweep = 0; sweep < 50; ++sweep) {
+		double off = std::abs(a[0][1]) + std::abs(a[0][2]) + std::abs(a[1][2]);
+		double scale = std::abs(a[0][0]) + std::abs(a[1][1]) + std::abs(a[2][2]);
+		if (off <= std::numeric_limits<double>::epsilon()*scale || off == 0.0)
+			return;
+		for (int p = 0; p < 2; ++p) {
+			for (int q = p + 1; q < 3; ++q) {
+				if (a[p][q] == 0.0)
+					continue;
+				// rotation angle that annihilates a[p][q]
+				double theta = (a[q][q] - a[p][p]) / (2.0*a[p][q]);
+				double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta*theta + 1.0));
+				double c = 1.0 / std::sqrt(t*t + 1.0);
+				double s = t*c;
+				for (int k = 0; k < 3; ++k) {
+					double akp = a[k][p], akq = a[k][q];
+					a[k][p] = c*akp - s*akq;
+					a[k][q] = s*akp + c*akq;
+				}
+				for (int k = 0; k < 3; ++k) {
+					double apk = a[p][k], aqk = a[q][k];
+					a[p][k] = c*apk - s*aqk;
+					a[q][k] = s*apk + c*aqk;
+				}
+				for (int k = 0; k < 3; ++k) {
+					double vkp = v[k][p], vkq = v[k][q];
+					v[k][p] = c*vkp - s*vkq;
+					v[k][q] = s*vkp + c*vkq;
+				}
+			}
+		}
+	}
+}
+
+void estimate_normal_wls_3d(unsigned nr_points, const float* _points, const float* _weights, float* _normal, float* _evals, float* _mean)
+{
+	// accumulate weighted moments of the points relative to the first point, which avoids cancellation for points far from the origin
+	const float* p0 = _points;
+	double sw = 0, sww = 0;
+	double s1[3] = { 0, 0, 0 };
+	double s2[6] = { 0, 0, 0, 0, 0, 0 };
+	for (unsigned i = 0; i < nr_points; ++i) {
+		const float* p = _points + 3 * i;
+		double w = _weights[i];
+		double dx = p[0] - p0[0], dy = p[1] - p0[1], dz = p[2] - p0[2];
+		sw += w;
+		sww += w*w;
+		s1[0] += w*dx; s1[1] += w*dy; s1[2] += w*dz;
+		s2[0] += w*dx*dx; s2[1] += w*dx*dy; s2[2] += w*dx*dz;
+		s2[3] += w*dy*dy; s2[4] += w*dy*dz; s2[5] += w*dz*dz;
+	}
+	double m[3] = { 0, 0, 0 };
+	double a[3][3] = { { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } };
+	if (sw > 0) {
+		for (int i = 0; i < 3; ++i)
+			m[i] = s1[i] / sw;
+		// same normalization as weighted_covmat_and_mean
+		double denom = 1.0 - sww / (sw*sw);
+		if (denom <= 0)
+			denom = 1.0;
+		a[0][0] = (s2[0] / sw - m[0] * m[0]) / denom;
+		a[0][1] = a[1][0] = (s2[1] / sw - m[0] * m[1]) / denom;
+		a[0][2] = a[2][0] = (s2[2] / sw - m[0] * m[2]) / denom;
+		a[1][1] = (s2[3] / sw - m[1] * m[1]) / denom;
+		a[1][2] = a[2][1] = (s2[4] / sw - m[1] * m[2]) / denom;
+		a[2][2] = (s2[5] / sw - m[2] * m[2]) / denom;
+	}
+	double v[3][3];
+	jacobi_sym_3x3(a, v);
+
+	// sort eigenvalues decreasingly, the normal is the eigenvector of the smallest one
+	int order[3] = { 0, 1, 2 };
+	for (int i = 0; i < 2; ++i)
+		for (int j = i + 1; j < 3; ++j)
+			if (a[order[j]][order[j]] > a[order[i]][order[i]])
+				std::swap(order[i], order[j]);
+	int c = order[2];
+	double l = std::sqrt(v[0][c] * v[0][c] + v[1][c] * v[1][c] + v[2][c] * v[2][c]);
+	for (int i = 0; i < 3; ++i)
+		_normal[i] = (float)(v[i][c] / l);
+	if (_evals) {
+		for (int i = 0; i < 3; ++i)
+			_evals[i] = (float)a[order[i]][order[i]];
+	}
+	if (_mean) {
+		for (int i = 0; i < 3; ++i)
+			_mean[i] = (float)(p0[i] + m[i]);
+	}
+}
+
 	}
 }
\ No newline at end of file
@@ -18,6 +18,13 @@ namespace cgv {
 
 		/// Weighted version of \c estimate_normal_ls with additional input \c _weights pointing to \c nr_points scalar weights.
 		extern CGV_API void estimate_normal_wls(unsigned nr_points, const float* _points, const float* _weights, float* _normal, float* _evals = 0, float* _mean = 0, float* _evecs = 0);
+
+		//! Allocation free version of \c estimate_normal_wls for 3D points.
+		/*! The weighted covariance matrix is accumulated relative to the first point in fixed size storage and its
+		    eigen decomposition is computed with the cyclic jacobi method on a 3x3 matrix. Results match
+			\c estimate_normal_wls up to the sign of the normal and rounding, such that it can be called per point
+			from several threads without touching the heap. Eigenvalues are returned in decreasing order. */
+		extern CGV_API void estimate_normal_wls_3d(unsigned nr_points, const float* _points, const float* _weights, float* _normal, float* _evals = 0, float* _mean = 0);
 	}
 }
 #include <cgv/config/lib_end.h>
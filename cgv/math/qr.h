@@ -24,8 +24,8 @@ bool qr(const mat<T> &a, mat<T> &q, up_tri_mat<T> &r)
 	q.resize(n,n);
 	r.resize(n);
 	unsigned i,j,k;
-	vec<T> c(n), d(n);
-	T scale,sigma,sum,tau;
+	vec<T> c(n), d(n), tmp(n);
+	T scale,sigma,sum;
 	for (k=0;k<n-1;k++) 
 	{
 		scale=0.0;
@@ -42,13 +42,9 @@ bool qr(const mat<T> &a, mat<T> &q, up_tri_mat<T> &r)
 			rr(k,k) += sigma;
 			c[k]=sigma*rr(k,k);
 			d[k] = -scale*sigma;
-			for (j=k+1;j<n;j++) {
-				for (sum=0.0,i=k;i<n;i++) 
-					sum += rr(i,k)*rr(i,j);
-				tau=sum/c[k];
-				for (i=k;i<n;i++) 
-					rr(i,j) -= tau*rr(i,k);
-			}
+			//apply householder reflection to the remaining columns
+			gemv_kernel(true, n-k, n-k-1, (T)1/c[k], &rr(k,k+1), n, &rr(k,k), (T)0, &tmp[k+1]);
+			ger_kernel(n-k, n-k-1, (T)-1, &rr(k,k), &tmp[k+1], &rr(k,k+1), n);
 		}
 	}
 	d[n-1]=rr(n-1,n-1);
@@ -62,15 +58,9 @@ bool qr(const mat<T> &a, mat<T> &q, up_tri_mat<T> &r)
 	{
 		if (c[k] != 0.0) 
 		{
-			for (j=0;j<n;j++) 
-			{
-				sum=0.0;
-				for (i=k;i<n;i++)
-					sum += rr(i,k)*q(j,i);
-				sum /= c[k];
-				for (i=k;i<n;i++)
-					q(j,i) -= sum*rr(i,k);
-			}
+			//accumulate householder reflection in q
+			gemv_kernel(false, n, n-k, (T)1/c[k], &q(0,k), n, &rr(k,k), (T)0, &tmp[0]);
+			ger_kernel(n, n-k, (T)-1, &tmp[0], &rr(k,k), &q(0,k), n);
 		}
 	}
 	for (i=0;i<n;i++) 
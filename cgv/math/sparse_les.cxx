@@ -1,4 +1,5 @@
 #include "sparse_les.h"
+#include "sparse_les_csr.h"
 #include <string>
 
 namespace cgv {
@@ -12,6 +13,11 @@ sparse_les_factory::~sparse_les_factory()
 std::vector<sparse_les_factory_ptr>& ref_solver_factories()
 {
 	static std::vector<sparse_les_factory_ptr> facs;
+	static bool initialized = false;
+	if (!initialized) {
+		initialized = true;
+		register_csr_sparse_les_factories(facs);
+	}
 	return facs;
 }
 
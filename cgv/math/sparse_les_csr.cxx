@@ -0,0 +1,670 @@
+#include "sparse_les_csr.h"
+#include <algorithm>
+#include <set>
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cmath>
+#include <cstdint>
+
+namespace cgv {
+	namespace math {
+
+namespace {
+	/// threads that process consecutive blocks of a range together with the calling thread and stay alive over all iterations of a solve
+	class block_pool
+	{
+		unsigned nr_blocks;
+		std::vector<std::thread> threads;
+		std::mutex mtx;
+		std::condition_variable start_condition, done_condition;
+		std::function<void(unsigned)> task;
+		size_t generation;
+		unsigned nr_pending;
+		bool stop;
+		/// wait for new tasks and process the given block of each
+		void work(unsigned block)
+		{
+			size_t last_generation = 0;
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock(mtx);
+					start_condition.wait(lock, [&] { return stop || generation != last_generation; });
+					if (stop)
+						return;
+					last_generation = generation;
+				}
+				task(block);
+				std::lock_guard<std::mutex> lock(mtx);
+				if (--nr_pending == 0)
+					done_condition.notify_one();
+			}
+		}
+	public:
+		/// start nr_blocks-1 threads
+		block_pool(unsigned _nr_blocks) : nr_blocks(std::max(_nr_blocks, 1u)), generation(0), nr_pending(0), stop(false)
+		{
+			for (unsigned b = 1; b < nr_blocks; ++b)
+				threads.emplace_back(&block_pool::work, this, b);
+		}
+		/// stop and join threads
+		~block_pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				stop = true;
+			}
+			start_condition.notify_all();
+			for (auto& t : threads)
+				t.join();
+		}
+		/// call f(begin, end, block) for nr_blocks consecutive ranges of [0,n), where the calling thread processes the first block
+		template <typename F>
+		void run(int n, const F& f)
+		{
+			unsigned nb = nr_blocks;
+			auto block_task = [n, nb, &f](unsigned b) { f(int(int64_t(n)*b / nb), int(int64_t(n)*(b + 1) / nb), b); };
+			if (nr_blocks == 1) {
+				block_task(0);
+				return;
+			}
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				task = block_task;
+				nr_pending = nr_blocks - 1;
+				++generation;
+			}
+			start_condition.notify_all();
+			block_task(0);
+			std::unique_lock<std::mutex> lock(mtx);
+			done_condition.wait(lock, [this] { return nr_pending == 0; });
+		}
+	};
+
+	//! compute approximate minimum degree ordering of the graph given by the off diagonal entries of the lower triangle L.
+	/*! The elimination graph is represented as quotient graph, where each eliminated node becomes an element
+	    that stores the clique of its neighbors and absorbs the elements adjacent to it. The degree of a node
+		is approximated from above by its node neighbors and the number of nodes in adjacent elements that are
+		not part of the most recent element as proposed for the approximate minimum degree ordering. */
+	void compute_minimum_degree_ordering(const csr_matrix& L, std::vector<int>& perm)
+	{
+		int n = L.get_nr_rows();
+		// node neighbors, adjacent elements per node and nodes per element, where element e results from eliminating node e
+		std::vector<std::vector<int> > nodes(n), elements(n), element_nodes(n);
+		for (int i = 0; i < n; ++i) {
+			for (int p = L.row_ptr[i]; p < L.row_ptr[i + 1]; ++p) {
+				int j = L.col_idx[p];
+				if (j != i) {
+					nodes[i].push_back(j);
+					nodes[j].push_back(i);
+				}
+			}
+		}
+		std::vector<int> degree(n), mark(n, -1), visited(n, -1), outside(n);
+		std::vector<bool> absorbed(n, false);
+		std::set<std::pair<int, int> > queue;
+		for (int i = 0; i < n; ++i) {
+			degree[i] = int(nodes[i].size());
+			queue.insert(std::make_pair(degree[i], i));
+		}
+		perm.resize(n);
+		for (int k = 0; k < n; ++k) {
+			int v = queue.begin()->second;
+			queue.erase(queue.begin());
+			perm[k] = v;
+			// form new element from node neighbors and nodes of absorbed elements
+			std::vector<int>& clique = element_nodes[v];
+			mark[v] = k;
+			for (int u : nodes[v]) {
+				if (mark[u] != k) {
+					mark[u] = k;
+					clique.push_back(u);
+				}
+			}
+			for (int e : elements[v]) {
+				for (int u : element_nodes[e]) {
+					if (mark[u] != k) {
+						mark[u] = k;
+						clique.push_back(u);
+					}
+				}
+				absorbed[e] = true;
+				std::vector<int>().swap(element_nodes[e]);
+			}
+			std::vector<int>().swap(nodes[v]);
+			std::vector<int>().swap(elements[v]);
+			// remove absorbed elements and covered node neighbors from the nodes of the new element and
+			// compute for each adjacent element e the number outside[e] of its nodes not in the new element
+			for (int i : clique) {
+				queue.erase(std::make_pair(degree[i], i));
+				std::vector<int>& E = elements[i];
+				E.erase(std::remove_if(E.begin(), E.end(), [&absorbed](int e) { return absorbed[e]; }), E.end());
+				for (int e : E) {
+					if (visited[e] != k) {
+						visited[e] = k;
+						outside[e] = int(element_nodes[e].size());
+					}
+					--outside[e];
+				}
+				E.push_back(v);
+				std::vector<int>& N = nodes[i];
+				N.erase(std::remove_if(N.begin(), N.end(), [&mark, k](int u) { return mark[u] == k; }), N.end());
+			}
+			// update approximate degrees
+			int clique_degree = int(clique.size()) - 1;
+			for (int i : clique) {
+				int d = int(nodes[i].size()) + clique_degree;
+				for (int e : elements[i])
+					if (e != v)
+						d += outside[e];
+				degree[i] = std::min(std::min(d, degree[i] + clique_degree), n - k - 2);
+				queue.insert(std::make_pair(degree[i], i));
+			}
+		}
+	}
+}
+
+/// return the index of entry (r,c) in values or -1 if it is not part of the sparsity pattern
+int csr_matrix::find_entry(int r, int c) const
+{
+	if (r < 0 || r >= get_nr_rows())
+		return -1;
+	std::vector<int>::const_iterator b = col_idx.begin() + row_ptr[r], e = col_idx.begin() + row_ptr[r + 1];
+	std::vector<int>::const_iterator i = std::lower_bound(b, e, c);
+	if (i == e || *i != c)
+		return -1;
+	return int(i - col_idx.begin());
+}
+/// compute y = A*x for the rows in [row_begin,row_end)
+void csr_matrix::multiply(const double* x, double* y, int row_begin, int row_end) const
+{
+	for (int i = row_begin; i < row_end; ++i) {
+		double sum = 0;
+		for (int p = row_ptr[i]; p < row_ptr[i + 1]; ++p)
+			sum += values[p] * x[col_idx[p]];
+		y[i] = sum;
+	}
+}
+/// compute y = A*x
+void csr_matrix::multiply(const double* x, double* y) const
+{
+	multiply(x, y, 0, get_nr_rows());
+}
+
+/// construct solver for n unknowns and nr_rhs right hand sides, nr_nze is used to reserve memory
+csr_sparse_les::csr_sparse_les(int _n, int _nr_rhs, int nr_nze) : n(_n), nr_rhs(_nr_rhs), B(size_t(_n)*_nr_rhs, 0.0), X(size_t(_n)*_nr_rhs, 0.0)
+{
+	A.row_ptr.resize(n + 1, 0);
+	if (nr_nze > 0)
+		triplets.reserve(nr_nze);
+}
+/// set entry in row r and column c in the sparse matrix A
+void csr_sparse_les::set_mat_entry(int r, int c, double val)
+{
+	if (r < 0 || r >= n || c < 0 || c >= n) {
+		std::cerr << "csr_sparse_les::set_mat_entry: entry (" << r << "," << c << ") outside of " << n << "x" << n << " matrix ignored" << std::endl;
+		return;
+	}
+	int p = A.find_entry(r, c);
+	if (p != -1)
+		A.values[p] = val;
+	else {
+		triplet t = { r, c, val };
+		triplets.push_back(t);
+	}
+}
+/// set i-th entry in the j-th right hand side
+void csr_sparse_les::set_b_entry(int i, int j, double val)
+{
+	B[size_t(j)*n + i] = val;
+}
+/// set i-th entry in j-th right hand side
+double& csr_sparse_les::ref_b_entry(int i, int j)
+{
+	return B[size_t(j)*n + i];
+}
+/// return the i-th component of the j-th solution vector
+double csr_sparse_les::get_x_entry(int i, int j) const
+{
+	return X[size_t(j)*n + i];
+}
+/// merge pending entries into A and return whether the sparsity pattern changed
+bool csr_sparse_les::assemble()
+{
+	if (triplets.empty())
+		return false;
+	// pending entries are not part of the pattern, such that only duplicates among them need to be resolved
+	std::stable_sort(triplets.begin(), triplets.end(), [](const triplet& a, const triplet& b) {
+		return a.r < b.r || (a.r == b.r && a.c < b.c);
+	});
+	size_t m = 0;
+	for (size_t k = 0; k < triplets.size(); ++k) {
+		if (m > 0 && triplets[m - 1].r == triplets[k].r && triplets[m - 1].c == triplets[k].c)
+			triplets[m - 1].val = triplets[k].val;
+		else
+			triplets[m++] = triplets[k];
+	}
+	triplets.resize(m);
+	// merge rows of assembled matrix and pending entries
+	csr_matrix M;
+	M.row_ptr.resize(n + 1);
+	M.col_idx.reserve(A.col_idx.size() + m);
+	M.values.reserve(A.col_idx.size() + m);
+	M.row_ptr[0] = 0;
+	size_t k = 0;
+	for (int r = 0; r < n; ++r) {
+		int p = A.row_ptr[r], e = A.row_ptr[r + 1];
+		while (p < e || (k < m && triplets[k].r == r)) {
+			if (k < m && triplets[k].r == r && (p == e || triplets[k].c < A.col_idx[p])) {
+				M.col_idx.push_back(triplets[k].c);
+				M.values.push_back(triplets[k].val);
+				++k;
+			}
+			else {
+				M.col_idx.push_back(A.col_idx[p]);
+				M.values.push_back(A.values[p]);
+				++p;
+			}
+		}
+		M.row_ptr[r + 1] = int(M.col_idx.size());
+	}
+	std::swap(A, M);
+	triplets.clear();
+	return true;
+}
+/// extract the lower triangle including the diagonal of the symmetric matrix defined by A
+void csr_sparse_les::extract_lower_triangle(csr_matrix& L) const
+{
+	L.row_ptr.assign(n + 1, 0);
+	for (int r = 0; r < n; ++r) {
+		for (int p = A.row_ptr[r]; p < A.row_ptr[r + 1]; ++p) {
+			int c = A.col_idx[p];
+			if (c <= r)
+				++L.row_ptr[r + 1];
+			else if (A.find_entry(c, r) == -1)
+				++L.row_ptr[c + 1];
+		}
+	}
+	for (int r = 0; r < n; ++r)
+		L.row_ptr[r + 1] += L.row_ptr[r];
+	L.col_idx.resize(L.row_ptr[n]);
+	L.values.resize(L.row_ptr[n]);
+	std::vector<int> pos(L.row_ptr.begin(), L.row_ptr.end() - 1);
+	bool sorted = true;
+	for (int r = 0; r < n; ++r) {
+		for (int p = A.row_ptr[r]; p < A.row_ptr[r + 1]; ++p) {
+			int c = A.col_idx[p];
+			if (c <= r) {
+				L.col_idx[pos[r]] = c;
+				L.values[pos[r]++] = A.values[p];
+			}
+			else if (A.find_entry(c, r) == -1) {
+				L.col_idx[pos[c]] = r;
+				L.values[pos[c]++] = A.values[p];
+				sorted = false;
+			}
+		}
+	}
+	if (sorted)
+		return;
+	// mirrored entries are appended after the lower entries of a row and need to be sorted in
+	std::vector<std::pair<int, double> > row;
+	for (int r = 0; r < n; ++r) {
+		int b = L.row_ptr[r], e = L.row_ptr[r + 1];
+		if (std::is_sorted(L.col_idx.begin() + b, L.col_idx.begin() + e))
+			continue;
+		row.clear();
+		for (int p = b; p < e; ++p)
+			row.push_back(std::make_pair(L.col_idx[p], L.values[p]));
+		std::sort(row.begin(), row.end(), [](const std::pair<int, double>& a, const std::pair<int, double>& b) { return a.first < b.first; });
+		for (int p = b; p < e; ++p) {
+			L.col_idx[p] = row[p - b].first;
+			L.values[p] = row[p - b].second;
+		}
+	}
+}
+/// extend the lower triangle L to the full symmetric matrix S
+void csr_sparse_les::expand_symmetric(const csr_matrix& L, csr_matrix& S)
+{
+	int n = L.get_nr_rows();
+	S.row_ptr.assign(n + 1, 0);
+	for (int i = 0; i < n; ++i) {
+		for (int p = L.row_ptr[i]; p < L.row_ptr[i + 1]; ++p) {
+			int j = L.col_idx[p];
+			++S.row_ptr[i + 1];
+			if (j != i)
+				++S.row_ptr[j + 1];
+		}
+	}
+	for (int i = 0; i < n; ++i)
+		S.row_ptr[i + 1] += S.row_ptr[i];
+	S.col_idx.resize(S.row_ptr[n]);
+	S.values.resize(S.row_ptr[n]);
+	// rows are processed in increasing order such that column indices end up sorted
+	std::vector<int> pos(S.row_ptr.begin(), S.row_ptr.end() - 1);
+	for (int i = 0; i < n; ++i) {
+		for (int p = L.row_ptr[i]; p < L.row_ptr[i + 1]; ++p) {
+			int j = L.col_idx[p];
+			S.col_idx[pos[i]] = j;
+			S.values[pos[i]++] = L.values[p];
+			if (j != i) {
+				S.col_idx[pos[j]] = i;
+				S.values[pos[j]++] = L.values[p];
+			}
+		}
+	}
+}
+/// compute and print the relative residuals of all right hand sides with respect to matrix M
+void csr_sparse_les::analyze_residuals(const csr_matrix& M)
+{
+	std::vector<double> y(n);
+	residuals.resize(nr_rhs);
+	for (int j = 0; j < nr_rhs; ++j) {
+		const double* x = &X[size_t(j)*n];
+		const double* b = &B[size_t(j)*n];
+		M.multiply(x, &y[0]);
+		double res_sqr = 0, b_sqr = 0;
+		for (int i = 0; i < n; ++i) {
+			res_sqr += (y[i] - b[i])*(y[i] - b[i]);
+			b_sqr += b[i] * b[i];
+		}
+		residuals[j] = b_sqr > 0 ? sqrt(res_sqr / b_sqr) : sqrt(res_sqr);
+		std::cout << "residual[" << j << "] = " << residuals[j] << std::endl;
+	}
+}
+
+/// construct solver for n unknowns and nr_rhs right hand sides
+pcg_sparse_les::pcg_sparse_les(int _n, int _nr_rhs, int nr_nze) : csr_sparse_les(_n, _nr_rhs, nr_nze)
+{
+	tolerance = 1e-10;
+	max_nr_iterations = -1;
+	nr_threads = 0;
+	min_nr_non_zeros_per_thread = 32768;
+	nr_used_threads = 0;
+	nr_iterations = 0;
+}
+/// solve system and fail if iteration does not converge or matrix is not positive definite
+bool pcg_sparse_les::solve(bool analyze_residual)
+{
+	assemble();
+	csr_matrix L;
+	extract_lower_triangle(L);
+	expand_symmetric(L, S);
+	// jacobi preconditioner
+	inv_diag.resize(n);
+	for (int i = 0; i < n; ++i) {
+		int p = S.find_entry(i, i);
+		if (p == -1 || S.values[p] <= 0) {
+			std::cerr << "pcg_sparse_les::solve: matrix not positive definite, diagonal entry " << i << " is not positive" << std::endl;
+			return false;
+		}
+		inv_diag[i] = 1.0 / S.values[p];
+	}
+	// only use as many threads as there is enough work for
+	unsigned nr_blocks = nr_threads == 0 ? std::thread::hardware_concurrency() : nr_threads;
+	nr_blocks = std::max(1u, std::min(nr_blocks, unsigned(S.get_nr_non_zeros() / min_nr_non_zeros_per_thread)));
+	nr_blocks = std::min(nr_blocks, unsigned(std::max(n, 1)));
+	nr_used_threads = nr_blocks;
+	block_pool pool(nr_blocks);
+	std::vector<double> partial(2 * nr_blocks);
+	auto sum_partial = [&partial, nr_blocks](unsigned k) {
+		double sum = 0;
+		for (unsigned b = 0; b < nr_blocks; ++b)
+			sum += partial[2 * b + k];
+		return sum;
+	};
+	r.resize(n);
+	z.resize(n);
+	p.resize(n);
+	q.resize(n);
+	int max_iter = max_nr_iterations < 0 ? std::max(n, 100) : max_nr_iterations;
+	nr_iterations = 0;
+	bool success = true;
+	for (int j = 0; j < nr_rhs; ++j) {
+		double* x = &X[size_t(j)*n];
+		const double* b = &B[size_t(j)*n];
+		// r = b - A*x, z = M^-1*r, p = z
+		pool.run(n, [&](int begin, int end, unsigned block) {
+			S.multiply(x, &r[0], begin, end);
+			double rz = 0, bb = 0;
+			for (int i = begin; i < end; ++i) {
+				r[i] = b[i] - r[i];
+				p[i] = z[i] = inv_diag[i] * r[i];
+				rz += r[i] * z[i];
+				bb += b[i] * b[i];
+			}
+			partial[2 * block] = rz;
+			partial[2 * block + 1] = bb;
+		});
+		double rz = sum_partial(0);
+		double b_norm = sqrt(sum_partial(1));
+		if (b_norm == 0) {
+			std::fill(x, x + n, 0.0);
+			continue;
+		}
+		double threshold = tolerance * b_norm;
+		int iter = 0;
+		double r_norm = 0;
+		for (; iter < max_iter; ++iter) {
+			// q = A*p
+			pool.run(n, [&](int begin, int end, unsigned block) {
+				S.multiply(&p[0], &q[0], begin, end);
+				double pq = 0;
+				for (int i = begin; i < end; ++i)
+					pq += p[i] * q[i];
+				partial[2 * block] = pq;
+			});
+			double pq = sum_partial(0);
+			if (pq <= 0) {
+				std::cerr << "pcg_sparse_les::solve: matrix not positive definite" << std::endl;
+				return false;
+			}
+			double alpha = rz / pq;
+			// x += alpha*p, r -= alpha*q, z = M^-1*r
+			pool.run(n, [&](int begin, int end, unsigned block) {
+				double rz = 0, rr = 0;
+				for (int i = begin; i < end; ++i) {
+					x[i] += alpha * p[i];
+					r[i] -= alpha * q[i];
+					z[i] = inv_diag[i] * r[i];
+					rz += r[i] * z[i];
+					rr += r[i] * r[i];
+				}
+				partial[2 * block] = rz;
+				partial[2 * block + 1] = rr;
+			});
+			double rz_new = sum_partial(0);
+			r_norm = sqrt(sum_partial(1));
+			if (r_norm <= threshold) {
+				++iter;
+				break;
+			}
+			double beta = rz_new / rz;
+			rz = rz_new;
+			// p = z + beta*p
+			pool.run(n, [&](int begin, int end, unsigned) {
+				for (int i = begin; i < end; ++i)
+					p[i] = z[i] + beta * p[i];
+			});
+		}
+		nr_iterations = std::max(nr_iterations, iter);
+		if (r_norm > threshold) {
+			std::cerr << "pcg_sparse_les::solve: no convergence for right hand side " << j << " after " << iter
+				<< " iterations, relative residual " << r_norm / b_norm << std::endl;
+			success = false;
+		}
+	}
+	if (success && analyze_residual)
+		analyze_residuals(S);
+	return success;
+}
+
+/// construct solver for n unknowns and nr_rhs right hand sides
+cholesky_sparse_les::cholesky_sparse_les(int _n, int _nr_rhs, int nr_nze) : csr_sparse_les(_n, _nr_rhs, nr_nze)
+{
+	symbolic_valid = false;
+}
+/// compute non zero pattern of row k of L in stack[top...n-1] and return top
+int cholesky_sparse_les::reach_row(int k)
+{
+	int top = n;
+	mark[k] = k;
+	for (int p = C_ptr[k]; p < C_ptr[k + 1]; ++p) {
+		int i = C_idx[p];
+		if (i > k)
+			continue;
+		// walk up the elimination tree until a marked node is found
+		int len = 0;
+		for (; mark[i] != k; i = parent[i]) {
+			stack[len++] = i;
+			mark[i] = k;
+		}
+		while (len > 0)
+			stack[--top] = stack[--len];
+	}
+	return top;
+}
+/// compute ordering, elimination tree and pattern of factor
+void cholesky_sparse_les::analyze()
+{
+	compute_minimum_degree_ordering(lower, perm);
+	perm_inv.resize(n);
+	for (int k = 0; k < n; ++k)
+		perm_inv[perm[k]] = k;
+	// upper triangle of permuted matrix in compressed column format
+	C_ptr.assign(n + 1, 0);
+	for (int i = 0; i < n; ++i)
+		for (int p = lower.row_ptr[i]; p < lower.row_ptr[i + 1]; ++p)
+			++C_ptr[std::max(perm_inv[i], perm_inv[lower.col_idx[p]]) + 1];
+	for (int k = 0; k < n; ++k)
+		C_ptr[k + 1] += C_ptr[k];
+	C_idx.resize(C_ptr[n]);
+	C_src.resize(C_ptr[n]);
+	C_val.resize(C_ptr[n]);
+	std::vector<int> pos(C_ptr.begin(), C_ptr.end() - 1);
+	for (int i = 0; i < n; ++i) {
+		for (int p = lower.row_ptr[i]; p < lower.row_ptr[i + 1]; ++p) {
+			int pi = perm_inv[i], pj = perm_inv[lower.col_idx[p]];
+			int c = std::max(pi, pj);
+			C_idx[pos[c]] = std::min(pi, pj);
+			C_src[pos[c]++] = p;
+		}
+	}
+	// elimination tree with path compression through ancestor
+	parent.assign(n, -1);
+	std::vector<int> ancestor(n, -1);
+	for (int k = 0; k < n; ++k) {
+		for (int p = C_ptr[k]; p < C_ptr[k + 1]; ++p) {
+			int i = C_idx[p];
+			while (i != -1 && i < k) {
+				int i_next = ancestor[i];
+				ancestor[i] = k;
+				if (i_next == -1)
+					parent[i] = k;
+				i = i_next;
+			}
+		}
+	}
+	// column counts of L from the row patterns
+	mark.assign(n, -1);
+	stack.resize(n);
+	std::vector<int> col_count(n, 1);
+	for (int k = 0; k < n; ++k)
+		for (int top = reach_row(k); top < n; ++top)
+			++col_count[stack[top]];
+	L_ptr.resize(n + 1);
+	L_ptr[0] = 0;
+	for (int k = 0; k < n; ++k)
+		L_ptr[k + 1] = L_ptr[k] + col_count[k];
+	L_idx.resize(L_ptr[n]);
+	L_val.resize(L_ptr[n]);
+	next.resize(n);
+	work.resize(n);
+	symbolic_valid = true;
+}
+/// compute numeric factorization and return false if matrix is not positive definite
+bool cholesky_sparse_les::factorize()
+{
+	for (size_t p = 0; p < C_src.size(); ++p)
+		C_val[p] = lower.values[C_src[p]];
+	std::fill(mark.begin(), mark.end(), -1);
+	std::fill(work.begin(), work.end(), 0.0);
+	std::copy(L_ptr.begin(), L_ptr.end() - 1, next.begin());
+	// up looking factorization computing one row of L per step
+	for (int k = 0; k < n; ++k) {
+		int top = reach_row(k);
+		work[k] = 0;
+		for (int p = C_ptr[k]; p < C_ptr[k + 1]; ++p)
+			work[C_idx[p]] = C_val[p];
+		double d = work[k];
+		work[k] = 0;
+		// solve L(0:k-1,0:k-1) * l = C(0:k-1,k) along the row pattern
+		for (; top < n; ++top) {
+			int i = stack[top];
+			double l_ki = work[i] / L_val[L_ptr[i]];
+			work[i] = 0;
+			for (int p = L_ptr[i] + 1; p < next[i]; ++p)
+				work[L_idx[p]] -= L_val[p] * l_ki;
+			d -= l_ki * l_ki;
+			int p = next[i]++;
+			L_idx[p] = k;
+			L_val[p] = l_ki;
+		}
+		if (d <= 0) {
+			std::cerr << "cholesky_sparse_les::solve: matrix not positive definite" << std::endl;
+			return false;
+		}
+		int p = next[k]++;
+		L_idx[p] = k;
+		L_val[p] = sqrt(d);
+	}
+	return true;
+}
+/// factorize matrix and solve for all right hand sides, fails if matrix is not positive definite
+bool cholesky_sparse_les::solve(bool analyze_residual)
+{
+	bool pattern_changed = assemble();
+	extract_lower_triangle(lower);
+	if (pattern_changed || !symbolic_valid)
+		analyze();
+	if (!factorize())
+		return false;
+	for (int j = 0; j < nr_rhs; ++j) {
+		double* x = &X[size_t(j)*n];
+		const double* b = &B[size_t(j)*n];
+		for (int k = 0; k < n; ++k)
+			work[k] = b[perm[k]];
+		// forward substitution with L
+		for (int k = 0; k < n; ++k) {
+			work[k] /= L_val[L_ptr[k]];
+			for (int p = L_ptr[k] + 1; p < L_ptr[k + 1]; ++p)
+				work[L_idx[p]] -= L_val[p] * work[k];
+		}
+		// backward substitution with L^T
+		for (int k = n - 1; k >= 0; --k) {
+			for (int p = L_ptr[k] + 1; p < L_ptr[k + 1]; ++p)
+				work[k] -= L_val[p] * work[L_idx[p]];
+			work[k] /= L_val[L_ptr[k]];
+		}
+		for (int k = 0; k < n; ++k)
+			x[perm[k]] = work[k];
+	}
+	if (analyze_residual) {
+		csr_matrix S;
+		expand_symmetric(lower, S);
+		analyze_residuals(S);
+	}
+	return true;
+}
+
+/// register the csr based solvers under the names "cholesky" and "pcg"
+void register_csr_sparse_les_factories(std::vector<sparse_les_factory_ptr>& factories)
+{
+	factories.push_back(sparse_les_factory_ptr(new sparse_les_factory_impl<cholesky_sparse_les>("cholesky", SparseLesCaps(SLC_SYMMETRIC | SLC_NZE_OPTIONAL))));
+	factories.push_back(sparse_les_factory_ptr(new sparse_les_factory_impl<pcg_sparse_les>("pcg", SparseLesCaps(SLC_SYMMETRIC | SLC_NZE_OPTIONAL))));
+}
+
+	}
+}
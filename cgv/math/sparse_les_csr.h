@@ -0,0 +1,172 @@
+#pragma once
+
+#include "sparse_les.h"
+#include <algorithm>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace math {
+
+/// sparse matrix in compressed sparse row format with column indices sorted within each row
+struct CGV_API csr_matrix
+{
+	/// start of each row in col_idx and values plus end of last row
+	std::vector<int> row_ptr;
+	/// column indices of the non zero entries
+	std::vector<int> col_idx;
+	/// values of the non zero entries
+	std::vector<double> values;
+	/// return the number of rows
+	int get_nr_rows() const { return row_ptr.empty() ? 0 : int(row_ptr.size()) - 1; }
+	/// return the number of non zero entries
+	int get_nr_non_zeros() const { return int(col_idx.size()); }
+	/// return the index of entry (r,c) in values or -1 if it is not part of the sparsity pattern
+	int find_entry(int r, int c) const;
+	/// compute y = A*x for the rows in [row_begin,row_end)
+	void multiply(const double* x, double* y, int row_begin, int row_end) const;
+	/// compute y = A*x
+	void multiply(const double* x, double* y) const;
+};
+
+/** base class for sparse les solvers that assemble the matrix A in compressed sparse row format.
+    Entries can be set in arbitrary order and setting an entry again overwrites its value. Once the
+	matrix has been assembled by a call to solve, entries of the existing sparsity pattern are updated
+	in place such that sequences of systems with the same pattern are assembled without sorting. */
+class CGV_API csr_sparse_les : public sparse_les
+{
+protected:
+	/// entry of A that is not part of the assembled sparsity pattern yet
+	struct triplet
+	{
+		int r, c;
+		double val;
+	};
+	int n, nr_rhs;
+	/// entries set since the last assembly
+	std::vector<triplet> triplets;
+	/// assembled matrix
+	csr_matrix A;
+	/// right hand sides and solutions stored one after the other
+	std::vector<double> B, X;
+	/// relative residuals of the last call to analyze_residuals
+	std::vector<double> residuals;
+	/// merge pending entries into A and return whether the sparsity pattern changed
+	bool assemble();
+	//! extract the lower triangle including the diagonal of the symmetric matrix defined by A.
+	/*! An entry above the diagonal is only used if its mirrored entry has not been set, such that
+	    it suffices to set one triangle of a symmetric matrix. */
+	void extract_lower_triangle(csr_matrix& L) const;
+	/// extend the lower triangle L to the full symmetric matrix S
+	static void expand_symmetric(const csr_matrix& L, csr_matrix& S);
+	/// compute and print the relative residuals of all right hand sides with respect to matrix M
+	void analyze_residuals(const csr_matrix& M);
+public:
+	/// construct solver for n unknowns and nr_rhs right hand sides, nr_nze is used to reserve memory
+	csr_sparse_les(int _n, int _nr_rhs, int nr_nze = -1);
+	using sparse_les::set_b_entry;
+	using sparse_les::ref_b_entry;
+	using sparse_les::get_x_entry;
+	/// set entry in row r and column c in the sparse matrix A
+	void set_mat_entry(int r, int c, double val);
+	/// set i-th entry in the j-th right hand side
+	void set_b_entry(int i, int j, double val);
+	/// set i-th entry in j-th right hand side
+	double& ref_b_entry(int i, int j);
+	/// return the i-th component of the j-th solution vector
+	double get_x_entry(int i, int j) const;
+	/// return the number of unknowns
+	int get_nr_unknowns() const { return n; }
+	/// return the number of right hand sides
+	int get_nr_rhs() const { return nr_rhs; }
+	/// return the assembled matrix, which does not include entries set after the last solve
+	const csr_matrix& get_matrix() const { return A; }
+	/// return the relative residual of the j-th right hand side computed during the last solve with residual analysis
+	double get_residual(int j = 0) const { return residuals.empty() ? -1.0 : residuals[j]; }
+};
+
+/** jacobi preconditioned conjugate gradient solver for symmetric positive definite systems. Sparse
+    matrix vector products and dot products are distributed over several threads for large systems.
+	The solution of the previous solve serves as initial guess, which speeds up sequences of
+	similar systems as they appear in iterative mesh smoothing. */
+class CGV_API pcg_sparse_les : public csr_sparse_les
+{
+protected:
+	double tolerance;
+	int max_nr_iterations;
+	unsigned nr_threads;
+	int min_nr_non_zeros_per_thread;
+	unsigned nr_used_threads;
+	int nr_iterations;
+	csr_matrix S;
+	std::vector<double> inv_diag, r, z, p, q;
+public:
+	/// construct solver for n unknowns and nr_rhs right hand sides
+	pcg_sparse_les(int _n, int _nr_rhs, int nr_nze = -1);
+	/// set relative residual norm at which iteration stops, defaults to 1e-10
+	void set_tolerance(double _tolerance) { tolerance = _tolerance; }
+	/// return tolerance
+	double get_tolerance() const { return tolerance; }
+	/// set maximum number of iterations per right hand side, where -1 corresponds to the number of unknowns
+	void set_max_nr_iterations(int _max_nr_iterations) { max_nr_iterations = _max_nr_iterations; }
+	/// return maximum number of iterations
+	int get_max_nr_iterations() const { return max_nr_iterations; }
+	/// set maximum number of threads, where 0 corresponds to the hardware concurrency
+	void set_nr_threads(unsigned _nr_threads) { nr_threads = _nr_threads; }
+	/// return maximum number of threads
+	unsigned get_nr_threads() const { return nr_threads; }
+	/// set minimum number of non zero matrix entries per thread that limits the number of used threads, defaults to 32768
+	void set_min_nr_non_zeros_per_thread(int _min_nr_non_zeros_per_thread) { min_nr_non_zeros_per_thread = std::max(_min_nr_non_zeros_per_thread, 1); }
+	/// return minimum number of non zero matrix entries per thread
+	int get_min_nr_non_zeros_per_thread() const { return min_nr_non_zeros_per_thread; }
+	/// return the number of threads used in the last solve
+	unsigned get_nr_used_threads() const { return nr_used_threads; }
+	/// return the maximum number of iterations used over all right hand sides in the last solve
+	int get_nr_iterations() const { return nr_iterations; }
+	/// solve system and fail if iteration does not converge or matrix is not positive definite
+	bool solve(bool analyze_residual = false);
+};
+
+/** direct solver for symmetric positive definite systems based on a sparse cholesky factorization
+    P*A*P^T = L*L^T. The symbolic analysis computes an approximate minimum degree ordering P, the elimination
+	tree and the sparsity pattern of L. It is reused as long as the sparsity pattern of A does not
+	change, such that only the numeric factorization is repeated if solely values are updated. */
+class CGV_API cholesky_sparse_les : public csr_sparse_les
+{
+protected:
+	bool symbolic_valid;
+	csr_matrix lower;
+	/// fill reducing permutation with perm[new index] = old index and its inverse
+	std::vector<int> perm, perm_inv;
+	/// upper triangle of P*A*P^T in compressed column format together with source entries in lower
+	std::vector<int> C_ptr, C_idx, C_src;
+	std::vector<double> C_val;
+	/// elimination tree
+	std::vector<int> parent;
+	/// cholesky factor in compressed column format with the diagonal entry first in each column
+	std::vector<int> L_ptr, L_idx;
+	std::vector<double> L_val;
+	std::vector<int> mark, stack, next;
+	std::vector<double> work;
+	/// compute ordering, elimination tree and pattern of factor
+	void analyze();
+	/// compute non zero pattern of row k of L in stack[top...n-1] and return top
+	int reach_row(int k);
+	/// compute numeric factorization and return false if matrix is not positive definite
+	bool factorize();
+public:
+	/// construct solver for n unknowns and nr_rhs right hand sides
+	cholesky_sparse_les(int _n, int _nr_rhs, int nr_nze = -1);
+	/// return number of non zero entries in the cholesky factor
+	int get_nr_factor_non_zeros() const { return int(L_idx.size()); }
+	/// factorize matrix and solve for all right hand sides, fails if matrix is not positive definite
+	bool solve(bool analyze_residual = false);
+};
+
+/// register the csr based solvers under the names "cholesky" and "pcg", which is done automatically on first access to the solver factories
+extern CGV_API void register_csr_sparse_les_factories(std::vector<sparse_les_factory_ptr>& factories);
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
@@ -40,6 +40,8 @@ bool svd(const mat<T> &a, mat<T> &u, diag_mat<T> &w,  mat<T> &v,bool ordering=tr
 		int i,its,j,jj,k,l,nm;
 		T anorm,c,f,g,h,s,scale,x,y,z;
 		vec<T> rv1(n);
+		//temporary vectors for the householder updates done with the dense kernels
+		vec<T> row(n), tmp((std::max)(m,n));
 		g = scale = anorm = 0.0;
 		for (i=0;i<n;i++) {
 			l=i+2;
@@ -56,10 +58,9 @@ bool svd(const mat<T> &a, mat<T> &u, diag_mat<T> &w,  mat<T> &v,bool ordering=tr
 					g = -sign(std::sqrt(s),f);
 					h=f*g-s;
 					u(i,i)=f-g;
-					for (j=l-1;j<n;j++) {
-						for (s=0.0,k=i;k<m;k++) s += u(k,i)*u(k,j);
-						f=s/h;
-						for (k=i;k<m;k++) u(k,j) += f*u(k,i);
+					if (l-1 < n) {
+						gemv_kernel(true, m-i, n-l+1, (T)1/h, &u(i,l-1), m, &u(i,i), (T)0, &tmp[l-1]);
+						ger_kernel(m-i, n-l+1, (T)1, &u(i,i), &tmp[l-1], &u(i,l-1), m);
 					}
 					for (k=i;k<m;k++) u(k,i) *= scale;
 				}
@@ -77,10 +78,13 @@ bool svd(const mat<T> &a, mat<T> &u, diag_mat<T> &w,  mat<T> &v,bool ordering=tr
 					g = -sign(std::sqrt(s),f);
 					h=f*g-s;
 					u(i,l-1)=f-g;
-					for (k=l-1;k<n;k++) rv1[k]=u(i,k)/h;
-					for (j=l-1;j<m;j++) {
-						for (s=0.0,k=l-1;k<n;k++) s += u(j,k)*u(i,k);
-						for (k=l-1;k<n;k++) u(j,k) += s*rv1[k];
+					for (k=l-1;k<n;k++) {
+						rv1[k]=u(i,k)/h;
+						row[k]=u(i,k);
+					}
+					if (l-1 < m) {
+						gemv_kernel(false, m-l+1, n-l+1, (T)1, &u(l-1,l-1), m, &row[l-1], (T)0, &tmp[l-1]);
+						ger_kernel(m-l+1, n-l+1, (T)1, &tmp[l-1], &rv1[l-1], &u(l-1,l-1), m);
 					}
 					for (k=l-1;k<n;k++) u(i,k) *= scale;
 				}
@@ -90,12 +94,12 @@ bool svd(const mat<T> &a, mat<T> &u, diag_mat<T> &w,  mat<T> &v,bool ordering=tr
 		for (i=n-1;i>=0;i--) {
 			if (i < n-1) {
 				if (g != 0.0) {
-					for (j=l;j<n;j++)
-						v(j,i)=(u(i,j)/u(i,l))/g;
 					for (j=l;j<n;j++) {
-						for (s=0.0,k=l;k<n;k++) s += u(i,k)*v(k,j);
-						for (k=l;k<n;k++) v(k,j) += s*v(k,i);
+						v(j,i)=(u(i,j)/u(i,l))/g;
+						row[j]=u(i,j);
 					}
+					gemv_kernel(true, n-l, n-l, (T)1, &v(l,l), n, &row[l], (T)0, &tmp[l]);
+					ger_kernel(n-l, n-l, (T)1, &v(l,i), &tmp[l], &v(l,l), n);
 				}
 				for (j=l;j<n;j++) v(i,j)=v(j,i)=0.0;
 			}
@@ -109,10 +113,9 @@ bool svd(const mat<T> &a, mat<T> &u, diag_mat<T> &w,  mat<T> &v,bool ordering=tr
 			for (j=l;j<n;j++) u(i,j)=0.0;
 			if (g != 0.0) {
 				g=(T)1.0/g;
-				for (j=l;j<n;j++) {
-					for (s=0.0,k=l;k<m;k++) s += u(k,i)*u(k,j);
-					f=(s/u(i,i))*g;
-					for (k=i;k<m;k++) u(k,j) += f*u(k,i);
+				if (l < n && l < m) {
+					gemv_kernel(true, m-l, n-l, g/u(i,i), &u(l,l), m, &u(l,i), (T)0, &tmp[l]);
+					ger_kernel(m-i, n-l, (T)1, &u(i,i), &tmp[l], &u(i,l), m);
 				}
 				for (j=i;j<m;j++) u(j,i) *= g;
 			} else for (j=i;j<m;j++) u(j,i)=0.0;
@@ -142,12 +145,7 @@ bool svd(const mat<T> &a, mat<T> &u, diag_mat<T> &w,  mat<T> &v,bool ordering=tr
 						h=(T)1.0/h;
 						c=g*h;
 						s = -f*h;
-						for (j=0;j<m;j++) {
-							y=u(j,nm);
-							z=u(j,i);
-							u(j,nm)=y*c+z*s;
-							u(j,i)=z*c-y*s;
-						}
+						rot_kernel((unsigned)m, &u(0,nm), &u(0,i), c, s);
 					}
 				}
 				z=w[k];
@@ -183,12 +181,7 @@ bool svd(const mat<T> &a, mat<T> &u, diag_mat<T> &w,  mat<T> &v,bool ordering=tr
 					g=g*c-x*s;
 					h=y*s;
 					y *= c;
-					for (jj=0;jj<n;jj++) {
-						x=v(jj,j);
-						z=v(jj,i);
-						v(jj,j)=x*c+z*s;
-						v(jj,i)=z*c-x*s;
-					}
+					rot_kernel((unsigned)n, &v(0,j), &v(0,i), c, s);
 					z=pythag(f,h);
 					w[j]=z;
 					if (z) {
@@ -198,12 +191,7 @@ bool svd(const mat<T> &a, mat<T> &u, diag_mat<T> &w,  mat<T> &v,bool ordering=tr
 					}
 					f=c*g+s*y;
 					x=c*y-s*g;
-					for (jj=0;jj<m;jj++) {
-						y=u(jj,j);
-						z=u(jj,i);
-						u(jj,j)=y*c+z*s;
-						u(jj,i)=z*c-y*s;
-					}
+					rot_kernel((unsigned)m, &u(0,j), &u(0,i), c, s);
 				}
 				rv1[l]=0.0;
 				rv1[k]=f;
@@ -8,10 +8,13 @@ namespace cgv {
 	namespace media {
 		namespace mesh {
 
+template <typename T> class CGV_API dynamic_mesh_deformer;
+
 /// the simple_mesh class is templated over the coordinate type that defaults to float
 template <typename T = float>
 class CGV_API dynamic_mesh : public simple_mesh<T>
 {
+	friend class dynamic_mesh_deformer<T>;
 public:
 	using typename simple_mesh_base::idx_type;
 	using typename simple_mesh_base::vec2i;
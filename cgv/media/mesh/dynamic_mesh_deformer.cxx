@@ -0,0 +1,396 @@
+#include "dynamic_mesh_deformer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <cgv/utils/zone_profiler.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CGV_MEDIA_MESH_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+/// worker threads that wait for a job, execute it together with the calling thread and signal its completion
+template <typename T>
+struct dynamic_mesh_deformer<T>::worker_pool
+{
+	std::vector<std::thread> threads;
+	std::mutex mtx;
+	std::condition_variable start_condition, done_condition;
+	uint64_t generation = 0;
+	unsigned nr_running = 0;
+	bool stop = false;
+	std::function<void()> job;
+	worker_pool(unsigned nr_workers)
+	{
+		for (unsigned i = 0; i < nr_workers; ++i)
+			threads.push_back(std::thread(&worker_pool::run, this));
+	}
+	~worker_pool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			stop = true;
+		}
+		start_condition.notify_all();
+		for (auto& t : threads)
+			t.join();
+	}
+	void run()
+	{
+		uint64_t executed_generation = 0;
+		for (;;) {
+			{
+				std::unique_lock<std::mutex> lock(mtx);
+				start_condition.wait(lock, [&]() { return stop || generation != executed_generation; });
+				if (stop)
+					return;
+				executed_generation = generation;
+			}
+			job();
+			std::lock_guard<std::mutex> lock(mtx);
+			if (--nr_running == 0)
+				done_condition.notify_one();
+		}
+	}
+	/// execute f on all workers and the calling thread and return after all calls finished
+	void execute(const std::function<void()>& f)
+	{
+		if (threads.empty()) {
+			f();
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mtx);
+			job = f;
+			nr_running = unsigned(threads.size());
+			++generation;
+		}
+		start_condition.notify_all();
+		f();
+		std::unique_lock<std::mutex> lock(mtx);
+		done_condition.wait(lock, [&]() { return nr_running == 0; });
+	}
+};
+
+template <typename T>
+dynamic_mesh_deformer<T>::dynamic_mesh_deformer(unsigned nr_threads)
+{
+	if (nr_threads == 0)
+		nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+	workers.reset(new worker_pool(nr_threads - 1));
+}
+
+template <typename T>
+dynamic_mesh_deformer<T>::~dynamic_mesh_deformer()
+{
+}
+
+template <typename T>
+unsigned dynamic_mesh_deformer<T>::get_nr_threads() const
+{
+	return unsigned(workers->threads.size() + 1);
+}
+
+template <typename T>
+void dynamic_mesh_deformer<T>::prepare(const dynamic_mesh<T>& mesh, bool quantize_blend_shapes, unsigned max_nr_weights_per_vertex)
+{
+	CGV_PROFILE_ZONE_CAT("dynamic_mesh_deformer prepare", "mesh");
+	// reference positions
+	const std::vector<vec3>& P = mesh.reference_positions.empty() ? mesh.get_positions() : mesh.reference_positions;
+	nr_vertices = uint32_t(P.size());
+	nr_blocks = (nr_vertices + block_size - 1) / block_size;
+	ref_x.resize(nr_vertices);
+	ref_y.resize(nr_vertices);
+	ref_z.resize(nr_vertices);
+	for (uint32_t vi = 0; vi < nr_vertices; ++vi) {
+		ref_x[vi] = P[vi][0];
+		ref_y[vi] = P[vi][1];
+		ref_z[vi] = P[vi][2];
+	}
+	positions = P;
+
+	// convert blend shapes to sorted runs of consecutive vertices and copy their offsets in run order
+	quantized = quantize_blend_shapes;
+	shapes.clear();
+	runs.clear();
+	std::vector<vec3> offsets;
+	for (const auto& bs : mesh.blend_shapes) {
+		// collect runs with offsets into blend_shape_data
+		std::vector<blend_shape_run> shape_runs;
+		uint32_t d = bs.blend_shape_data_range[0];
+		switch (bs.mode) {
+		case dynamic_mesh<T>::blend_shape_mode::direct:
+			shape_runs.push_back({ 0, bs.blend_shape_data_range[1] - d, d });
+			break;
+		case dynamic_mesh<T>::blend_shape_mode::indexed: {
+			std::vector<std::pair<uint32_t, uint32_t> > vertex_data;
+			for (uint32_t j = bs.blend_shape_index_range[0]; d < bs.blend_shape_data_range[1]; ++d, ++j)
+				vertex_data.push_back({ mesh.blend_shape_indices[j], d });
+			std::sort(vertex_data.begin(), vertex_data.end());
+			for (const auto& vd : vertex_data) {
+				if (!shape_runs.empty() && shape_runs.back().end == vd.first && shape_runs.back().data_offset + (shape_runs.back().end - shape_runs.back().begin) == vd.second)
+					++shape_runs.back().end;
+				else
+					shape_runs.push_back({ vd.first, vd.first + 1, vd.second });
+			}
+			break;
+		}
+		case dynamic_mesh<T>::blend_shape_mode::range_indexed:
+			for (uint32_t j = bs.blend_shape_index_range[0]; j < bs.blend_shape_index_range[1]; j += 2) {
+				uint32_t b = mesh.blend_shape_indices[j], e = mesh.blend_shape_indices[j + 1];
+				shape_runs.push_back({ b, e, d });
+				d += e - b;
+			}
+			std::sort(shape_runs.begin(), shape_runs.end(), [](const blend_shape_run& r0, const blend_shape_run& r1) { return r0.begin < r1.begin; });
+			break;
+		}
+		// append runs restricted to the mesh vertices and copy offsets
+		compiled_blend_shape cs;
+		cs.run_begin = uint32_t(runs.size());
+		T max_abs = 0;
+		for (auto r : shape_runs) {
+			r.end = std::min(r.end, nr_vertices);
+			if (r.begin >= r.end)
+				continue;
+			uint32_t o = uint32_t(offsets.size());
+			for (uint32_t i = 0; i < r.end - r.begin; ++i) {
+				const vec3& v = mesh.blend_shape_data[r.data_offset + i];
+				offsets.push_back(v);
+				max_abs = std::max(max_abs, std::max(std::abs(v[0]), std::max(std::abs(v[1]), std::abs(v[2]))));
+			}
+			r.data_offset = o;
+			runs.push_back(r);
+		}
+		cs.run_end = uint32_t(runs.size());
+		cs.scale = quantized ? max_abs / 32767 : T(1);
+		shapes.push_back(cs);
+	}
+	size_t n = offsets.size();
+	qoff_x.clear(); qoff_y.clear(); qoff_z.clear();
+	off_x.clear(); off_y.clear(); off_z.clear();
+	if (quantized) {
+		qoff_x.resize(n); qoff_y.resize(n); qoff_z.resize(n);
+		for (const auto& cs : shapes) {
+			T inv_scale = cs.scale > 0 ? T(1) / cs.scale : T(0);
+			for (uint32_t ri = cs.run_begin; ri < cs.run_end; ++ri)
+				for (uint32_t i = runs[ri].data_offset; i < runs[ri].data_offset + runs[ri].end - runs[ri].begin; ++i) {
+					qoff_x[i] = int16_t(std::lround(offsets[i][0] * inv_scale));
+					qoff_y[i] = int16_t(std::lround(offsets[i][1] * inv_scale));
+					qoff_z[i] = int16_t(std::lround(offsets[i][2] * inv_scale));
+				}
+		}
+	}
+	else {
+		off_x.resize(n); off_y.resize(n); off_z.resize(n);
+		for (size_t i = 0; i < n; ++i) {
+			off_x[i] = offsets[i][0];
+			off_y[i] = offsets[i][1];
+			off_z[i] = offsets[i][2];
+		}
+	}
+	// first run per blend shape and block, initialized to the end of the runs of the blend shape
+	block_first_run.resize(size_t(shapes.size()) * nr_blocks);
+	for (size_t si = 0; si < shapes.size(); ++si) {
+		uint32_t* first_run = &block_first_run[si * nr_blocks];
+		std::fill(first_run, first_run + nr_blocks, shapes[si].run_end);
+		for (uint32_t ri = shapes[si].run_end; ri > shapes[si].run_begin; ) {
+			--ri;
+			for (uint32_t bi = runs[ri].begin / block_size; bi <= (runs[ri].end - 1) / block_size; ++bi)
+				first_run[bi] = ri;
+		}
+	}
+
+	// prune, normalize, quantize and sort vertex weights
+	nr_joints = uint32_t(mesh.get_nr_joints());
+	assert(nr_joints <= 65536);
+	weight_begins.assign(1, 0);
+	weight_joints.clear();
+	weight_values.clear();
+	bool has_weights = !mesh.vertex_weight_data.empty();
+	std::vector<std::pair<T, uint32_t> > vertex_weights;
+	for (uint32_t vi = 0; vi < nr_vertices; ++vi) {
+		vertex_weights.clear();
+		if (has_weights) {
+			switch (mesh.weight_mode) {
+			case dynamic_mesh<T>::vertex_weight_mode::dense:
+				for (uint32_t ji = 0; ji < nr_joints; ++ji)
+					vertex_weights.push_back({ mesh.vertex_weight_data[size_t(vi) * nr_joints + ji], ji });
+				break;
+			// like dynamic_mesh::lbs, fixed weights are addressed through the index begins as sparse weights
+			case dynamic_mesh<T>::vertex_weight_mode::sparse:
+			case dynamic_mesh<T>::vertex_weight_mode::fixed: {
+				size_t beg = mesh.vertex_weight_index_begins[vi];
+				size_t end = vi + 1 < mesh.vertex_weight_index_begins.size() ? mesh.vertex_weight_index_begins[vi + 1] : mesh.vertex_weight_indices.size();
+				for (size_t wi = beg; wi < end; ++wi)
+					vertex_weights.push_back({ mesh.vertex_weight_data[wi], mesh.vertex_weight_indices[wi] });
+				break;
+			}
+			}
+		}
+		// keep largest positive weights
+		std::sort(vertex_weights.begin(), vertex_weights.end(), [](const std::pair<T, uint32_t>& w0, const std::pair<T, uint32_t>& w1) { return w0.first > w1.first; });
+		while (!vertex_weights.empty() && (vertex_weights.size() > max_nr_weights_per_vertex || !(vertex_weights.back().first > 0)))
+			vertex_weights.pop_back();
+		T sum = 0;
+		for (const auto& w : vertex_weights)
+			sum += w.first;
+		// quantize such that the weights sum up to 65535 exactly
+		size_t first = weight_values.size();
+		int total = 0;
+		for (const auto& w : vertex_weights) {
+			uint16_t q = uint16_t(std::lround(w.first / sum * 65535));
+			if (q == 0)
+				continue;
+			weight_joints.push_back(uint16_t(w.second));
+			weight_values.push_back(q);
+			total += q;
+		}
+		if (weight_values.size() > first)
+			weight_values[first] = uint16_t(int(weight_values[first]) + 65535 - total);
+		// sort by joint index for more coherent access to the joint matrices
+		for (size_t i = first + 1; i < weight_values.size(); ++i)
+			for (size_t j = i; j > first && weight_joints[j - 1] > weight_joints[j]; --j) {
+				std::swap(weight_joints[j - 1], weight_joints[j]);
+				std::swap(weight_values[j - 1], weight_values[j]);
+			}
+		weight_begins.push_back(uint32_t(weight_values.size()));
+	}
+}
+
+template <typename T>
+void dynamic_mesh_deformer<T>::deform_block(uint32_t bi, const T* weights, const uint32_t* active_shapes, uint32_t nr_active_shapes, const T* joint_data)
+{
+	const uint32_t b = bi * block_size, e = std::min(b + block_size, nr_vertices), n = e - b;
+	T ax[block_size], ay[block_size], az[block_size];
+	std::copy(&ref_x[b], &ref_x[b] + n, ax);
+	std::copy(&ref_y[b], &ref_y[b] + n, ay);
+	std::copy(&ref_z[b], &ref_z[b] + n, az);
+	// accumulate offsets of active blend shapes
+	for (uint32_t ai = 0; ai < nr_active_shapes; ++ai) {
+		uint32_t si = active_shapes[ai];
+		const compiled_blend_shape& cs = shapes[si];
+		for (uint32_t ri = block_first_run[size_t(si) * nr_blocks + bi]; ri < cs.run_end && runs[ri].begin < e; ++ri) {
+			const blend_shape_run& r = runs[ri];
+			if (r.end <= b)
+				continue;
+			uint32_t v0 = std::max(r.begin, b), v1 = std::min(r.end, e);
+			uint32_t o = r.data_offset + v0 - r.begin, m = v1 - v0;
+			T* x = ax + (v0 - b), *y = ay + (v0 - b), *z = az + (v0 - b);
+			if (quantized) {
+				T w = weights[ai] * cs.scale;
+				const int16_t* qx = &qoff_x[o], *qy = &qoff_y[o], *qz = &qoff_z[o];
+				for (uint32_t i = 0; i < m; ++i) {
+					x[i] += w * qx[i];
+					y[i] += w * qy[i];
+					z[i] += w * qz[i];
+				}
+			}
+			else {
+				T w = weights[ai];
+				const T* dx = &off_x[o], *dy = &off_y[o], *dz = &off_z[o];
+				for (uint32_t i = 0; i < m; ++i) {
+					x[i] += w * dx[i];
+					y[i] += w * dy[i];
+					z[i] += w * dz[i];
+				}
+			}
+		}
+	}
+	vec3* out = &positions[b];
+	if (!joint_data) {
+		for (uint32_t i = 0; i < n; ++i)
+			out[i] = vec3(ax[i], ay[i], az[i]);
+		return;
+	}
+	// skin with blended joint matrices, where vertices without weights are mapped to the origin as in dynamic_mesh::lbs
+	const uint32_t* wb = &weight_begins[b];
+#ifdef CGV_MEDIA_MESH_USE_SSE
+	if (std::is_same<T, float>::value) {
+		const float* J = reinterpret_cast<const float*>(joint_data);
+		for (uint32_t i = 0; i < n; ++i) {
+			__m128 c0 = _mm_setzero_ps(), c1 = c0, c2 = c0, c3 = c0;
+			for (uint32_t wi = wb[i]; wi < wb[i + 1]; ++wi) {
+				const float* M = J + 16 * weight_joints[wi];
+				__m128 w = _mm_set1_ps(float(weight_values[wi]) * (1.0f / 65535));
+				c0 = _mm_add_ps(c0, _mm_mul_ps(w, _mm_loadu_ps(M)));
+				c1 = _mm_add_ps(c1, _mm_mul_ps(w, _mm_loadu_ps(M + 4)));
+				c2 = _mm_add_ps(c2, _mm_mul_ps(w, _mm_loadu_ps(M + 8)));
+				c3 = _mm_add_ps(c3, _mm_mul_ps(w, _mm_loadu_ps(M + 12)));
+			}
+			__m128 q = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(float(ax[i]))), _mm_mul_ps(c1, _mm_set1_ps(float(ay[i])))),
+				_mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(float(az[i]))), c3));
+			float r[4];
+			_mm_storeu_ps(r, q);
+			out[i] = vec3(T(r[0]), T(r[1]), T(r[2]));
+		}
+		return;
+	}
+#endif
+	for (uint32_t i = 0; i < n; ++i) {
+		T c[12] = { 0 };
+		for (uint32_t wi = wb[i]; wi < wb[i + 1]; ++wi) {
+			const T* M = joint_data + 16 * weight_joints[wi];
+			T w = T(weight_values[wi]) * (T(1) / 65535);
+			for (unsigned k = 0; k < 3; ++k) {
+				c[k] += w * M[k];
+				c[3 + k] += w * M[4 + k];
+				c[6 + k] += w * M[8 + k];
+				c[9 + k] += w * M[12 + k];
+			}
+		}
+		for (unsigned k = 0; k < 3; ++k)
+			out[i][k] = c[k] * ax[i] + c[3 + k] * ay[i] + c[6 + k] * az[i] + c[9 + k];
+	}
+}
+
+template <typename T>
+void dynamic_mesh_deformer<T>::deform(const std::vector<T>& blend_shape_weights, const std::vector<mat4>& joint_matrices, idx_type blend_shape_offset)
+{
+	CGV_PROFILE_ZONE_CAT("dynamic_mesh_deformer deform", "mesh");
+	// collect blend shapes with non zero weight
+	std::vector<uint32_t> active_shapes;
+	std::vector<T> active_weights;
+	for (size_t wi = 0; wi < blend_shape_weights.size(); ++wi)
+		if (blend_shape_weights[wi] != 0 && blend_shape_offset + wi < shapes.size()) {
+			active_shapes.push_back(uint32_t(blend_shape_offset + wi));
+			active_weights.push_back(blend_shape_weights[wi]);
+		}
+	// pack joint matrices
+	std::vector<T> joint_data;
+	if (!joint_matrices.empty() && !weight_values.empty()) {
+		assert(joint_matrices.size() >= nr_joints);
+		joint_data.resize(16 * joint_matrices.size());
+		for (size_t ji = 0; ji < joint_matrices.size(); ++ji)
+			std::copy(&joint_matrices[ji](0, 0), &joint_matrices[ji](0, 0) + 16, &joint_data[16 * ji]);
+	}
+	positions.resize(nr_vertices);
+	std::atomic<uint32_t> next_block(0);
+	workers->execute([&]() {
+		for (uint32_t bi; (bi = next_block.fetch_add(1, std::memory_order_relaxed)) < nr_blocks; )
+			deform_block(bi, active_weights.data(), active_shapes.data(), uint32_t(active_shapes.size()), joint_data.empty() ? 0 : joint_data.data());
+	});
+}
+
+template <typename T>
+void dynamic_mesh_deformer<T>::store_positions(dynamic_mesh<T>& mesh) const
+{
+	mesh.ref_positions() = positions;
+}
+
+template class dynamic_mesh_deformer<float>;
+template class dynamic_mesh_deformer<double>;
+
+		}
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cgv/media/mesh/dynamic_mesh.h>
+#include <memory>
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace mesh {
+
+/** CPU deformation engine for dynamic meshes that applies blend shapes followed by linear blend
+    skinning in one pass over the vertices. In prepare() the reference positions, blend shapes and
+	vertex weights of a dynamic_mesh are compiled into tables tuned for repeated deformation:
+	- reference positions and blend shape offsets are stored in structure of arrays layout
+	- blend shapes of all modes are converted to runs of consecutive vertices whose offsets can
+	  optionally be quantized to 16 bit integers with one scale per blend shape
+	- vertex weights are pruned to the largest max_nr_weights_per_vertex positive weights, renormalized,
+	  quantized to 16 bit and sorted by joint index, such that the result only equals dynamic_mesh::lbs
+	  for vertices whose weights are positive and sum up to one
+
+	deform() splits the vertices into blocks of block_size vertices that are pulled by the calling
+	thread and a set of persistent worker threads from a shared counter. Each block is blended in
+	a cache resident accumulator and skinned with SSE 4x4 transformations for float meshes. Blend
+	shapes with zero weight are skipped. The result is available as array of positions and can be
+	copied to the position attribute of the mesh. As in dynamic_mesh::lbs, vertices without weights are mapped
+	to the origin by skinning and fixed vertex weights are addressed through the vertex weight index begins.
+	The mesh must not be changed after prepare(). */
+template <typename T = float>
+class CGV_API dynamic_mesh_deformer
+{
+public:
+	typedef typename dynamic_mesh<T>::idx_type idx_type;
+	typedef typename dynamic_mesh<T>::vec3 vec3;
+	typedef typename dynamic_mesh<T>::mat4 mat4;
+	/// number of vertices processed as one work item
+	static const uint32_t block_size = 1024;
+protected:
+	/// number of vertices
+	uint32_t nr_vertices = 0;
+	/// number of vertex blocks
+	uint32_t nr_blocks = 0;
+	/// reference positions in structure of arrays layout
+	std::vector<T> ref_x, ref_y, ref_z;
+	/// run of consecutive vertices affected by a blend shape
+	struct blend_shape_run
+	{
+		uint32_t begin, end;
+		/// offset of first vertex of run in the offset arrays
+		uint32_t data_offset;
+	};
+	/// blend shape compiled to runs
+	struct compiled_blend_shape
+	{
+		/// first and end index in runs
+		uint32_t run_begin, run_end;
+		/// scale of quantized offsets
+		T scale;
+	};
+	std::vector<compiled_blend_shape> shapes;
+	std::vector<blend_shape_run> runs;
+	/// for each blend shape and block the index of the first run that ends after the block begin
+	std::vector<uint32_t> block_first_run;
+	/// whether blend shape offsets are quantized
+	bool quantized = false;
+	/// quantized blend shape offsets in structure of arrays layout
+	std::vector<int16_t> qoff_x, qoff_y, qoff_z;
+	/// unquantized blend shape offsets in structure of arrays layout
+	std::vector<T> off_x, off_y, off_z;
+	/// for each vertex the index of its first weight, with an additional entry at the end
+	std::vector<uint32_t> weight_begins;
+	/// joint index per weight
+	std::vector<uint16_t> weight_joints;
+	/// weights quantized such that 65535 corresponds to one
+	std::vector<uint16_t> weight_values;
+	/// number of joints
+	uint32_t nr_joints = 0;
+	/// deformed positions
+	std::vector<vec3> positions;
+	/// persistent worker threads
+	struct worker_pool;
+	std::unique_ptr<worker_pool> workers;
+	/// deform vertices of one block
+	void deform_block(uint32_t bi, const T* weights, const uint32_t* active_shapes, uint32_t nr_active_shapes, const T* joint_data);
+	/// no copies due to worker threads
+	dynamic_mesh_deformer(const dynamic_mesh_deformer&) = delete;
+	dynamic_mesh_deformer& operator = (const dynamic_mesh_deformer&) = delete;
+public:
+	/// construct with given number of threads including the calling thread, where 0 corresponds to the hardware concurrency
+	dynamic_mesh_deformer(unsigned nr_threads = 0);
+	/// stop worker threads
+	~dynamic_mesh_deformer();
+	/// return number of threads used in deform including the calling thread
+	unsigned get_nr_threads() const;
+	//! compile reference positions, blend shapes and vertex weights of mesh
+	/*! If the mesh has no reference positions, the current positions are used. Blend shape offsets are quantized
+	    to 16 bit with one scale per blend shape if quantize_blend_shapes is true, which halves the memory traffic
+	    at the cost of a relative error of up to 1/65534 of the largest offset of each blend shape. */
+	void prepare(const dynamic_mesh<T>& mesh, bool quantize_blend_shapes = false, unsigned max_nr_weights_per_vertex = 8);
+	/// return the number of vertices
+	uint32_t get_nr_vertices() const { return nr_vertices; }
+	//! apply weights.size() blend shapes starting at blend_shape_offset to the reference positions followed by skinning with the joint matrices
+	/*! Each of the stages is skipped if the corresponding vector is empty. Skinning needs one matrix per joint
+	    of the mesh and is also skipped if the mesh has no vertex weights at all. */
+	void deform(const std::vector<T>& blend_shape_weights, const std::vector<mat4>& joint_matrices, idx_type blend_shape_offset = 0);
+	/// return the deformed positions
+	const std::vector<vec3>& get_positions() const { return positions; }
+	/// copy the deformed positions to the position attribute of the mesh
+	void store_positions(dynamic_mesh<T>& mesh) const;
+};
+
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
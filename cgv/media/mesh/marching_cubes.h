@@ -2,6 +2,9 @@
 
 #include <vector>
 #include <deque>
+#include <thread>
+#include <unordered_map>
+#include <cstdint>
 #include <cgv/utils/progression.h>
 #include <cgv/math/fvec.h>
 #include <cgv/math/mfunc.h>
@@ -78,6 +81,27 @@ private:
 	pnt_type p;
 	vec_type d;
 	T iso_value;
+	/// index of the currently processed slice
+	unsigned int slice_index;
+	/// resolution in x and y used to compute vertex keys
+	unsigned int key_resx, key_resy;
+	/// if not null, a key identifying the grid edge or snapped grid point is recorded for each new vertex
+	std::vector<uint64_t>* vertex_keys;
+	/// compute key of the edge e starting at grid point (i,j,k) or of the grid point itself for e = 3
+	uint64_t vertex_key(unsigned int i, unsigned int j, unsigned int k, int e) const {
+		return (((uint64_t)k*key_resy + j)*key_resx + i) * 4 + e;
+	}
+	/// callback handler that records the vertices and triangles extracted from one slab in parallel mode
+	struct slab_recorder : public streaming_mesh_callback_handler
+	{
+		const marching_cubes_base<X, T>* mc;
+		std::vector<pnt_type> pnts;
+		std::vector<unsigned int> triangles;
+		std::vector<uint64_t> keys;
+		void new_vertex(unsigned int vertex_index) { pnts.push_back(mc->vertex_location(vertex_index)); }
+		void new_polygon(const std::vector<unsigned int>& vertex_indices) { triangles.insert(triangles.end(), vertex_indices.begin(), vertex_indices.end()); }
+		void before_drop_vertex(unsigned int vertex_index) {}
+	};
 protected:
 	X epsilon;
 	X grid_epsilon;
@@ -85,7 +109,7 @@ public:
 	/// construct marching cubes object
 	marching_cubes_base(streaming_mesh_callback_handler* _smcbh, 
 				   const X& _grid_epsilon = 0.01f, 
-				   const X& _epsilon = 1e-6f) : epsilon(_epsilon), grid_epsilon(_grid_epsilon)
+				   const X& _epsilon = 1e-6f) : epsilon(_epsilon), grid_epsilon(_grid_epsilon), vertex_keys(0)
 	{
 		base_type::set_callback_handler(_smcbh);
 	}
@@ -101,6 +125,9 @@ public:
 		// check whether to snap to edge start
 		int vi = base_type::get_nr_vertices();
 		pnt_type q = p;
+		// edges in z-direction start on the previous slice
+		unsigned int k_1 = e == 2 ? slice_index - 1 : slice_index;
+		uint64_t key;
 		if (f < grid_epsilon) {
 			int vj = info_ptr_1->snap_index(i_1, j_1);
 			if (vj != -1) {
@@ -109,6 +136,7 @@ public:
 			}
 			info_ptr_1->snap_index(i_1, j_1) = vi;
 			q(e) -= d(e);
+			key = vertex_key(i_1, j_1, k_1, 3);
 		}
 		else if (1 - f < grid_epsilon) {
 			int vj = info_ptr_2->snap_index(i_2, j_2);
@@ -117,10 +145,14 @@ public:
 				return;
 			}
 			info_ptr_2->snap_index(i_2, j_2) = vi;
+			key = vertex_key(i_2, j_2, slice_index, 3);
 		}
-		else
+		else {
 			q(e) -= (1 - f)*d(e);
-
+			key = vertex_key(i_1, j_1, k_1, e);
+		}
+		if (vertex_keys)
+			vertex_keys->push_back(key);
 		info_ptr_1->index(i_1, j_1, e) = vi;
 		this->new_vertex(q);
 	}
@@ -131,16 +163,28 @@ public:
 		const axis_aligned_box<X, 3>& box,
 		unsigned int resx, unsigned int resy, unsigned int resz,
 		const Eval& eval, const Valid& valid, bool show_progress = false)
+	{
+		// prepare progression
+		cgv::utils::progression prog;
+		if (show_progress) prog.init("extraction", resz, 10);
+
+		extract_slab(_iso_value, box, resx, resy, resz, 0, resz - 1, eval, valid, show_progress ? &prog : 0);
+	}
+	/// extract the part of the iso surface between slices k_begin and k_end including both
+	template <typename Eval, typename Valid>
+	void extract_slab(const T& _iso_value,
+		const axis_aligned_box<X, 3>& box,
+		unsigned int resx, unsigned int resy, unsigned int resz,
+		unsigned int k_begin, unsigned int k_end,
+		const Eval& eval, const Valid& valid, cgv::utils::progression* prog_ptr = 0)
 	{
 		// prepare private members
 		p = box.get_min_pnt();
 		d = box.get_extent();
 		d(0) /= (resx - 1); d(1) /= (resy - 1); d(2) /= (resz - 1);
 		iso_value = _iso_value;
-
-		// prepare progression
-		cgv::utils::progression prog;
-		if (show_progress) prog.init("extraction", resz, 10);
+		key_resx = resx;
+		key_resy = resy;
 
 		// construct two slice infos
 		slice_info<T> slice_info_1(resx, resy), slice_info_2(resx, resy);
@@ -149,7 +193,10 @@ public:
 		// iterate through all slices
 		unsigned int nr_vertices[3] = { 0, 0, 0 };
 		unsigned int i, j, k, n;
-		for (k = 0; k < resz; ++k, p(2) += d(2)) {
+		for (k = k_begin; k <= k_end; ++k) {
+			// compute z from the slice index such that slabs sharing a slice agree on its location
+			p(2) = box.get_min_pnt()(2) + k*d(2);
+			slice_index = k;
 			n = (int)base_type::get_nr_vertices();
 			// evaluate function on next slice and construct slice interior vertices
 			slice_info<T> *info_ptr = slice_info_ptrs[k & 1];
@@ -166,10 +213,10 @@ public:
 				}
 				}
 			// show progression
-			if (show_progress)
-				prog.step();
+			if (prog_ptr)
+				prog_ptr->step();
 			// if this is the first considered slice, construct the next one
-			if (k != 0) {
+			if (k != k_begin) {
 				// get info of previous slice
 				slice_info<T> *prev_info_ptr = slice_info_ptrs[1 - (k & 1)];
 				// construct vertices on edges between previous and new slice
@@ -225,6 +272,93 @@ public:
 				base_type::drop_vertices(n);
 		}
 	}
+	/** extract iso surface in parallel by splitting the volume into one z-slab per thread. Slabs share their
+	    boundary slice, such that vertices on these slices are extracted twice and merged by the grid edge or grid
+		point they lie on. Results are delivered to the marching cubes handler from the calling thread in the same
+		slice order as in extract_impl, which requires eval to be thread safe. If nr_threads is 0, the number of
+		hardware threads is used. */
+	template <typename Eval, typename Valid>
+	void extract_impl_parallel(const T& _iso_value,
+		const axis_aligned_box<X, 3>& box,
+		unsigned int resx, unsigned int resy, unsigned int resz,
+		const Eval& eval, const Valid& valid, bool show_progress = false, unsigned int nr_threads = 0)
+	{
+		if (nr_threads == 0)
+			nr_threads = std::max(std::thread::hardware_concurrency(), 1u);
+		unsigned int nr_slabs = std::min(nr_threads, resz - 1);
+		if (nr_slabs <= 1) {
+			extract_impl(_iso_value, box, resx, resy, resz, eval, valid, show_progress);
+			return;
+		}
+		// extract slabs concurrently into recorders
+		std::vector<unsigned int> slab_begin(nr_slabs + 1);
+		for (unsigned int s = 0; s <= nr_slabs; ++s)
+			slab_begin[s] = (unsigned int)((uint64_t)s * (resz - 1) / nr_slabs);
+		std::vector<slab_recorder> recorders(nr_slabs);
+		std::vector<std::thread> threads;
+		for (unsigned int s = 0; s < nr_slabs; ++s) {
+			threads.push_back(std::thread([&, s]() {
+				marching_cubes_base<X, T> mc(&recorders[s], grid_epsilon, epsilon);
+				recorders[s].mc = &mc;
+				mc.vertex_keys = &recorders[s].keys;
+				mc.extract_slab(_iso_value, box, resx, resy, resz, slab_begin[s], slab_begin[s + 1], eval, valid);
+			}));
+		}
+		for (auto& t : threads)
+			t.join();
+
+		// prepare progression
+		cgv::utils::progression prog;
+		if (show_progress) prog.init("stitching", nr_slabs, 10);
+
+		// stitch slabs: vertices on the slice shared with the next slab are emitted last and kept in the deque
+		// until the next slab has been emitted, all other vertices are dropped once the triangles of their slab are out
+		std::unordered_map<uint64_t, unsigned int> boundary_vertices, next_boundary_vertices;
+		std::vector<unsigned int> global_index;
+		unsigned int nr_kept = 0;
+		uint64_t slice_size = (uint64_t)resx*resy;
+		for (unsigned int s = 0; s < nr_slabs; ++s) {
+			slab_recorder& sr = recorders[s];
+			bool has_next = s + 1 < nr_slabs;
+			unsigned int nr_local = (unsigned int)sr.pnts.size();
+			global_index.resize(nr_local);
+			next_boundary_vertices.clear();
+			std::vector<unsigned int> boundary;
+			unsigned int nr_emitted = 0;
+			for (unsigned int vi = 0; vi < nr_local; ++vi) {
+				uint64_t k = sr.keys[vi] / 4 / slice_size;
+				if (has_next && k == slab_begin[s + 1]) {
+					boundary.push_back(vi);
+					continue;
+				}
+				if (s > 0 && k == slab_begin[s]) {
+					auto iter = boundary_vertices.find(sr.keys[vi]);
+					if (iter != boundary_vertices.end()) {
+						global_index[vi] = iter->second;
+						continue;
+					}
+				}
+				global_index[vi] = base_type::new_vertex(sr.pnts[vi]);
+				++nr_emitted;
+			}
+			for (unsigned int vi : boundary) {
+				global_index[vi] = base_type::new_vertex(sr.pnts[vi]);
+				next_boundary_vertices[sr.keys[vi]] = global_index[vi];
+			}
+			for (size_t ti = 0; ti + 2 < sr.triangles.size(); ti += 3)
+				base_type::new_triangle(global_index[sr.triangles[ti]], global_index[sr.triangles[ti + 1]], global_index[sr.triangles[ti + 2]]);
+			// free recorder memory early
+			std::vector<pnt_type>().swap(sr.pnts);
+			std::vector<unsigned int>().swap(sr.triangles);
+			std::vector<uint64_t>().swap(sr.keys);
+			if (has_next)
+				base_type::drop_vertices(nr_kept + nr_emitted);
+			nr_kept = (unsigned int)boundary.size();
+			boundary_vertices.swap(next_boundary_vertices);
+			if (show_progress)
+				prog.step();
+		}
+	}
 };
 
 template <typename T>
@@ -279,6 +413,15 @@ public:
 		always_valid<T> valid;
 		this->extract_impl(_iso_value, box, resx, resy, resz, *this, valid, show_progress);
 	}
+	/// extract in parallel with extract_impl_parallel, which requires the evaluate method of func to be thread safe
+	void extract_parallel(const T& _iso_value,
+		const axis_aligned_box<X, 3>& box,
+		unsigned int resx, unsigned int resy, unsigned int resz,
+		bool show_progress = false, unsigned int nr_threads = 0)
+	{
+		always_valid<T> valid;
+		this->extract_impl_parallel(_iso_value, box, resx, resy, resz, *this, valid, show_progress, nr_threads);
+	}
 };
 
 		}
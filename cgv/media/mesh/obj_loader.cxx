@@ -1,5 +1,6 @@
 #include "obj_loader.h"
 #include <cgv/utils/file.h>
+#include <cgv/utils/zone_profiler.h>
 #include <cgv/type/standard_types.h>
 
 using namespace cgv::utils::file;
@@ -140,6 +141,7 @@ const char* get_bin_extension<float>()
 template <typename T>
 bool obj_loader_generic<T>::read_obj(const std::string& file_name)
 {
+	CGV_PROFILE_ZONE_CAT("obj load", "mesh");
 	// check if binary file exists
 	std::string bin_fn = drop_extension(file_name) + get_bin_extension<T>();
 	if (exists(bin_fn) &&
@@ -150,12 +152,8 @@ bool obj_loader_generic<T>::read_obj(const std::string& file_name)
 				this->path_name += "/";
 			return true;
 	}
-	
-	vertices.clear();
-	normals.clear();
-	texcoords.clear(); 
-	faces.clear(); 
-	colors.clear();
+	// discard everything, also what a failed read of the binary file might have left behind
+	clear();
 
 	if (!obj_reader_generic<T>::read_obj(file_name))
 		return false;
@@ -181,6 +179,7 @@ bool obj_loader_generic<T>::read_obj(const std::string& file_name)
 template <typename T>
 bool obj_loader_generic<T>::read_obj_bin(const std::string& file_name)
 {
+	CGV_PROFILE_ZONE_CAT("obj read binary", "mesh");
 	// open binary file
 	FILE* fp = fopen(file_name.c_str(), "rb");
 	if (!fp)
@@ -303,11 +302,13 @@ void obj_loader_generic<T>::clear()
 	vertices.clear(); 
 	normals.clear(); 
 	texcoords.clear(); 
+	colors.clear();
 
 	vertex_indices.clear();
 	normal_indices.clear();
 	texcoord_indices.clear();
 
+	lines.clear();
 	faces.clear(); 
 	groups.clear();
 	materials.clear();
@@ -316,6 +317,7 @@ void obj_loader_generic<T>::clear()
 template <typename T>
 bool obj_loader_generic<T>::write_obj_bin(const std::string& file_name) const
 {
+	CGV_PROFILE_ZONE_CAT("obj write binary", "mesh");
 	// open binary file
 	FILE* fp = fopen(file_name.c_str(), "wb");
 	if (!fp)
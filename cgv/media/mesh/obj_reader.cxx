@@ -4,7 +4,13 @@
 #include <cgv/type/standard_types.h>
 #include <cgv/utils/advanced_scan.h>
 #include <cgv/utils/tokenizer.h>
+#include <cgv/utils/zone_profiler.h>
 #include <cgv/base/import.h>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <algorithm>
+#include <thread>
 
 using namespace cgv::math;
 using namespace cgv::type;
@@ -97,7 +103,7 @@ void obj_reader_base::clear()
 	nr_groups = 0;
 	minus = 1;
 	nr_normals = nr_texcoords = 0;
-	material_index = -1;
+	material_index = undefined_index;
 	have_default_material = false;
 }
 
@@ -191,66 +197,295 @@ void obj_reader_generic<T>::parse_and_process_texcoord(const std::vector<cgv::ut
 {
 	process_texcoord(parse_v2d(tokens));
 }
+///
+template <typename T>
+void obj_reader_generic<T>::process_vertex_coords(const double* c)
+{
+	process_vertex(v3d_type((T)c[0], (T)c[1], (T)c[2]));
+}
+///
+template <typename T>
+void obj_reader_generic<T>::process_normal_coords(const double* c)
+{
+	process_normal(v3d_type((T)c[0], (T)c[1], (T)c[2]));
+}
+///
+template <typename T>
+void obj_reader_generic<T>::process_texcoord_coords(const double* c)
+{
+	process_texcoord(v2d_type((T)c[0], (T)c[1]));
+}
 
-bool obj_reader_base::read_obj(const std::string& file_name)
+/// fast scanner for the frequent obj statements, which records per line only a statement tag and the parsed values
+struct obj_chunk
 {
-	std::string content;
-	if (!cgv::base::read_data_file(file_name, content, true))
+	/// kinds of statements recorded during scanning
+	enum statement_kind { SK_VERTEX, SK_VERTEX_COLOR, SK_NORMAL, SK_TEXCOORD, SK_COLOR, SK_FACE, SK_LINE, SK_OTHER };
+	/// marks a corner without texcoord or normal index
+	static const int no_index = INT_MIN;
+	/// marks a corner given only by a vertex index, which is then also used as texcoord and normal index
+	static const int implicit_index = INT_MIN + 1;
+	/// one entry per relevant line, count is the number of corners for faces and lines
+	struct statement
+	{
+		unsigned char kind;
+		unsigned count;
+	};
+	std::vector<statement> statements;
+	std::vector<double> vertex_coords, normal_coords, texcoord_coords;
+	/// rgba values of colors
+	std::vector<float> color_values;
+	/// vertex, texcoord and normal index per corner
+	std::vector<int> corner_indices;
+	/// lines of statements that are handled by the tokenizer based path
+	std::vector<line> other_lines;
+	/// scan all lines in [begin,end) where begin must be the start of a line
+	void scan(const char* begin, const char* end);
+};
+
+static inline bool is_obj_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline const char* skip_obj_space(const char* p, const char* e)
+{
+	while (p < e && is_obj_space(*p))
+		++p;
+	return p;
+}
+
+static inline const char* find_obj_space(const char* p, const char* e)
+{
+	while (p < e && !is_obj_space(*p))
+		++p;
+	return p;
+}
+
+static inline const char* find_obj_slash(const char* p, const char* e)
+{
+	while (p < e && *p != '/')
+		++p;
+	return p;
+}
+
+/// parse token [b,e) as a double and leave value untouched on failure
+static inline bool parse_obj_double(const char* b, const char* e, double& value)
+{
+	if (b < e && *b == '+')
+		++b;
+	double v;
+	std::from_chars_result r = std::from_chars(b, e, v);
+	if (r.ec != std::errc() || r.ptr != e)
 		return false;
+	value = v;
+	return true;
+}
 
-	path_name = file::get_path(file_name);
-	if (!path_name.empty())
-		path_name += "/";
+/// parse the integer at the start of [b,e) with the semantics of atoi
+static inline int parse_obj_int(const char* b, const char* e)
+{
+	if (b < e && *b == '+')
+		++b;
+	int v = 0;
+	if (std::from_chars(b, e, v).ec != std::errc())
+		return 0;
+	return v;
+}
 
-	std::vector<line> lines;
-	split_to_lines(content,lines);
-	
-	minus = 1;
-	material_index = -1;
-	group_index = -1;
-	nr_groups = 0;
-	nr_normals = nr_texcoords = 0;
-	std::map<std::string,unsigned> group_index_lut;
-	std::vector<token> tokens;
-	for (unsigned li=0; li<lines.size(); ++li) {
-		if(li % 1000 == 0)
-			printf("%d Percent done.\r", (int)(100.0*li/(lines.size()-1)) );
+/// parse up to max_nr_values values from the tokens in [p,e) and return the number of tokens
+static unsigned scan_obj_values(const char* p, const char* e, double* values, unsigned max_nr_values)
+{
+	unsigned nr_tokens = 0;
+	bool ok = true;
+	while ((p = skip_obj_space(p, e)) < e) {
+		const char* q = find_obj_space(p, e);
+		if (nr_tokens < max_nr_values && ok)
+			ok = parse_obj_double(p, q, values[nr_tokens]);
+		++nr_tokens;
+		p = q;
+	}
+	return nr_tokens;
+}
 
-		tokenizer(lines[li]).bite_all(tokens);
-		if (tokens.size() == 0)
+void obj_chunk::scan(const char* begin, const char* end)
+{
+	CGV_PROFILE_ZONE_CAT("obj scan chunk", "mesh");
+	// rough estimate of 32 bytes per statement avoids most reallocations
+	size_t estimate = (end - begin) / 32;
+	statements.reserve(estimate);
+	vertex_coords.reserve(estimate);
+	corner_indices.reserve(3 * estimate);
+
+	const char* p = begin;
+	while (p < end) {
+		const char* line_end = static_cast<const char*>(memchr(p, '\n', end - p));
+		if (!line_end)
+			line_end = end;
+		const char* kb = skip_obj_space(p, line_end);
+		const char* ke = find_obj_space(kb, line_end);
+		p = line_end + 1;
+		if (kb == ke)
 			continue;
-
-		switch (tokens[0][0]) {
-		case 'v' :
-			if (tokens[0].size() == 1) {
-				parse_and_process_vertex(tokens);
-				if (tokens.size() >= 7)
-					process_color(parse_color(tokens, 3));
+		double v[7] = { 0, 0, 0, 0, 0, 0, 1 };
+		statement s = { SK_OTHER, 0 };
+		switch (kb[0]) {
+		case 'v':
+			if (ke - kb == 1) {
+				if (scan_obj_values(ke, line_end, v, 7) >= 6) {
+					s.kind = SK_VERTEX_COLOR;
+					for (unsigned i = 3; i < 7; ++i)
+						color_values.push_back((float)v[i]);
+				}
+				else
+					s.kind = SK_VERTEX;
+				vertex_coords.insert(vertex_coords.end(), v, v + 3);
 			}
 			else {
-				switch (tokens[0][1]) {
-				case 'n' :
-					parse_and_process_normal(tokens);
-					++nr_normals;
+				switch (kb[1]) {
+				case 'n':
+					scan_obj_values(ke, line_end, v, 3);
+					normal_coords.insert(normal_coords.end(), v, v + 3);
+					s.kind = SK_NORMAL;
 					break;
-				case 't' : 
-					parse_and_process_texcoord(tokens);
-					++nr_texcoords;
+				case 't':
+					scan_obj_values(ke, line_end, v, 2);
+					texcoord_coords.insert(texcoord_coords.end(), v, v + 2);
+					s.kind = SK_TEXCOORD;
 					break;
-				case 'c' : 
-					process_color(parse_color(tokens));
+				case 'c':
+					v[3] = 1;
+					if (scan_obj_values(ke, line_end, v, 4) < 3)
+						v[0] = v[1] = v[2] = 0;
+					for (unsigned i = 0; i < 4; ++i)
+						color_values.push_back((float)v[i]);
+					s.kind = SK_COLOR;
 					break;
+				default:
+					continue;
 				}
 			}
 			break;
-		case 'f' :
-			if (group_index == -1) {
+		case 'f':
+		case 'l':
+			s.kind = kb[0] == 'f' ? SK_FACE : SK_LINE;
+			for (const char* cb = skip_obj_space(ke, line_end); cb < line_end; cb = skip_obj_space(cb, line_end)) {
+				const char* ce = find_obj_space(cb, line_end);
+				// decompose corner into v, v/, v/t, v//n or v/t/n
+				int vi = 0, ti = no_index, ni = no_index;
+				const char* s1 = find_obj_slash(cb, ce);
+				vi = parse_obj_int(cb, s1);
+				if (s1 == ce)
+					ti = ni = implicit_index;
+				else if (s1 + 1 < ce) {
+					const char* s2 = find_obj_slash(s1 + 1, ce);
+					if (s2 > s1 + 1)
+						ti = parse_obj_int(s1 + 1, s2);
+					if (s2 + 1 < ce)
+						ni = parse_obj_int(s2 + 1, find_obj_slash(s2 + 1, ce));
+				}
+				corner_indices.push_back(vi);
+				corner_indices.push_back(ti);
+				corner_indices.push_back(ni);
+				++s.count;
+				cb = ce;
+			}
+			break;
+		case 'g':
+		case 'u':
+		case 'm':
+			while (is_obj_space(line_end[-1]))
+				--line_end;
+			other_lines.push_back(line(kb, line_end));
+			break;
+		default:
+			continue;
+		}
+		statements.push_back(s);
+	}
+}
+
+void obj_reader_base::process_statement(const std::vector<token>& tokens, std::map<std::string, unsigned>& group_index_lut)
+{
+	if (tokens.empty())
+		return;
+	if (tokens[0][0] == 'g') {
+		if (tokens.size() > 1) {
+			std::string name = to_string(tokens[1]);
+			std::string parameters;
+			if (tokens.size() > 2)
+				parameters.assign(tokens[2].begin, tokens.back().end - tokens[2].begin);
+
+			std::map<std::string,unsigned>::iterator it = 
+				group_index_lut.find(name);
+
+			if (it != group_index_lut.end())
+				group_index = it->second;
+			else {
+				group_index = nr_groups;
+				++nr_groups;
+				process_group(name, parameters);
+				group_index_lut[name] = group_index;
+			}
+		}
+	}
+	else if (to_string(tokens[0]) == "usemtl")
+		parse_material(tokens);
+	else if (to_string(tokens[0]) == "mtllib") {
+		if (tokens.size() > 1)
+			read_mtl(to_string(tokens[1]));
+	}
+}
+
+void obj_reader_base::process_chunk(const obj_chunk& chunk, std::map<std::string, unsigned>& group_index_lut, size_t& statement_index, size_t nr_statements)
+{
+	CGV_PROFILE_ZONE_CAT("obj process chunk", "mesh");
+	const double* vertex_ptr = chunk.vertex_coords.data();
+	const double* normal_ptr = chunk.normal_coords.data();
+	const double* texcoord_ptr = chunk.texcoord_coords.data();
+	const float* color_ptr = chunk.color_values.data();
+	const int* corner_ptr = chunk.corner_indices.data();
+	std::vector<line>::const_iterator other_it = chunk.other_lines.begin();
+	std::vector<int> vertex_indices, normal_indices, texcoord_indices;
+	std::vector<token> tokens;
+	for (const obj_chunk::statement& s : chunk.statements) {
+		if (statement_index % 1000 == 0)
+			printf("%d Percent done.\r", (int)(100.0*statement_index/nr_statements));
+		++statement_index;
+		switch (s.kind) {
+		case obj_chunk::SK_VERTEX:
+			process_vertex_coords(vertex_ptr);
+			vertex_ptr += 3;
+			break;
+		case obj_chunk::SK_VERTEX_COLOR:
+			process_vertex_coords(vertex_ptr);
+			vertex_ptr += 3;
+			process_color(color_type(color_ptr[0], color_ptr[1], color_ptr[2], color_ptr[3]));
+			color_ptr += 4;
+			break;
+		case obj_chunk::SK_NORMAL:
+			process_normal_coords(normal_ptr);
+			normal_ptr += 3;
+			++nr_normals;
+			break;
+		case obj_chunk::SK_TEXCOORD:
+			process_texcoord_coords(texcoord_ptr);
+			texcoord_ptr += 2;
+			++nr_texcoords;
+			break;
+		case obj_chunk::SK_COLOR:
+			process_color(color_type(color_ptr[0], color_ptr[1], color_ptr[2], color_ptr[3]));
+			color_ptr += 4;
+			break;
+		case obj_chunk::SK_FACE:
+		case obj_chunk::SK_LINE:
+			if (group_index == undefined_index) {
 				group_index = 0;
 				nr_groups = 1;
 				process_group("main","");
 				group_index_lut["main"] = group_index;
 			}
-			if (material_index == -1) {
+			if (s.kind == obj_chunk::SK_FACE && material_index == undefined_index) {
 				obj_material m;
 				m.set_name("default");
 				material_index = 0;
@@ -259,46 +494,95 @@ bool obj_reader_base::read_obj(const std::string& file_name)
 				material_index_lut[m.get_name()] = material_index;
 				have_default_material = true;
 			}
-			parse_face(tokens); 
-			break;
-		case 'l':
-			if (group_index == -1) {
-				group_index = 0;
-				nr_groups = 1;
-				process_group("main", "");
-				group_index_lut["main"] = group_index;
-			}
-			parse_face(tokens, true);
-			break;
-		case 'g' :
-			if (tokens.size() > 1) {
-				std::string name = to_string(tokens[1]);
-				std::string parameters;
-				if (tokens.size() > 2)
-					parameters.assign(tokens[2].begin, tokens.back().end - tokens[2].begin);
-
-				std::map<std::string,unsigned>::iterator it = 
-					group_index_lut.find(name);
-
-				if (it != group_index_lut.end())
-					group_index = it->second;
-				else {
-					group_index = nr_groups;
-					++nr_groups;
-					process_group(name, parameters);
-					group_index_lut[name] = group_index;
+			vertex_indices.clear();
+			normal_indices.clear();
+			texcoord_indices.clear();
+			for (unsigned i = 0; i < s.count; ++i, corner_ptr += 3) {
+				int vi = corner_ptr[0], ti = corner_ptr[1], ni = corner_ptr[2];
+				if (vi > 0)
+					vi -= minus;
+				vertex_indices.push_back(vi);
+				if (ti == obj_chunk::implicit_index) {
+					if ((int)nr_normals > vi)
+						normal_indices.push_back(vi);
+					if ((int)nr_texcoords > vi)
+						texcoord_indices.push_back(vi);
+					continue;
+				}
+				if (ti != obj_chunk::no_index) {
+					if (ti > 0)
+						ti -= minus;
+					if ((int)nr_texcoords > ti)
+						texcoord_indices.push_back(ti);
+				}
+				if (ni != obj_chunk::no_index) {
+					if (ni > 0)
+						ni -= minus;
+					if ((int)nr_normals > ni)
+						normal_indices.push_back(ni);
 				}
 			}
-			break;
-		default:
-			if (to_string(tokens[0]) == "usemtl")
-				parse_material(tokens);
-			else if (to_string(tokens[0]) == "mtllib") {
-				if (tokens.size() > 1)
-					read_mtl(to_string(tokens[1]));
+			{
+				int* nml_ptr = normal_indices.size() == vertex_indices.size() ? normal_indices.data() : 0;
+				int* tex_ptr = texcoord_indices.size() == vertex_indices.size() ? texcoord_indices.data() : 0;
+				if (s.kind == obj_chunk::SK_LINE)
+					process_line((unsigned)vertex_indices.size(), vertex_indices.data(), tex_ptr, nml_ptr);
+				else
+					process_face((unsigned)vertex_indices.size(), vertex_indices.data(), tex_ptr, nml_ptr);
 			}
+			break;
+		case obj_chunk::SK_OTHER:
+			tokens.clear();
+			tokenizer(*other_it++).bite_all(tokens);
+			process_statement(tokens, group_index_lut);
+			break;
 		}
-		tokens.clear();
+	}
+}
+
+bool obj_reader_base::read_obj(const std::string& file_name)
+{
+	CGV_PROFILE_ZONE_CAT("obj read", "mesh");
+	std::string content;
+	if (!cgv::base::read_data_file(file_name, content, true))
+		return false;
+
+	path_name = file::get_path(file_name);
+	if (!path_name.empty())
+		path_name += "/";
+
+	// split content at line boundaries into one chunk per thread, but not below 1MB per chunk
+	const char* begin = content.data();
+	const char* end = begin + content.size();
+	const size_t min_chunk_size = 1 << 20;
+	size_t nr_chunks = std::min(size_t(std::max(std::thread::hardware_concurrency(), 1u)), content.size() / min_chunk_size + 1);
+	std::vector<const char*> bounds(nr_chunks + 1, end);
+	bounds[0] = begin;
+	for (size_t i = 1; i < nr_chunks; ++i) {
+		const char* p = std::max(begin + i * content.size() / nr_chunks, bounds[i - 1]);
+		const char* q = static_cast<const char*>(memchr(p, '\n', end - p));
+		bounds[i] = q ? q + 1 : end;
+	}
+	std::vector<obj_chunk> chunks(nr_chunks);
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < nr_chunks; ++i)
+		threads.push_back(std::thread(&obj_chunk::scan, &chunks[i], bounds[i], bounds[i + 1]));
+	chunks[0].scan(bounds[0], bounds[1]);
+	for (auto& t : threads)
+		t.join();
+
+	minus = 1;
+	material_index = undefined_index;
+	group_index = undefined_index;
+	nr_groups = 0;
+	nr_normals = nr_texcoords = 0;
+	std::map<std::string,unsigned> group_index_lut;
+	size_t nr_statements = 0, statement_index = 0;
+	for (const auto& c : chunks)
+		nr_statements += c.statements.size();
+	for (auto& c : chunks) {
+		process_chunk(c, group_index_lut, statement_index, nr_statements);
+		c = obj_chunk();
 	}
 	printf("\n");
 	return true;
@@ -306,6 +590,7 @@ bool obj_reader_base::read_obj(const std::string& file_name)
 
 bool obj_reader_base::read_mtl(const std::string& file_name)
 {
+	CGV_PROFILE_ZONE_CAT("obj read mtl", "mesh");
 	std::string fn = cgv::base::find_data_file(file_name, "McpD", "", path_name);
 	if (path_name.empty()) {
 		path_name = file::get_path(file_name);
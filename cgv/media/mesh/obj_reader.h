@@ -14,12 +14,17 @@ namespace cgv {
 	namespace media {
 		namespace mesh {
 
+/// statements of a file chunk scanned by the fast obj parser, defined in obj_reader.cxx
+struct obj_chunk;
+
 /** base class for obj reader with implementation that is independent of coordinate type.*/
 class CGV_API obj_reader_base
 {
 public:
 	/// type used for rgba colors
 	typedef illum::obj_material::color_type color_type;
+	/// value of the current group and material index before a group or material has been selected
+	static const unsigned undefined_index = unsigned(-1);
 protected:
 	/// keep track of the current group
 	unsigned group_index;
@@ -44,6 +49,16 @@ protected:
 	virtual void parse_and_process_vertex(const std::vector<cgv::utils::token>& tokens) = 0;
 	virtual void parse_and_process_normal(const std::vector<cgv::utils::token>& tokens) = 0;
 	virtual void parse_and_process_texcoord(const std::vector<cgv::utils::token>& tokens) = 0;
+	/// process a vertex position given by three coordinates from the fast scanner
+	virtual void process_vertex_coords(const double* c) = 0;
+	/// process a normal given by three coordinates from the fast scanner
+	virtual void process_normal_coords(const double* c) = 0;
+	/// process a texture coordinate given by two coordinates from the fast scanner
+	virtual void process_texcoord_coords(const double* c) = 0;
+	/// handle group, usemtl and mtllib statements
+	void process_statement(const std::vector<cgv::utils::token>& tokens, std::map<std::string, unsigned>& group_index_lut);
+	/// replay the statements of a scanned chunk in file order through the virtual interface
+	void process_chunk(const obj_chunk& chunk, std::map<std::string, unsigned>& group_index_lut, size_t& statement_index, size_t nr_statements);
 	//@}
 
 	/**@name status info during reading*/
@@ -79,7 +94,8 @@ protected:
 public:
 	///
 	obj_reader_base();
-	/// read an obj file
+	/** read an obj file. The file is split at line boundaries into chunks that are scanned
+	    concurrently; the scanned statements are then passed to the virtual interface in file order. */
 	virtual bool read_obj(const std::string& file_name);
 	/// read a material file
 	virtual bool read_mtl(const std::string& file_name);
@@ -116,6 +132,12 @@ protected:
 	void parse_and_process_normal(const std::vector<cgv::utils::token>& tokens);
 	///
 	void parse_and_process_texcoord(const std::vector<cgv::utils::token>& tokens);
+	///
+	void process_vertex_coords(const double* c);
+	///
+	void process_normal_coords(const double* c);
+	///
+	void process_texcoord_coords(const double* c);
 	//@}
 
 	/**@name virtual interface*/
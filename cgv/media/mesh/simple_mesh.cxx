@@ -3,6 +3,7 @@
 #include "obj_loader.h"
 #include <cgv/math/inv.h>
 #include <cgv/utils/scan.h>
+#include <cgv/utils/zone_profiler.h>
 #include <cgv/media/mesh/obj_reader.h>
 #include <cgv/math/bucket_sort.h>
 #include <fstream>
@@ -453,6 +454,7 @@ void simple_mesh<T>::clear()
 template <typename T>
 bool simple_mesh<T>::read(const std::string& file_name)
 { 
+	CGV_PROFILE_ZONE_CAT("simple_mesh read", "mesh");
 	std::string ext = cgv::utils::to_lower(cgv::utils::file::get_extension(file_name));
 	if (ext == "obj") {
 		simple_mesh_obj_reader<T> reader(*this);
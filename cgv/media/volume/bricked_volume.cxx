@@ -0,0 +1,550 @@
+#include "bricked_volume.h"
+#include <cgv/type/standard_types.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#pragma warning(disable:4996)
+
+namespace cgv {
+	namespace media {
+		namespace volume {
+
+			/// magic string at the beginning of bricked volume files
+			static const char bricked_volume_magic[8] = { 'c', 'g', 'v', '_', 'b', 'v', 'o', 'l' };
+			/// version of the bricked volume file format
+			static const uint32_t bricked_volume_version = 1;
+			/// offset of the brick table offset within the file header
+			static const long long table_offset_position = 60;
+
+			/// seek to 64 bit file position
+			static bool seek_file(FILE* fp, uint64_t pos)
+			{
+				return
+#ifdef _WIN32
+					_fseeki64
+#else
+					fseeko64
+#endif
+					(fp, pos, SEEK_SET) == 0;
+			}
+
+			/// return 64 bit file position
+			static uint64_t tell_file(FILE* fp)
+			{
+				return
+#ifdef _WIN32
+					_ftelli64
+#else
+					ftello64
+#endif
+					(fp);
+			}
+
+			template <typename T>
+			static bool write_values(FILE* fp, const T* values, size_t n)
+			{
+				return fwrite(values, sizeof(T), n, fp) == n;
+			}
+
+			template <typename T>
+			static bool read_values(FILE* fp, T* values, size_t n)
+			{
+				return fread(values, sizeof(T), n, fp) == n;
+			}
+
+			/// compute range over all components of nr_values values of type T
+			template <typename T>
+			struct brick_range
+			{
+				static void apply(const uint8_t* data, size_t nr_values, double& min_value, double& max_value)
+				{
+					const T* values = reinterpret_cast<const T*>(data);
+					if (nr_values == 0) {
+						min_value = max_value = 0;
+						return;
+					}
+					T min_v = values[0], max_v = values[0];
+					for (size_t i = 1; i < nr_values; ++i) {
+						if (values[i] < min_v)
+							min_v = values[i];
+						else if (values[i] > max_v)
+							max_v = values[i];
+					}
+					min_value = (double)min_v;
+					max_value = (double)max_v;
+				}
+			};
+
+			/// encode the difference of each value to the value nr_components before as zigzag varint, differences are computed modulo 2^64 to be exact for all integral types
+			template <typename T>
+			struct brick_encoder
+			{
+				static void apply(const uint8_t* data, size_t nr_values, unsigned nr_components, std::vector<uint8_t>& encoded)
+				{
+					const T* values = reinterpret_cast<const T*>(data);
+					encoded.clear();
+					for (size_t i = 0; i < nr_values; ++i) {
+						uint64_t d = uint64_t(int64_t(values[i]));
+						if (i >= nr_components)
+							d -= uint64_t(int64_t(values[i - nr_components]));
+						uint64_t z = (d << 1) ^ uint64_t(int64_t(d) >> 63);
+						while (z >= 0x80) {
+							encoded.push_back(uint8_t(z | 0x80));
+							z >>= 7;
+						}
+						encoded.push_back(uint8_t(z));
+					}
+				}
+			};
+
+			/// inverse of brick_encoder, returns false if encoded data is corrupt
+			template <typename T>
+			struct brick_decoder
+			{
+				static bool apply(const uint8_t* encoded, size_t encoded_size, size_t nr_values, unsigned nr_components, uint8_t* data)
+				{
+					T* values = reinterpret_cast<T*>(data);
+					const uint8_t* p = encoded, *e = encoded + encoded_size;
+					for (size_t i = 0; i < nr_values; ++i) {
+						uint64_t z = 0;
+						unsigned shift = 0;
+						do {
+							if (p == e || shift > 63)
+								return false;
+							z |= uint64_t(*p & 0x7F) << shift;
+							shift += 7;
+						} while (*p++ & 0x80);
+						uint64_t d = (z >> 1) ^ (uint64_t(0) - (z & 1));
+						if (i >= nr_components)
+							d += uint64_t(int64_t(values[i - nr_components]));
+						values[i] = T(d);
+					}
+					return p == e;
+				}
+			};
+
+			/// call F<T>::apply with T corresponding to the given type id, return false for unsupported types
+			template <template <typename> class F, typename... Args>
+			static bool dispatch_integral_type(cgv::type::info::TypeId type_id, Args&&... args)
+			{
+				using namespace cgv::type::info;
+				switch (type_id) {
+				case TI_INT8:   F<int8_t>::apply(args...); return true;
+				case TI_INT16:  F<int16_t>::apply(args...); return true;
+				case TI_INT32:  F<int32_t>::apply(args...); return true;
+				case TI_INT64:  F<int64_t>::apply(args...); return true;
+				case TI_UINT8:  F<uint8_t>::apply(args...); return true;
+				case TI_UINT16: F<uint16_t>::apply(args...); return true;
+				case TI_UINT32: F<uint32_t>::apply(args...); return true;
+				case TI_UINT64: F<uint64_t>::apply(args...); return true;
+				default: return false;
+				}
+			}
+
+			static void compute_brick_range(cgv::type::info::TypeId type_id, const uint8_t* data, size_t nr_values, double& min_value, double& max_value)
+			{
+				using namespace cgv::type::info;
+				if (dispatch_integral_type<brick_range>(type_id, data, nr_values, min_value, max_value))
+					return;
+				switch (type_id) {
+				case TI_FLT32: brick_range<float>::apply(data, nr_values, min_value, max_value); break;
+				case TI_FLT64: brick_range<double>::apply(data, nr_values, min_value, max_value); break;
+				default: min_value = max_value = 0; break;
+				}
+			}
+
+			static bool decode_brick(cgv::type::info::TypeId type_id, const uint8_t* encoded, size_t encoded_size, size_t nr_values, unsigned nr_components, uint8_t* data)
+			{
+				using namespace cgv::type::info;
+				switch (type_id) {
+				case TI_INT8:   return brick_decoder<int8_t>::apply(encoded, encoded_size, nr_values, nr_components, data);
+				case TI_INT16:  return brick_decoder<int16_t>::apply(encoded, encoded_size, nr_values, nr_components, data);
+				case TI_INT32:  return brick_decoder<int32_t>::apply(encoded, encoded_size, nr_values, nr_components, data);
+				case TI_INT64:  return brick_decoder<int64_t>::apply(encoded, encoded_size, nr_values, nr_components, data);
+				case TI_UINT8:  return brick_decoder<uint8_t>::apply(encoded, encoded_size, nr_values, nr_components, data);
+				case TI_UINT16: return brick_decoder<uint16_t>::apply(encoded, encoded_size, nr_values, nr_components, data);
+				case TI_UINT32: return brick_decoder<uint32_t>::apply(encoded, encoded_size, nr_values, nr_components, data);
+				case TI_UINT64: return brick_decoder<uint64_t>::apply(encoded, encoded_size, nr_values, nr_components, data);
+				default: return false;
+				}
+			}
+
+			bricked_volume_header::bricked_volume_header()
+				: dimensions(0, 0, 0), extent(1, 1, 1), type_id(cgv::type::info::TI_UINT8), components(cgv::data::CF_L), brick_size(64, 64, 64), compression(BC_DELTA_VARINT)
+			{
+			}
+
+			bricked_volume_header::bricked_volume_header(const volume& V, const volume::dimension_type& _brick_size, BrickCompression _compression)
+				: dimensions(V.get_dimensions()), extent(V.get_extent()), type_id(V.get_component_type()), components(V.get_component_format()), brick_size(_brick_size), compression(_compression)
+			{
+			}
+
+			unsigned bricked_volume_header::get_voxel_size() const
+			{
+				return cgv::data::component_format(type_id, components).get_entry_size();
+			}
+
+			volume::dimension_type bricked_volume_header::get_brick_counts() const
+			{
+				return volume::dimension_type(
+					(dimensions(0) + brick_size(0) - 1) / brick_size(0),
+					(dimensions(1) + brick_size(1) - 1) / brick_size(1),
+					(dimensions(2) + brick_size(2) - 1) / brick_size(2));
+			}
+
+			size_t bricked_volume_header::get_nr_bricks() const
+			{
+				volume::dimension_type bc = get_brick_counts();
+				return size_t(bc(0)) * bc(1) * bc(2);
+			}
+
+			size_t bricked_volume_header::get_brick_index(const volume::index_type& b) const
+			{
+				volume::dimension_type bc = get_brick_counts();
+				return (size_t(b(2)) * bc(1) + b(1)) * bc(0) + b(0);
+			}
+
+			volume::dimension_type bricked_volume_header::get_brick_dimensions(const volume::index_type& b) const
+			{
+				volume::dimension_type d;
+				for (unsigned c = 0; c < 3; ++c)
+					d(c) = std::min(brick_size(c), dimensions(c) - b(c) * brick_size(c));
+				return d;
+			}
+
+			bricked_volume_writer::bricked_volume_writer()
+			{
+				fp = 0;
+				nr_slab_slices = 0;
+				nr_written_slices = 0;
+			}
+
+			bricked_volume_writer::~bricked_volume_writer()
+			{
+				if (fp)
+					close();
+			}
+
+			bool bricked_volume_writer::open(const std::string& file_name, const bricked_volume_header& _header)
+			{
+				header = _header;
+				for (unsigned c = 0; c < 3; ++c) {
+					if (header.dimensions(c) <= 0 || header.brick_size(c) <= 0) {
+						std::cerr << "invalid dimensions or brick size for bricked volume " << file_name << std::endl;
+						return false;
+					}
+				}
+				if (fp)
+					close();
+				fp = fopen(file_name.c_str(), "wb");
+				if (!fp) {
+					std::cerr << "could not open " << file_name << " for writing" << std::endl;
+					return false;
+				}
+				uint64_t table_offset = 0;
+				int32_t dims[3] = { header.dimensions(0), header.dimensions(1), header.dimensions(2) };
+				int32_t brick_size[3] = { header.brick_size(0), header.brick_size(1), header.brick_size(2) };
+				uint32_t fields[3] = { uint32_t(header.type_id), uint32_t(header.components), uint32_t(header.compression) };
+				if (!write_values(fp, bricked_volume_magic, 8) ||
+					!write_values(fp, &bricked_volume_version, 1) ||
+					!write_values(fp, dims, 3) ||
+					!write_values(fp, &header.extent(0), 3) ||
+					!write_values(fp, fields, 2) ||
+					!write_values(fp, brick_size, 3) ||
+					!write_values(fp, fields + 2, 1) ||
+					!write_values(fp, &table_offset, 1)) {
+					fclose(fp);
+					fp = 0;
+					return false;
+				}
+				bricks.clear();
+				bricks.reserve(header.get_nr_bricks());
+				slab.resize(size_t(header.dimensions(0)) * header.dimensions(1) * header.brick_size(2) * header.get_voxel_size());
+				nr_slab_slices = 0;
+				nr_written_slices = 0;
+				return true;
+			}
+
+			bool bricked_volume_writer::append_slices(const void* data, unsigned nr_slices)
+			{
+				size_t slice_size = size_t(header.dimensions(0)) * header.dimensions(1) * header.get_voxel_size();
+				const uint8_t* src = static_cast<const uint8_t*>(data);
+				while (nr_slices > 0) {
+					if (nr_written_slices + nr_slab_slices >= header.dimensions(2)) {
+						std::cerr << "appended more slices than bricked volume has" << std::endl;
+						return false;
+					}
+					int slab_depth = std::min(header.brick_size(2), header.dimensions(2) - nr_written_slices);
+					unsigned n = std::min(nr_slices, unsigned(slab_depth - nr_slab_slices));
+					std::copy(src, src + n * slice_size, &slab[nr_slab_slices * slice_size]);
+					src += n * slice_size;
+					nr_slab_slices += n;
+					nr_slices -= n;
+					if (nr_slab_slices == slab_depth && !write_slab())
+						return false;
+				}
+				return true;
+			}
+
+			bool bricked_volume_writer::write_slab()
+			{
+				volume::dimension_type bc = header.get_brick_counts();
+				unsigned voxel_size = header.get_voxel_size();
+				unsigned nr_components = cgv::data::component_format(header.type_id, header.components).get_nr_components();
+				size_t row_size = size_t(header.dimensions(0)) * voxel_size;
+				size_t slice_size = row_size * header.dimensions(1);
+				volume::index_type b(0, 0, nr_written_slices / header.brick_size(2));
+				for (b(1) = 0; b(1) < bc(1); ++b(1)) {
+					for (b(0) = 0; b(0) < bc(0); ++b(0)) {
+						volume::dimension_type bd = header.get_brick_dimensions(b);
+						size_t brick_row_size = size_t(bd(0)) * voxel_size;
+						brick_data.resize(brick_row_size * bd(1) * bd(2));
+						uint8_t* dst = brick_data.data();
+						for (int k = 0; k < bd(2); ++k) {
+							for (int j = 0; j < bd(1); ++j) {
+								const uint8_t* src = &slab[k * slice_size + (b(1) * header.brick_size(1) + j) * row_size + b(0) * header.brick_size(0) * voxel_size];
+								std::copy(src, src + brick_row_size, dst);
+								dst += brick_row_size;
+							}
+						}
+						size_t nr_values = brick_data.size() / cgv::type::info::get_type_size(header.type_id);
+						brick_info bi;
+						compute_brick_range(header.type_id, brick_data.data(), nr_values, bi.min_value, bi.max_value);
+						const std::vector<uint8_t>* stored = &brick_data;
+						// fall back to raw storage for unsupported types and incompressible bricks
+						if (header.compression == BC_DELTA_VARINT &&
+							dispatch_integral_type<brick_encoder>(header.type_id, brick_data.data(), nr_values, nr_components, encoded_data) &&
+							encoded_data.size() < brick_data.size())
+							stored = &encoded_data;
+						bi.offset = tell_file(fp);
+						bi.size = stored->size();
+						if (!write_values(fp, stored->data(), stored->size())) {
+							std::cerr << "could not write brick of bricked volume" << std::endl;
+							return false;
+						}
+						bricks.push_back(bi);
+					}
+				}
+				nr_written_slices += nr_slab_slices;
+				nr_slab_slices = 0;
+				return true;
+			}
+
+			bool bricked_volume_writer::close()
+			{
+				if (!fp)
+					return false;
+				bool success = true;
+				if (nr_slab_slices > 0)
+					success = write_slab();
+				if (success && nr_written_slices < header.dimensions(2)) {
+					std::cerr << "bricked volume closed after " << nr_written_slices << " of " << header.dimensions(2) << " slices" << std::endl;
+					success = false;
+				}
+				if (success) {
+					uint64_t table_offset = tell_file(fp);
+					success = write_values(fp, bricks.data(), bricks.size()) &&
+						seek_file(fp, table_offset_position) &&
+						write_values(fp, &table_offset, 1);
+				}
+				if (fclose(fp) != 0)
+					success = false;
+				fp = 0;
+				slab = std::vector<uint8_t>();
+				return success;
+			}
+
+			ooc_bricked_volume::ooc_bricked_volume(size_t _max_cache_size) : max_cache_size(_max_cache_size)
+			{
+				fp = 0;
+				cache_size = 0;
+			}
+
+			ooc_bricked_volume::~ooc_bricked_volume()
+			{
+				close();
+			}
+
+			bool ooc_bricked_volume::open_read(const std::string& file_name)
+			{
+				close();
+				fp = fopen(file_name.c_str(), "rb");
+				if (!fp) {
+					std::cerr << "could not open bricked volume " << file_name << std::endl;
+					return false;
+				}
+				char magic[8];
+				uint32_t version, fields[3];
+				int32_t dims[3], brick_size[3];
+				uint64_t table_offset;
+				if (!read_values(fp, magic, 8) || std::memcmp(magic, bricked_volume_magic, 8) != 0 ||
+					!read_values(fp, &version, 1) || version != bricked_volume_version ||
+					!read_values(fp, dims, 3) ||
+					!read_values(fp, &header.extent(0), 3) ||
+					!read_values(fp, fields, 2) ||
+					!read_values(fp, brick_size, 3) ||
+					!read_values(fp, fields + 2, 1) ||
+					!read_values(fp, &table_offset, 1)) {
+					std::cerr << "invalid header in bricked volume " << file_name << std::endl;
+					close();
+					return false;
+				}
+				header.dimensions = volume::dimension_type(dims[0], dims[1], dims[2]);
+				header.brick_size = volume::dimension_type(brick_size[0], brick_size[1], brick_size[2]);
+				header.type_id = cgv::type::info::TypeId(fields[0]);
+				header.components = cgv::data::ComponentFormat(fields[1]);
+				header.compression = BrickCompression(fields[2]);
+				bricks.resize(header.get_nr_bricks());
+				if (table_offset == 0 || !seek_file(fp, table_offset) ||
+					!read_values(fp, bricks.data(), bricks.size())) {
+					std::cerr << "could not read brick table of bricked volume " << file_name << std::endl;
+					close();
+					return false;
+				}
+				return true;
+			}
+
+			bool ooc_bricked_volume::is_open() const
+			{
+				return fp != 0;
+			}
+
+			void ooc_bricked_volume::close()
+			{
+				if (fp) {
+					fclose(fp);
+					fp = 0;
+				}
+				bricks.clear();
+				cache.clear();
+				lru.clear();
+				cache_size = 0;
+			}
+
+			void ooc_bricked_volume::set_max_cache_size(size_t size)
+			{
+				max_cache_size = size;
+				shrink_cache();
+			}
+
+			void ooc_bricked_volume::shrink_cache() const
+			{
+				while (cache_size > max_cache_size && lru.size() > 1) {
+					auto it = cache.find(lru.back());
+					cache_size -= it->second.data.size();
+					cache.erase(it);
+					lru.pop_back();
+				}
+			}
+
+			const uint8_t* ooc_bricked_volume::get_brick(size_t bi) const
+			{
+				auto it = cache.find(bi);
+				if (it != cache.end()) {
+					lru.splice(lru.begin(), lru, it->second.lru_pos);
+					return it->second.data.data();
+				}
+				if (bi >= bricks.size())
+					return 0;
+				// compute brick coordinates from linear index to determine raw size
+				volume::dimension_type bc = header.get_brick_counts();
+				volume::index_type b(int(bi % bc(0)), int((bi / bc(0)) % bc(1)), int(bi / (size_t(bc(0)) * bc(1))));
+				volume::dimension_type bd = header.get_brick_dimensions(b);
+				size_t raw_size = size_t(bd(0)) * bd(1) * bd(2) * header.get_voxel_size();
+				const brick_info& info = bricks[bi];
+				std::vector<uint8_t> data(raw_size);
+				bool success = fp && seek_file(fp, info.offset);
+				if (success) {
+					if (info.size == raw_size)
+						success = read_values(fp, data.data(), raw_size);
+					else {
+						encoded_data.resize(info.size);
+						unsigned nr_components = cgv::data::component_format(header.type_id, header.components).get_nr_components();
+						success = read_values(fp, encoded_data.data(), encoded_data.size()) &&
+							decode_brick(header.type_id, encoded_data.data(), encoded_data.size(),
+								raw_size / cgv::type::info::get_type_size(header.type_id), nr_components, data.data());
+					}
+				}
+				if (!success) {
+					std::cerr << "could not read brick " << bi << " of bricked volume" << std::endl;
+					return 0;
+				}
+				lru.push_front(bi);
+				cache_entry& ce = cache[bi];
+				ce.data.swap(data);
+				ce.lru_pos = lru.begin();
+				cache_size += raw_size;
+				shrink_cache();
+				return ce.data.data();
+			}
+
+			bool ooc_bricked_volume::read_sub_volume(const volume::index_type& min_idx, const volume::dimension_type& dims, volume& V) const
+			{
+				for (unsigned c = 0; c < 3; ++c) {
+					if (min_idx(c) < 0 || dims(c) <= 0 || min_idx(c) + dims(c) > header.dimensions(c)) {
+						std::cerr << "sub volume exceeds bricked volume" << std::endl;
+						return false;
+					}
+				}
+				if (V.get_component_type() != header.type_id)
+					V.set_component_type(header.type_id);
+				if (V.get_component_format() != header.components)
+					V.set_component_format(header.components);
+				if (V.get_dimensions() != dims)
+					V.resize(dims);
+				for (unsigned c = 0; c < 3; ++c)
+					V.ref_extent()(c) = header.extent(c) * dims(c) / header.dimensions(c);
+
+				unsigned voxel_size = header.get_voxel_size();
+				volume::index_type max_idx = min_idx + dims - 1;
+				volume::index_type b0 = min_idx / header.brick_size, b1 = max_idx / header.brick_size, b;
+				for (b(2) = b0(2); b(2) <= b1(2); ++b(2)) {
+					for (b(1) = b0(1); b(1) <= b1(1); ++b(1)) {
+						for (b(0) = b0(0); b(0) <= b1(0); ++b(0)) {
+							const uint8_t* brick = get_brick(header.get_brick_index(b));
+							if (!brick)
+								return false;
+							volume::dimension_type bd = header.get_brick_dimensions(b);
+							volume::index_type origin = b * header.brick_size;
+							// intersect brick with sub box in brick local coordinates
+							volume::index_type lo, hi;
+							for (unsigned c = 0; c < 3; ++c) {
+								lo(c) = std::max(min_idx(c) - origin(c), 0);
+								hi(c) = std::min(max_idx(c) - origin(c), bd(c) - 1);
+							}
+							size_t run = size_t(hi(0) - lo(0) + 1) * voxel_size;
+							for (int k = lo(2); k <= hi(2); ++k) {
+								for (int j = lo(1); j <= hi(1); ++j) {
+									const uint8_t* src = brick + ((size_t(k) * bd(1) + j) * bd(0) + lo(0)) * voxel_size;
+									uint8_t* dst = V.get_voxel_ptr<uint8_t>(origin(0) + lo(0) - min_idx(0), origin(1) + j - min_idx(1), origin(2) + k - min_idx(2));
+									std::copy(src, src + run, dst);
+								}
+							}
+						}
+					}
+				}
+				return true;
+			}
+
+			void ooc_bricked_volume::find_bricks(double min_value, double max_value, std::vector<size_t>& brick_indices) const
+			{
+				for (size_t bi = 0; bi < bricks.size(); ++bi)
+					if (bricks[bi].max_value >= min_value && bricks[bi].min_value <= max_value)
+						brick_indices.push_back(bi);
+			}
+
+			bool write_bricked_volume(const std::string& file_name, const volume& V, const volume::dimension_type& brick_size, BrickCompression compression)
+			{
+				bricked_volume_writer writer;
+				if (!writer.open(file_name, bricked_volume_header(V, brick_size, compression)))
+					return false;
+				if (!writer.append_slices(V.get_data_ptr<uint8_t>(), V.get_dimensions()(2))) {
+					writer.close();
+					return false;
+				}
+				return writer.close();
+			}
+		}
+	}
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include "volume.h"
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "../lib_begin.h"
+
+namespace cgv {
+	namespace media {
+		namespace volume {
+
+			/// lossless compression schemes supported for the bricks of a bricked volume file
+			enum BrickCompression
+			{
+				BC_NONE,        /// bricks are stored as raw voxel data
+				BC_DELTA_VARINT /// per component deltas of integral voxel values stored as zigzag encoded variable length integers
+			};
+
+			/// meta data of a single brick as stored in the brick table of a bricked volume file
+			struct brick_info
+			{
+				/// offset of the brick data in the file
+				uint64_t offset;
+				/// size of the stored brick data in bytes, which equals the raw size for uncompressed bricks
+				uint64_t size;
+				/// minimum over all voxel components of the brick
+				double min_value;
+				/// maximum over all voxel components of the brick
+				double max_value;
+			};
+
+			/// header of a bricked volume file
+			struct CGV_API bricked_volume_header
+			{
+				volume::dimension_type dimensions;
+				volume::extent_type extent;
+				cgv::type::info::TypeId type_id;
+				cgv::data::ComponentFormat components;
+				/// number of voxels per brick in each dimension, bricks at the upper borders are clipped
+				volume::dimension_type brick_size;
+				BrickCompression compression;
+				///
+				bricked_volume_header();
+				/// construct header for the given volume
+				bricked_volume_header(const volume& V, const volume::dimension_type& brick_size = volume::dimension_type(64, 64, 64), BrickCompression compression = BC_DELTA_VARINT);
+				/// return the size of a voxel in bytes
+				unsigned get_voxel_size() const;
+				/// return the number of bricks in each dimension
+				volume::dimension_type get_brick_counts() const;
+				/// return the total number of bricks
+				size_t get_nr_bricks() const;
+				/// return the linear index of brick with brick coordinates b, where x varies fastest
+				size_t get_brick_index(const volume::index_type& b) const;
+				/// return the voxel dimensions of the brick with brick coordinates b
+				volume::dimension_type get_brick_dimensions(const volume::index_type& b) const;
+			};
+
+			/** writes a bricked volume file slice by slice such that volumes larger than main memory can be converted,
+			    for example by reading an ooc_sliced_volume slice after slice. Slices are buffered until a layer of
+				bricks is complete, which needs memory for brick_size(2) slices. */
+			class CGV_API bricked_volume_writer
+			{
+			protected:
+				bricked_volume_header header;
+				FILE* fp;
+				std::vector<brick_info> bricks;
+				std::vector<uint8_t> slab;
+				std::vector<uint8_t> brick_data, encoded_data;
+				int nr_slab_slices;
+				int nr_written_slices;
+				/// write the buffered slab as one layer of bricks
+				bool write_slab();
+			public:
+				///
+				bricked_volume_writer();
+				/// close file if still open
+				~bricked_volume_writer();
+				/// open file for writing the volume described by the header
+				bool open(const std::string& file_name, const bricked_volume_header& _header);
+				/// append nr_slices consecutive slices of the volume in the voxel layout of class volume
+				bool append_slices(const void* data, unsigned nr_slices);
+				/// flush remaining slices and write brick table, fails if not all slices have been appended
+				bool close();
+			};
+
+			/** the ooc_bricked_volume provides random access to sub boxes of a volume stored in a bricked volume file.
+			    Decoded bricks are kept in a cache of limited size from which the least recently used bricks are evicted.
+				The brick table with per brick value ranges is kept in memory and allows to skip bricks without loading them.
+				Access is not thread safe. */
+			class CGV_API ooc_bricked_volume
+			{
+			protected:
+				bricked_volume_header header;
+				std::vector<brick_info> bricks;
+				FILE* fp;
+				/// decoded brick data together with its position in the lru list
+				struct cache_entry
+				{
+					std::vector<uint8_t> data;
+					std::list<size_t>::iterator lru_pos;
+				};
+				mutable std::unordered_map<size_t, cache_entry> cache;
+				/// brick indices ordered from most to least recently used
+				mutable std::list<size_t> lru;
+				mutable size_t cache_size;
+				size_t max_cache_size;
+				mutable std::vector<uint8_t> encoded_data;
+				/// evict least recently used bricks until cache fits into max_cache_size
+				void shrink_cache() const;
+			public:
+				/// construct with cache size in bytes
+				ooc_bricked_volume(size_t _max_cache_size = size_t(256) << 20);
+				/// close file
+				~ooc_bricked_volume();
+				/// open bricked volume file and read brick table
+				bool open_read(const std::string& file_name);
+				///
+				bool is_open() const;
+				/// close file and clear cache
+				void close();
+				/// return header of opened file
+				const bricked_volume_header& get_header() const { return header; }
+				/// return volume dimensions
+				volume::dimension_type get_dimensions() const { return header.dimensions; }
+				/// return meta data of brick with linear index bi
+				const brick_info& get_brick_info(size_t bi) const { return bricks[bi]; }
+				/// return maximum number of bytes used for cached bricks
+				size_t get_max_cache_size() const { return max_cache_size; }
+				/// set maximum number of bytes used for cached bricks, at least the most recently used brick is always kept
+				void set_max_cache_size(size_t size);
+				/// return number of bytes currently used for cached bricks
+				size_t get_cache_size() const { return cache_size; }
+				/// return pointer to the decoded voxels of brick bi in volume layout of dimensions get_brick_dimensions or 0 on failure; pointer is valid until next brick access
+				const uint8_t* get_brick(size_t bi) const;
+				/// read sub box of given dimensions starting at voxel index min_idx into V, which is resized accordingly and gets the extent of the sub box
+				bool read_sub_volume(const volume::index_type& min_idx, const volume::dimension_type& dims, volume& V) const;
+				/// collect indices of bricks whose value range overlaps [min_value,max_value]
+				void find_bricks(double min_value, double max_value, std::vector<size_t>& brick_indices) const;
+			};
+
+			/// write in memory volume to bricked volume file
+			extern CGV_API bool write_bricked_volume(const std::string& file_name, const volume& V, const volume::dimension_type& brick_size = volume::dimension_type(64, 64, 64), BrickCompression compression = BC_DELTA_VARINT);
+		}
+	}
+}
+
+#include <cgv/config/lib_end.h>
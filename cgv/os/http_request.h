@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <functional>
 
 namespace cgv {
 	namespace os {
@@ -32,6 +33,10 @@ struct http_request
 	std::string accept_language;
 	std::string accept_encoding;
 	std::string user_agent;
+	/// all header fields with lower case names, only filled by providers that support it
+	std::map<std::string, std::string> headers;
+	/// body of the request, for example the data of a POST request
+	std::string body;
 
 	/**@name return values*/
 	//@{
@@ -43,8 +48,16 @@ struct http_request
 	/** auth_realm: allows to set the basic realm for an authentication,
 	    no need to additionally set status if set */
 	std::string auth_realm;
-	/// set this member to the html page to be returned
+	/// set this member to the html page to be returned, which can also contain binary data
 	std::string answer;
+	/// content type of the answer, where an empty string corresponds to "text/html; charset=ISO-8859-1"
+	std::string content_type;
+	/** if set, the answer is followed by chunks that are created by repeated calls of the chunk
+	    generator until it returns false and that are sent with chunked transfer encoding. This allows
+		to stream large or incrementally generated answers. Only supported by providers that support
+		HTTP/1.1 like the co_web_mt plugin, which calls the generator after handle_request has returned
+		whenever the connection can take further data. */
+	std::function<bool(std::string& chunk)> chunk_generator;
 };
 
 	}
@@ -1,17 +1,26 @@
 #include <errno.h>
 #ifdef WIN32
 #pragma warning(disable:4996)
+#ifndef FD_SETSIZE
+#define FD_SETSIZE 1024
+#endif
 #include <WinSock2.h>
 #else
 #include <netdb.h>
 #include <sys/socket.h>
 #include <sys/time.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <netinet/in.h>
 #include <unistd.h>
-#include <string.h>
+#ifdef __linux__
+#define CGV_OS_USE_EPOLL
+#include <sys/epoll.h>
+#endif
 #endif
 
+#include <string.h>
 #include <algorithm>
 #include <iostream>
 #include "socket.h"
@@ -24,6 +33,12 @@ typedef int SOCKET;
 #define closesocket(s) ::close(s)
 #endif
 
+#ifdef __linux__
+#define CGV_OS_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define CGV_OS_SEND_FLAGS 0
+#endif
+
 #ifdef WIN32
 		typedef int socklen_t;
 #endif
@@ -40,6 +55,23 @@ mutex& ref_show_mutex()
 	return sm;
 }
 
+/// number of bytes received with one system call
+static const size_t input_chunk_size = 65536;
+/// maximum number of buffers passed to one gather operation
+static const size_t max_nr_gather_buffers = 64;
+
+/// wait until socket is readable or writable or timeout_ms milliseconds passed (-1 waits infinitely) and return whether socket is ready
+static bool wait_for_socket(size_t s, bool write, int timeout_ms)
+{
+	fd_set set;
+	FD_ZERO(&set);
+	FD_SET((SOCKET)s, &set);
+	timeval t;
+	t.tv_sec = timeout_ms / 1000;
+	t.tv_usec = 1000 * (timeout_ms % 1000);
+	return select((int)s + 1, write ? 0 : &set, write ? &set : 0, 0, timeout_ms < 0 ? 0 : &t) == 1;
+}
+
 int socket::nr_of_sockets= 0;
 bool socket::show_debug_output = false;
 
@@ -50,8 +82,17 @@ void socket::enable_debug_output(bool enable)
 }
 
 
+/// mutex protecting the socket count, as sockets can be opened and closed in different threads
+static mutex& ref_count_mutex()
+{
+	static mutex cm;
+	return cm;
+}
+
 bool socket::begin() 
 {
+	ref_count_mutex().lock();
+	bool success = true;
 	if (!nr_of_sockets) {
 #ifdef WIN32
 		WSADATA info;
@@ -61,7 +102,7 @@ bool socket::begin()
 				std::cerr << "could not start up windows socket dll" << std::endl;
 				ref_show_mutex().unlock();
 			}
-			return false;
+			success = false;
 		}
 		else
 #endif
@@ -71,12 +112,15 @@ bool socket::begin()
 				ref_show_mutex().unlock();
 			}
 	}
-	++nr_of_sockets;
-	return true;
+	if (success)
+		++nr_of_sockets;
+	ref_count_mutex().unlock();
+	return success;
 }
 
 void socket::end() 
 {
+	ref_count_mutex().lock();
 	if (--nr_of_sockets == 0) {
 #ifdef WIN32
 		WSACleanup();
@@ -87,25 +131,38 @@ void socket::end()
 			ref_show_mutex().unlock();
 		}
 	}
-
+	ref_count_mutex().unlock();
 }
 
 socket::socket() : user_data(0) 
 {
+	reset_state();
 }
 
 /// construct from existing socket identifier
 socket::socket(size_t _id) : user_data(_id)
 {
+	reset_state();
+}
+
+void socket::reset_state()
+{
+	input_buffer.clear();
+	input_begin = input_end = line_scan_pos = 0;
+	output_buffer.clear();
+	output_capacity = 65536;
+	blocking = true;
+	closed = false;
 }
 
 bool socket::set_last_error(const char* location, const std::string& text) const
 {
 	if (text.empty()) {
-		char buffer[1024];
-		socklen_t len;
-		getsockopt(user_data, SOL_SOCKET, SO_ERROR, buffer, &len);
-		last_error = buffer;
+#ifdef WIN32
+		last_error = "error code " + std::to_string(WSAGetLastError());
+#else
+		last_error = strerror(errno);
+#endif
 	}
 	else
 		last_error = text;
@@ -114,7 +171,7 @@ bool socket::set_last_error(const char* location, const std::string& text) const
 		std::cerr << "socket error: ";
 		if (user_data)
 			std::cerr << '(' << user_data << ") ";
-		std::cerr << location << " - " << last_error.c_str();
+		std::cerr << location << " - " << last_error.c_str() << std::endl;
 		ref_show_mutex().unlock();
 	}
 	return false;
@@ -132,15 +189,45 @@ std::string socket::get_last_error() const
 	return last_error;
 }
 
+/// return whether last socket call failed because it would block
+bool socket::last_call_would_block()
+{
+#ifdef WIN32
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+/// switch between blocking (default) and non blocking mode
+bool socket::set_blocking(bool enable)
+{
+	if (!user_data)
+		return set_last_error("set_blocking", "socket not connected");
+	if (blocking == enable)
+		return true;
+#ifdef WIN32
+	u_long arg = enable ? 0 : 1;
+	if (ioctlsocket(user_data, FIONBIO, &arg) != 0)
+		return set_last_error("set_blocking");
+#else
+	int flags = fcntl(user_data, F_GETFL, 0);
+	if (flags == -1 || fcntl(user_data, F_SETFL, enable ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK)) == -1)
+		return set_last_error("set_blocking");
+#endif
+	blocking = enable;
+	last_error.clear();
+	return true;
+}
+
 /// return whether data has arrived
 bool socket::is_data_pending() const
 {
-	fd_set set;
-	FD_ZERO(&set);
-	FD_SET(user_data, &set);
-	timeval t;
-	timerclear(&t);
-	return select(0, &set, 0, 0, &t) == 1;
+	if (input_begin < input_end)
+		return true;
+	if (!user_data || closed)
+		return false;
+	return wait_for_socket(user_data, false, 0);
 }
 
 /// return the number of data bytes that have been arrived at the socket
@@ -150,97 +237,246 @@ int socket::get_nr_of_arrived_bytes() const
 		set_last_error("get_nr_of_arrived_bytes", "socket not connected");
 		return -1;
 	}
-	unsigned long arg;
+	int nr_buffered = int(input_end - input_begin);
 #ifdef WIN32
+	unsigned long arg;
 	if (ioctlsocket(user_data, FIONREAD, &arg) != 0) {
 		set_last_error("get_nr_of_arrived_bytes");
 		return -1;
 	}
-	last_error.clear();
 #else
-	arg = -1;
-	std::cerr << "get_nr_of_arrived_bytes not implemented!!!" << std::endl;
+	int arg;
+	if (ioctl(user_data, FIONREAD, &arg) != 0) {
+		set_last_error("get_nr_of_arrived_bytes");
+		return -1;
+	}
 #endif
-	return arg;
+	last_error.clear();
+	return nr_buffered + int(arg);
 }
 
-std::string socket::receive_data(unsigned int nr_of_bytes) 
+int socket::fill_input_buffer()
 {
-	std::string ret;
-	char buf[1024];
-	last_error.clear();
+	if (!user_data || closed)
+		return -1;
+	// discard consumed data and make room for a complete chunk
+	if (input_begin == input_end)
+		input_begin = input_end = line_scan_pos = 0;
+	if (input_buffer.size() - input_end < input_chunk_size) {
+		if (input_begin > 0) {
+			memmove(&input_buffer[0], &input_buffer[input_begin], input_end - input_begin);
+			input_end -= input_begin;
+			line_scan_pos -= input_begin;
+			input_begin = 0;
+		}
+		if (input_buffer.size() - input_end < input_chunk_size)
+			input_buffer.resize(std::max(2 * input_buffer.size(), input_end + input_chunk_size));
+	}
+	int result = recv(user_data, &input_buffer[input_end], int(input_buffer.size() - input_end), 0);
+	if (result > 0) {
+		input_end += result;
+		return result;
+	}
+	if (result == SOCKET_ERROR && last_call_would_block())
+		return 0;
+	closed = true;
+	set_last_error("receive", result == SOCKET_ERROR ? "" : "connection closed");
+	return -1;
+}
 
+bool socket::extract_line(std::string& line)
+{
+	const char* buffer = input_buffer.data();
+	const char* nl = static_cast<const char*>(memchr(buffer + line_scan_pos, '\n', input_end - line_scan_pos));
+	if (!nl) {
+		line_scan_pos = input_end;
+		return false;
+	}
+	size_t line_end = nl - buffer + 1;
+	line.assign(buffer + input_begin, line_end - input_begin);
+	input_begin = line_scan_pos = line_end;
+	return true;
+}
+
+std::string socket::receive_data(unsigned int nr_of_bytes)
+{
+	last_error.clear();
 	if (nr_of_bytes == 0) {
-		while (is_data_pending()) {
-			int received_nr_of_bytes = recv (user_data, buf, 1024, 0);
-			if (received_nr_of_bytes <= 0) {
-				set_last_error("receive_data", received_nr_of_bytes == SOCKET_ERROR ? "" : "connection closed");
+		while (!closed && user_data && wait_for_socket(user_data, false, 0))
+			if (fill_input_buffer() <= 0)
 				break;
-			}
-			ret += std::string(buf,received_nr_of_bytes);
-		}
+		nr_of_bytes = unsigned(input_end - input_begin);
 	}
 	else {
-		while (nr_of_bytes > 0) {
-			int received_nr_of_bytes = recv(user_data, buf, min(1024, (int)nr_of_bytes), 0);
-			if (received_nr_of_bytes <= 0) {
-				set_last_error("receive_data", received_nr_of_bytes == SOCKET_ERROR ? "" : "connection closed");
+		while (input_end - input_begin < nr_of_bytes) {
+			int result = fill_input_buffer();
+			if (result < 0)
 				break;
-			}
-			ret += std::string(buf,received_nr_of_bytes);
-			nr_of_bytes -= received_nr_of_bytes;
+			if (result == 0)
+				wait_for_socket(user_data, false, -1);
 		}
-
+		nr_of_bytes = std::min(nr_of_bytes, unsigned(input_end - input_begin));
 	}
+	std::string ret(input_buffer.data() + input_begin, nr_of_bytes);
+	input_begin += nr_of_bytes;
+	line_scan_pos = std::max(line_scan_pos, input_begin);
 	return ret;
 }
 
-std::string socket::receive_line() 
+std::string socket::receive_line()
 {
 	std::string ret;
-	while (true) {
-		char r;
-		int result = recv(user_data, &r, 1, 0);
-		if (result <= 0) {
-			set_last_error("receive_line", result == SOCKET_ERROR ? "" : "connection closed");
+	while (!extract_line(ret)) {
+		int result = fill_input_buffer();
+		if (result < 0)
 			return "";
+		if (result == 0)
+			wait_for_socket(user_data, false, -1);
+	}
+	last_error.clear();
+	if (show_debug_output) {
+		ref_show_mutex().lock();
+		std::cout << "received line: " << ret.c_str();
+		std::cout.flush();
+		ref_show_mutex().unlock();
+	}
+	return ret;
+}
+
+bool socket::try_receive_line(std::string& line)
+{
+	if (extract_line(line))
+		return true;
+	while (!closed && user_data && (!blocking || wait_for_socket(user_data, false, 0))) {
+		if (fill_input_buffer() <= 0)
+			break;
+		if (extract_line(line))
+			return true;
+	}
+	return false;
+}
+
+bool socket::try_receive_data(std::string& data)
+{
+	while (!closed && user_data && (!blocking || wait_for_socket(user_data, false, 0)))
+		if (fill_input_buffer() <= 0)
+			break;
+	if (input_begin == input_end)
+		return false;
+	data.append(input_buffer.data() + input_begin, input_end - input_begin);
+	input_begin = input_end = line_scan_pos = 0;
+	return true;
+}
+
+bool socket::send_all(const socket_buffer* buffers, size_t nr_buffers, const char* location)
+{
+	if (!user_data)
+		return set_last_error(location, "socket not connected");
+	// collect non empty buffers starting with the output buffer
+	std::vector<socket_buffer> parts;
+	parts.reserve(nr_buffers + 1);
+	if (!output_buffer.empty())
+		parts.push_back({ output_buffer.data(), output_buffer.size() });
+	for (size_t i = 0; i < nr_buffers; ++i)
+		if (buffers[i].size > 0)
+			parts.push_back(buffers[i]);
+	size_t pi = 0;
+	while (pi < parts.size()) {
+		size_t nr_parts = std::min(parts.size() - pi, max_nr_gather_buffers);
+#ifdef WIN32
+		WSABUF wsa_buffers[max_nr_gather_buffers];
+		for (size_t i = 0; i < nr_parts; ++i) {
+			wsa_buffers[i].buf = const_cast<char*>(parts[pi + i].data);
+			wsa_buffers[i].len = ULONG(parts[pi + i].size);
 		}
-		ret += r;
-		if (r == '\n') {
-			last_error.clear();
-			if (show_debug_output) {
-				ref_show_mutex().lock();
-				std::cout << "received line: " << ret.c_str(); 
-				std::cout.flush();
-				ref_show_mutex().unlock();
+		DWORD nr_sent_bytes = 0;
+		long long nr_bytes_sent = WSASend(user_data, wsa_buffers, DWORD(nr_parts), &nr_sent_bytes, 0, 0, 0) == 0 ? (long long)nr_sent_bytes : -1;
+#else
+		iovec io_buffers[max_nr_gather_buffers];
+		for (size_t i = 0; i < nr_parts; ++i) {
+			io_buffers[i].iov_base = const_cast<char*>(parts[pi + i].data);
+			io_buffers[i].iov_len = parts[pi + i].size;
+		}
+		msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = io_buffers;
+		msg.msg_iovlen = nr_parts;
+		long long nr_bytes_sent = sendmsg(user_data, &msg, CGV_OS_SEND_FLAGS);
+#endif
+		if (nr_bytes_sent < 0) {
+			if (last_call_would_block()) {
+				if (!blocking)
+					break;
+				wait_for_socket(user_data, true, -1);
+				continue;
 			}
-			return ret;
+			closed = true;
+			output_buffer.clear();
+			return set_last_error(location);
+		}
+		// advance over sent data
+		size_t n = size_t(nr_bytes_sent);
+		while (pi < parts.size() && n >= parts[pi].size)
+			n -= parts[pi++].size;
+		if (n > 0) {
+			parts[pi].data += n;
+			parts[pi].size -= n;
 		}
 	}
+	// keep unsent data, which might point into the output buffer
+	std::string unsent;
+	for (; pi < parts.size(); ++pi)
+		unsent.append(parts[pi].data, parts[pi].size);
+	output_buffer.swap(unsent);
+	last_error.clear();
+	return true;
 }
 
-bool socket::send_line(const std::string& s) 
+bool socket::send_line(const std::string& s)
 {
-	return send_data(s+'\n');
+	socket_buffer buffers[2] = { { s.data(), s.size() }, { "\n", 1 } };
+	return send_all(buffers, 2, "send_line");
 }
 
 bool socket::send_data(const std::string& s)
 {
-	int nr_bytes = (int)s.length();
-	const char* buf = s.c_str();
-	do {
-		int nr_bytes_sent = send(user_data, buf, nr_bytes, 0);
-		if (nr_bytes_sent <= 0)
-			return set_last_error("send_data/line", nr_bytes_sent == SOCKET_ERROR ? "" : "connection closed");
-		nr_bytes -= nr_bytes_sent;
-		buf += nr_bytes_sent;
-	} while (nr_bytes > 0);
-	last_error.clear();
+	socket_buffer buffer = { s.data(), s.size() };
+	return send_all(&buffer, 1, "send_data");
+}
+
+bool socket::send_buffers(const socket_buffer* buffers, size_t nr_buffers)
+{
+	return send_all(buffers, nr_buffers, "send_buffers");
+}
+
+bool socket::write_data(const char* data, size_t size)
+{
+	output_buffer.append(data, size);
+	if (output_buffer.size() >= output_capacity)
+		return flush();
+	return true;
+}
+
+bool socket::write_line(const std::string& content)
+{
+	output_buffer.append(content);
+	output_buffer.push_back('\n');
+	if (output_buffer.size() >= output_capacity)
+		return flush();
 	return true;
 }
 
+bool socket::flush()
+{
+	if (output_buffer.empty())
+		return true;
+	return send_all(0, 0, "flush");
+}
+
 bool socket::close() 
 {
+	if (user_data && !output_buffer.empty())
+		flush();
 #ifdef WIN32
 	shutdown(user_data, SD_BOTH);
 	int result = closesocket(user_data);
@@ -260,6 +496,7 @@ bool socket::close()
 		set_last_error("close");
 
 	user_data = 0;
+	reset_state();
 	end();
 	return result == 0;
 }
@@ -270,6 +507,8 @@ socket_client::socket_client()
 
 bool socket_client::connect(const std::string& host, int port)
 {
+	if (user_data)
+		close();
 	if (!begin())
 		return set_last_error("connect", "could not initialize os specific socket shared library");
 	user_data = ::socket(AF_INET,SOCK_STREAM,0);
@@ -318,6 +557,9 @@ bool socket_server::bind_and_listen(int port, int max_nr_connections)
 		user_data = 0;
 		return set_last_error("bind_and_listen", "could not create socket");
 	}
+	/* allow to rebind the port while connections of a previous server are in TIME_WAIT state */
+	int reuse = 1;
+	setsockopt(user_data, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
 	/* bind the socket to the internet address */
 	if (bind(user_data, (sockaddr *)&sa, sizeof(sockaddr_in)) == SOCKET_ERROR) {
 		set_last_error("bind_and_listen");
@@ -343,13 +585,7 @@ socket_ptr socket_server::wait_for_connection()
 		set_last_error("wait_for_connection", "attempt to wait for connection of socket server that does not listen to port");
 		return socket_ptr();
 	}
-#ifdef WIN32
-	u_long arg = 0;
-	ioctlsocket(user_data, FIONBIO, &arg);
-#else
-	int flags = fcntl(user_data, F_GETFD) & (~O_NONBLOCK);
-	fcntl(user_data, F_SETFD, flags);
-#endif
+	set_blocking(true);
 	SOCKET new_sock = ::accept(user_data, 0, 0);
 	if (new_sock == INVALID_SOCKET) {
 		set_last_error("wait_for_connection");
@@ -362,7 +598,11 @@ socket_ptr socket_server::wait_for_connection()
 		ref_show_mutex().unlock();
 	}
 	begin();
-	return socket_ptr(new socket(new_sock));
+	socket_ptr s(new socket(new_sock));
+	// accepted sockets inherit the non blocking mode of the server on some platforms
+	s->blocking = false;
+	s->set_blocking(true);
+	return s;
 }
 
 /// check if a new connection is in the connection queue and return this or an empty connection pointer
@@ -372,12 +612,7 @@ socket_ptr socket_server::check_for_connection()
 		set_last_error("check_for_connection", "attempt to check for connection of socket server that does not listen to port");
 		return socket_ptr();
 	}
-#ifdef WIN32
-	u_long arg = 1;
-	ioctlsocket(user_data, FIONBIO, &arg);
-#else
-	fcntl(user_data, F_SETFD, O_NONBLOCK);
-#endif
+	set_blocking(false);
 	SOCKET new_sock = ::accept(user_data, 0, 0);
 	if (new_sock == INVALID_SOCKET) {
 #ifdef WIN32
@@ -398,7 +633,11 @@ socket_ptr socket_server::check_for_connection()
 		ref_show_mutex().unlock();
 	}
 	begin();
-	return socket_ptr(new socket(new_sock));
+	socket_ptr s(new socket(new_sock));
+	// accepted sockets inherit the non blocking mode of the server on some platforms
+	s->blocking = false;
+	s->set_blocking(true);
+	return s;
 }
 
 /// this is the only way to create a socket_server as a reference counted pointer
@@ -407,6 +646,250 @@ socket_server_ptr create_socket_server()
 	return socket_server_ptr(new socket_server);
 }
 
+socket_select::socket_select() : poll_handle(-1), wake_handle(0), stop_requested(false)
+{
+#ifdef CGV_OS_USE_EPOLL
+	poll_handle = epoll_create1(0);
+	if (poll_handle == -1)
+		std::cerr << "socket_select: could not create epoll instance - " << strerror(errno) << std::endl;
+#endif
+	if (!socket::begin())
+		return;
+	// create datagram socket bound to a free loopback port and connected to itself
+	SOCKET s = ::socket(AF_INET, SOCK_DGRAM, 0);
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	socklen_t len = sizeof(addr);
+	if (s == INVALID_SOCKET || bind(s, (sockaddr*)&addr, sizeof(addr)) != 0 ||
+		getsockname(s, (sockaddr*)&addr, &len) != 0 || ::connect(s, (sockaddr*)&addr, sizeof(addr)) != 0) {
+		std::cerr << "socket_select: could not create wake up socket, wait() can only be interrupted by timeouts" << std::endl;
+		if (s != INVALID_SOCKET)
+			closesocket(s);
+		return;
+	}
+#ifdef WIN32
+	u_long arg = 1;
+	ioctlsocket(s, FIONBIO, &arg);
+#else
+	fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+#endif
+	wake_handle = size_t(s);
+#ifdef CGV_OS_USE_EPOLL
+	epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = wake_handle;
+	epoll_ctl(poll_handle, EPOLL_CTL_ADD, s, &ev);
+#endif
+}
+
+socket_select::~socket_select()
+{
+#ifdef CGV_OS_USE_EPOLL
+	if (poll_handle != -1)
+		::close(poll_handle);
+#endif
+	if (wake_handle)
+		closesocket((SOCKET)wake_handle);
+	socket::end();
+}
+
+void socket_select::wake_up()
+{
+	if (wake_handle)
+		send((SOCKET)wake_handle, "w", 1, 0);
+}
+
+/// discard all pending wake up messages
+static void drain_wake_up_socket(size_t wake_handle)
+{
+	char buffer[64];
+	while (recv((SOCKET)wake_handle, buffer, sizeof(buffer), 0) > 0)
+		;
+}
+
+int socket_select::find(const socket* s) const
+{
+	if (s->user_data) {
+		auto iter = entry_index.find(s->user_data);
+		if (iter != entry_index.end() && entries[iter->second].sock.operator->() == s)
+			return int(iter->second);
+	}
+	// socket might have been closed after registration
+	for (size_t i = 0; i < entries.size(); ++i)
+		if (entries[i].sock.operator->() == s)
+			return int(i);
+	return -1;
+}
+
+bool socket_select::update_os_events(entry& e)
+{
+	int os_events = e.events & (SE_READ | SE_WRITE);
+	if (e.sock->get_nr_of_unsent_bytes() > 0)
+		os_events |= SE_WRITE;
+	if (os_events == e.os_events)
+		return true;
+#ifdef CGV_OS_USE_EPOLL
+	epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = ((os_events & SE_READ) ? EPOLLIN : 0) | ((os_events & SE_WRITE) ? EPOLLOUT : 0);
+	ev.data.u64 = e.handle;
+	if (epoll_ctl(poll_handle, e.os_events == -1 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, int(e.handle), &ev) == -1) {
+		std::cerr << "socket_select: could not register socket " << e.handle << " - " << strerror(errno) << std::endl;
+		return false;
+	}
+#endif
+	e.os_events = os_events;
+	return true;
+}
+
+bool socket_select::add(socket_ptr s, int events, const handler_type& handler)
+{
+	if (!s || !s->user_data) {
+		std::cerr << "socket_select: attempt to add socket that is not connected" << std::endl;
+		return false;
+	}
+	int i = find(s.operator->());
+	if (i != -1) {
+		entries[i].handler = handler;
+		return modify(s, events);
+	}
+	if (!s->set_blocking(false))
+		return false;
+	entry e = { s, s->user_data, events, handler, -1 };
+	if (!update_os_events(e))
+		return false;
+	entry_index[e.handle] = entries.size();
+	entries.push_back(e);
+	return true;
+}
+
+bool socket_select::modify(socket_ptr s, int events)
+{
+	int i = s ? find(s.operator->()) : -1;
+	if (i == -1)
+		return false;
+	entries[i].events = events;
+	return update_os_events(entries[i]);
+}
+
+bool socket_select::remove(socket_ptr s)
+{
+	int i = s ? find(s.operator->()) : -1;
+	if (i == -1)
+		return false;
+#ifdef CGV_OS_USE_EPOLL
+	// closed sockets have been removed from the epoll set by the os
+	if (s->user_data == entries[i].handle) {
+		epoll_event ev;
+		epoll_ctl(poll_handle, EPOLL_CTL_DEL, int(entries[i].handle), &ev);
+	}
+#endif
+	entry_index.erase(entries[i].handle);
+	if (size_t(i) + 1 < entries.size()) {
+		entries[i] = entries.back();
+		entry_index[entries[i].handle] = i;
+	}
+	entries.pop_back();
+	return true;
+}
+
+void socket_select::dispatch(size_t handle, int events)
+{
+	auto iter = entry_index.find(handle);
+	if (iter == entry_index.end())
+		return;
+	// copy socket and handler as the handler may change the registered sockets
+	socket_ptr s = entries[iter->second].sock;
+	handler_type handler = entries[iter->second].handler;
+	int interest = entries[iter->second].events;
+	if ((events & SE_WRITE) && s->get_nr_of_unsent_bytes() > 0)
+		s->flush();
+	if (s->is_closed())
+		events |= SE_CLOSE;
+	events &= interest | SE_CLOSE;
+	if (events)
+		handler(s, events);
+	iter = entry_index.find(handle);
+	if (iter != entry_index.end())
+		update_os_events(entries[iter->second]);
+}
+
+int socket_select::wait(int timeout_ms)
+{
+	// register write interest of sockets with data written outside of their handlers
+	for (auto& e : entries)
+		if (!update_os_events(e))
+			return -1;
+	std::vector<std::pair<size_t, int> > ready;
+#ifdef CGV_OS_USE_EPOLL
+	std::vector<epoll_event> events(std::max(std::min(entries.size(), size_t(1024)), size_t(1)));
+	int n = epoll_wait(poll_handle, &events[0], int(events.size()), timeout_ms);
+	if (n == -1) {
+		if (errno == EINTR)
+			return 0;
+		std::cerr << "socket_select: epoll_wait failed - " << strerror(errno) << std::endl;
+		return -1;
+	}
+	for (int i = 0; i < n; ++i)
+		if (events[i].data.u64 == wake_handle)
+			drain_wake_up_socket(wake_handle);
+		else
+			ready.push_back(std::make_pair(size_t(events[i].data.u64),
+			((events[i].events & EPOLLIN) ? SE_READ : 0) | ((events[i].events & EPOLLOUT) ? SE_WRITE : 0) |
+				((events[i].events & (EPOLLHUP | EPOLLERR)) ? SE_READ | SE_CLOSE : 0)));
+#else
+	if (entries.empty() && !wake_handle)
+		return 0;
+	fd_set read_set, write_set, error_set;
+	FD_ZERO(&read_set);
+	FD_ZERO(&write_set);
+	FD_ZERO(&error_set);
+	size_t max_handle = wake_handle;
+	if (wake_handle)
+		FD_SET((SOCKET)wake_handle, &read_set);
+	for (const auto& e : entries) {
+		if (e.os_events & SE_READ)
+			FD_SET((SOCKET)e.handle, &read_set);
+		if (e.os_events & SE_WRITE)
+			FD_SET((SOCKET)e.handle, &write_set);
+		FD_SET((SOCKET)e.handle, &error_set);
+		max_handle = std::max(max_handle, e.handle);
+	}
+	timeval t;
+	t.tv_sec = timeout_ms / 1000;
+	t.tv_usec = 1000 * (timeout_ms % 1000);
+	int n = select(int(max_handle) + 1, &read_set, &write_set, &error_set, timeout_ms < 0 ? 0 : &t);
+	if (n == SOCKET_ERROR) {
+		if (errno == EINTR)
+			return 0;
+		std::cerr << "socket_select: select failed" << std::endl;
+		return -1;
+	}
+	if (wake_handle && FD_ISSET((SOCKET)wake_handle, &read_set))
+		drain_wake_up_socket(wake_handle);
+	for (const auto& e : entries) {
+		int events = (FD_ISSET((SOCKET)e.handle, &read_set) ? SE_READ : 0) | (FD_ISSET((SOCKET)e.handle, &write_set) ? SE_WRITE : 0) |
+			(FD_ISSET((SOCKET)e.handle, &error_set) ? SE_READ | SE_CLOSE : 0);
+		if (events)
+			ready.push_back(std::make_pair(e.handle, events));
+	}
+#endif
+	for (const auto& r : ready)
+		dispatch(r.first, r.second);
+	return int(ready.size());
+}
+
+void socket_select::run(int timeout_ms)
+{
+	stop_requested = false;
+	while (!stop_requested && !entries.empty())
+		if (wait(timeout_ms) < 0)
+			break;
+}
+
 
 	}
 }
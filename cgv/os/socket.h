@@ -1,6 +1,10 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <functional>
+#include <atomic>
+#include <unordered_map>
 #include <cgv/data/ref_ptr.h>
 
 #include "lib_begin.h"
@@ -8,7 +12,24 @@
 namespace cgv {
 	namespace os {
 
-/** base class for all sockets */
+/// memory range that is passed to socket::send_buffers
+struct socket_buffer
+{
+	/// pointer to first byte
+	const char* data;
+	/// number of bytes
+	size_t size;
+};
+
+/** base class for all sockets. Received data is read in large chunks into an input buffer from which
+    lines and data are extracted without further system calls. Data written with write_data() and
+	write_line() is collected in an output buffer and sent in large chunks on flush() or when the
+	buffer exceeds its capacity.
+
+	Sockets are blocking by default. In non blocking mode no function waits for the connection:
+	the try_receive functions only consume data that has already arrived and data that cannot be sent
+	immediately remains in the output buffer, which is flushed by socket_select once the socket
+	becomes writable. */
 class CGV_API socket : public data::ref_counted
 {
 protected:
@@ -26,8 +47,33 @@ protected:
 	size_t user_data;
 	/// store the last error
 	mutable std::string last_error;
+	/// buffer for received data, of which the range [input_begin,input_end) has not been consumed yet
+	std::vector<char> input_buffer;
+	size_t input_begin, input_end;
+	/// position in input buffer up to which no newline is present
+	size_t line_scan_pos;
+	/// data that has been written but not sent yet
+	std::string output_buffer;
+	/// number of bytes in output buffer after which the buffer is flushed
+	size_t output_capacity;
+	/// whether socket is in blocking mode
+	bool blocking;
+	/// whether the connection has been closed by the peer or failed
+	bool closed;
 	/// convenience function to set last error and print debug info. The method always returns false.
 	bool set_last_error(const char* location, const std::string& text = "") const;
+	/// return whether last socket call failed because it would block
+	static bool last_call_would_block();
+	//! receive available data into input buffer with one system call
+	/*! Returns the number of received bytes, 0 if no data is available in non blocking mode and -1 if the connection has been closed or failed. */
+	int fill_input_buffer();
+	/// extract line including the newline from input buffer if a complete line is available
+	bool extract_line(std::string& line);
+	/// reset buffers and state for a new connection
+	void reset_state();
+	//! send output buffer followed by given buffers with one gather operation per system call
+	/*! In non blocking mode the data that could not be sent is stored in the output buffer. */
+	bool send_all(const socket_buffer* buffers, size_t nr_buffers, const char* location);
 public:
 	/// enables or disables (default) debug output for all socket commands
 	static void enable_debug_output(bool enable = true);
@@ -35,18 +81,46 @@ public:
 	virtual ~socket();
 	/// returns the last error
 	std::string get_last_error() const;
-	/// return whether data has arrived
+	/// return platform dependent socket handle or 0 if socket is not open
+	size_t get_handle() const { return user_data; }
+	/// switch between blocking (default) and non blocking mode
+	bool set_blocking(bool enable);
+	/// return whether socket is in blocking mode
+	bool is_blocking() const { return blocking; }
+	/// return whether the connection has been closed by the peer or failed, such that only buffered data can be received, while sending might still be possible
+	bool is_closed() const { return closed; }
+	/// return whether data has arrived, including data in the input buffer
 	bool is_data_pending() const;
-	/// return the number of data bytes that have been arrived at the socket or -1 if socket is not connected
+	/// return the number of data bytes that have been arrived at the socket including the input buffer or -1 if socket is not connected
 	int get_nr_of_arrived_bytes() const;
-	/// receive data up to the next newline excluding the newline char
+	/// receive data up to and including the next newline, blocks until a complete line has arrived
 	std::string receive_line();
 	/// receive all pending data or if nr_of_bytes is larger than 0, exactly nr_of_bytes
 	std::string receive_data(unsigned int nr_of_bytes = 0);
+	/// receive arrived data without blocking and extract the next complete line including the newline, return false if no complete line is available
+	bool try_receive_line(std::string& line);
+	/// receive arrived data without blocking and append all buffered data to the given string, return whether data has been appended
+	bool try_receive_data(std::string& data);
 	/// extends line by newline and send as data
 	bool send_line(const std::string& content);
-	/// send the data in the string
+	/// send the data in the string after the data in the output buffer
 	bool send_data(const std::string&);
+	/// send the given memory ranges with a single gather operation after the data in the output buffer
+	bool send_buffers(const socket_buffer* buffers, size_t nr_buffers);
+	/// set the number of bytes after which write_data() and write_line() flush the output buffer (defaults to 64kB)
+	void set_output_capacity(size_t capacity) { output_capacity = capacity; }
+	/// append data to output buffer and flush if buffer exceeds its capacity
+	bool write_data(const char* data, size_t size);
+	/// append data to output buffer and flush if buffer exceeds its capacity
+	bool write_data(const std::string& data) { return write_data(data.data(), data.size()); }
+	/// append line and newline to output buffer and flush if buffer exceeds its capacity
+	bool write_line(const std::string& content);
+	//! send data in output buffer
+	/*! In blocking mode the function returns after all data has been sent. In non blocking mode the data that
+	    cannot be sent immediately remains in the output buffer. */
+	bool flush();
+	/// return the number of bytes in the output buffer that have not been sent
+	size_t get_nr_of_unsent_bytes() const { return output_buffer.size(); }
 	/// close the socket
 	bool close();
 };
@@ -99,6 +173,96 @@ public:
 /// this is the only way to create a socket_server as a reference counted pointer
 extern CGV_API socket_server_ptr create_socket_server();
 
+/// events reported by socket_select
+enum socket_event
+{
+	SE_READ = 1,   /// data or a new connection has arrived
+	SE_WRITE = 2,  /// data can be sent without blocking
+	SE_CLOSE = 4   /// the connection has been closed by the peer or failed
+};
+
+/** multiplexes many sockets on a single thread. Sockets are registered with a handler that is called with the
+    socket_event flags that occurred. The implementation uses epoll on linux and select on other platforms.
+	Registered sockets are switched to non blocking mode and data remaining in their output buffers
+	is flushed by the socket_select as soon as the socket becomes writable, such that handlers only
+	need to register SE_WRITE if they want to produce data in a streaming fashion.
+\code
+socket_select sel;
+socket_server_ptr server = create_socket_server();
+server->bind_and_listen(8080, 128);
+sel.add(server, SE_READ, [&](socket_ptr s, int events) {
+	for (socket_ptr c = server->check_for_connection(); c; c = server->check_for_connection())
+		sel.add(c, SE_READ, [&](socket_ptr c, int events) {
+			std::string line;
+			while (c->try_receive_line(line))
+				c->write_data(line);
+			c->flush();
+			if (c->is_closed())
+				sel.remove(c);
+		});
+});
+sel.run();
+\endcode */
+class CGV_API socket_select
+{
+public:
+	/// handler called with the socket and the socket_event flags that occurred
+	typedef std::function<void(socket_ptr, int)> handler_type;
+protected:
+	/// registered socket
+	struct entry
+	{
+		socket_ptr sock;
+		/// handle of socket at registration
+		size_t handle;
+		int events;
+		handler_type handler;
+		/// events currently registered at the os, which include SE_WRITE while unsent data is buffered, or -1 if not registered yet
+		int os_events;
+	};
+	/// registered sockets
+	std::vector<entry> entries;
+	/// index into entries for each socket handle
+	std::unordered_map<size_t, size_t> entry_index;
+	/// platform dependent handle of the multiplexer
+	int poll_handle;
+	/// loopback datagram socket connected to itself that is used to interrupt wait() or 0 if not available
+	size_t wake_handle;
+	/// whether run() should return
+	std::atomic<bool> stop_requested;
+	/// find index of entry of socket or -1
+	int find(const socket* s) const;
+	/// update os registration of entry if needed
+	bool update_os_events(entry& e);
+	/// flush output of writable socket and call handler
+	void dispatch(size_t handle, int events);
+	/// no copies
+	socket_select(const socket_select&) = delete;
+	socket_select& operator = (const socket_select&) = delete;
+public:
+	/// construct empty socket select
+	socket_select();
+	/// close multiplexer
+	~socket_select();
+	/// register socket for the given combination of socket_event flags, where SE_CLOSE is always reported
+	bool add(socket_ptr s, int events, const handler_type& handler);
+	/// change the events the socket is registered for
+	bool modify(socket_ptr s, int events);
+	/// unregister socket, which can be called from within handlers
+	bool remove(socket_ptr s);
+	/// return the number of registered sockets
+	size_t get_nr_sockets() const { return entries.size(); }
+	//! wait for events up to timeout_ms milliseconds (-1 waits infinitely) and dispatch them to the handlers
+	/*! Returns the number of sockets with events or -1 on failure. */
+	int wait(int timeout_ms = -1);
+	/// call wait() until stop() is called or no sockets are registered, checking for stop requests every timeout_ms milliseconds
+	void run(int timeout_ms = 100);
+	/// interrupt a wait() in progress or the next call to wait(), can be called from other threads
+	void wake_up();
+	/// request run() to return, can be called from handlers or other threads
+	void stop() { stop_requested = true; wake_up(); }
+};
+
 #if _MSC_VER >= 1400
 CGV_TEMPLATE template class CGV_API cgv::data::ref_ptr<cgv::os::socket_ptr>;
 CGV_TEMPLATE template class CGV_API cgv::data::ref_ptr<cgv::os::socket_client_ptr>;
@@ -109,10 +109,10 @@ void thread::kill()
 ///join the current thread
 void thread::wait_for_completion()
 {
-	if (running) {
-		std::thread& t = *((std::thread*&) thread_ptr);
-		t.join();
-	}
+	// also join threads whose run method has already returned, as destructing joinable threads terminates the program
+	std::thread* std_thread_ptr = reinterpret_cast<std::thread*>(thread_ptr);
+	if (std_thread_ptr && std_thread_ptr->joinable() && std_thread_ptr->get_id() != std::this_thread::get_id())
+		std_thread_ptr->join();
 }
 
 ///standard destructor (a running thread will be killed)
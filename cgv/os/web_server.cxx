@@ -34,16 +34,16 @@ void web_server::start()
 	if (ref_provider()) 
 		ref_provider()->start_web_server(this);
 	else
-		std::cerr << "no web server provider registered, please use the co_web plugin" << std::endl;
+		std::cerr << "no web server provider registered, please use the co_web or co_web_mt plugin" << std::endl;
 }
 
 /// can only be called from a different thread
 void web_server::stop()
 {
-	if (user_data && ref_provider()) 
+	if (!ref_provider())
+		std::cerr << "no web server provider registered, please use the co_web or co_web_mt plugin" << std::endl;
+	else if (user_data)
 		ref_provider()->stop_web_server(this);
-	else
-		std::cerr << "no web server provider registered, please use the co_web plugin" << std::endl;
 }
 
 
@@ -53,11 +53,17 @@ void web_server_thread::start()
 	thread::start();
 }
 
-/// calls the stop method of the web_server
+/// stops the web server and waits for the serving thread to terminate
 web_server_thread::~web_server_thread()
 {
-	thread::kill();
-	web_server::stop();
+	// the provider stores its state in user_data only once the server listens
+	while (is_running()) {
+		if (user_data)
+			web_server::stop();
+		else
+			thread::wait(1);
+	}
+	thread::wait_for_completion();
 }
 
 /// reimplements the run method that simply starts the web server
@@ -18,7 +18,7 @@ protected:
 public:
 	/// create a web server that listens to the given port
 	web_server(unsigned int _port = 80);
-	/// reimplement to handle requests
+	/// reimplement to handle requests, which can be called concurrently from several threads depending on the provider
 	virtual void handle_request(http_request& request) = 0;
 	/// start the web server (does never return)
 	void start();
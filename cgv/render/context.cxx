@@ -114,6 +114,12 @@ bool render_config::self_reflect(cgv::reflect::reflection_handler& srh)
 		srh.reflect_member("show_error_on_console", show_error_on_console);
 }
 
+/// all reflected members are plain members, such that properties are set through the reflection schema
+bool render_config::use_reflection_schema() const
+{
+	return true;
+}
+
 /// return a pointer to the current shader configuration
 render_config_ptr get_render_config()
 {
@@ -566,6 +566,8 @@ struct CGV_API render_config : public cgv::base::base, public context_config
 	std::string get_type_name() const;
 	/// reflect the shader_path member
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// all reflected members are plain members, such that properties are set through the reflection schema
+	bool use_reflection_schema() const;
 };
 
 /// type of ref counted pointer to render configuration
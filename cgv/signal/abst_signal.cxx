@@ -1,5 +1,7 @@
 #include <cgv/signal/abst_signal.h>
 #include "signal.h"
+#include <mutex>
+#include <thread>
 
 namespace cgv {
 	namespace signal {
@@ -14,15 +16,57 @@ void disconnect(signal<>& s, void(*fp)())
 	s.disconnect(function_functor<0>(fp)); 
 }
 
+/// mutex that serializes all modifications of signals and tackers
+static std::recursive_mutex& ref_signal_mutex()
+{
+	static std::recursive_mutex m;
+	return m;
+}
+
+/// mutex that serializes waiting for emissions, threads inside an emission only try to lock it to never block an emission that is waited for
+static std::mutex& ref_wait_mutex()
+{
+	static std::mutex m;
+	return m;
+}
+
+/// maximum nesting depth of emissions per thread that is recorded
+static const unsigned max_nr_recorded_emissions = 16;
+/// signals emitted by the current thread
+static thread_local const signal_base* emitted_signals[max_nr_recorded_emissions];
+/// number of nested emissions in the current thread
+static thread_local unsigned nr_nested_emissions = 0;
+
+signal_base::signal_base() : functors(0), emission_epoch(0), has_retired(false)
+{
+	nr_emissions[0] = nr_emissions[1] = 0;
+}
+
+signal_base::signal_base(const signal_base&) : functors(0), emission_epoch(0), has_retired(false)
+{
+	nr_emissions[0] = nr_emissions[1] = 0;
+}
+
+signal_base& signal_base::operator = (const signal_base&)
+{
+	return *this;
+}
+
 signal_base::~signal_base()
 {
 	disconnect_all();
+	std::lock_guard<std::recursive_mutex> lock(ref_signal_mutex());
+	for (auto fv : retired_functor_vectors)
+		delete fv;
+	for (auto fp : retired_functors)
+		delete fp;
 }
 
 /// return the number of connected functors
 unsigned signal_base::get_nr_functors() const
 {
-	return (unsigned) functors.size();
+	const functor_vector* fv = functors.load();
+	return fv ? (unsigned) fv->size() : 0;
 }
 
 /// only use this if you exactly know what to do!
@@ -31,6 +75,79 @@ void signal_base::connect_abst(functor_base* fp)
 	connect(fp);
 }
 
+void signal_base::publish(functor_vector* fv)
+{
+	if (fv && fv->empty()) {
+		delete fv;
+		fv = 0;
+	}
+	const functor_vector* old_fv = functors.exchange(fv);
+	if (old_fv) {
+		retired_functor_vectors.push_back(old_fv);
+		has_retired = true;
+	}
+	collect_retired();
+}
+
+void signal_base::collect_retired() const
+{
+	// emissions that start after the check see the current vector only, which cannot be retired while the mutex is locked
+	if (nr_emissions[0].load() != 0 || nr_emissions[1].load() != 0)
+		return;
+	for (auto fv : retired_functor_vectors)
+		delete fv;
+	retired_functor_vectors.clear();
+	for (auto fp : retired_functors)
+		delete fp;
+	retired_functors.clear();
+	has_retired = false;
+}
+
+void signal_base::wait_for_emissions() const
+{
+	// an emission of this signal by the current thread could never end, if more emissions are nested than recorded assume the worst
+	if (nr_nested_emissions > max_nr_recorded_emissions)
+		return;
+	for (unsigned i = 0; i < nr_nested_emissions; ++i)
+		if (emitted_signals[i] == this)
+			return;
+	// threads inside an emission do not wait if another thread is waiting, which might wait for the emission of the current thread
+	std::unique_lock<std::mutex> lock(ref_wait_mutex(), std::defer_lock);
+	if (nr_nested_emissions > 0) {
+		if (!lock.try_lock())
+			return;
+	}
+	else
+		lock.lock();
+	// toggle the epoch twice, such that emissions that started before are drained in both epochs while new emissions
+	// are counted in the other epoch and cannot delay the wait indefinitely
+	for (int i = 0; i < 2; ++i) {
+		unsigned epoch = emission_epoch.load();
+		emission_epoch.store(1 - epoch);
+		while (nr_emissions[epoch].load() != 0)
+			std::this_thread::yield();
+	}
+}
+
+const signal_base::functor_vector* signal_base::begin_emission(unsigned& epoch) const
+{
+	epoch = emission_epoch.load();
+	++nr_emissions[epoch];
+	if (nr_nested_emissions < max_nr_recorded_emissions)
+		emitted_signals[nr_nested_emissions] = this;
+	++nr_nested_emissions;
+	return functors.load();
+}
+
+void signal_base::end_emission(unsigned epoch) const
+{
+	--nr_nested_emissions;
+	if (--nr_emissions[epoch] == 0 && has_retired.load()) {
+		std::lock_guard<std::recursive_mutex> lock(ref_signal_mutex());
+		collect_retired();
+	}
+}
+
 void signal_base::link(functor_base* fp) 
 {
 	const tacker* t = fp->get_tacker();
@@ -43,47 +160,78 @@ void signal_base::unlink(functor_base* fp)
 	const tacker* t = fp->get_tacker();
 	if (t)
 		t->untack(this);
-	delete fp;
+	retired_functors.push_back(fp);
+	has_retired = true;
 }
 
 void signal_base::connect(functor_base* fp) 
 {
+	std::lock_guard<std::recursive_mutex> lock(ref_signal_mutex());
 	link(fp);
-	functors.push_back(fp);
+	const functor_vector* fv = functors.load();
+	functor_vector* new_fv = fv ? new functor_vector(*fv) : new functor_vector();
+	new_fv->push_back(fp);
+	publish(new_fv);
 }
 
 void signal_base::disconnect(const functor_base* fp)
 {
-	unsigned int i;
-	for (i=0; i<functors.size(); ++i) {
-		if (*functors[i] == *fp) {
-			unlink(functors[i]);
-			functors.erase(functors.begin()+i);
-			--i;
+	{
+		std::lock_guard<std::recursive_mutex> lock(ref_signal_mutex());
+		const functor_vector* fv = functors.load();
+		if (!fv)
+			return;
+		functor_vector* new_fv = new functor_vector();
+		for (auto f : *fv) {
+			if (*f == *fp)
+				unlink(f);
+			else
+				new_fv->push_back(f);
+		}
+		if (new_fv->size() == fv->size()) {
+			delete new_fv;
+			return;
 		}
+		publish(new_fv);
 	}
+	wait_for_emissions();
 }
 
 void signal_base::disconnect(const tacker* c)
 {
-	unsigned int i;
-	for (i=0; i<functors.size(); ++i) {
-		const auto tacker = functors[i]->get_tacker();
-		if (tacker == c) {
-			unlink(functors[i]);
-			functors.erase(functors.begin()+i);
-			--i;
+	{
+		std::lock_guard<std::recursive_mutex> lock(ref_signal_mutex());
+		const functor_vector* fv = functors.load();
+		if (!fv)
+			return;
+		functor_vector* new_fv = new functor_vector();
+		for (auto f : *fv) {
+			if (f->get_tacker() == c)
+				unlink(f);
+			else
+				new_fv->push_back(f);
+		}
+		if (new_fv->size() == fv->size()) {
+			delete new_fv;
+			return;
 		}
+		publish(new_fv);
 	}
+	wait_for_emissions();
 }
 
-
 void signal_base::disconnect_all()
 {
-	unsigned int i;
-	for (i=0; i<functors.size(); ++i)
-		unlink(functors[i]);
-	functors.clear();
+	{
+		std::lock_guard<std::recursive_mutex> lock(ref_signal_mutex());
+		const functor_vector* fv = functors.load();
+		if (!fv)
+			return;
+		for (auto f : *fv)
+			unlink(f);
+		publish(0);
+	}
+	wait_for_emissions();
 }
 
 functor_base::~functor_base() 
@@ -114,10 +262,12 @@ tacker::tacker(const tacker&)
 
 void tacker::tack(signal_base* s) const
 {
+	std::lock_guard<std::recursive_mutex> lock(ref_signal_mutex());
 	++signals[s];
 }
 void tacker::untack(signal_base* s) const
 {
+	std::lock_guard<std::recursive_mutex> lock(ref_signal_mutex());
 	// some bug somewhere (probably in the stereo_view_interactor) causes internal state corruption
 	// to the "signals" container on non-Windows platforms, the non-Windows branch does some additional
 	// diagnostics (although the bug is not being worked around)
@@ -142,17 +292,26 @@ void tacker::untack(signal_base* s) const
 
 void tacker::untack_all() const
 {
+	// the mutex is released between the disconnections from the individual signals
+	std::unique_lock<std::recursive_mutex> lock(ref_signal_mutex());
 	// some bug somewhere (probably in the stereo_view_interactor) causes
 	// this to be an infinite loop on non-Windows platforms
 	#ifdef _WIN32
-		while (!signals.empty())
-			signals.begin()->first->disconnect(this);
+		while (!signals.empty()) {
+			signal_base* s = signals.begin()->first;
+			lock.unlock();
+			s->disconnect(this);
+			lock.lock();
+		}
 	#else
 		// TODO: incredibly hacky workaraound, could break any time for any sort of non-trivial usage
 		//       of signals - fix underling issue ASAP!
 		unsigned num_signals = signals.size();
 		while (!signals.empty()) {
-			signals.begin()->first->disconnect(this);
+			signal_base* s = signals.begin()->first;
+			lock.unlock();
+			s->disconnect(this);
+			lock.lock();
 			if (signals.size() >= num_signals)
 				// unregistering failed, break loop and leave all remaining registered
 				// objects in limbo
@@ -0,0 +1,123 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace cgv {
+	namespace utils {
+
+mapped_file::mapped_file() : file(0), mapping(0), base(0), nr_bytes(0)
+{
+}
+
+mapped_file::mapped_file(const std::string& file_name) : file(0), mapping(0), base(0), nr_bytes(0)
+{
+	open(file_name);
+}
+
+mapped_file::~mapped_file()
+{
+	close();
+}
+
+#ifdef _WIN32
+
+bool mapped_file::open(const std::string& file_name)
+{
+	close();
+	HANDLE h = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (h == INVALID_HANDLE_VALUE)
+		return false;
+	LARGE_INTEGER fs;
+	if (!GetFileSizeEx(h, &fs) || fs.QuadPart == 0) {
+		CloseHandle(h);
+		return false;
+	}
+	HANDLE m = CreateFileMappingA(h, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m == NULL) {
+		CloseHandle(h);
+		return false;
+	}
+	void* ptr = MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+	if (ptr == NULL) {
+		CloseHandle(m);
+		CloseHandle(h);
+		return false;
+	}
+	file = h;
+	mapping = m;
+	base = (unsigned char*)ptr;
+	nr_bytes = (size_t)fs.QuadPart;
+	return true;
+}
+
+void mapped_file::close()
+{
+	if (base)
+		UnmapViewOfFile(base);
+	if (mapping)
+		CloseHandle((HANDLE)mapping);
+	if (file)
+		CloseHandle((HANDLE)file);
+	file = 0;
+	mapping = 0;
+	base = 0;
+	nr_bytes = 0;
+}
+
+void mapped_file::advise_sequential() const
+{
+	// sequential access was already requested with FILE_FLAG_SEQUENTIAL_SCAN in open
+}
+
+#else
+
+bool mapped_file::open(const std::string& file_name)
+{
+	close();
+	int fd = ::open(file_name.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+	void* ptr = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (ptr == MAP_FAILED) {
+		::close(fd);
+		return false;
+	}
+	file = (void*)(ptrdiff_t)fd;
+	base = (unsigned char*)ptr;
+	nr_bytes = (size_t)st.st_size;
+	return true;
+}
+
+void mapped_file::close()
+{
+	if (base) {
+		munmap(base, nr_bytes);
+		::close((int)(ptrdiff_t)file);
+	}
+	file = 0;
+	base = 0;
+	nr_bytes = 0;
+}
+
+void mapped_file::advise_sequential() const
+{
+	if (base)
+		madvise(base, nr_bytes, MADV_SEQUENTIAL);
+}
+
+#endif
+
+	}
+}
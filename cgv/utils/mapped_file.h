@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+
+/**
+* read-only memory mapping of a complete file.
+*
+* The file content is mapped into the address space of the process such that it can be accessed
+* through data() without copying it into user allocated memory. Pages are loaded on demand by the
+* operating system. All pointers returned by data() or ptr() become invalid when the mapping is closed.
+*
+* Example:
+*
+* mapped_file mf;
+* if (mf.open("points.bpc")) {
+*	const float* P = mf.ptr<float>(12);
+*	...
+* }
+*/
+class CGV_API mapped_file
+{
+	/// file handle (HANDLE on windows, file descriptor casted to pointer size on other systems)
+	void* file;
+	/// handle of file mapping object, only used on windows
+	void* mapping;
+	/// pointer to first byte of mapped file
+	unsigned char* base;
+	/// size of the mapped file in bytes
+	size_t nr_bytes;
+	/// copying of mappings is not supported
+	mapped_file(const mapped_file&) = delete;
+	mapped_file& operator = (const mapped_file&) = delete;
+public:
+	/// construct without mapping a file
+	mapped_file();
+	/// construct and map the given file, check success with is_open()
+	mapped_file(const std::string& file_name);
+	/// close mapping if still open
+	~mapped_file();
+	/// map the given file for read access; closes a previously opened mapping
+	bool open(const std::string& file_name);
+	/// unmap the file
+	void close();
+	/// return whether a file is mapped
+	bool is_open() const { return base != 0; }
+	/// return the size of the mapped file in bytes
+	size_t size() const { return nr_bytes; }
+	/// return pointer to first byte of the mapped file or 0 if no file is mapped
+	const unsigned char* data() const { return base; }
+	/// return typed pointer to the given byte offset or 0 if the offset plus one element of type T is outside of the mapped file
+	template <typename T>
+	const T* ptr(size_t offset) const { return (base && offset + sizeof(T) <= nr_bytes) ? reinterpret_cast<const T*>(base + offset) : 0; }
+	/// return whether count elements of type T starting at the given byte offset are inside of the mapped file
+	template <typename T>
+	bool contains(size_t offset, size_t count) const { return offset <= nr_bytes && count <= (nr_bytes - offset) / sizeof(T); }
+	/// tell the operating system that the mapped range will be traversed sequentially, which enables aggressive read ahead
+	void advise_sequential() const;
+};
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
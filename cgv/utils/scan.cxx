@@ -2,6 +2,7 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <charconv>
 
 namespace cgv {
 	namespace utils {
@@ -357,6 +358,21 @@ bool is_integer(const char* begin, const char* end, int& value)
 	// skip trailing spaces
 	while (begin < end && *begin == ' ')
 		++begin;
+	// fast path for decimal integers that fit into an int
+	const char* q = begin;
+	if (q < end && (*q == '+' || *q == '-'))
+		++q;
+	if (q < end && is_digit(*q)) {
+		int new_value;
+		std::from_chars_result r = std::from_chars(*begin == '+' ? begin + 1 : begin, end, new_value);
+		if (r.ptr == end) {
+			// decimal integers that do not fit into an int are rejected
+			if (r.ec != std::errc())
+				return false;
+			value = new_value;
+			return true;
+		}
+	}
 	// check for hexadecimal case
 	if (end-begin>2 && begin[0] == '0' && to_upper(begin[1]) == 'X') {
 		int new_value = 0, b = 1;
@@ -415,6 +431,18 @@ bool is_double(const char* begin, const char* end, double& value)
 	const char* p = begin;
 	while (p < end && *p == ' ')
 		++p;
+	// fast path for numbers in decimal or exponential notation, all other cases are validated below
+	const char* q = p;
+	if (q < end && (*q == '+' || *q == '-'))
+		++q;
+	if (q < end && (is_digit(*q) || *q == '.')) {
+		double new_value;
+		std::from_chars_result r = std::from_chars(*p == '+' ? p + 1 : p, end, new_value);
+		if (r.ec == std::errc() && r.ptr == end) {
+			value = new_value;
+			return true;
+		}
+	}
 	for (; p<end; ++p) {
 		switch (*p) {
 		case '0' :
@@ -462,6 +490,38 @@ bool is_double(const std::string& s, double& value)
 	return is_double(&s[0], &s[0]+s.size(), value);
 }
 
+template <typename T>
+bool scan_number(const char*& p, const char* end, T& value)
+{
+	const char* q = p;
+	while (q < end && (*q == ' ' || *q == '\t'))
+		++q;
+	if (q < end && *q == '+') {
+		if (++q == end || *q == '-')
+			return false;
+	}
+	std::from_chars_result r = std::from_chars(q, end, value);
+	if (r.ec != std::errc())
+		return false;
+	p = r.ptr;
+	return true;
+}
+
+bool scan_integer(const char*& p, const char* end, int& value)
+{
+	return scan_number(p, end, value);
+}
+
+bool scan_double(const char*& p, const char* end, double& value)
+{
+	return scan_number(p, end, value);
+}
+
+bool scan_float(const char*& p, const char* end, float& value)
+{
+	return scan_number(p, end, value);
+}
+
 
 bool is_year(const char* begin, const char* end, unsigned short& year, bool short_allowed)
 {
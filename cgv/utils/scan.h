@@ -92,6 +92,14 @@ extern CGV_API bool is_integer(const std::string& s, int& value);
 extern CGV_API bool is_double(const char* begin, const char* end, double& value);
 /// check if the passed string defines a double value. If yes, store the value in the passed reference.
 extern CGV_API bool is_double(const std::string& s, double& value);
+/** skip spaces and tabs, read an integer from the text range (p,end( and advance p behind it. Other
+    than is_integer() the number need not extend to the end of the range such that consecutive numbers
+	can be read without tokenizing. Returns false and leaves p unchanged if no integer is found. */
+extern CGV_API bool scan_integer(const char*& p, const char* end, int& value);
+/// skip spaces and tabs, read a double from the text range (p,end( and advance p behind it; see scan_integer()
+extern CGV_API bool scan_double(const char*& p, const char* end, double& value);
+/// skip spaces and tabs, read a float from the text range (p,end( and advance p behind it; see scan_integer()
+extern CGV_API bool scan_float(const char*& p, const char* end, float& value);
 /// check and extract year from string token [\c begin, \c end]
 extern CGV_API bool is_year(const char* begin, const char* end, unsigned short& year, bool short_allowed = true);
 /// check and extract year from string \c s
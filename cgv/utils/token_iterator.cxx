@@ -0,0 +1,131 @@
+#include "token_iterator.h"
+
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CGV_UTILS_USE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace cgv {
+	namespace utils {
+
+#ifdef CGV_UTILS_USE_SSE2
+/// return index of lowest set bit of non zero mask
+static inline unsigned first_bit(unsigned mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return (unsigned)index;
+#else
+	return (unsigned)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+delimiter_set::delimiter_set(const std::string& chars)
+{
+	memset(is_delim, 0, sizeof(is_delim));
+	nr_delims = 0;
+	for (char c : chars) {
+		if (is_delim[(unsigned char)c])
+			continue;
+		is_delim[(unsigned char)c] = true;
+		if (nr_delims < 8)
+			delims[nr_delims] = c;
+		++nr_delims;
+	}
+}
+
+const char* delimiter_set::find(const char* begin, const char* end) const
+{
+	const char* p = begin;
+#ifdef CGV_UTILS_USE_SSE2
+	// compare 16 characters at once against each delimiter
+	if (nr_delims > 0 && nr_delims <= 8) {
+		__m128i d[8];
+		for (unsigned i = 0; i < nr_delims; ++i)
+			d[i] = _mm_set1_epi8(delims[i]);
+		for (; end - p >= 16; p += 16) {
+			__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			__m128i match = _mm_cmpeq_epi8(chunk, d[0]);
+			for (unsigned i = 1; i < nr_delims; ++i)
+				match = _mm_or_si128(match, _mm_cmpeq_epi8(chunk, d[i]));
+			unsigned mask = (unsigned)_mm_movemask_epi8(match);
+			if (mask != 0)
+				return p + first_bit(mask);
+		}
+	}
+#endif
+	while (p < end && !contains(*p))
+		++p;
+	return p;
+}
+
+const char* delimiter_set::skip(const char* begin, const char* end) const
+{
+	// delimiter sequences are typically short such that a scalar loop is sufficient
+	while (begin < end && contains(*begin))
+		++begin;
+	return begin;
+}
+
+line_iterator::line_iterator(const char* begin, const char* _end) : pos(begin), end(_end)
+{
+}
+
+line_iterator::line_iterator(const token& text) : pos(text.begin), end(text.end)
+{
+}
+
+line_iterator::line_iterator(const std::string& text) : pos(text.data()), end(text.data() + text.size())
+{
+}
+
+bool line_iterator::next(token& line)
+{
+	if (pos >= end)
+		return false;
+	const char* nl = static_cast<const char*>(memchr(pos, '\n', end - pos));
+	line.begin = pos;
+	if (nl) {
+		line.end = nl;
+		pos = nl + 1;
+	}
+	else
+		line.end = pos = end;
+	if (line.end > line.begin && line.end[-1] == '\r')
+		--line.end;
+	return true;
+}
+
+token_iterator::token_iterator(const char* begin, const char* _end, const delimiter_set& _delims) : pos(begin), end(_end), delims(_delims)
+{
+}
+
+token_iterator::token_iterator(const token& text, const delimiter_set& _delims) : pos(text.begin), end(text.end), delims(_delims)
+{
+}
+
+bool token_iterator::next(token& tok)
+{
+	pos = delims.skip(pos, end);
+	if (pos == end)
+		return false;
+	tok.begin = pos;
+	tok.end = pos = delims.find(pos, end);
+	return true;
+}
+
+const delimiter_set& get_blank_delimiters()
+{
+	static const delimiter_set blanks(" \t");
+	return blanks;
+}
+
+	}
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+
+#include "token.h"
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+
+/** set of up to 256 delimiter characters that supports fast classification of characters and
+    a vectorized search for the first delimiter in a text range. */
+class CGV_API delimiter_set
+{
+protected:
+	/// table of flags for all characters
+	bool is_delim[256];
+	/// delimiters used in the vectorized search if there are not more than eight
+	char delims[8];
+	/// number of delimiters
+	unsigned nr_delims;
+public:
+	/// construct from the characters of the given string
+	delimiter_set(const std::string& chars = " \t");
+	/// check whether the given character is a delimiter
+	bool contains(char c) const { return is_delim[(unsigned char)c]; }
+	/// return pointer to first delimiter in (begin,end( or end if none is found
+	const char* find(const char* begin, const char* end) const;
+	/// return pointer to first non delimiter in (begin,end( or end if none is found
+	const char* skip(const char* begin, const char* end) const;
+};
+
+/** iterates the lines of a text range without allocating memory. Lines are separated by '\n'
+    and a '\r' in front of it is removed from the line. An empty range has no lines.
+\code
+line_iterator li(content);
+token line;
+while (li.next(line))
+	process(line);
+\endcode */
+class CGV_API line_iterator
+{
+protected:
+	/// begin of the not yet iterated part of the text
+	const char* pos;
+	/// end of the text
+	const char* end;
+public:
+	/// construct from text range
+	line_iterator(const char* begin, const char* end);
+	/// construct from text range given as token
+	line_iterator(const token& text);
+	/// construct from string that must not be changed during iteration
+	line_iterator(const std::string& text);
+	/// extract the next line and return false if the text is exhausted
+	bool next(token& line);
+	/// return the begin of the not yet iterated part of the text
+	const char* get_position() const { return pos; }
+};
+
+/** iterates the tokens of a text range that are separated by sequences of delimiter characters
+    without allocating memory. It is a light weight alternative to the tokenizer for the parsing of
+	large files that only need white space separation. */
+class CGV_API token_iterator
+{
+protected:
+	/// begin of the not yet iterated part of the text
+	const char* pos;
+	/// end of the text
+	const char* end;
+	/// delimiters separating the tokens
+	const delimiter_set& delims;
+public:
+	/// construct from text range and delimiters that need to stay valid during iteration
+	token_iterator(const char* begin, const char* end, const delimiter_set& delims);
+	/// construct from text range given as token and delimiters that need to stay valid during iteration
+	token_iterator(const token& text, const delimiter_set& delims);
+	/// extract the next token and return false if the text is exhausted
+	bool next(token& tok);
+	/// return the begin of the not yet iterated part of the text
+	const char* get_position() const { return pos; }
+};
+
+/// return delimiter set of space and tab characters
+extern CGV_API const delimiter_set& get_blank_delimiters();
+
+	}
+}
+
+#include <cgv/config/lib_end.h>
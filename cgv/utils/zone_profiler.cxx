@@ -0,0 +1,269 @@
+#include "zone_profiler.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cgv {
+	namespace utils {
+
+/// block of zone events that is filled by one thread and read by the export
+struct zone_event_block
+{
+	/// number of events per block
+	static const unsigned capacity = 4096;
+	/// storage of events
+	zone_event events[capacity];
+	/// number of valid events that is published with release semantics after an event has been written
+	std::atomic<unsigned> size;
+	/// next block of the same thread
+	std::atomic<zone_event_block*> next;
+	///
+	zone_event_block() : size(0), next(nullptr) {}
+};
+
+/// event buffer of a thread that lives until the end of the program such that exited threads remain in the trace
+struct zone_thread_buffer
+{
+	/// index used as thread id in the trace
+	unsigned index;
+	/// name of thread, protected by the registry mutex
+	std::string name;
+	/// first block that has not been cleared, only accessed under the registry mutex
+	zone_event_block* first;
+	/// block filled by the thread
+	std::atomic<zone_event_block*> last;
+	/// number of events of the first block that have been cleared
+	unsigned nr_cleared;
+	/// current nesting depth, only accessed by the thread
+	uint32_t depth;
+	///
+	zone_thread_buffer(unsigned _index) : index(_index), first(new zone_event_block()), last(first), nr_cleared(0), depth(0) {}
+	///
+	~zone_thread_buffer()
+	{
+		while (first) {
+			zone_event_block* next = first->next.load();
+			delete first;
+			first = next;
+		}
+	}
+	/// append event without locking, called only by the owning thread
+	void append(const zone_event& e)
+	{
+		zone_event_block* block = last.load(std::memory_order_relaxed);
+		unsigned size = block->size.load(std::memory_order_relaxed);
+		if (size == zone_event_block::capacity) {
+			zone_event_block* new_block = new zone_event_block();
+			block->next.store(new_block, std::memory_order_release);
+			last.store(new_block, std::memory_order_release);
+			block = new_block;
+			size = 0;
+		}
+		block->events[size] = e;
+		block->size.store(size + 1, std::memory_order_release);
+	}
+};
+
+/// registry of all thread buffers
+struct zone_registry
+{
+	std::mutex mtx;
+	std::vector<std::unique_ptr<zone_thread_buffer> > buffers;
+	std::atomic<bool> enabled;
+	std::chrono::steady_clock::time_point start;
+	zone_registry() : enabled(false), start(std::chrono::steady_clock::now()) {}
+};
+
+static zone_registry& ref_zone_registry()
+{
+	static zone_registry registry;
+	return registry;
+}
+
+/// buffer of calling thread or null if the thread did not record a zone yet
+static thread_local zone_thread_buffer* thread_buffer = nullptr;
+/// name of calling thread that is kept until its buffer is allocated
+static thread_local std::string thread_name;
+
+/// return buffer of calling thread, which is allocated and registered on first use such that threads that do not record zones need no buffer
+static zone_thread_buffer& ref_thread_buffer()
+{
+	if (!thread_buffer) {
+		zone_registry& R = ref_zone_registry();
+		std::lock_guard<std::mutex> lock(R.mtx);
+		R.buffers.push_back(std::unique_ptr<zone_thread_buffer>(new zone_thread_buffer((unsigned)R.buffers.size())));
+		thread_buffer = R.buffers.back().get();
+		thread_buffer->name = thread_name;
+	}
+	return *thread_buffer;
+}
+
+void enable_zone_profiling(bool enable)
+{
+	ref_zone_registry().enabled.store(enable, std::memory_order_relaxed);
+}
+
+bool is_zone_profiling_enabled()
+{
+	return ref_zone_registry().enabled.load(std::memory_order_relaxed);
+}
+
+int64_t get_zone_profiler_time()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - ref_zone_registry().start).count();
+}
+
+void set_zone_profiling_thread_name(const std::string& name)
+{
+	thread_name = name;
+	if (thread_buffer) {
+		std::lock_guard<std::mutex> lock(ref_zone_registry().mtx);
+		thread_buffer->name = name;
+	}
+}
+
+size_t get_nr_zone_profiling_threads()
+{
+	zone_registry& R = ref_zone_registry();
+	std::lock_guard<std::mutex> lock(R.mtx);
+	return R.buffers.size();
+}
+
+void record_zone(const char* name, const char* category, int64_t begin_ns, int64_t end_ns, uint32_t depth)
+{
+	zone_event e = { name, category, begin_ns, end_ns, depth };
+	ref_thread_buffer().append(e);
+}
+
+/// call f for each event that has not been cleared, must be called under the registry mutex
+template <typename F>
+static void for_each_zone_event(zone_thread_buffer& buffer, F f)
+{
+	unsigned i = buffer.nr_cleared;
+	for (zone_event_block* block = buffer.first; block; block = block->next.load(std::memory_order_acquire), i = 0) {
+		unsigned size = block->size.load(std::memory_order_acquire);
+		for (; i < size; ++i)
+			f(block->events[i]);
+	}
+}
+
+void clear_zone_events()
+{
+	zone_registry& R = ref_zone_registry();
+	std::lock_guard<std::mutex> lock(R.mtx);
+	for (auto& buffer : R.buffers) {
+		// the owning thread only writes to the last block such that all previous blocks can be released
+		zone_event_block* last = buffer->last.load(std::memory_order_acquire);
+		while (buffer->first != last) {
+			zone_event_block* next = buffer->first->next.load(std::memory_order_acquire);
+			delete buffer->first;
+			buffer->first = next;
+		}
+		buffer->nr_cleared = last->size.load(std::memory_order_acquire);
+	}
+}
+
+size_t get_nr_zone_events()
+{
+	zone_registry& R = ref_zone_registry();
+	std::lock_guard<std::mutex> lock(R.mtx);
+	size_t n = 0;
+	for (auto& buffer : R.buffers)
+		for_each_zone_event(*buffer, [&n](const zone_event&) { ++n; });
+	return n;
+}
+
+/// write string as json string literal
+static void write_json_string(std::ostream& os, const char* s)
+{
+	static const char* hex = "0123456789abcdef";
+	os << '"';
+	for (; *s; ++s) {
+		unsigned char c = (unsigned char)*s;
+		switch (c) {
+		case '"': os << "\\\""; break;
+		case '\\': os << "\\\\"; break;
+		case '\n': os << "\\n"; break;
+		case '\t': os << "\\t"; break;
+		default:
+			if (c < 0x20)
+				os << "\\u00" << hex[c >> 4] << hex[c & 15];
+			else
+				os << (char)c;
+		}
+	}
+	os << '"';
+}
+
+/// write time given in nanoseconds in microseconds as expected by the trace format
+static void write_microseconds(std::ostream& os, int64_t ns)
+{
+	os << ns / 1000 << '.';
+	int64_t frac = ns % 1000;
+	os << (char)('0' + frac / 100) << (char)('0' + frac / 10 % 10) << (char)('0' + frac % 10);
+}
+
+void write_chrome_trace(std::ostream& os)
+{
+	zone_registry& R = ref_zone_registry();
+	std::lock_guard<std::mutex> lock(R.mtx);
+	os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	for (auto& buffer : R.buffers) {
+		unsigned tid = buffer->index;
+		if (!buffer->name.empty()) {
+			os << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid << ",\"args\":{\"name\":";
+			write_json_string(os, buffer->name.c_str());
+			os << "}}";
+			first = false;
+		}
+		for_each_zone_event(*buffer, [&](const zone_event& e) {
+			os << (first ? "\n" : ",\n") << "{\"name\":";
+			write_json_string(os, e.name);
+			os << ",\"cat\":";
+			write_json_string(os, e.category);
+			os << ",\"ph\":\"X\",\"ts\":";
+			write_microseconds(os, e.begin_ns);
+			os << ",\"dur\":";
+			write_microseconds(os, e.end_ns - e.begin_ns);
+			os << ",\"pid\":0,\"tid\":" << tid << ",\"args\":{\"depth\":" << e.depth << "}}";
+			first = false;
+		});
+	}
+	os << "\n]}\n";
+}
+
+bool write_chrome_trace(const std::string& file_name)
+{
+	std::ofstream os(file_name.c_str());
+	if (os.fail()) {
+		std::cerr << "could not open trace file " << file_name << std::endl;
+		return false;
+	}
+	write_chrome_trace(os);
+	return !os.fail();
+}
+
+scoped_zone::scoped_zone(const char* _name, const char* _category) : name(_name), category(_category), begin_ns(-1), depth_ptr(0)
+{
+	if (!is_zone_profiling_enabled())
+		return;
+	depth_ptr = &ref_thread_buffer().depth;
+	++*depth_ptr;
+	begin_ns = get_zone_profiler_time();
+}
+
+scoped_zone::~scoped_zone()
+{
+	if (begin_ns < 0)
+		return;
+	int64_t end_ns = get_zone_profiler_time();
+	record_zone(name, category, begin_ns, end_ns, --*depth_ptr);
+}
+
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <string>
+#include <iostream>
+#include <cstdint>
+
+#include "lib_begin.h"
+
+namespace cgv {
+	namespace utils {
+
+/// zone recorded by the zone profiler
+struct zone_event
+{
+	/// name of zone
+	const char* name;
+	/// category of zone
+	const char* category;
+	/// begin and end time in nanoseconds since the first use of the profiler
+	int64_t begin_ns, end_ns;
+	/// nesting depth of zone on its thread
+	uint32_t depth;
+};
+
+/// enable or disable recording of zones, which only affects zones that are entered afterwards
+extern CGV_API void enable_zone_profiling(bool enable = true);
+/// check whether zones are recorded
+extern CGV_API bool is_zone_profiling_enabled();
+/// return current time in nanoseconds since the first use of the profiler
+extern CGV_API int64_t get_zone_profiler_time();
+/// set the name of the calling thread as shown in the trace, where the name is copied and no event buffer is allocated
+extern CGV_API void set_zone_profiling_thread_name(const std::string& name);
+/// return the number of threads that allocated an event buffer by recording a zone
+extern CGV_API size_t get_nr_zone_profiling_threads();
+/// record a zone on the calling thread, which is done by scoped_zone
+extern CGV_API void record_zone(const char* name, const char* category, int64_t begin_ns, int64_t end_ns, uint32_t depth);
+/// discard all recorded zones and release the buffers filled so far
+extern CGV_API void clear_zone_events();
+/// return the number of recorded zones over all threads
+extern CGV_API size_t get_nr_zone_events();
+/// write all recorded zones as json object in the Chrome trace event format
+extern CGV_API void write_chrome_trace(std::ostream& os);
+/// write all recorded zones to a json file in the Chrome trace event format and return whether this succeeded
+extern CGV_API bool write_chrome_trace(const std::string& file_name);
+
+/** a zone is a named time interval recorded on one thread. Zones nest and are stored in per thread
+    buffers that are filled without locking such that zones can be placed in multithreaded code paths.
+	When profiling is disabled, which is the default, a zone costs one check of an atomic flag.
+	The recorded zones can be exported in the Chrome trace event format and be inspected with
+	chrome://tracing or https://ui.perfetto.dev.
+
+	Zone names and categories are not copied and must be string literals or otherwise outlive the
+	export. A zone is typically placed with the CGV_PROFILE_ZONE macro:
+\code
+enable_zone_profiling();
+{
+	CGV_PROFILE_ZONE("load");
+	for (auto& f : files) {
+		CGV_PROFILE_ZONE("parse file");
+		parse(f);
+	}
+}
+write_chrome_trace("trace.json");
+\endcode
+
+	A scoped_zone records a zone from construction to destruction if zone profiling is enabled at construction. */
+class CGV_API scoped_zone
+{
+protected:
+	/// name of zone
+	const char* name;
+	/// category of zone
+	const char* category;
+	/// begin time or -1 if zone is not recorded
+	int64_t begin_ns;
+	/// pointer to nesting depth of calling thread
+	uint32_t* depth_ptr;
+	/// zones cannot be copied
+	scoped_zone(const scoped_zone&) = delete;
+	scoped_zone& operator = (const scoped_zone&) = delete;
+public:
+	/// enter zone with given name and category, which need to outlive the export
+	scoped_zone(const char* _name, const char* _category = "cgv");
+	/// leave zone and record it
+	~scoped_zone();
+};
+
+	}
+}
+
+#define CGV_PROFILE_ZONE_CONCAT_IMPL(A, B) A##B
+#define CGV_PROFILE_ZONE_CONCAT(A, B) CGV_PROFILE_ZONE_CONCAT_IMPL(A, B)
+/// place a zone with given name that extends to the end of the current scope
+#define CGV_PROFILE_ZONE(NAME) cgv::utils::scoped_zone CGV_PROFILE_ZONE_CONCAT(cgv_profile_zone_, __LINE__)(NAME)
+/// place a zone with given name and category that extends to the end of the current scope
+#define CGV_PROFILE_ZONE_CAT(NAME, CATEGORY) cgv::utils::scoped_zone CGV_PROFILE_ZONE_CONCAT(cgv_profile_zone_, __LINE__)(NAME, CATEGORY)
+
+#include <cgv/config/lib_end.h>
@@ -70,6 +70,10 @@ namespace cgv {
 				std::cerr << "ICP::reg_icp: source or target cloud not set!\n";
 				return;
 			}
+			if (sourceCloud->get_nr_points() == 0) {
+				std::cerr << "ICP::reg_icp: source cloud is empty!\n";
+				return;
+			}
 			Pnt source_center;
 			Pnt target_center;
 			source_center.zeros();
@@ -117,6 +121,10 @@ namespace cgv {
 			Mat rotation_update_mat = rotation_mat;
 			Dir translation_update_vec = translation_vec;
 
+			// closest point queries of all samples are answered in parallel in each iteration
+			utility::WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+			std::vector<Idx> closest(S.get_nr_points());
+
 			for (int iter = 0; iter < maxIterations; iter++)
 			{
 				// update S
@@ -126,11 +134,12 @@ namespace cgv {
 				get_center_point(S, source_center);
 			
 				fA.zeros();
+				/// get the closest points to S from the target point cloud
+				tree->find_closest(&S.pnt(0), Cnt(S.get_nr_points()), &closest[0], pool);
 				for (int i = 0; i < S.get_nr_points(); i++)
 				{
-					/// get the closest point to p from the target point cloud
 					Pnt p = S.pnt(i);
-					Pnt q = targetCloud->pnt(tree->find_closest(p));
+					Pnt q = targetCloud->pnt(closest[i]);
 					Q.pnt(i) = q; 
 					fA += Mat(q - target_center, p - source_center);
 				}
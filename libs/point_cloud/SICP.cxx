@@ -216,10 +216,13 @@ namespace cgv {
 			vector<Pnt> closest_points(sourceCloud->get_nr_points());
 			vector<Pnt> Z(sourceCloud->get_nr_points(), Pnt(0, 0, 0));
 			vector<Pnt> lagrage_multipliers(sourceCloud->get_nr_points(), Pnt(0, 0, 0));
+			vector<Idx> closest(sourceCloud->get_nr_points());
+			utility::WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
 
 			for (int i = 0; i < parameters.max_runs; ++i) {
+				neighbor_tree.find_closest(source_points.data(), Cnt(source_points.size()), closest.data(), pool);
 				for (int i = 0; i < sourceCloud->get_nr_points(); ++i) {
-					closest_points[i] = targetCloud->pnt(neighbor_tree.find_closest(source_points[i]));
+					closest_points[i] = targetCloud->pnt(closest[i]);
 				}
 
 				float mu = parameters.mu;
@@ -300,10 +303,13 @@ namespace cgv {
 			vector<Dir> closest_points_normal(sourceCloud->get_nr_points());
 			vector<float> Z(sourceCloud->get_nr_points(), 0);
 			vector<float> lagrage_multipliers(sourceCloud->get_nr_points(), 0);
+			vector<Idx> closest(sourceCloud->get_nr_points());
+			utility::WorkerPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1);
 
 			for (int i = 0; i < parameters.max_runs; ++i) {
+				neighbor_tree.find_closest(source_points.data(), Cnt(source_points.size()), closest.data(), pool);
 				for (int i = 0; i < sourceCloud->get_nr_points(); ++i) {
-					int c = neighbor_tree.find_closest(source_points[i]);
+					int c = closest[i];
 					closest_points_position[i] = targetCloud->pnt(c);
 					closest_points_normal[i] = targetCloud->nml(c);
 				}
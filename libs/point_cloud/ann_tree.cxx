@@ -95,8 +95,8 @@ void ann_tree::build(const point_cloud& _pc, const std::vector<Idx>& component_i
 
 void ann_tree::extract_neighbors(Idx i, Idx k, std::vector<Idx>& N) const
 {
-	static std::vector<float> dists;
-	static std::vector<Idx> tmp;
+	thread_local std::vector<float> dists;
+	thread_local std::vector<Idx> tmp;
 	ann_struct* ann = static_cast<ann_struct*>(ann_impl);
 	if (!ann) {
 		std::cerr << "no ann_tree built" << std::endl;
@@ -131,9 +131,95 @@ void ann_tree::find_closest_points(const Pnt& p, Idx k, std::vector<const Pnt*>&
 	knn.resize(k);
 	ANNdistArray dist_array = new ANNdist[k];
 	ANNidxArray index_array = new ANNidx[k];
-	ann->ps->annkSearch(const_cast<ANNpoint>(&p[0]), 1, (ANNidxArray)&index_array, dist_array);
+	ann->ps->annkSearch(const_cast<ANNpoint>(&p[0]), k, index_array, dist_array);
 	for (Idx i = 0; i < k; ++i)
 		knn[i] = reinterpret_cast<const Pnt*>(ann->ps->thePoints()[index_array[i]]);
 	delete[] dist_array;
 	delete[] index_array;
-}
\ No newline at end of file
+}
+
+ann_tree::Cnt ann_tree::find_points_in_radius(const Pnt& p, Crd radius, std::vector<Idx>& indices, std::vector<Crd>* sqr_dists) const
+{
+	thread_local std::vector<ANNdist> dists;
+	ann_struct* ann = static_cast<ann_struct*>(ann_impl);
+	indices.clear();
+	if (sqr_dists)
+		sqr_dists->clear();
+	if (!ann) {
+		std::cerr << "no ann_tree built" << std::endl;
+		return 0;
+	}
+	// first count points in range and then query them as k nearest neighbors within the radius
+	ANNpoint q = const_cast<ANNpoint>(&p[0]);
+	ANNdist sqr_radius = radius * radius;
+	int n = ann->ps->annkFRSearch(q, sqr_radius);
+	if (n == 0)
+		return 0;
+	indices.resize(n);
+	dists.resize(n);
+	ann->ps->annkFRSearch(q, sqr_radius, n, (ANNidxArray)&indices[0], &dists[0]);
+	if (sqr_dists)
+		sqr_dists->assign(dists.begin(), dists.end());
+	return Cnt(n);
+}
+
+void ann_tree::find_closest(const Pnt* queries, Cnt n, Idx* closest, cgv::pointcloud::utility::WorkerPool& pool) const
+{
+	ann_struct* ann = static_cast<ann_struct*>(ann_impl);
+	if (!ann) {
+		std::cerr << "no ann_tree built" << std::endl;
+		return;
+	}
+	cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, 1024, [ann, queries, closest](int64_t first, int64_t last) {
+		ANNdist dist;
+		for (int64_t i = first; i < last; ++i)
+			ann->ps->annkSearch(const_cast<ANNpoint>(&queries[i][0]), 1, (ANNidxArray)&closest[i], &dist);
+	});
+}
+
+void ann_tree::find_closest_points(const Pnt* queries, Cnt n, Idx k, Idx* knn_indices, Crd* knn_sqr_dists, cgv::pointcloud::utility::WorkerPool& pool) const
+{
+	ann_struct* ann = static_cast<ann_struct*>(ann_impl);
+	if (!ann) {
+		std::cerr << "no ann_tree built" << std::endl;
+		return;
+	}
+	cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, 1024, [ann, queries, k, knn_indices, knn_sqr_dists](int64_t first, int64_t last) {
+		thread_local std::vector<ANNdist> dists;
+		dists.resize(k);
+		for (int64_t i = first; i < last; ++i) {
+			ANNdistArray dist_array = knn_sqr_dists ? knn_sqr_dists + i * k : &dists[0];
+			ann->ps->annkSearch(const_cast<ANNpoint>(&queries[i][0]), k, (ANNidxArray)(knn_indices + i * k), dist_array);
+		}
+	});
+}
+
+void ann_tree::find_points_in_radius(const Pnt* queries, Cnt n, Crd radius, std::vector<size_t>& offsets, std::vector<Idx>& indices, cgv::pointcloud::utility::WorkerPool& pool) const
+{
+	offsets.assign(size_t(n) + 1, 0);
+	indices.clear();
+	ann_struct* ann = static_cast<ann_struct*>(ann_impl);
+	if (!ann) {
+		std::cerr << "no ann_tree built" << std::endl;
+		return;
+	}
+	// count points in range per query, compute offsets with a prefix sum and let each query fill its own range
+	ANNdist sqr_radius = radius * radius;
+	cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, 1024, [ann, queries, sqr_radius, &offsets](int64_t first, int64_t last) {
+		for (int64_t i = first; i < last; ++i)
+			offsets[i + 1] = ann->ps->annkFRSearch(const_cast<ANNpoint>(&queries[i][0]), sqr_radius);
+	});
+	for (Cnt i = 0; i < n; ++i)
+		offsets[i + 1] += offsets[i];
+	indices.resize(offsets[n]);
+	cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, 1024, [ann, queries, sqr_radius, &offsets, &indices](int64_t first, int64_t last) {
+		thread_local std::vector<ANNdist> dists;
+		for (int64_t i = first; i < last; ++i) {
+			int c = int(offsets[i + 1] - offsets[i]);
+			if (c == 0)
+				continue;
+			dists.resize(c);
+			ann->ps->annkFRSearch(const_cast<ANNpoint>(&queries[i][0]), sqr_radius, c, (ANNidxArray)&indices[offsets[i]], &dists[0]);
+		}
+	});
+}
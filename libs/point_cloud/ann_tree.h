@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "point_cloud.h"
+#include "concurrency.h"
 
 #include "lib_begin.h"
 
@@ -31,6 +32,17 @@ public:
 	Idx find_closest(const Pnt& p) const;
 	/// knn query that returns pointers to points
 	void find_closest_points(const Pnt& p, Idx k, std::vector<const Pnt*>& knn) const;
+	/// find all points within the given radius around p and return their number, indices refer to the points in the order they were passed to build
+	Cnt find_points_in_radius(const Pnt& p, Crd radius, std::vector<Idx>& indices, std::vector<Crd>* sqr_dists = 0) const;
+	/**@name batched queries that distribute the query points over the threads of a pool*/
+	//@{
+	/// find closest point for each of the n query points and store its index in closest[i]
+	void find_closest(const Pnt* queries, Cnt n, Idx* closest, cgv::pointcloud::utility::WorkerPool& pool) const;
+	/// find k nearest neighbors of each of the n query points and store indices and optionally squared distances with stride k in the preallocated arrays
+	void find_closest_points(const Pnt* queries, Cnt n, Idx k, Idx* knn_indices, Crd* knn_sqr_dists, cgv::pointcloud::utility::WorkerPool& pool) const;
+	/// find all points within radius of each of the n query points, where the result of query i is indices[offsets[i]] to indices[offsets[i+1]-1]
+	void find_points_in_radius(const Pnt* queries, Cnt n, Crd radius, std::vector<size_t>& offsets, std::vector<Idx>& indices, cgv::pointcloud::utility::WorkerPool& pool) const;
+	//@}
 };
 
 #include <cgv/config/lib_end.h>
\ No newline at end of file
@@ -64,6 +64,7 @@ namespace utility {
 		if (ptask) {
 			// wait and clear task afterwards
 			{
+				CGV_PROFILE_ZONE_CAT("WorkerPool wait for workers", "point_cloud");
 				// there should only be the thread who called run() in here
 				while (ptask->remaining.load(std::memory_order_relaxed) > 0) {
 					std::this_thread::yield();
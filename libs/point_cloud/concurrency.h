@@ -6,6 +6,10 @@
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <cgv/utils/zone_profiler.h>
 
 #include "lib_begin.h"
 
@@ -156,6 +160,21 @@ class CGV_API SenseReversingBarrier
 	};
 
 
+	/// split the index range [begin, end) into chunks of at most chunk_size indices and process them with func(first, last) on all threads of the pool
+	template <typename F>
+	void parallel_for_chunks(WorkerPool& pool, int64_t begin, int64_t end, int64_t chunk_size, F func)
+	{
+		struct Chunk {
+			int64_t first;
+			int64_t last;
+		};
+		TaskPool<Chunk> tasks;
+		for (int64_t first = begin; first < end; first += chunk_size)
+			tasks.pool.push_back({ first, std::min(first + chunk_size, end) });
+		tasks.func = [&func](Chunk* chunk) { func(chunk->first, chunk->last); };
+		pool.run([&tasks](int thread_id) { tasks(); });
+	}
+
 	// template definitions
 	template <typename F>
 	void WorkerPool::run(F func)
@@ -184,6 +203,8 @@ class CGV_API SenseReversingBarrier
 	{
 		// individual jobs
 		bool clear_task = !is_pool_member;
+		if (is_pool_member)
+			cgv::utils::set_zone_profiling_thread_name("WorkerPool thread " + std::to_string(thread_id));
 
 		do {
 			// std::printf("%d arrived\n", thread_id);
@@ -197,10 +218,14 @@ class CGV_API SenseReversingBarrier
 
 			// run any existing task
 			if (ptask) {
-				ptask->task(thread_id);
+				{
+					CGV_PROFILE_ZONE_CAT("WorkerPool task", "point_cloud");
+					ptask->task(thread_id);
+				}
 				int rem = ptask->remaining.fetch_sub(1);
 
 				if (clear_task) {
+					CGV_PROFILE_ZONE_CAT("WorkerPool wait for workers", "point_cloud");
 					// there should only be the thread who called run() in here
 					while (ptask->remaining.load(std::memory_order_relaxed) > 0) {
 						std::this_thread::yield();
@@ -237,39 +237,47 @@ void gl_point_cloud_drawable::draw_points(context& ctx)
 	GLint offset = GLint(show_point_begin / show_point_step);
 
 	if (sort_points && ensure_view_pointer()) {
-		struct sort_pred {
-			const point_cloud& pc;
-			const Pnt& view_dir;
-			bool operator () (GLuint i, GLuint j) const {
-				return dot(pc.pnt(i), view_dir) > dot(pc.pnt(j), view_dir);
-			}
-			sort_pred(const point_cloud& _pc, const Pnt& _view_dir) : pc(_pc), view_dir(_view_dir) {}
-		};
-		Pnt view_dir = view_ptr->get_view_dir();
-		std::vector<GLuint> indices;
+		// describe current selection of points and only rebuild the index list if it changed
+		std::vector<size_t> selection;
+		selection.push_back(pc.get_nr_points());
 		if (pc.has_components() && use_these_component_colors) {
-			unsigned nr = 0;
 			for (unsigned ci = 0; ci < pc.get_nr_components(); ++ci) {
 				if ((*use_these_component_colors)[ci][3] > 0.0f) {
-					unsigned off = unsigned(pc.components[ci].index_of_first_point);
-					for (unsigned i = 0; i < pc.components[ci].nr_points; ++i)
-						indices.push_back((GLuint)(off + i));
+					selection.push_back(pc.components[ci].index_of_first_point);
+					selection.push_back(pc.components[ci].nr_points);
 				}
 			}
 		}
 		else {
-			indices.resize(n);
-			size_t i;
-			for (i = 0; i < indices.size(); ++i)
-				indices[i] = (GLuint)(show_point_step*i) + offset;
+			selection.push_back(n);
+			selection.push_back(offset);
+			selection.push_back(show_point_step);
+		}
+		bool reuse_order = selection == sorted_selection;
+		if (!reuse_order) {
+			sorted_selection = selection;
+			sorted_indices.clear();
+			if (pc.has_components() && use_these_component_colors) {
+				for (size_t i = 1; i < selection.size(); i += 2)
+					for (size_t j = 0; j < selection[i + 1]; ++j)
+						sorted_indices.push_back(uint32_t(selection[i] + j));
+			}
+			else {
+				sorted_indices.resize(n);
+				for (size_t i = 0; i < n; ++i)
+					sorted_indices[i] = uint32_t(show_point_step*i) + offset;
+			}
 		}
-		std::sort(indices.begin(), indices.end(), sort_pred(pc, view_dir));
+		// reuse order of last frame, which is fixed up cheaply for small view changes
+		Dir view_dir = view_ptr->get_view_dir();
+		if (!sorted_indices.empty())
+			depth_sorter.sort_back_to_front(&pc.pnt(0), sorted_indices, view_dir, reuse_order);
 
 		glDepthFunc(GL_LEQUAL);
-		size_t nn = indices.size() / nr_draw_calls;
+		size_t nn = sorted_indices.size() / nr_draw_calls;
 		for (unsigned i = 1; i<nr_draw_calls; ++i)
-			glDrawElements(GL_POINTS, GLsizei(nn), GL_UNSIGNED_INT, &indices[(i - 1)*nn]);
-		glDrawElements(GL_POINTS, GLsizei(indices.size() - (nr_draw_calls - 1)*nn), GL_UNSIGNED_INT, &indices[(nr_draw_calls - 1)*nn]);
+			glDrawElements(GL_POINTS, GLsizei(nn), GL_UNSIGNED_INT, &sorted_indices[(i - 1)*nn]);
+		glDrawElements(GL_POINTS, GLsizei(sorted_indices.size() - (nr_draw_calls - 1)*nn), GL_UNSIGNED_INT, &sorted_indices[(nr_draw_calls - 1)*nn]);
 		glDepthFunc(GL_LESS);
 	}
 	else {
@@ -5,6 +5,7 @@
 #include <cgv/render/view.h>
 
 #include "point_cloud.h"
+#include "point_depth_sorter.h"
 
 #include <cgv_gl/surfel_renderer.h>
 #include <cgv_gl/arrow_renderer.h>
@@ -49,6 +50,11 @@ protected:
 	unsigned show_point_step;
 	std::size_t show_point_begin, show_point_end;
 	unsigned nr_draw_calls;
+	// back to front sorting of points
+	point_depth_sorter depth_sorter;
+	std::vector<uint32_t> sorted_indices;
+	/// point range, step and visible components from which sorted_indices were built
+	std::vector<size_t> sorted_selection;
 	cgv::render::view* view_ptr;
 	mutable std::string last_error;
 	bool ensure_view_pointer();
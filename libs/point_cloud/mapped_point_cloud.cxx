@@ -0,0 +1,240 @@
+#include "mapped_point_cloud.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+/// layout of point_cloud_types::component_info as written by point_cloud::write_bin, the name bytes are meaningless in the file
+struct bpc_component_info
+{
+	char name[sizeof(std::string)];
+	size_t index_of_first_point;
+	size_t nr_points;
+};
+
+template <typename T>
+void mapped_point_cloud::copy_from_file(std::vector<T>& V, size_t offset, size_t count) const
+{
+	V.resize(count);
+	if (count > 0)
+		std::memcpy((char*)&V[0], file.data() + offset, count * sizeof(T));
+}
+
+mapped_point_cloud::mapped_point_cloud()
+{
+	close();
+}
+
+mapped_point_cloud::mapped_point_cloud(const std::string& file_name)
+{
+	close();
+	open(file_name);
+}
+
+void mapped_point_cloud::close()
+{
+	file.close();
+	n = nr_nmls = 0;
+	flags = 0;
+	tc_offset = pixcrd_offset = comp_offset = 0;
+	P_ptr = 0;
+	N_ptr = 0;
+	C_ptr = 0;
+	P.clear();
+	N.clear();
+	C.clear();
+	P.shrink_to_fit();
+	N.shrink_to_fit();
+	C.shrink_to_fit();
+}
+
+bool mapped_point_cloud::open(const std::string& file_name)
+{
+	close();
+	if (!file.open(file_name))
+		return false;
+	if (!file.contains<Cnt>(0, 2)) {
+		close();
+		return false;
+	}
+	const Cnt* header = file.ptr<Cnt>(0);
+	// decode header in the same way as point_cloud::read_bin
+	size_t offset;
+	Cnt m = header[1];
+	n = header[0];
+	if (n == 0) {
+		if (!file.contains<Cnt>(0, 3)) {
+			close();
+			return false;
+		}
+		n = m;
+		flags = header[2];
+		nr_nmls = (flags & BPC_HAS_NMLS) ? n : 0;
+		offset = 3 * sizeof(Cnt);
+	}
+	else {
+		if (m >= 2 * n) {
+			flags |= BPC_HAS_CLRS | BPC_HAS_BYTE_CLRS;
+			m -= 2 * n;
+		}
+		if (m > 0)
+			flags |= BPC_HAS_NMLS;
+		nr_nmls = m;
+		offset = 2 * sizeof(Cnt);
+	}
+	// positions and normals are stored in the same layout as in memory
+	if (!file.contains<Pnt>(offset, n)) {
+		close();
+		return false;
+	}
+	P_ptr = file.ptr<Pnt>(offset);
+	offset += n * sizeof(Pnt);
+	if (flags & BPC_HAS_NMLS) {
+		if (!file.contains<Nml>(offset, nr_nmls)) {
+			close();
+			return false;
+		}
+		N_ptr = file.ptr<Nml>(offset);
+		offset += nr_nmls * sizeof(Nml);
+	}
+	// colors can only be viewed if the stored color format matches the in memory format
+	if (flags & BPC_HAS_CLRS) {
+		bool byte_colors_in_file = (flags & BPC_HAS_BYTE_CLRS) != 0;
+#ifdef BYTE_COLORS
+		bool byte_colors_in_pc = true;
+#else
+		bool byte_colors_in_pc = false;
+#endif
+		typedef cgv::media::color<cgv::type::uint8_type> byte_color;
+		typedef cgv::media::color<float> float_color;
+		size_t clr_size = byte_colors_in_file ? sizeof(byte_color) : sizeof(float_color);
+		if (offset > file.size() || (file.size() - offset) / clr_size < n) {
+			close();
+			return false;
+		}
+		if (byte_colors_in_file == byte_colors_in_pc)
+			C_ptr = file.ptr<Clr>(offset);
+		else {
+			C.resize(n);
+			if (byte_colors_in_file) {
+				const byte_color* tmp = reinterpret_cast<const byte_color*>(file.data() + offset);
+				for (size_t i = 0; i < n; ++i)
+					C[i] = Clr(byte_to_color_component(tmp[i][0]), byte_to_color_component(tmp[i][1]), byte_to_color_component(tmp[i][2]));
+			}
+			else {
+				for (size_t i = 0; i < n; ++i) {
+					float_color c;
+					std::memcpy((char*)&c, file.data() + offset + i * sizeof(float_color), sizeof(float_color));
+					C[i] = Clr(float_to_color_component(c[0]), float_to_color_component(c[1]), float_to_color_component(c[2]));
+				}
+			}
+			C_ptr = &C[0];
+		}
+		offset += n * clr_size;
+	}
+	// remaining attributes are only located here and copied in extract
+	if (flags & BPC_HAS_TCS) {
+		tc_offset = offset;
+		offset += n * sizeof(TexCrd);
+	}
+	if (flags & BPC_HAS_PIXCRDS) {
+		pixcrd_offset = offset;
+		offset += n * sizeof(PixCrd);
+	}
+	if (flags & BPC_HAS_COMPS)
+		comp_offset = offset;
+	if (offset > file.size()) {
+		close();
+		return false;
+	}
+	file.advise_sequential();
+	return true;
+}
+
+std::vector<mapped_point_cloud::Pnt>& mapped_point_cloud::materialize_positions()
+{
+	if (!positions_materialized() && P_ptr) {
+		P.assign(P_ptr, P_ptr + n);
+		P_ptr = &P[0];
+	}
+	return P;
+}
+
+std::vector<mapped_point_cloud::Nml>& mapped_point_cloud::materialize_normals()
+{
+	if (!normals_materialized() && N_ptr) {
+		N.assign(N_ptr, N_ptr + nr_nmls);
+		N_ptr = &N[0];
+	}
+	return N;
+}
+
+std::vector<mapped_point_cloud::Clr>& mapped_point_cloud::materialize_colors()
+{
+	if (!colors_materialized() && C_ptr) {
+		C.assign(C_ptr, C_ptr + n);
+		C_ptr = &C[0];
+	}
+	return C;
+}
+
+bool mapped_point_cloud::extract(point_cloud& pc) const
+{
+	if (!is_open())
+		return false;
+	pc.clear();
+	pc.P.assign(P_ptr, P_ptr + n);
+	if (N_ptr) {
+		pc.N.assign(N_ptr, N_ptr + nr_nmls);
+		pc.N.resize(n);
+	}
+	if (C_ptr)
+		pc.C.assign(C_ptr, C_ptr + n);
+	if (flags & BPC_HAS_TCS)
+		copy_from_file(pc.T, tc_offset, n);
+	if (flags & BPC_HAS_PIXCRDS)
+		copy_from_file(pc.I, pixcrd_offset, n);
+	if (flags & BPC_HAS_COMPS) {
+		size_t offset = comp_offset;
+		const cgv::type::uint32_type* nr_comps_ptr = file.ptr<cgv::type::uint32_type>(offset);
+		if (!nr_comps_ptr) {
+			std::cerr << "mapped_point_cloud::extract: component block truncated" << std::endl;
+			return false;
+		}
+		size_t nr_comps = *nr_comps_ptr;
+		offset += sizeof(cgv::type::uint32_type);
+		size_t nr_bytes = nr_comps * sizeof(bpc_component_info);
+		if (flags & BPC_HAS_COMP_CLRS)
+			nr_bytes += nr_comps * sizeof(RGBA);
+		if (flags & BPC_HAS_COMP_TRANS)
+			nr_bytes += nr_comps * (sizeof(Qat) + sizeof(Dir));
+		if (!file.contains<char>(offset, nr_bytes)) {
+			std::cerr << "mapped_point_cloud::extract: component block truncated" << std::endl;
+			return false;
+		}
+		pc.components.resize(nr_comps);
+		pc.component_indices.resize(n);
+		for (size_t i = 0; i < nr_comps; ++i) {
+			bpc_component_info ci;
+			std::memcpy(&ci, file.data() + offset, sizeof(ci));
+			offset += sizeof(ci);
+			if (ci.index_of_first_point > n || ci.nr_points > n - ci.index_of_first_point) {
+				std::cerr << "mapped_point_cloud::extract: component " << i << " exceeds point range" << std::endl;
+				return false;
+			}
+			pc.components[i] = component_info(ci.index_of_first_point, ci.nr_points);
+			std::fill(pc.component_indices.begin() + ci.index_of_first_point,
+				pc.component_indices.begin() + ci.index_of_first_point + ci.nr_points, unsigned(i));
+		}
+		if (flags & BPC_HAS_COMP_CLRS) {
+			copy_from_file(pc.component_colors, offset, nr_comps);
+			offset += nr_comps * sizeof(RGBA);
+		}
+		if (flags & BPC_HAS_COMP_TRANS) {
+			copy_from_file(pc.component_rotations, offset, nr_comps);
+			offset += nr_comps * sizeof(Qat);
+			copy_from_file(pc.component_translations, offset, nr_comps);
+		}
+	}
+	pc.update_attribute_flags();
+	return true;
+}
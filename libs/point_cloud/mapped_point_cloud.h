@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include <cgv/utils/mapped_file.h>
+
+#include "point_cloud.h"
+
+#include "lib_begin.h"
+
+/** read-only access to a binary point cloud file (*.bpc, see point_cloud::read_bin) through a memory mapping.
+    Positions, normals and colors are not copied but exposed as views straight into the mapped file such that
+    opening a file only costs the header parse and pages are loaded on first access. Before the first mutating
+    access to an attribute through one of the ref_* methods, the attribute is copied into a std::vector and all
+    further accesses go to this copy (lazy materialization). The mapped file itself is never written.
+    In case the color format stored in the file does not match point_cloud_types::Clr, colors are converted
+    already in open(). */
+class CGV_API mapped_point_cloud : public point_cloud_types
+{
+protected:
+	/// memory mapping of the bpc file
+	cgv::utils::mapped_file file;
+	/// number of points
+	Cnt n;
+	/// number of normals, which is either 0 or n for files with the current header
+	Cnt nr_nmls;
+	/// attribute flags of the file (see BPCFlags)
+	cgv::type::uint32_type flags;
+	/// byte offset of the texture coordinates in the mapped file
+	size_t tc_offset;
+	/// byte offset of the pixel coordinates in the mapped file
+	size_t pixcrd_offset;
+	/// byte offset of the component block in the mapped file
+	size_t comp_offset;
+	/// pointers to the current positions, normals and colors, either into the mapped file or into the materialized vectors
+	const Pnt* P_ptr;
+	const Nml* N_ptr;
+	const Clr* C_ptr;
+	/// materialized copies of positions, normals and colors
+	std::vector<Pnt> P;
+	std::vector<Nml> N;
+	std::vector<Clr> C;
+	/// copy count elements starting at given byte offset of mapped file into vector
+	template <typename T>
+	void copy_from_file(std::vector<T>& V, size_t offset, size_t count) const;
+public:
+	/// construct without opening a file
+	mapped_point_cloud();
+	/// construct and open the given file, check success with is_open()
+	mapped_point_cloud(const std::string& file_name);
+	/// map a bpc file and parse its header, return false if the file could not be mapped or is truncated
+	bool open(const std::string& file_name);
+	/// unmap file and free materialized attributes
+	void close();
+	/// return whether a file is opened
+	bool is_open() const { return file.is_open(); }
+	/// return the number of points
+	Cnt get_nr_points() const { return n; }
+	/// return whether the file provides normals
+	bool has_normals() const { return N_ptr != 0; }
+	/// return whether the file provides colors
+	bool has_colors() const { return C_ptr != 0; }
+	/// return whether the file provides texture coordinates
+	bool has_texture_coordinates() const { return (flags & BPC_HAS_TCS) != 0; }
+	/// return whether the file provides pixel coordinates
+	bool has_pixel_coordinates() const { return (flags & BPC_HAS_PIXCRDS) != 0; }
+	/// return whether the file provides components
+	bool has_components() const { return (flags & BPC_HAS_COMPS) != 0; }
+
+	/**@name views*/
+	//@{
+	/// return pointer to all positions
+	const Pnt* positions() const { return P_ptr; }
+	/// return pointer to all normals or 0 if no normals are available
+	const Nml* normals() const { return N_ptr; }
+	/// return pointer to all colors or 0 if no colors are available
+	const Clr* colors() const { return C_ptr; }
+	/// return the i-th point as const reference
+	const Pnt& pnt(size_t i) const { return P_ptr[i]; }
+	/// return i-th normal as const reference
+	const Nml& nml(size_t i) const { return N_ptr[i]; }
+	/// return i-th color as const reference
+	const Clr& clr(size_t i) const { return C_ptr[i]; }
+	//@}
+
+	/**@name mutable access with lazy materialization*/
+	//@{
+	/// return whether positions have been copied out of the mapped file
+	bool positions_materialized() const { return !P.empty(); }
+	/// return whether normals have been copied out of the mapped file
+	bool normals_materialized() const { return !N.empty(); }
+	/// return whether colors have been copied out of the mapped file or converted on open
+	bool colors_materialized() const { return !C.empty(); }
+	/// copy positions out of the mapped file if not done before and return the copy
+	std::vector<Pnt>& materialize_positions();
+	/// copy normals out of the mapped file if not done before and return the copy
+	std::vector<Nml>& materialize_normals();
+	/// copy colors out of the mapped file if not done before and return the copy
+	std::vector<Clr>& materialize_colors();
+	/// return the i-th point as reference, which materializes all positions on first call
+	Pnt& ref_pnt(size_t i) { return positions_materialized() ? P[i] : materialize_positions()[i]; }
+	/// return the i-th normal as reference, which materializes all normals on first call
+	Nml& ref_nml(size_t i) { return normals_materialized() ? N[i] : materialize_normals()[i]; }
+	/// return the i-th color as reference, which materializes all colors on first call
+	Clr& ref_clr(size_t i) { return colors_materialized() ? C[i] : materialize_colors()[i]; }
+	//@}
+
+	/// copy all attributes including texture coordinates, pixel coordinates and components into the given point cloud with one block copy per attribute
+	bool extract(point_cloud& pc) const;
+};
+
+#include <cgv/config/lib_end.h>
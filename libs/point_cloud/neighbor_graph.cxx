@@ -94,3 +94,82 @@ void neighbor_graph::symmetrize()
 		}
 	}
 }
+
+void compact_neighbor_graph::clear()
+{
+	offsets.clear();
+	indices.clear();
+}
+
+int compact_neighbor_graph::find(Idx vi, Idx vj) const
+{
+	const Idx* b = begin_neighbors(vi);
+	const Idx* e = end_neighbors(vi);
+	const Idx* p = std::find(b, e, vj);
+	return p == e ? -1 : int(p - b);
+}
+
+bool compact_neighbor_graph::is_directed_edge(Idx vi, Idx vj) const
+{
+	return find(vi, vj) != -1;
+}
+
+void compact_neighbor_graph::compact(const std::vector<Cnt>& counts, Cnt k)
+{
+	Cnt n = get_nr_vertices();
+	size_t dst = 0;
+	for (Cnt vi = 0; vi < n; ++vi) {
+		size_t src = size_t(vi) * k;
+		offsets[vi] = dst;
+		if (dst != src)
+			std::copy(indices.begin() + src, indices.begin() + src + counts[vi], indices.begin() + dst);
+		dst += counts[vi];
+	}
+	offsets[n] = dst;
+	indices.resize(dst);
+}
+
+void compact_neighbor_graph::symmetrize(cgv::pointcloud::utility::WorkerPool& pool)
+{
+	Cnt n = get_nr_vertices();
+	// mark half edges whose reverse half edge is missing
+	vector<cgv::type::uint8_type> missing(indices.size(), 0);
+	cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, 4096, [this, &missing](int64_t first, int64_t last) {
+		for (int64_t vi = first; vi < last; ++vi)
+			for (size_t h = offsets[vi]; h < offsets[vi + 1]; ++h)
+				if (!is_directed_edge(indices[h], Idx(vi)))
+					missing[h] = 1;
+	});
+	// compute new list sizes and offsets
+	vector<size_t> new_offsets(size_t(n) + 1, 0);
+	for (Cnt vi = 0; vi < n; ++vi)
+		new_offsets[vi + 1] += get_nr_neighbors(vi);
+	for (size_t h = 0; h < indices.size(); ++h)
+		if (missing[h])
+			++new_offsets[indices[h] + 1];
+	for (Cnt vi = 0; vi < n; ++vi)
+		new_offsets[vi + 1] += new_offsets[vi];
+	// copy existing lists and append reverse half edges
+	vector<Idx> new_indices(new_offsets[n]);
+	vector<size_t> fill(new_offsets.begin(), new_offsets.end() - 1);
+	for (Cnt vi = 0; vi < n; ++vi) {
+		std::copy(begin_neighbors(vi), end_neighbors(vi), new_indices.begin() + fill[vi]);
+		fill[vi] += get_nr_neighbors(vi);
+	}
+	for (Cnt vi = 0; vi < n; ++vi)
+		for (size_t h = offsets[vi]; h < offsets[vi + 1]; ++h)
+			if (missing[h])
+				new_indices[fill[indices[h]]++] = Idx(vi);
+	offsets.swap(new_offsets);
+	indices.swap(new_indices);
+}
+
+void compact_neighbor_graph::extract(neighbor_graph& ng) const
+{
+	Cnt n = get_nr_vertices();
+	ng.clear();
+	ng.resize(n);
+	for (Cnt vi = 0; vi < n; ++vi)
+		ng[vi].assign(begin_neighbors(vi), end_neighbors(vi));
+	ng.nr_half_edges = Cnt(indices.size());
+}
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <cgv/utils/statistics.h>
 #include <cgv/type/standard_types.h>
+#include "concurrency.h"
 
 #include "lib_begin.h"
 
@@ -84,9 +85,97 @@ struct CGV_API neighbor_graph : public std::vector<std::vector<graph_location::I
 			nr_half_edges += k;
 		}
 	}
+	/// build a knn neighbor graph in parallel on the threads of the given pool, where knn.extract_neighbors needs to be thread safe
+	template <typename knn_info>
+	void build(Cnt n, Cnt k, const knn_info& knn, cgv::pointcloud::utility::WorkerPool& pool, cgv::utils::statistics* he_stats = 0) {
+		if (he_stats)
+			he_stats->init();
+		clear();
+		resize(n);
+		// each chunk writes only to the neighbor lists of its own points
+		cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, 4096, [this, k, &knn](int64_t first, int64_t last) {
+			for (int64_t i = first; i < last; ++i)
+				knn.extract_neighbors(Idx(i), k, at(i));
+		});
+		for (Idx i = 0; i < (Idx)n; ++i) {
+			if (he_stats)
+				he_stats->update((double)at(i).size());
+			nr_half_edges += Cnt(at(i).size());
+		}
+	}
 	/// ensure the neighbor graph to be symmetric
 	void symmetrize();
 	//@}
 };
 
+/** knn neighbor graph that stores all neighbor lists in one flat array in compressed sparse row layout, such that the
+    neighbors of vertex vi are indices[offsets[vi]] to indices[offsets[vi+1]-1]. Compared to neighbor_graph this avoids
+    one allocation per vertex and keeps neighbor lists of consecutive vertices adjacent in memory. Use extract() to
+    convert into a neighbor_graph for algorithms that modify individual neighbor lists. */
+struct CGV_API compact_neighbor_graph
+{
+	/// index type
+	typedef graph_location::Idx Idx;
+	/// count type
+	typedef graph_location::Cnt Cnt;
+	/// start of the neighbor list of each vertex in indices followed by the total number of half edges
+	std::vector<size_t> offsets;
+	/// neighbor indices of all vertices
+	std::vector<Idx> indices;
+	/// remove all vertices and half edges
+	void clear();
+
+	/**@name queries*/
+	//@{
+	/// return number of vertices
+	Cnt get_nr_vertices() const { return offsets.empty() ? 0 : Cnt(offsets.size() - 1); }
+	/// return number of half edges
+	size_t get_nr_half_edges() const { return indices.size(); }
+	/// return number of neighbors of vertex vi
+	Cnt get_nr_neighbors(Idx vi) const { return Cnt(offsets[vi + 1] - offsets[vi]); }
+	/// return pointer to first neighbor of vertex vi
+	const Idx* begin_neighbors(Idx vi) const { return indices.data() + offsets[vi]; }
+	/// return pointer behind last neighbor of vertex vi
+	const Idx* end_neighbors(Idx vi) const { return indices.data() + offsets[vi + 1]; }
+	/// return ni-th neighbor of vertex vi
+	Idx neighbor(Idx vi, Cnt ni) const { return indices[offsets[vi] + ni]; }
+	/// find index of vj in neighbors of vi and return -1 if not found
+	int find(Idx vi, Idx vj) const;
+	/// check if the directed edge from vi to vj is contained in the neighbor graph
+	bool is_directed_edge(Idx vi, Idx vj) const;
+	//@}
+
+	/**@name construction */
+	//@{
+	/// build a knn neighbor graph for n points in parallel on the threads of the given pool from a data structure that provides a thread safe method extract_neighbors(i, k, vector<Idx>&)
+	template <typename knn_info>
+	void build(Cnt n, Cnt k, const knn_info& knn, cgv::pointcloud::utility::WorkerPool& pool) {
+		clear();
+		offsets.resize(size_t(n) + 1);
+		for (size_t i = 0; i <= n; ++i)
+			offsets[i] = i * k;
+		indices.resize(size_t(n) * k);
+		// neighbor lists are written with fixed stride k and compacted afterwards in case fewer neighbors were found
+		std::vector<Cnt> counts(n);
+		cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, 4096, [this, k, &knn, &counts](int64_t first, int64_t last) {
+			thread_local std::vector<Idx> Ni;
+			for (int64_t i = first; i < last; ++i) {
+				knn.extract_neighbors(Idx(i), k, Ni);
+				Cnt c = std::min(Cnt(Ni.size()), k);
+				std::copy(Ni.begin(), Ni.begin() + c, indices.begin() + size_t(i) * k);
+				counts[i] = c;
+			}
+		});
+		compact(counts, k);
+	}
+	/// ensure the neighbor graph to be symmetric, where the search for missing reverse edges runs in parallel
+	void symmetrize(cgv::pointcloud::utility::WorkerPool& pool);
+	/// copy neighbor lists into a neighbor_graph
+	void extract(neighbor_graph& ng) const;
+	//@}
+protected:
+	/// remove unused entries from neighbor lists written with fixed stride k, where counts gives the number of used entries per vertex
+	void compact(const std::vector<Cnt>& counts, Cnt k);
+};
+
 #include <cgv/config/lib_end.h>
@@ -3,6 +3,17 @@
 #include <cmath>
 #include <cgv/math/functions.h>
 #include <algorithm>
+#include <thread>
+#include "concurrency.h"
+
+/// number of points processed per task in the parallel normal computations
+const int64_t normal_chunk_size = 1024;
+
+/// construct a pool that uses all hardware threads together with the calling thread
+static unsigned nr_pool_threads()
+{
+	return std::max(std::thread::hardware_concurrency(), 1u) - 1;
+}
 
 normal_estimator::normal_estimator(point_cloud& _pc, neighbor_graph& _ng) : pc(_pc), ng(_ng) 
 {
@@ -138,16 +149,20 @@ void normal_estimator::compute_weighted_normals(bool reorient)
 		pc.create_normals();
 		reorient = false;
 	}
-	std::vector<Crd> weights;
-	std::vector<Pnt> points;
-	for (Idx vi = 0; vi < (Idx)pc.get_nr_points(); ++vi) {
-		compute_weights(vi, weights, &points);
-		Nml new_nml;
-		cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], new_nml);
-		if (reorient && (dot(new_nml,pc.nml(vi)) < 0))
-			new_nml = -new_nml;
-		pc.nml(vi) = new_nml;
-	}
+	// every point only writes its own normal, such that chunks of points can be processed concurrently
+	cgv::pointcloud::utility::WorkerPool pool(nr_pool_threads());
+	cgv::pointcloud::utility::parallel_for_chunks(pool, 0, pc.get_nr_points(), normal_chunk_size, [this, reorient](int64_t first, int64_t last) {
+		thread_local std::vector<Crd> weights;
+		thread_local std::vector<Pnt> points;
+		for (Idx vi = Idx(first); vi < Idx(last); ++vi) {
+			compute_weights(vi, weights, &points);
+			Nml new_nml;
+			cgv::math::estimate_normal_wls_3d((unsigned)points.size(), points[0], &weights[0], new_nml);
+			if (reorient && (dot(new_nml,pc.nml(vi)) < 0))
+				new_nml = -new_nml;
+			pc.nml(vi) = new_nml;
+		}
+	});
 }
 
 /// recompute normals from neighbor graph and distance and normal weights
@@ -185,24 +200,22 @@ void normal_estimator::compute_bilateral_weighted_normals(bool reorient)
 	if (!pc.has_normals())
 		compute_weighted_normals(reorient);
 
-	std::vector<Crd> weights;
-	std::vector<Pnt> points;
-
-	// copy current normals
+	// new normals depend on the current normals of the neighbors and are therefore written to a separate array
 	std::vector<Nml> NS;
 	NS.resize(pc.get_nr_points());
 	Idx i, n = (Idx) pc.get_nr_points();
-	for (i = 0; i < n; ++i)
-		NS[i] = pc.nml(i);
-
-	for (Idx vi = 0; vi < (Idx)pc.get_nr_points(); ++vi) {
-
-		compute_bilateral_weights(vi, weights, &points);
 
-		cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], NS[vi]);
-		if (reorient && (dot(NS[vi],pc.nml(vi)) < 0))
-			NS[vi] = -NS[vi];
-	}
+	cgv::pointcloud::utility::WorkerPool pool(nr_pool_threads());
+	cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, normal_chunk_size, [this, reorient, &NS](int64_t first, int64_t last) {
+		thread_local std::vector<Crd> weights;
+		thread_local std::vector<Pnt> points;
+		for (Idx vi = Idx(first); vi < Idx(last); ++vi) {
+			compute_bilateral_weights(vi, weights, &points);
+			cgv::math::estimate_normal_wls_3d((unsigned)points.size(), points[0], &weights[0], NS[vi]);
+			if (reorient && (dot(NS[vi],pc.nml(vi)) < 0))
+				NS[vi] = -NS[vi];
+		}
+	});
 	for (i = 0; i < n; ++i)
 		pc.nml(i) = NS[i];
 }
@@ -213,43 +226,43 @@ void normal_estimator::compute_plane_bilateral_weighted_normals(bool reorient)
 	if (!pc.has_normals())
 		compute_weighted_normals(reorient);
 
-	std::vector<Crd> weights;
-	std::vector<Pnt> points;
-
-	// copy current normals
+	// new normals depend on the current normals of the neighbors and are therefore written to a separate array
 	std::vector<Nml> NS;
 	NS.resize(pc.get_nr_points());
 	Idx i, n = (Idx) pc.get_nr_points();
-	for (i = 0; i < n; ++i)
-		NS[i] = pc.nml(i);
 
-	for (Idx vi = 0; vi < (Idx)pc.get_nr_points(); ++vi) {
-		const Pnt& pi = pc.pnt(vi);
-		const Nml& nml_i = pc.nml(vi);
-		const std::vector<Idx> &Ni = ng.at(vi);
-		unsigned ni = (unsigned) Ni.size();
-		weights.resize(ni+1);
-		points.resize(ni+1);
-		weights[0] = 1;
-		points[0] = pi;
-		Crd l0 = estimate_scale(vi);
-		Crd l0_sqr = l0*l0;
-		Crd err0_sqr = l0_sqr*noise_to_sampling_ratio*noise_to_sampling_ratio;
-		for (unsigned j=0; j < ni; ++j) {
-			Idx vj = Ni[j];
-			Dir dij = pc.pnt(vj)-pc.pnt(vi);
-			Crd lij_sqr = sqr_length(dij);
-			Crd w_x = exp(-lij_sqr/l0_sqr);
-			Crd errij = dot(pc.nml(vj),dij)*dot(pc.nml(vj),dij);
-			Crd w_n = exp(-errij/err0_sqr);
-			Crd w   = w_x*w_n;
-			weights[j+1] = w;
-			points[j+1] = pc.pnt(vj);
+	cgv::pointcloud::utility::WorkerPool pool(nr_pool_threads());
+	cgv::pointcloud::utility::parallel_for_chunks(pool, 0, n, normal_chunk_size, [this, reorient, &NS](int64_t first, int64_t last) {
+		thread_local std::vector<Crd> weights;
+		thread_local std::vector<Pnt> points;
+		for (Idx vi = Idx(first); vi < Idx(last); ++vi) {
+			const Pnt& pi = pc.pnt(vi);
+			const Nml& nml_i = pc.nml(vi);
+			const std::vector<Idx> &Ni = ng.at(vi);
+			unsigned ni = (unsigned) Ni.size();
+			weights.resize(ni+1);
+			points.resize(ni+1);
+			weights[0] = 1;
+			points[0] = pi;
+			Crd l0 = estimate_scale(vi);
+			Crd l0_sqr = l0*l0;
+			Crd err0_sqr = l0_sqr*noise_to_sampling_ratio*noise_to_sampling_ratio;
+			for (unsigned j=0; j < ni; ++j) {
+				Idx vj = Ni[j];
+				Dir dij = pc.pnt(vj)-pc.pnt(vi);
+				Crd lij_sqr = sqr_length(dij);
+				Crd w_x = exp(-lij_sqr/l0_sqr);
+				Crd errij = dot(pc.nml(vj),dij)*dot(pc.nml(vj),dij);
+				Crd w_n = exp(-errij/err0_sqr);
+				Crd w   = w_x*w_n;
+				weights[j+1] = w;
+				points[j+1] = pc.pnt(vj);
+			}
+			cgv::math::estimate_normal_wls_3d((unsigned)points.size(), points[0], &weights[0], NS[vi]);
+			if (reorient && (dot(NS[vi],pc.nml(vi)) < 0))
+				NS[vi] = -NS[vi];
 		}
-		cgv::math::estimate_normal_wls((unsigned)points.size(), points[0], &weights[0], NS[vi]);
-		if (reorient && (dot(NS[vi],pc.nml(vi)) < 0))
-			NS[vi] = -NS[vi];
-	}
+	});
 	for (i = 0; i < n; ++i)
 		pc.nml(i) = NS[i];
 }
@@ -14,6 +14,11 @@
 #include <sstream>
 #include <exception>
 #include <typeinfo>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <cgv/utils/file.h>
+#include <cgv/utils/zone_profiler.h>
 
 #include "concurrency.h"
 #include "morton.h"
@@ -145,14 +150,65 @@ namespace pointcloud {
 		int z = 0;
 		int size = 0; //cube edge length
 		int numPoints;
-		//point cloud data
+		//point cloud data, null for chunks that are spilled to a file in streaming mode
 		std::shared_ptr<ChunkPointCloud<point_t>> pc_data;
 		std::string id;
-
-		ChunkNode(std::string node_id, int numPoints) {
+		//file that holds the chunk's points in streaming mode
+		std::string file_name;
+		//buffered handle of file_name that stays open during the distribution pass
+		std::shared_ptr<FILE> file;
+		//serializes appends to file_name
+		std::shared_ptr<std::mutex> mtx_file;
+
+		ChunkNode(std::string node_id, int numPoints, bool allocate = true) {
 			this->numPoints = numPoints;
 			this->id = node_id;
-			this->pc_data = std::make_shared<ChunkPointCloud<point_t>>(numPoints);
+			if (allocate)
+				this->pc_data = std::make_shared<ChunkPointCloud<point_t>>(numPoints);
+			else
+				this->mtx_file = std::make_shared<std::mutex>();
+		}
+
+		//create the chunk file and keep it open for appending, if the process runs out of file handles the chunk falls back to reopening the file on each append
+		void open_file() {
+			FILE* fp = fopen(file_name.c_str(), "wb");
+			if (fp)
+				file = std::shared_ptr<FILE>(fp, fclose);
+		}
+
+		//flush and close the chunk file and return false if buffered points could not be written
+		bool close_file() {
+			if (!file)
+				return true;
+			bool success = fflush(file.get()) == 0;
+			file = nullptr;
+			return success;
+		}
+
+		//append points to the chunk file
+		bool append_to_file(const point_t* points, const int64_t size) {
+			std::lock_guard<std::mutex> lock(*mtx_file);
+			if (file)
+				return fwrite(points, sizeof(point_t), size, file.get()) == size_t(size);
+			FILE* fp = fopen(file_name.c_str(), "ab");
+			if (!fp)
+				return false;
+			bool success = fwrite(points, sizeof(point_t), size, fp) == size_t(size);
+			fclose(fp);
+			return success;
+		}
+
+		//read the points of a spilled chunk back into memory and delete the chunk file
+		bool load_from_file() {
+			pc_data = std::make_shared<ChunkPointCloud<point_t>>(numPoints);
+			FILE* fp = fopen(file_name.c_str(), "rb");
+			if (!fp)
+				return false;
+			size_t nr_read = fread(pc_data->vertices.data(), sizeof(point_t), numPoints, fp);
+			fclose(fp);
+			pc_data->numPointsWritten = int(nr_read);
+			cgv::utils::file::remove(file_name);
+			return nr_read == size_t(numPoints);
 		}
 
 	};
@@ -172,6 +228,60 @@ namespace pointcloud {
 		virtual void sample(std::shared_ptr<IndexNode<point_t>> node, double baseSpacing, std::function<void(IndexNode<point_t>*)> callbackNodeCompleted) = 0;
 	};
 
+	/// input of the streaming lod generation, which reads the points several times in batches
+	template <typename point_t>
+	struct PointSource {
+		virtual ~PointSource() {}
+		/// restart reading at the first point
+		virtual bool rewind() = 0;
+		/// read up to max_num_points points into buffer and return the number of read points, 0 signals the end of the input
+		virtual size_t read(point_t* buffer, size_t max_num_points) = 0;
+	};
+
+	/// reads points from a file that contains a plain array of point_t
+	template <typename point_t>
+	struct FilePointSource : public PointSource<point_t> {
+		FILE* fp = nullptr;
+
+		FilePointSource(const std::string& file_name) {
+			fp = fopen(file_name.c_str(), "rb");
+		}
+		~FilePointSource() {
+			if (fp)
+				fclose(fp);
+		}
+		bool is_open() const {
+			return fp != nullptr;
+		}
+		bool rewind() override {
+			return fp && fseek(fp, 0, SEEK_SET) == 0;
+		}
+		size_t read(point_t* buffer, size_t max_num_points) override {
+			return fp ? fread(buffer, sizeof(point_t), max_num_points, fp) : 0;
+		}
+	};
+
+	/// entry of the node table at the end of a lod file written by generate_lods_streamed
+	struct LODFileNode {
+		/// index of the first point of the node in the point array
+		uint64_t first_point = 0;
+		uint64_t num_points = 0;
+		uint32_t level = 0;
+		/// node name as in IndexNode, "r" for the root followed by one digit per level
+		std::string name;
+	};
+
+	/// header of a lod file, which is followed by num_points points of size point_size grouped by node and the node table at node_table_offset
+	struct LODFileHeader {
+		char magic[4] = { 'L', 'O', 'D', 'P' };
+		uint32_t version = 1;
+		uint32_t point_size = 0;
+		uint32_t reserved = 0;
+		uint64_t num_points = 0;
+		uint64_t num_nodes = 0;
+		uint64_t node_table_offset = 0;
+	};
+
 /// generates octree based lods for point clouds, 
 /// @param type point_t should provide two position() and level() methods like GenericLODPoint, these are used to read the point position and write the LOD
 template <typename point_t>
@@ -202,26 +312,120 @@ class octree_lod_generator : public cgv::render::render_types {
 		};
 
 		// this indexer writes all nodes to an output vector assigning the nodes level to each point
+		// the output vector has to be resized to an upper bound of the number of points before indexing, each node reserves
+		// its range with an atomic offset such that worker threads do not block each other, finalize() trims the output
 		struct FlatIndexer : public Indexer {
 			std::vector<point_t>* output;
-			std::mutex mtx_write;
+			std::atomic<size_t> num_written = 0;
 			FlatIndexer(std::vector<point_t>* const ptr) {
 				output = ptr;
 			}
 
-			// lock and write node to out
+			// reserve range in output and copy node to it
 			void finish_node(IndexNode<point_t>& node) override {
 				assert(node.sampled);
-				std::lock_guard<std::mutex> lock(mtx_write);
-				for (auto& vert : *node.points) {
-					vert.level() = node.level();
-					output->push_back(vert);
+				size_t num_points = node.points->size();
+				size_t first = num_written.fetch_add(num_points, std::memory_order_relaxed);
+				assert(first + num_points <= output->size());
+				const point_t* src = node.points->data();
+				point_t* dst = output->data() + first;
+				uint8_t level = uint8_t(node.level());
+				for (size_t i = 0; i < num_points; ++i) {
+					dst[i] = src[i];
+					dst[i].level() = level;
+				}
+				node.points = nullptr;
+			}
+
+			// shrink output to the number of written points
+			void finalize() {
+				output->resize(num_written);
+			}
+		};
+
+		// this indexer appends finished nodes to a lod file and records them in a node table that is written by close()
+		struct StreamIndexer : public Indexer {
+			FILE* fp = nullptr;
+			std::string file_name;
+			std::mutex mtx_write;
+			LODFileHeader header;
+			std::vector<LODFileNode> node_table;
+			bool write_failed = false;
+
+			// an indexer that was not closed successfully removes its partial output file
+			~StreamIndexer() {
+				discard();
+			}
+
+			bool open(const std::string& _file_name) {
+				file_name = _file_name;
+				fp = fopen(file_name.c_str(), "wb");
+				if (!fp)
+					return false;
+				header.point_size = sizeof(point_t);
+				return fwrite(&header, sizeof(LODFileHeader), 1, fp) == 1;
+			}
+
+			// lock and append node to file
+			void finish_node(IndexNode<point_t>& node) override {
+				assert(node.sampled);
+				if (node.points) {
+					for (auto& vert : *node.points)
+						vert.level() = node.level();
+					write_node(node.name, node.points->data(), node.points->size());
 				}
 				node.points = nullptr;
 			}
+
+			void write_node(const std::string& name, const point_t* points, size_t num_points) {
+				std::lock_guard<std::mutex> lock(mtx_write);
+				LODFileNode entry;
+				entry.first_point = header.num_points;
+				entry.num_points = num_points;
+				entry.level = uint32_t(name.size() - 1);
+				entry.name = name;
+				if (fwrite(points, sizeof(point_t), num_points, fp) != num_points)
+					write_failed = true;
+				header.num_points += num_points;
+				node_table.push_back(entry);
+			}
+
+			// write node table, update header and close file
+			bool close() {
+				if (!fp)
+					return false;
+				header.num_nodes = node_table.size();
+				header.node_table_offset = sizeof(LODFileHeader) + header.num_points * sizeof(point_t);
+				for (const auto& entry : node_table) {
+					uint32_t name_length = uint32_t(entry.name.size());
+					write_failed |= fwrite(&entry.first_point, sizeof(uint64_t), 1, fp) != 1;
+					write_failed |= fwrite(&entry.num_points, sizeof(uint64_t), 1, fp) != 1;
+					write_failed |= fwrite(&entry.level, sizeof(uint32_t), 1, fp) != 1;
+					write_failed |= fwrite(&name_length, sizeof(uint32_t), 1, fp) != 1;
+					write_failed |= fwrite(entry.name.data(), 1, name_length, fp) != name_length;
+				}
+				write_failed |= fseek(fp, 0, SEEK_SET) != 0;
+				write_failed |= fwrite(&header, sizeof(LODFileHeader), 1, fp) != 1;
+				write_failed |= fclose(fp) != 0;
+				fp = nullptr;
+				if (write_failed)
+					cgv::utils::file::remove(file_name);
+				return !write_failed;
+			}
+
+			// close and remove an unfinished lod file
+			void discard() {
+				if (!fp)
+					return;
+				fclose(fp);
+				fp = nullptr;
+				cgv::utils::file::remove(file_name);
+			}
 		};
 		
 		int max_points_per_chunk = -1;
+		/// number of points read at once from a PointSource in generate_lods_streamed
+		size_t stream_batch_size = 1'000'000;
 
 	protected:
 
@@ -251,15 +455,20 @@ class octree_lod_generator : public cgv::render::render_types {
 			
 		inline std::vector<std::atomic_int32_t> lod_counting(const vec3* positions, const int64_t num_points, int64_t grid_size, const vec3& min, const vec3& max, const float& cube_size);
 
+		//add counts of a batch of points to an existing counting grid
+		inline void lod_counting(std::vector<std::atomic_int32_t>& grid, const point_t* vertices, const int64_t num_points, int64_t grid_size, const vec3& min, const float& cube_size);
+
 		inline void lod_counting_core(std::function<void(int64_t first_point, int64_t num_points)>& processor, const int64_t num_points);
 
 
-		inline NodeLUT lod_createLUT(std::vector<std::atomic_int32_t>& grid, int64_t grid_size,std::vector<ChunkNode<point_t>>& nodes);
+		inline NodeLUT lod_createLUT(std::vector<std::atomic_int32_t>& grid, int64_t grid_size,std::vector<ChunkNode<point_t>>& nodes, bool allocate_chunks = true);
 			
 		//create chunk nodes
 		inline void distribute_points(vec3 min, vec3 max, float cube_size, int64_t grid_size, NodeLUT& lut, const point_t* vertices, const int64_t num_points, const std::vector<ChunkNode<point_t>>& nodes);
+		//sort points into buckets per chunk and pass each non empty bucket to write_bucket(chunk_index, points, num_points)
+		inline void distribute_points_core(float cube_size, int64_t grid_size, NodeLUT& lut, const point_t* vertices, const int64_t num_points, int num_buckets, const vec3& min, std::function<void(int, const point_t*, int64_t)> write_bucket);
 		//inout chunks
-		inline void indexing(Chunks<point_t>& chunks, Indexer& indexer, Sampler<point_t>& sampler);
+		inline bool indexing(Chunks<point_t>& chunks, Indexer& indexer, Sampler<point_t>& sampler);
 			
 		void build_hierarchy(Indexer* indexer, IndexNode<point_t>* node, std::shared_ptr<std::vector<point_t>> points, int64_t numPoints, int64_t depth = 0, int max_points_per_index_node = 10000);
 			
@@ -278,6 +487,13 @@ class octree_lod_generator : public cgv::render::render_types {
 		/// generate points with lod information out of the given vertices
 		inline std::vector<point_t> generate_lods(const std::vector<point_t>& points);
 
+		/// generate lods out of core: points are read in batches from source, chunks are spilled to files in temp_dir and
+		/// finished nodes are appended to a lod file at output_file_name, such that only a few chunks need to be in memory
+		inline bool generate_lods_streamed(PointSource<point_t>& source, const std::string& output_file_name, const std::string& temp_dir);
+
+		/// read all points and optionally the node table of a lod file written by generate_lods_streamed
+		inline static bool read_lod_file(const std::string& file_name, std::vector<point_t>& points, std::vector<LODFileNode>* nodes = nullptr);
+
 		//creates a octree structure out of IndexNodes and returns a shared pointer to the root
 		inline std::shared_ptr<IndexNode<point_t>> build_octree(const std::vector<point_t>& points);
 		
@@ -292,8 +508,14 @@ class octree_lod_generator : public cgv::render::render_types {
 		}
 
 		bool init() {
+			return init(std::thread::hardware_concurrency());
+		}
+
+		/// (re)create the thread pool such that num_threads threads including the calling thread work on the lod generation
+		bool init(unsigned num_threads) {
+			pool_ptr = nullptr;
 			pool_ptr =
-				  std::make_unique<cgv::pointcloud::utility::WorkerPool>((std::thread::hardware_concurrency() - 1));
+				  std::make_unique<cgv::pointcloud::utility::WorkerPool>(std::max(num_threads, 1u) - 1);
 			return pool_ptr != nullptr;
 		}
 
@@ -334,6 +556,7 @@ struct SamplerRandom : public Sampler<point_t> {
 
 	// subsample a octree from bottom up, calls onNodeCompleted on every node except the root
 	inline void sample(std::shared_ptr<IndexNode<point_t>> node, double baseSpacing, std::function<void(IndexNode<point_t>*)> onNodeCompleted) {
+		CGV_PROFILE_ZONE_CAT("octree sample node", "octree");
 		//using IndexNode = octree_lod_generator::IndexNode;
 		using vec3 = cgv::render::render_types::vec3;
 
@@ -564,6 +787,7 @@ struct SamplerRandom : public Sampler<point_t> {
 	template <typename point_t>
 	Chunks<point_t> octree_lod_generator<point_t>::chunking(const point_t* vertices, const size_t num_points, const vec3& min, const vec3& max, const float& cube_size)
 	{
+		CGV_PROFILE_ZONE_CAT("octree chunking", "octree");
 		// stores chunks created by the chunking phase
 		Chunks<point_t> chunks;
 
@@ -674,6 +898,7 @@ struct SamplerRandom : public Sampler<point_t> {
 	template <typename point_t>
 	std::vector<std::atomic_int32_t> octree_lod_generator<point_t>::lod_counting(const point_t* vertices, const int64_t num_points, int64_t grid_size, const vec3& min, const vec3& max, const float& cube_size)
 	{
+		CGV_PROFILE_ZONE_CAT("octree counting", "octree");
 		std::vector<std::atomic_int32_t> grid(grid_size * grid_size * grid_size);
 
 		// count points for each cell
@@ -693,6 +918,7 @@ struct SamplerRandom : public Sampler<point_t> {
 	template <typename point_t>
 	std::vector<std::atomic_int32_t> octree_lod_generator<point_t>::lod_counting(const vec3* positions, const int64_t num_points, int64_t grid_size, const vec3& min, const vec3& max, const float& cube_size)
 	{
+		CGV_PROFILE_ZONE_CAT("octree counting", "octree");
 		std::vector<std::atomic_int32_t> grid(grid_size * grid_size * grid_size);
 
 		// count points for each cell
@@ -708,11 +934,42 @@ struct SamplerRandom : public Sampler<point_t> {
 		return std::move(grid);
 	}
 
+	template <typename point_t>
+	void octree_lod_generator<point_t>::lod_counting(std::vector<std::atomic_int32_t>& grid, const point_t* vertices, const int64_t num_points, int64_t grid_size, const vec3& min, const float& cube_size)
+	{
+		std::function<void(int64_t first_point, int64_t num_points)> processor = [this, &grid, &cube_size, grid_size, vertices, &min](int64_t first_point, int64_t num_points) {
+			for (int i = 0; i < num_points; i++) {
+				int64_t index = grid_index(vertices[first_point + i].position(), min, cube_size, grid_size);
+				grid[index].fetch_add(1, std::memory_order::memory_order_relaxed);
+			}
+		};
+
+		lod_counting_core(processor, num_points);
+	}
+
 
 	template <typename point_t>
 	void octree_lod_generator<point_t>::distribute_points(vec3 min, vec3 max, float cube_size, int64_t grid_size, NodeLUT& lut, const point_t* vertices, const int64_t num_points, const std::vector<ChunkNode<point_t>>& nodes)
 	{
-		//auto start = std::chrono::steady_clock::now();
+		CGV_PROFILE_ZONE_CAT("octree distribute points", "octree");
+		distribute_points_core(cube_size, grid_size, lut, vertices, num_points, int(nodes.size()), min, [&nodes](int i, const point_t* points, int64_t size) {
+			nodes[i].pc_data->write_points(points, int(size));
+		});
+
+		/* //single thread variant
+		for (int i = 0; i < num_points; ++i) {
+			vec3 p = vertices[i].position;
+			int idx = grid_index(p, min, cube_size, grid_size);
+
+			auto& node = nodes[grid[idx]];
+			point_t v = vertices[i];
+			node.pc_data->write_points(&v, 1);
+		}*/
+	}
+
+	template <typename point_t>
+	void octree_lod_generator<point_t>::distribute_points_core(float cube_size, int64_t grid_size, NodeLUT& lut, const point_t* vertices, const int64_t num_points, int num_buckets, const vec3& min, std::function<void(int, const point_t*, int64_t)> write_bucket)
+	{
 		auto& grid = lut.grid;
 
 		constexpr int max_chunk_size = 512 * (64 / sizeof(point_t));
@@ -741,7 +998,7 @@ struct SamplerRandom : public Sampler<point_t> {
 			}
 		}
 
-		tasks.func = [this, &tasks, &vertices, &min, &cube_size, &grid_size, &grid, &nodes](Task* task) {
+		tasks.func = [this, &vertices, &min, &cube_size, &grid_size, &grid, num_buckets, &write_bucket](Task* task) {
 			int batch_size = task->batch_size;
 			int64_t first_point = task->first_point;
 
@@ -749,7 +1006,6 @@ struct SamplerRandom : public Sampler<point_t> {
 			const point_t* end = start + batch_size;
 
 			//create a bucket for each chunk
-			int num_buckets = nodes.size();
 			std::vector<std::vector<point_t>> buckets(num_buckets);
 
 			for (const point_t* i = start; i < end; ++i) {
@@ -760,29 +1016,18 @@ struct SamplerRandom : public Sampler<point_t> {
 
 			for (int i = 0; i < num_buckets; ++i) {
 				if (buckets[i].size() > 0)
-					nodes[i].pc_data->write_points(buckets[i].data(), buckets[i].size());
+					write_bucket(i, buckets[i].data(), buckets[i].size());
 			}
 
 		};
 
 		pool_ptr->run([&tasks](int id) {tasks(); });
-
-		/* //single thread variant
-		for (int i = 0; i < num_points; ++i) {
-			vec3 p = vertices[i].position;
-			int idx = grid_index(p, min, cube_size, grid_size);
-
-			auto& node = nodes[grid[idx]];
-			point_t v = vertices[i];
-			node.pc_data->write_points(&v, 1);
-		}*/
-		auto end = std::chrono::steady_clock::now();
-		//std::printf("distributing: %d ns\n", std::chrono::duration_cast<std::chrono::nanoseconds>(end - start));
 	}
 
 	template <typename point_t>
-	NodeLUT octree_lod_generator<point_t>::lod_createLUT(std::vector<std::atomic_int32_t>& grid, int64_t grid_size, std::vector<ChunkNode<point_t>>& nodes)
+	NodeLUT octree_lod_generator<point_t>::lod_createLUT(std::vector<std::atomic_int32_t>& grid, int64_t grid_size, std::vector<ChunkNode<point_t>>& nodes, bool allocate_chunks)
 	{
+		CGV_PROFILE_ZONE_CAT("octree create LUT", "octree");
 		nodes.clear();
 
 		auto for_xyz = [](int64_t gridSize, std::function< void(int64_t, int64_t, int64_t)> callback) {
@@ -818,7 +1063,7 @@ struct SamplerRandom : public Sampler<point_t> {
 			// grid_high
 
 			// loop through all cells of the lower detail target grid, and for each cell through the 8 enclosed cells of the higher level grid
-			for_xyz(gridSize_low, [this, &nodes, &grid_low, &grid_high, gridSize_low, gridSize_high, level_low, level_high, level_max](int64_t x, int64_t y, int64_t z) {
+			for_xyz(gridSize_low, [this, &nodes, &grid_low, &grid_high, gridSize_low, gridSize_high, level_low, level_high, level_max, allocate_chunks](int64_t x, int64_t y, int64_t z) {
 
 				int64_t index_low = x + y * gridSize_low + z * gridSize_low * gridSize_low;
 
@@ -867,7 +1112,7 @@ struct SamplerRandom : public Sampler<point_t> {
 
 						if (value > 0) {
 							std::string node_id = to_node_id(level_high, gridSize_high, nx, ny, nz);
-							nodes.emplace_back(node_id, value);
+							nodes.emplace_back(node_id, value, allocate_chunks);
 							ChunkNode<point_t>& node = nodes.back();
 
 							node.x = nx;
@@ -944,8 +1189,9 @@ struct SamplerRandom : public Sampler<point_t> {
 	}
 
 	template <typename point_t>
-	void octree_lod_generator<point_t>::indexing(Chunks<point_t>& chunks, Indexer& indexer, Sampler<point_t>& sampler)
+	bool octree_lod_generator<point_t>::indexing(Chunks<point_t>& chunks, Indexer& indexer, Sampler<point_t>& sampler)
 	{
+		CGV_PROFILE_ZONE_CAT("octree indexing", "octree");
 		struct Task {
 			ChunkNode<point_t>* chunk = nullptr;
 			int id = 0;
@@ -980,14 +1226,25 @@ struct SamplerRandom : public Sampler<point_t> {
 		
 		std::mutex mtx_nodes;
 		std::vector<std::shared_ptr<IndexNode<point_t>>> nodes;
+		std::atomic_bool load_failed = false;
 
 		indexer.root = std::make_shared<IndexNode<point_t>>("r", chunks.min, chunks.max);
 		indexer.spacing = (chunks.max - chunks.min).x() / 128.0;
 
 		//builds node hierachy
-		tasks.func = [this, &indexer, &sampler, &nodes, &mtx_nodes](Task* task) {
+		tasks.func = [this, &indexer, &sampler, &nodes, &mtx_nodes, &load_failed](Task* task) {
 			static constexpr float Infinity = std::numeric_limits<float>::infinity();
 			ChunkNode<point_t>* chunk = task->chunk;
+			if (load_failed)
+				return;
+
+			// chunks of the streaming mode are only loaded when they are processed
+			if (!chunk->pc_data && !chunk->load_from_file()) {
+				std::cerr << "lod generator: could not read chunk file " << chunk->file_name << std::endl;
+				chunk->pc_data = nullptr;
+				load_failed = true;
+				return;
+			}
 
 			vec3 min(Infinity), max(-Infinity);
 
@@ -1022,6 +1279,10 @@ struct SamplerRandom : public Sampler<point_t> {
 				indexer.root->add_descendant(chunk_root);
 			}
 
+			// release chunk memory as soon as all nodes built from it are finished
+			if (!chunk->file_name.empty())
+				chunk->pc_data = nullptr;
+
 			std::lock_guard<std::mutex> lock(mtx_nodes);
 
 			nodes.push_back(chunk_root);
@@ -1033,6 +1294,8 @@ struct SamplerRandom : public Sampler<point_t> {
 		}
 
 		pool_ptr->run([&tasks](int thread_id) {tasks(); });
+		if (load_failed)
+			return false;
 
 		if (chunks.nodes.size() == 1) {
 			indexer.root = nodes[0];
@@ -1044,6 +1307,7 @@ struct SamplerRandom : public Sampler<point_t> {
 			sampler.sample(indexer.root, indexer.spacing, onNodeCompleted);
 		}
 		indexer.finish_node(*indexer.root.get());
+		return true;
 	}
 
 	struct NodeCandidate {
@@ -1294,8 +1558,8 @@ struct SamplerRandom : public Sampler<point_t> {
 	template <typename point_t>
 	std::vector<point_t> octree_lod_generator<point_t>::generate_lods(const std::vector<point_t>& points)
 	{
+		CGV_PROFILE_ZONE_CAT("octree generate lods", "octree");
 		std::vector<point_t> out;
-		out.reserve(points.size());
 
 		point_t* source_data = (point_t*)points.data();
 		size_t source_data_size = points.size();
@@ -1339,8 +1603,10 @@ struct SamplerRandom : public Sampler<point_t> {
 			Chunks<point_t> nodes = chunking(source_data, source_data_size, min, max, cube_size);
 
 			SamplerRandom<point_t> sampler;
+			out.resize(source_data_size);
 			FlatIndexer indexer(&out);
 			indexing(nodes, indexer, sampler);
+			indexer.finalize();
 		}
 		
 		if (out.size() != points.size()) {
@@ -1353,6 +1619,7 @@ struct SamplerRandom : public Sampler<point_t> {
 
 	template <typename point_t>
 	std::shared_ptr<IndexNode<point_t>> octree_lod_generator<point_t>::build_octree(const std::vector<point_t>& points) {
+		CGV_PROFILE_ZONE_CAT("octree build octree", "octree");
 		const point_t* source_data = points.data();
 		size_t source_data_size = points.size();
 
@@ -1385,6 +1652,158 @@ struct SamplerRandom : public Sampler<point_t> {
 		return std::move(indexer.get_root());
 	}
 
+	template <typename point_t>
+	bool octree_lod_generator<point_t>::generate_lods_streamed(PointSource<point_t>& source, const std::string& output_file_name, const std::string& temp_dir)
+	{
+		CGV_PROFILE_ZONE_CAT("octree generate lods streamed", "octree");
+		std::vector<point_t> batch(stream_batch_size);
+		size_t batch_num_points;
+
+		// BOUNDS - first pass over the input
+		static constexpr float Infinity = std::numeric_limits<float>::infinity();
+		vec3 min = { Infinity , Infinity , Infinity };
+		vec3 max = { -Infinity , -Infinity , -Infinity };
+		int64_t num_points = 0;
+
+		if (!source.rewind())
+			return false;
+		while ((batch_num_points = source.read(batch.data(), batch.size())) > 0) {
+			for (size_t i = 0; i < batch_num_points; ++i) {
+				const vec3& p = batch[i].position();
+				min.x() = std::min(min.x(), p.x());
+				min.y() = std::min(min.y(), p.y());
+				min.z() = std::min(min.z(), p.z());
+
+				max.x() = std::max(max.x(), p.x());
+				max.y() = std::max(max.y(), p.y());
+				max.z() = std::max(max.z(), p.z());
+			}
+			num_points += batch_num_points;
+		}
+
+		StreamIndexer indexer;
+		if (!indexer.open(output_file_name)) {
+			std::cerr << "lod generator: could not open " << output_file_name << " for writing" << std::endl;
+			return false;
+		}
+
+		vec3 ext = max - min;
+		float cube_size = num_points > 0 ? *std::max_element(ext.begin(), ext.end()) : 0.f;
+
+		if (cube_size == 0.f) {
+			//all points have the same position, assign root level to all points
+			if (!source.rewind())
+				return false;
+			while ((batch_num_points = source.read(batch.data(), batch.size())) > 0) {
+				if (allow_duplicate_elimination) {
+					//only copy one point
+					batch_num_points = 1;
+				}
+				for (size_t i = 0; i < batch_num_points; ++i)
+					batch[i].level() = 0;
+				indexer.write_node("r", batch.data(), batch_num_points);
+				if (allow_duplicate_elimination)
+					break;
+			}
+			return indexer.close();
+		}
+		max = min + vec3(cube_size, cube_size, cube_size);
+
+		// COUNT - second pass
+		max_points_per_chunk = std::min<size_t>(num_points / 20, 10'000'000ll);
+		int64_t grid_size = select_grid_size(num_points);
+		std::vector<std::atomic_int32_t> grid(grid_size * grid_size * grid_size);
+
+		if (!source.rewind())
+			return false;
+		while ((batch_num_points = source.read(batch.data(), batch.size())) > 0)
+			lod_counting(grid, batch.data(), batch_num_points, grid_size, min, cube_size);
+
+		// DISTRIBUTE - third pass, spill points to one file per chunk
+		Chunks<point_t> chunks;
+		chunks.min = min;
+		chunks.max = max;
+		auto lut = lod_createLUT(grid, grid_size, chunks.nodes, false);
+		auto remove_chunk_files = [&chunks]() {
+			for (auto& chunk : chunks.nodes) {
+				chunk.file = nullptr;
+				cgv::utils::file::remove(chunk.file_name);
+			}
+		};
+		for (auto& chunk : chunks.nodes) {
+			chunk.file_name = temp_dir + "/chunk_" + chunk.id + ".bin";
+			chunk.open_file();
+		}
+
+		std::atomic_bool spill_failed = false;
+		if (!source.rewind()) {
+			remove_chunk_files();
+			return false;
+		}
+		while ((batch_num_points = source.read(batch.data(), batch.size())) > 0) {
+			distribute_points_core(cube_size, grid_size, lut, batch.data(), batch_num_points, int(chunks.nodes.size()), min, [&chunks, &spill_failed](int i, const point_t* points, int64_t size) {
+				if (!chunks.nodes[i].append_to_file(points, size))
+					spill_failed = true;
+			});
+		}
+		for (auto& chunk : chunks.nodes)
+			if (!chunk.close_file())
+				spill_failed = true;
+		if (spill_failed) {
+			std::cerr << "lod generator: could not write chunk files to " << temp_dir << std::endl;
+			remove_chunk_files();
+			return false;
+		}
+		batch.clear();
+		batch.shrink_to_fit();
+
+		// INDEXING - chunks are loaded one per thread and finished nodes go to the lod file
+		SamplerRandom<point_t> sampler;
+		if (!indexing(chunks, indexer, sampler)) {
+			remove_chunk_files();
+			return false;
+		}
+
+		if (indexer.header.num_points != uint64_t(num_points)) {
+			std::cout << "lod generator: some points were eliminated!\n";
+		}
+		return indexer.close();
+	}
+
+	template <typename point_t>
+	bool octree_lod_generator<point_t>::read_lod_file(const std::string& file_name, std::vector<point_t>& points, std::vector<LODFileNode>* nodes)
+	{
+		CGV_PROFILE_ZONE_CAT("octree read lod file", "octree");
+		FILE* fp = fopen(file_name.c_str(), "rb");
+		if (!fp)
+			return false;
+		LODFileHeader header;
+		bool success = fread(&header, sizeof(LODFileHeader), 1, fp) == 1 &&
+			memcmp(header.magic, LODFileHeader().magic, 4) == 0 &&
+			header.point_size == sizeof(point_t);
+		if (success) {
+			points.resize(header.num_points);
+			success = fread(points.data(), sizeof(point_t), points.size(), fp) == points.size();
+		}
+		if (success && nodes) {
+			nodes->resize(header.num_nodes);
+			for (auto& entry : *nodes) {
+				uint32_t name_length = 0;
+				success = success &&
+					fread(&entry.first_point, sizeof(uint64_t), 1, fp) == 1 &&
+					fread(&entry.num_points, sizeof(uint64_t), 1, fp) == 1 &&
+					fread(&entry.level, sizeof(uint32_t), 1, fp) == 1 &&
+					fread(&name_length, sizeof(uint32_t), 1, fp) == 1;
+				if (!success)
+					break;
+				entry.name.resize(name_length);
+				success = fread(&entry.name[0], 1, name_length, fp) == name_length;
+			}
+		}
+		fclose(fp);
+		return success;
+	}
+
 
 
 	template <typename point_t>
@@ -1540,6 +1959,8 @@ struct SamplerRandom : public Sampler<point_t> {
 	using cgv::pointcloud::octree::SimpleLODPoint;
 	using cgv::pointcloud::octree::GenericLODPoint;
 	using cgv::pointcloud::octree::ref_octree_lod_generator;
+	using cgv::pointcloud::octree::PointSource;
+	using cgv::pointcloud::octree::FilePointSource;
 } //pointcloud namespace
 } //cgv namespace
 
@@ -1,12 +1,21 @@
 #include <cgv/math/permute.h>
 #include <cgv/math/det.h>
 #include "point_cloud.h"
+#include "concurrency.h"
 #include <cgv/utils/file.h>
 #include <cgv/utils/stopwatch.h>
 #include <cgv/utils/scan.h>
 #include <cgv/utils/advanced_scan.h>
+#include <cgv/utils/token_iterator.h>
+#include <cgv/utils/mapped_file.h>
+#include <cgv/utils/zone_profiler.h>
 #include <cgv/media/mesh/obj_reader.h>
 #include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <limits>
+#include <cstring>
 
 #pragma warning(disable:4996)
 
@@ -463,6 +472,45 @@ void point_cloud::resize(size_t nr_points)
 }
 
 
+/// recompute attribute flags from container sizes and mark cached ranges out of date after containers have been filled directly
+void point_cloud::update_attribute_flags()
+{
+	if (N.size() > 0)
+		has_nmls = true;
+	else if (P.size() > 0)
+		has_nmls = false;
+
+	if (C.size() > 0)
+		has_clrs = true;
+	else if (P.size() > 0)
+		has_clrs = false;
+
+	if (T.size() > 0)
+		has_texcrds = true;
+	else if (P.size() > 0)
+		has_texcrds = false;
+
+	if (I.size() > 0)
+		has_pixcrds = true;
+	else if (P.size() > 0)
+		has_pixcrds = false;
+
+	if (has_comps = components.size() > 0) {
+		has_comp_clrs = component_colors.size() > 0;
+		has_comp_trans = component_rotations.size() > 0;
+		component_boxes.resize(get_nr_components());
+		component_pixel_ranges.resize(get_nr_components());
+		comp_box_out_of_date.resize(get_nr_components());
+		std::fill(comp_box_out_of_date.begin(), comp_box_out_of_date.end(), true);
+		comp_pixrng_out_of_date.resize(get_nr_components());
+		std::fill(comp_pixrng_out_of_date.begin(), comp_pixrng_out_of_date.end(), true);
+	}
+
+	box_out_of_date = true;
+	if (has_pixel_coordinates())
+		pixel_range_out_of_date = true;
+}
+
 bool point_cloud::read(const string& _file_name)
 {
 	string ext = to_lower(get_extension(_file_name));
@@ -487,44 +535,12 @@ bool point_cloud::read(const string& _file_name)
 		success = read_ply(_file_name);
 	if (ext == "txt")
 		success = read_txt(_file_name);
+	if (ext == "csv")
+		success = read_ascii_columns(_file_name, ext);
 	if (ext == "e57")
 		success = read_e57(_file_name);
-	if (success) {
-		if (N.size() > 0)
-			has_nmls = true;
-		else if (P.size() > 0)
-			has_nmls = false;
-
-		if (C.size() > 0)
-			has_clrs = true;
-		else if (P.size() > 0)
-			has_clrs = false;
-
-		if (T.size() > 0)
-			has_texcrds = true;
-		else if (P.size() > 0)
-			has_texcrds = false;
-
-		if (I.size() > 0)
-			has_pixcrds = true;
-		else if (P.size() > 0)
-			has_pixcrds = false;
-
-		if (has_comps = components.size() > 0) {
-			has_comp_clrs = component_colors.size() > 0;
-			has_comp_trans = component_rotations.size() > 0;
-			component_boxes.resize(get_nr_components());
-			component_pixel_ranges.resize(get_nr_components());
-			comp_box_out_of_date.resize(get_nr_components());
-			std::fill(comp_box_out_of_date.begin(), comp_box_out_of_date.end(), true);
-			comp_pixrng_out_of_date.resize(get_nr_components());
-			std::fill(comp_pixrng_out_of_date.begin(), comp_pixrng_out_of_date.end(), true);
-		}
-
-		box_out_of_date = true;
-		if (has_pixel_coordinates())
-			pixel_range_out_of_date = true;
-	}
+	if (success)
+		update_attribute_flags();
 	else {
 		cerr << "unknown extension <." << ext << ">." << endl;
 	}
@@ -683,155 +699,299 @@ bool point_cloud::write_component_transformations(const std::string& file_name,
 
 
 
-/// read ascii file with lines of the form i j x y z I, where ij are pixel coordinates, xyz coordinates and I the intensity
-bool point_cloud::read_pct(const std::string& file_name)
+point_cloud::ascii_layout::ascii_layout()
 {
-	string content;
-	// double time;
-	// {
-		// cgv::utils::stopwatch watch(&time);
-		if (!cgv::utils::file::read(file_name, content, true))
-			return false;
-		// std::cout << "read from disk in " << watch.get_elapsed_time() << " sec" << std::endl; watch.restart();
-		clear();
-		vector<line> lines;
-		split_to_lines(content, lines);
-		// std::cout << "split to " << lines.size() << " lines in " << watch.get_elapsed_time() << " sec" << std::endl; watch.restart();
-
-		bool do_parse = false;
-		for (unsigned li = 1; li < lines.size(); ++li) {
-			if (lines[li].empty())
-				continue;
-			Pnt p;
-			int i, j, Intensity;
-			char tmp = lines[li].end[0];
-			content[lines[li].end - content.c_str()] = 0;
-			sscanf(lines[li].begin, "%d %d %f %f %f %d", &i, &j, &p[2], &p[0], &p[1], &Intensity);
-			content[lines[li].end - content.c_str()] = tmp;
-			P.push_back(p);
-			C.push_back(Clr(byte_to_color_component(Intensity), byte_to_color_component(Intensity), byte_to_color_component(Intensity)));
-			I.push_back(PixCrd(i, j));
-
-			if ((P.size() % 100000) == 0)
-				cout << "read " << P.size() << " points" << endl;
-		}
-		// std::cout << "parsed in " << watch.get_elapsed_time() << " sec" << std::endl;
-	// }
-	return true;
+	nr_columns = 3;
+	pos_col[0] = 0;
+	pos_col[1] = 1;
+	pos_col[2] = 2;
+	nr_required_columns = 3;
+	nml_col = clr_col = gray_col = pix_col = -1;
+	color_scale = 1;
 }
 
+/// maximum number of columns considered in ascii files
+const unsigned max_nr_ascii_columns = 16;
 
-/// read ascii file with lines of the form x y z r g b I colors and intensity values, where intensity values are ignored
-bool point_cloud::read_xyz(const std::string& file_name)
+/// read up to max_nr_values numbers separated by blanks, commas or semicolons from a line and return their count
+static unsigned scan_ascii_values(const char* p, const char* e, double* values, unsigned max_nr_values)
 {
-	string content;
-	cgv::utils::stopwatch watch;
-	if (!cgv::utils::file::read(file_name, content, true))
-		return false;
-	std::cout << "read data from disk "; watch.add_time();
-	clear();
-	vector<line> lines;
-	split_to_lines(content, lines);
-	std::cout << "split data into " << lines.size() << " lines. ";	watch.add_time();
+	unsigned n = 0;
+	while (n < max_nr_values && scan_double(p, e, values[n])) {
+		++n;
+		while (p < e && (*p == ',' || *p == ';'))
+			++p;
+	}
+	return n;
+}
 
-	bool do_parse = false;
-	unsigned i;
-	for (i = 0; i<lines.size(); ++i) {
-		if (lines[i].empty())
-			continue;
+/// value statistics of a column collected during layout detection
+struct ascii_column_info
+{
+	bool all_integer = true;
+	double min_value = std::numeric_limits<double>::max();
+	double max_value = -std::numeric_limits<double>::max();
+	void add(double v)
+	{
+		if (v != floor(v))
+			all_integer = false;
+		min_value = std::min(min_value, v);
+		max_value = std::max(max_value, v);
+	}
+	bool is_byte() const { return all_integer && min_value >= 0 && max_value <= 255; }
+};
 
-		if (true) {
-			Pnt p;
-			int c[3], I;
-			char tmp = lines[i].end[0];
-			content[lines[i].end - content.c_str()] = 0;
-			sscanf(lines[i].begin, "%f %f %f %d %d %d %d", &p[0], &p[1], &p[2], c, c + 1, c + 2, &I);
-			content[lines[i].end - content.c_str()] = tmp;
-			P.push_back(p);
-			C.push_back(Clr(byte_to_color_component(c[0]), byte_to_color_component(c[1]), byte_to_color_component(c[2])));
+bool point_cloud::detect_ascii_layout(const char* begin, const char* end, ascii_layout& layout, const std::string& format_hint) const
+{
+	layout = ascii_layout();
+	if (format_hint == "pct") {
+		// i j z x y I, where the intensity is optional
+		layout.nr_columns = 6;
+		layout.nr_required_columns = 5;
+		layout.pix_col = 0;
+		layout.pos_col[0] = 3;
+		layout.pos_col[1] = 4;
+		layout.pos_col[2] = 2;
+		layout.gray_col = 5;
+		return true;
+	}
+	const unsigned max_nr_lines = 1000;
+	unsigned histogram[max_nr_ascii_columns + 1] = { 0 };
+	ascii_column_info columns[max_nr_ascii_columns];
+	bool unit_length = true;
+	line_iterator li(begin, end);
+	token l;
+	for (unsigned nr_lines = 0; nr_lines < max_nr_lines && li.next(l); ) {
+		double values[max_nr_ascii_columns];
+		unsigned n = scan_ascii_values(l.begin, l.end, values, max_nr_ascii_columns);
+		if (n < 3)
+			continue;
+		++histogram[n];
+		for (unsigned i = 0; i < n; ++i)
+			columns[i].add(values[i]);
+		if (n >= 6) {
+			double length = sqrt(values[3] * values[3] + values[4] * values[4] + values[5] * values[5]);
+			if (fabs(length - 1) > 0.01)
+				unit_length = false;
 		}
-		else {
-
-			vector<token> numbers;
-			tokenizer(lines[i]).bite_all(numbers);
-			double values[7];
-			unsigned n = min(7, (int)numbers.size());
-			unsigned j;
-			for (j = 0; j < n; ++j) {
-				if (!is_double(numbers[j].begin, numbers[j].end, values[j]))
-					break;
-			}
-			if (j >= 3)
-				P.push_back(Pnt((Crd)values[0], (Crd)values[1], (Crd)values[2]));
-			if (j >= 6)
-				C.push_back(Clr(float_to_color_component(values[3]), float_to_color_component(values[4]), float_to_color_component(values[5])));
+		++nr_lines;
+	}
+	// use most frequent number of columns
+	unsigned n = 3;
+	for (unsigned i = 3; i <= max_nr_ascii_columns; ++i)
+		if (histogram[i] > histogram[n])
+			n = i;
+	auto are_bytes = [&columns](unsigned first) {
+		return columns[first].is_byte() && columns[first + 1].is_byte() && columns[first + 2].is_byte();
+	};
+	auto color_scale = [&columns](unsigned first) {
+		double max_value = std::max(columns[first].max_value, std::max(columns[first + 1].max_value, columns[first + 2].max_value));
+		return max_value > 1 ? 1.0 : 255.0;
+	};
+	bool normals_expected = (format_hint == "points" || format_hint == "apc" || format_hint == "pnt") && !no_normals_contained;
+	if (n >= 9) {
+		layout.nr_columns = 9;
+		layout.nml_col = 3;
+		layout.clr_col = 6;
+		layout.color_scale = color_scale(6);
+	}
+	else if (n >= 7) {
+		// distinguish <x y z r g b I> from <x y z I r g b> by the value range of the intensity
+		bool rgb_i = are_bytes(3) && !columns[6].is_byte();
+		bool i_rgb = are_bytes(4) && !columns[3].is_byte();
+		layout.nr_columns = 7;
+		layout.clr_col = (i_rgb || (!rgb_i && format_hint == "txt")) ? 4 : 3;
+		layout.color_scale = color_scale(layout.clr_col);
+	}
+	else if (n == 6) {
+		if (!normals_expected && ((are_bytes(3) && color_scale(3) == 1) || no_normals_contained || !unit_length)) {
+			layout.clr_col = 3;
+			layout.color_scale = color_scale(3);
 		}
-		if ((P.size() % 100000) == 0)
-			cout << "read " << P.size() << " points" << endl;
+		else
+			layout.nml_col = 3;
+		layout.nr_columns = 6;
 	}
-	watch.add_time();
+	layout.nr_required_columns = layout.nr_columns;
 	return true;
 }
 
-/// read ascii file with lines of the form x y z I r g b intensity and color values, where intensity values are ignored
-bool point_cloud::read_txt(const std::string& file_name)
+/// parser of the lines of one chunk of an ascii file into preallocated attribute ranges
+struct ascii_point_chunk : public point_cloud_types
 {
-	string content;
-	cgv::utils::stopwatch watch;
-	if (!cgv::utils::file::read(file_name, content, true))
-		return false;
-	std::cout << "read data from disk "; watch.add_time();
-	clear();
-	vector<line> lines;
-	split_to_lines(content, lines);
-	std::cout << "split data into " << lines.size() << " lines. ";	watch.add_time();
-
-	bool do_parse = false;
-	unsigned i;
-	for (i = 0; i < lines.size(); ++i) {
-		if (lines[i].empty())
-			continue;
-
-		if (true) {
-			Pnt p;
-			int icol[3], iint;
-			double dcol[3];
-			char tmp = lines[i].end[0];
-			content[lines[i].end - content.c_str()] = 0;
-			if (sscanf(lines[i].begin, "%f %f %f %d %d %d %d", &p[0], &p[1], &p[2], &iint, icol, icol + 1, icol + 2) == 7) 
-			{
-				P.push_back(p);
-				C.push_back(Clr(byte_to_color_component(icol[0]), byte_to_color_component(icol[1]),
-								byte_to_color_component(icol[2])));
-			}
-			else if (sscanf(lines[i].begin, "%f %f %f %lf %lf %lf", &p[0], &p[1], &p[2], dcol, dcol + 1, dcol + 2) == 6) {
-				P.push_back(p);
-				C.push_back(Clr(float_to_color_component(dcol[0]), float_to_color_component(dcol[1]),
-								float_to_color_component(dcol[2])));
+	const char* begin;
+	const char* end;
+	/// upper bound of the number of points given by the number of lines
+	size_t nr_lines;
+	/// index of first point of chunk within the preallocated ranges
+	size_t offset;
+	/// number of valid lines that have been parsed into points
+	size_t nr_points;
+	/// count lines of chunk
+	void count_lines()
+	{
+		nr_lines = std::count(begin, end, '\n');
+		if (end > begin && end[-1] != '\n')
+			++nr_lines;
+	}
+	/// parse points into the given arrays starting at offset, where arrays of attributes not in the layout are null
+	void parse(const point_cloud::ascii_layout& layout, Pnt* P, Nml* N, Clr* C, PixCrd* I)
+	{
+		CGV_PROFILE_ZONE_CAT("point_cloud parse ascii chunk", "point_cloud");
+		line_iterator li(begin, end);
+		token l;
+		double v[max_nr_ascii_columns];
+		size_t i = offset;
+		while (li.next(l)) {
+			unsigned n = scan_ascii_values(l.begin, l.end, v, layout.nr_columns);
+			if (n < layout.nr_required_columns)
+				continue;
+			// optional columns default to zero
+			std::fill(v + n, v + layout.nr_columns, 0.0);
+			P[i] = Pnt(Crd(v[layout.pos_col[0]]), Crd(v[layout.pos_col[1]]), Crd(v[layout.pos_col[2]]));
+			if (layout.nml_col >= 0)
+				N[i] = Nml(Crd(v[layout.nml_col]), Crd(v[layout.nml_col + 1]), Crd(v[layout.nml_col + 2]));
+			if (layout.clr_col >= 0)
+				C[i] = Clr(to_color_component(v[layout.clr_col] * layout.color_scale),
+						   to_color_component(v[layout.clr_col + 1] * layout.color_scale),
+						   to_color_component(v[layout.clr_col + 2] * layout.color_scale));
+			if (layout.gray_col >= 0) {
+				ClrComp g = to_color_component(v[layout.gray_col]);
+				C[i] = Clr(g, g, g);
 			}
-			content[lines[i].end - content.c_str()] = tmp;
+			if (layout.pix_col >= 0)
+				I[i] = PixCrd(Idx(v[layout.pix_col]), Idx(v[layout.pix_col + 1]));
+			++i;
 		}
-		else {
-			vector<token> numbers;
-			tokenizer(lines[i]).bite_all(numbers);
-			double values[7];
-			unsigned n = min(7, (int)numbers.size());
-			unsigned j;
-			for (j = 0; j < n; ++j) {
-				if (!is_double(numbers[j].begin, numbers[j].end, values[j]))
-					break;
-			}
-			if (j >= 3)
-				P.push_back(Pnt((Crd)values[0], (Crd)values[1], (Crd)values[2]));
-			if (j >= 6)
-				C.push_back(Clr(float_to_color_component(values[3]), float_to_color_component(values[4]), float_to_color_component(values[5])));
+		nr_points = i - offset;
+	}
+	/// convert value in [0,255] to color component
+	static ClrComp to_color_component(double v)
+	{
+		return byte_to_color_component(cgv::type::uint8_type(std::min(std::max(v + 0.5, 0.0), 255.0)));
+	}
+};
+
+/// move the points of all chunks behind each other to close the gaps left by invalid lines and shrink the attribute vector
+template <typename T>
+static void compact_chunks(std::vector<T>& dst, size_t base, const std::vector<ascii_point_chunk>& chunks)
+{
+	size_t n = base;
+	for (const auto& c : chunks) {
+		if (base + c.offset != n)
+			std::copy(dst.begin() + (base + c.offset), dst.begin() + (base + c.offset + c.nr_points), dst.begin() + n);
+		n += c.nr_points;
+	}
+	dst.resize(n);
+}
+
+void point_cloud::parse_ascii_columns(const char* begin, const char* end, const ascii_layout& layout, size_t min_chunk_size, unsigned max_nr_chunks)
+{
+	CGV_PROFILE_ZONE_CAT("point_cloud parse ascii", "point_cloud");
+	// split text at line boundaries into one chunk per thread, but not below the minimum chunk size
+	size_t size = end - begin;
+	if (max_nr_chunks == 0)
+		max_nr_chunks = std::max(std::thread::hardware_concurrency(), 1u);
+	size_t nr_chunks = std::min(size_t(max_nr_chunks), size / std::max(min_chunk_size, size_t(1)) + 1);
+	std::vector<ascii_point_chunk> chunks(nr_chunks);
+	const char* p = begin;
+	for (size_t i = 0; i < nr_chunks; ++i) {
+		chunks[i].begin = p;
+		if (i + 1 < nr_chunks) {
+			const char* q = std::max(begin + (i + 1) * size / nr_chunks, p);
+			q = static_cast<const char*>(memchr(q, '\n', end - q));
+			p = q ? q + 1 : end;
 		}
-		if ((P.size() % 100000) == 0)
-			cout << "read " << P.size() << " points" << endl;
+		else
+			p = end;
+		chunks[i].end = p;
+	}
+	cgv::pointcloud::utility::WorkerPool pool(unsigned(nr_chunks - 1));
+	// count lines per chunk to allocate the attributes once and let each chunk parse into its own range
+	pool.run([&chunks](int thread_id) { chunks[thread_id].count_lines(); });
+	size_t nr_lines = 0;
+	for (auto& c : chunks) {
+		c.offset = nr_lines;
+		nr_lines += c.nr_lines;
+	}
+	size_t base_P = P.size(), base_N = N.size(), base_C = C.size(), base_I = I.size();
+	bool has_N = layout.nml_col >= 0, has_C = layout.clr_col >= 0 || layout.gray_col >= 0, has_I = layout.pix_col >= 0;
+	P.resize(base_P + nr_lines);
+	if (has_N)
+		N.resize(base_N + nr_lines);
+	if (has_C)
+		C.resize(base_C + nr_lines);
+	if (has_I)
+		I.resize(base_I + nr_lines);
+	Pnt* P_ptr = P.data() + base_P;
+	Nml* N_ptr = has_N ? N.data() + base_N : 0;
+	Clr* C_ptr = has_C ? C.data() + base_C : 0;
+	PixCrd* I_ptr = has_I ? I.data() + base_I : 0;
+	pool.run([&](int thread_id) { chunks[thread_id].parse(layout, P_ptr, N_ptr, C_ptr, I_ptr); });
+	compact_chunks(P, base_P, chunks);
+	if (has_N)
+		compact_chunks(N, base_N, chunks);
+	if (has_C)
+		compact_chunks(C, base_C, chunks);
+	if (has_I)
+		compact_chunks(I, base_I, chunks);
+}
+
+bool point_cloud::read_ascii_columns(const std::string& file_name, const std::string& format_hint, unsigned nr_header_lines, const std::string& data_marker)
+{
+	CGV_PROFILE_ZONE_CAT("point_cloud read ascii", "point_cloud");
+	// map file into memory and only fall back to reading it if this fails, e.g. for empty files
+	mapped_file mf;
+	std::string content;
+	const char* begin, *end;
+	if (mf.open(file_name)) {
+		mf.advise_sequential();
+		begin = reinterpret_cast<const char*>(mf.data());
+		end = begin + mf.size();
 	}
-	watch.add_time();
+	else {
+		if (!cgv::utils::file::read(file_name, content, true))
+			return false;
+		begin = content.data();
+		end = begin + content.size();
+	}
+	clear();
+	line_iterator li(begin, end);
+	token l;
+	for (unsigned i = 0; i < nr_header_lines && li.next(l); ++i)
+		;
+	if (!data_marker.empty()) {
+		do {
+			if (!li.next(l))
+				return true;
+			l.reverse_skip(" \t");
+		} while (!(l == data_marker));
+	}
+	begin = li.get_position();
+	ascii_layout layout;
+	if (!detect_ascii_layout(begin, end, layout, format_hint))
+		return false;
+	parse_ascii_columns(begin, end, layout);
 	return true;
 }
+
+/// read ascii file with lines of the form i j x y z I, where ij are pixel coordinates, xyz coordinates and I the intensity
+bool point_cloud::read_pct(const std::string& file_name)
+{
+	return read_ascii_columns(file_name, "pct", 1);
+}
+
+/// read ascii file with lines of the form x y z r g b I colors and intensity values, where intensity values are ignored
+bool point_cloud::read_xyz(const std::string& file_name)
+{
+	return read_ascii_columns(file_name, "xyz");
+}
+
+/// read ascii file with lines of the form x y z I r g b intensity and color values, where intensity values are ignored
+bool point_cloud::read_txt(const std::string& file_name)
+{
+	return read_ascii_columns(file_name, "txt");
+}
 /// read e57 file from leica scanner
 bool point_cloud::read_e57(const std::string& file_name) 
 {
@@ -840,45 +1000,9 @@ bool point_cloud::read_e57(const std::string& file_name)
 
 bool point_cloud::read_points(const std::string& file_name)
 {
-	string content;
-	if (!cgv::utils::file::read(file_name, content, true))
-		return false;
-	clear();
-	vector<line> lines;
-	split_to_lines(content, lines);
-	bool do_parse = false;
-	unsigned i;
-	for (i=0; i<lines.size(); ++i) {
-		if (do_parse) {
-			if (lines[i].empty())
-				continue;
-			vector<token> numbers;
-			tokenizer(lines[i]).bite_all(numbers);
-			double values[9];
-			unsigned n = min(9,(int)numbers.size());
-			unsigned j;
-			for (j=0; j<n; ++j) {
-				if (!is_double(numbers[j].begin, numbers[j].end, values[j]))
-					break;
-			}
-			if (j >= 3)
-				P.push_back(Pnt((Crd)values[0],(Crd)values[1],(Crd)values[2]));
-			if (j >= 6)
-				N.push_back(Nml((Crd)values[3],(Crd)values[4],(Crd)values[5]));
-			if (j >= 9)
-				C.push_back(Clr(float_to_color_component(values[6]), float_to_color_component(values[7]), float_to_color_component(values[8])));
-
-			if ( (P.size() % 10000) == 0)
-				cout << "read " << P.size() << " points" << endl;
-		}
-		if (lines[i] == "#Data:") {
-			do_parse = true;
-			cout << "starting to parse after line " << i << endl;
-		}
-	}
-	return true;
+	return read_ascii_columns(file_name, "points", 0, "#Data:");
 }
-
+
 bool point_cloud::read_wrl(const std::string& file_name)
 {
 	string content;
@@ -961,18 +1085,6 @@ bool point_cloud::read_wrl(const std::string& file_name)
 	return true;
 }
 
-enum BPCFlags
-{
-	BPC_HAS_CLRS = 1,
-	BPC_HAS_NMLS = 2,
-	BPC_HAS_TCS = 4,
-	BPC_HAS_PIXCRDS = 8,
-	BPC_HAS_COMPS = 16,
-	BPC_HAS_COMP_CLRS = 32,
-	BPC_HAS_COMP_TRANS = 64,
-	BPC_HAS_BYTE_CLRS = 128
-};
-
 enum LPCFlags
 {
 	LPC_HAS_CLRS = 1,
@@ -1107,6 +1219,8 @@ bool point_cloud::read_bin(const string& file_name)
 			flags += (m >= 2 * n) ? BPC_HAS_CLRS : 0;
 			if (flags & BPC_HAS_CLRS) {
 				m = m - 2 * n;
+				// files with the old header always store byte colors
+				flags += BPC_HAS_BYTE_CLRS;
 			}
 			flags += (m > 0) ? BPC_HAS_NMLS : 0;
 		}
@@ -1120,7 +1234,7 @@ bool point_cloud::read_bin(const string& file_name)
 			success = success && (fread(&N[0][0], sizeof(Nml), m, fp) == m);
 		}
 		if (flags & BPC_HAS_CLRS) {
-			bool byte_colors_in_file = !((flags & BPC_HAS_BYTE_CLRS) != 0);
+			bool byte_colors_in_file = (flags & BPC_HAS_BYTE_CLRS) != 0;
 #ifdef BYTE_COLORS
 			bool byte_colors_in_pc = true;
 #else
@@ -1168,8 +1282,8 @@ bool point_cloud::read_bin(const string& file_name)
 				success = success && fread(&components[0], sizeof(component_info), nr_comps, fp) == nr_comps;
 				component_indices.resize(n);
 				for (unsigned i = 0; i < nr_comps; ++i)
-					for (unsigned j = unsigned(components[i].index_of_first_point); j < components[i].index_of_first_point + components[i].nr_points; ++j)
-						component_indices[j] = i;
+					std::fill(component_indices.begin() + components[i].index_of_first_point,
+						component_indices.begin() + components[i].index_of_first_point + components[i].nr_points, i);
 				if (flags & BPC_HAS_COMP_CLRS) {
 					component_colors.resize(nr_comps);
 					success = success && fread(&component_colors[0], sizeof(RGBA), nr_comps, fp) == nr_comps;
@@ -1219,19 +1333,187 @@ static PlyProperty vert_props[] = { /* list of property information for a vertex
   {"intensity", Uint8, Uint8, offsetof(PlyVertex,red), 0, 0, 0, 0},
 };
 
-typedef struct PlyFace {
-  unsigned char nverts;
-  int *verts;
-} PlyFace;
+/// scalar property of a ply element as needed by the binary fast path
+struct ply_scalar_property
+{
+	std::string name;
+	int type;
+	size_t offset;
+};
 
-static PlyProperty face_props[] = { /* list of property information for a face */
-{"vertex_indices", Int32, Int32, offsetof(PlyFace,verts), 1, Uint8, Uint8, offsetof(PlyFace,nverts)},
-};
+/// return size of ply scalar type given by name or 0 if the name is not a scalar type; type is set to the corresponding ply type code
+static size_t get_ply_type_size(const std::string& name, int& type)
+{
+	static const char* names[] = { "int8", "int16", "int32", "uint8", "uint16", "uint32", "float32", "float64" };
+	static const char* old_names[] = { "char", "short", "int", "uchar", "ushort", "uint", "float", "double" };
+	static const int types[] = { Int8, Int16, Int32, Uint8, Uint16, Uint32, Float32, Float64 };
+	static const size_t sizes[] = { 1, 2, 4, 1, 2, 4, 4, 8 };
+	for (unsigned i = 0; i < 8; ++i)
+		if (name == names[i] || name == old_names[i]) {
+			type = types[i];
+			return sizes[i];
+		}
+	return 0;
+}
 
-static char* propNames[] = { "vertex", "face" };
+/// read a value of the given ply type from unaligned little endian memory
+static double get_ply_value(const char* ptr, int type)
+{
+	switch (type) {
+	case Int8: return *reinterpret_cast<const int8_t*>(ptr);
+	case Uint8: return *reinterpret_cast<const uint8_t*>(ptr);
+	case Int16: { int16_t v; memcpy(&v, ptr, 2); return v; }
+	case Uint16: { uint16_t v; memcpy(&v, ptr, 2); return v; }
+	case Int32: { int32_t v; memcpy(&v, ptr, 4); return v; }
+	case Uint32: { uint32_t v; memcpy(&v, ptr, 4); return v; }
+	case Float32: { float v; memcpy(&v, ptr, 4); return v; }
+	case Float64: { double v; memcpy(&v, ptr, 8); return v; }
+	}
+	return 0;
+}
+
+/// read three consecutive components at the given offsets into a vector, where three consecutive float32 values are copied at once
+template <typename V>
+static void get_ply_vector(const char* record, const ply_scalar_property* props[3], bool consecutive_floats, V& v)
+{
+	if (consecutive_floats)
+		memcpy(&v[0], record + props[0]->offset, 3 * sizeof(float));
+	else
+		for (unsigned c = 0; c < 3; ++c)
+			v[c] = typename V::value_type(get_ply_value(record + props[c]->offset, props[c]->type));
+}
+
+/// check whether the host stores numbers in little endian byte order
+static bool is_little_endian_host()
+{
+	const uint16_t one = 1;
+	return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+bool point_cloud::read_ply_fast(const std::string& file_name)
+{
+	if (!is_little_endian_host())
+		return false;
+	mapped_file mf;
+	if (!mf.open(file_name))
+		return false;
+	CGV_PROFILE_ZONE_CAT("point_cloud read binary ply", "point_cloud");
+	const char* begin = reinterpret_cast<const char*>(mf.data());
+	const char* end = begin + mf.size();
+	// parse header, which must describe a vertex element with scalar properties in binary little endian format
+	line_iterator li(begin, end);
+	token l;
+	if (!li.next(l) || !(l == "ply"))
+		return false;
+	bool little_endian = false, header_complete = false, in_vertex = false, vertex_read = false;
+	size_t nr_vertices = 0, stride = 0;
+	std::vector<ply_scalar_property> props;
+	while (!header_complete && li.next(l)) {
+		std::vector<token> toks;
+		tokenizer(l).bite_all(toks);
+		if (toks.empty() || toks[0] == "comment" || toks[0] == "obj_info")
+			continue;
+		if (toks[0] == "format")
+			little_endian = toks.size() > 1 && toks[1] == "binary_little_endian";
+		else if (toks[0] == "element") {
+			if (toks.size() != 3)
+				return false;
+			int n;
+			if (!is_integer(toks[2].begin, toks[2].end, n) || n < 0)
+				return false;
+			in_vertex = toks[1] == "vertex";
+			if (in_vertex) {
+				if (vertex_read)
+					return false;
+				vertex_read = true;
+				nr_vertices = n;
+			}
+			// only elements without instances may precede the vertex element
+			else if (!vertex_read && n > 0)
+				return false;
+		}
+		else if (toks[0] == "property") {
+			if (!in_vertex)
+				continue;
+			ply_scalar_property p;
+			size_t size;
+			if (toks.size() != 3 || (size = get_ply_type_size(to_string(toks[1]), p.type)) == 0)
+				return false;
+			p.name = to_string(toks[2]);
+			p.offset = stride;
+			stride += size;
+			props.push_back(p);
+		}
+		else if (toks[0] == "end_header")
+			header_complete = true;
+	}
+	if (!header_complete || !little_endian || !vertex_read || stride == 0)
+		return false;
+	const char* data = li.get_position();
+	if (size_t(end - data) / stride < nr_vertices)
+		return false;
+	// map property names to attributes
+	auto find = [&props](const char* name) -> const ply_scalar_property* {
+		for (const auto& p : props)
+			if (p.name == name)
+				return &p;
+		return 0;
+	};
+	const ply_scalar_property* pos[3] = { find("x"), find("y"), find("z") };
+	const ply_scalar_property* nml[3] = { find("nx"), find("ny"), find("nz") };
+	const ply_scalar_property* clr[3] = { find("red"), find("green"), find("blue") };
+	const ply_scalar_property* intensity = find("intensity");
+	if (!(pos[0] && pos[1] && pos[2])) {
+		std::cerr << "ply file " << file_name << " has no complete position property!" << std::endl;
+		return false;
+	}
+	auto are_consecutive = [](const ply_scalar_property* v[3], int type) {
+		return v[0]->type == type && v[1]->type == type && v[2]->type == type &&
+			v[1]->offset == v[0]->offset + 4 && v[2]->offset == v[1]->offset + 4;
+	};
+	bool read_nmls = nml[0] && nml[1] && nml[2];
+	bool read_clrs = clr[0] && clr[1] && clr[2];
+	bool read_intensity = !read_clrs && intensity != 0;
+	bool pos_floats = are_consecutive(pos, Float32);
+	bool nml_floats = read_nmls && are_consecutive(nml, Float32);
+	clear();
+	P.resize(nr_vertices);
+	if (read_nmls)
+		N.resize(nr_vertices);
+	if (read_clrs || read_intensity)
+		C.resize(nr_vertices);
+	has_nmls = read_nmls;
+	has_clrs = read_clrs || read_intensity;
+	// convert records in one vertex range per thread
+	auto convert = [&](size_t first, size_t last) {
+		const char* record = data + first * stride;
+		for (size_t i = first; i < last; ++i, record += stride) {
+			get_ply_vector(record, pos, pos_floats, P[i]);
+			if (read_nmls)
+				get_ply_vector(record, nml, nml_floats, N[i]);
+			if (read_clrs) {
+				for (unsigned c = 0; c < 3; ++c)
+					C[i][c] = clr[c]->type == Uint8 ?
+						byte_to_color_component(*reinterpret_cast<const uint8_t*>(record + clr[c]->offset)) :
+						float_to_color_component(get_ply_value(record + clr[c]->offset, clr[c]->type));
+			}
+			else if (read_intensity) {
+				ClrComp g = byte_to_color_component(cgv::type::uint8_type(get_ply_value(record + intensity->offset, intensity->type)));
+				C[i] = Clr(g, g, g);
+			}
+		}
+	};
+	const size_t min_chunk_size = 1 << 16;
+	size_t nr_chunks = std::min(size_t(std::max(std::thread::hardware_concurrency(), 1u)), nr_vertices / min_chunk_size + 1);
+	cgv::pointcloud::utility::WorkerPool pool(unsigned(nr_chunks - 1));
+	pool.run([&](int thread_id) { convert(thread_id * nr_vertices / nr_chunks, (thread_id + 1) * nr_vertices / nr_chunks); });
+	return true;
+}
 
 bool point_cloud::read_ply(const string& _file_name) 
 {
+	if (read_ply_fast(_file_name))
+		return true;
 	PlyFile* ply_in =  open_ply_for_read(const_cast<char*>(_file_name.c_str()));
 	if (!ply_in)
 		return false;
@@ -1312,52 +1594,52 @@ bool point_cloud::read_ply(const string& _file_name)
 
 bool point_cloud::write_ply(const std::string& file_name) const
 {
-	PlyFile* ply_out = open_ply_for_write(file_name.c_str(), 2, propNames, PLY_BINARY_LE);
-	if (!ply_out) 
-		return false;
-	describe_element_ply (ply_out, "vertex", (int)P.size());
-	for (int p=0; p<10; ++p) 
-		describe_property_ply (ply_out, &vert_props[p]);
-	describe_element_ply (ply_out, "face", 0);
-	describe_property_ply (ply_out, &face_props[0]);
-	header_complete_ply(ply_out);
-
-	put_element_setup_ply (ply_out, "vertex");
-
-	for (int j = 0; j < (int)P.size(); j++) {
-		PlyVertex vertex;
-		vertex.x = P[j][0];
-		vertex.y = P[j][1];
-		vertex.z = P[j][2];
-		if (N.size() == P.size()) {
-			vertex.nx = N[j][0];
-			vertex.ny = N[j][1];
-			vertex.nz = N[j][2];
-		}
-		else {
-			vertex.nx = 0.0f;
-			vertex.ny = 0.0f;
-			vertex.nz = 1.0f;
-		}
-		if (C.size() == P.size()) {
-			vertex.red = (unsigned char)(C[j][0]*255);
-			vertex.green = (unsigned char)(C[j][1]*255);
-			vertex.blue = (unsigned char)(C[j][2]*255);
-		}
-		else {
-			vertex.red   = 255;
-			vertex.green = 255;
-			vertex.blue  = 255;
-		}
-		vertex.alpha = 255;
-		put_element_ply(ply_out, (void *)&vertex);
+	CGV_PROFILE_ZONE_CAT("point_cloud write ply", "point_cloud");
+	if (!is_little_endian_host()) {
+		std::cerr << "write_ply only supported on little endian hosts" << std::endl;
+		return false;
 	}
-	put_element_setup_ply (ply_out, "face");
-	close_ply (ply_out);
-	free_ply (ply_out);
-	return true;
-}
-
+	FILE* fp = fopen(file_name.c_str(), "wb");
+	if (!fp)
+		return false;
+	bool write_nmls = N.size() == P.size();
+	bool write_clrs = C.size() == P.size();
+	std::ostringstream header;
+	header << "ply\nformat binary_little_endian 1.0\nelement vertex " << P.size() << "\n"
+		<< "property float32 x\nproperty float32 y\nproperty float32 z\n";
+	if (write_nmls)
+		header << "property float32 nx\nproperty float32 ny\nproperty float32 nz\n";
+	if (write_clrs)
+		header << "property uint8 red\nproperty uint8 green\nproperty uint8 blue\nproperty uint8 alpha\n";
+	header << "element face 0\nproperty list uint8 int32 vertex_indices\nend_header\n";
+	std::string h = header.str();
+	bool success = fwrite(h.data(), 1, h.size(), fp) == h.size();
+	// assemble records in a buffer of about 4MB that is written at once
+	size_t stride = 3 * sizeof(float) + (write_nmls ? 3 * sizeof(float) : 0) + (write_clrs ? 4 : 0);
+	size_t nr_buffer_records = (size_t(1) << 22) / stride;
+	std::vector<char> buffer(nr_buffer_records * stride);
+	for (size_t first = 0; success && first < P.size(); first += nr_buffer_records) {
+		size_t last = std::min(first + nr_buffer_records, P.size());
+		char* record = buffer.data();
+		for (size_t i = first; i < last; ++i) {
+			memcpy(record, &P[i][0], 3 * sizeof(float));
+			record += 3 * sizeof(float);
+			if (write_nmls) {
+				memcpy(record, &N[i][0], 3 * sizeof(float));
+				record += 3 * sizeof(float);
+			}
+			if (write_clrs) {
+				for (unsigned c = 0; c < 3; ++c)
+					*record++ = (char)color_component_to_byte(C[i][c]);
+				*record++ = (char)255;
+			}
+		}
+		size_t nr_bytes = record - buffer.data();
+		success = fwrite(buffer.data(), 1, nr_bytes, fp) == nr_bytes;
+	}
+	return fclose(fp) == 0 && success;
+}
+
 bool point_cloud::write_txt(const std::string& file_name) const
 {
 	/*if (!has_components())
@@ -1388,30 +1670,10 @@ bool point_cloud::write_e57(const std::string& file_name) const
 
 bool point_cloud::read_ascii(const string& file_name)
 {
-	ifstream is(file_name.c_str());
-	if (is.fail()) 
-		return false;
-	clear();
-	while (!is.eof()) {
-		char buffer[4096];
-		is.getline(buffer,4096);
-		float x, y, z, nx, ny, nz, r, g, b;
-		unsigned int n = sscanf(buffer, "%f %f %f %f %f %f %f %f %f", &x, &y, &z, &nx, &ny, &nz, &r, &g, &b);
-		if (n == 3 || n == 6 || n == 9)
-			P.push_back(Pnt(x,y,z));
-		if (n == 6) {
-			if (no_normals_contained)
-				C.push_back(Clr(float_to_color_component(nx), float_to_color_component(ny), float_to_color_component(nz)));
-			else
-				N.push_back(Nml(nx,ny,nz));
-		}
-		if (n == 9)
-			C.push_back(Clr(float_to_color_component(r), float_to_color_component(g), float_to_color_component(b)));
-	}
-	return true;
+	return read_ascii_columns(file_name, to_lower(get_extension(file_name)));
 }
 
-
+
 bool point_cloud::write_ascii(const std::string& file_name, bool write_nmls) const
 {
 	ofstream os(file_name.c_str());
@@ -109,6 +109,19 @@ public:
 };
 
 
+/// flags stored in the header of binary point cloud files (*.bpc) that tell which attributes follow the positions
+enum BPCFlags
+{
+	BPC_HAS_CLRS = 1,
+	BPC_HAS_NMLS = 2,
+	BPC_HAS_TCS = 4,
+	BPC_HAS_PIXCRDS = 8,
+	BPC_HAS_COMPS = 16,
+	BPC_HAS_COMP_CLRS = 32,
+	BPC_HAS_COMP_TRANS = 64,
+	BPC_HAS_BYTE_CLRS = 128
+};
+
 /** simple point cloud data structure with dynamic containers for positions, normals and colors. 
     Normals and colors are optional and can be dynamically allocated and deallocated. */
 class CGV_API point_cloud : public point_cloud_types
@@ -159,6 +172,7 @@ protected:
 	friend class point_cloud_viewer;
 	friend class gl_point_cloud_drawable;
 	friend class vr_rgbd;
+	friend class mapped_point_cloud;
 private:
 	mutable std::vector<bool> comp_box_out_of_date;
 	mutable std::vector<bool> comp_pixrng_out_of_date;
@@ -193,6 +207,8 @@ protected:
 	bool has_comp_trans;
 	/// flag that tells whether component colors are allocated
 	bool has_comp_clrs;
+	/// recompute attribute flags from container sizes and mark cached ranges out of date after containers have been filled directly
+	void update_attribute_flags();
 	/// read obj-file. Ignores all except of v, vn and vc lines. v lines can be extended by 3 rgb color components
 	bool read_obj(const std::string& file_name);
 	/// read ascii file with lines of the form x y z r g b I colors and intensity values, where intensity values are ignored
@@ -219,6 +235,8 @@ protected:
 	/*! Ignores all but the vertex elements and from the vertex elements the properties x,y,z,nx,ny,nz:Float32 and red,green,blue,alpha:Uint8.
 	    Colors are transformed to 32-bit floats in the range [0,1] and alpha components are ignored. */
 	bool read_ply(const std::string& file_name);
+	/// read binary little endian ply files whose first element is the vertex element with scalar properties directly from a memory mapping and return false for all other files
+	bool read_ply_fast(const std::string& file_name);
 	/// read txt file from leica scanner
 	bool read_txt(const std::string& file_name);
 	/// read e57 file from leica scanner
@@ -280,6 +298,44 @@ protected:
 
 	/**@name file io*/
 	//@{
+	/// column layout of ascii point cloud files with one point per line
+	struct ascii_layout
+	{
+		/// number of numeric columns needed to extract all attributes of a point
+		unsigned nr_columns;
+		/// minimum number of numeric columns of a valid line, where missing trailing columns are zero
+		unsigned nr_required_columns;
+		/// column indices of the x, y and z coordinates
+		int pos_col[3];
+		/// column index of the first normal component or -1
+		int nml_col;
+		/// column index of the first color component or -1
+		int clr_col;
+		/// column index of an intensity that is stored as gray color or -1
+		int gray_col;
+		/// column index of the first pixel coordinate or -1
+		int pix_col;
+		/// factor that maps color values to the range [0,255], i.e. 255 for colors in [0,1] and 1 for byte colors
+		double color_scale;
+		/// construct layout with positions in the first three columns
+		ascii_layout();
+	};
+	//! detect the column layout from the first lines of the given text
+	/*! Lines are analyzed with respect to the number of numeric columns and the value ranges of the columns.
+	    Supported are 3 columns <x y z>, 6 columns <x y z nx ny nz> or <x y z r g b>, 7 columns <x y z r g b I>
+		or <x y z I r g b> and 9 columns <x y z nx ny nz r g b>. Normals are distinguished from colors by their
+		unit length and the intensity column from the colors by its value range. If this is not decisive, the
+		format hint given as file extension is used. Columns can be separated by spaces, tabs, commas or semicolons.
+		Lines that do not start with three numbers are ignored. */
+	bool detect_ascii_layout(const char* begin, const char* end, ascii_layout& layout, const std::string& format_hint = "") const;
+	//! read ascii file with one point per line in parallel
+	/*! The file is memory mapped, split at line boundaries into one chunk per hardware thread and the chunks
+	    are parsed concurrently with the layout given by detect_ascii_layout directly into the attribute vectors,
+		which are allocated once for the number of lines. The first nr_header_lines lines
+		are skipped and if data_marker is not empty, only the lines after the first line matching data_marker are read. */
+	bool read_ascii_columns(const std::string& file_name, const std::string& format_hint = "", unsigned nr_header_lines = 0, const std::string& data_marker = "");
+	/// parse the lines of the given text in parallel with the given column layout and append the points, where the text is split into chunks of at least min_chunk_size bytes for at most max_nr_chunks threads or one thread per hardware thread if max_nr_chunks is 0
+	void parse_ascii_columns(const char* begin, const char* end, const ascii_layout& layout, size_t min_chunk_size = 1 << 20, unsigned max_nr_chunks = 0);
 	//! determine format from extension and read with corresponding read method 
 	/*! extension mapping:
 	    - read_ascii: *.pnt,*.apc
@@ -287,7 +343,8 @@ protected:
 		- read_ply:   *.ply
 		- read_obj:   *.obj
 		- read_points:*.points 
-		- read_txt:   *.txt*/
+		- read_txt:   *.txt
+		- read_ascii_columns: *.csv */
 	bool read(const std::string& file_name);
 	/// read component transformations from ascii file with 12 numbers per line (9 for rotation matrix and 3 for translation vector)
 	bool read_component_transformations(const std::string& file_name);
@@ -161,7 +161,10 @@ void point_cloud_interactable::build_neighbor_graph()
 	ng.clear();
 	ensure_tree_ds();
 	cgv::utils::statistics he_stats;
-	ng.build(pc.get_nr_points(), k, *tree_ds, &he_stats);
+	// distribute knn queries over all hardware threads, the calling thread also participates
+	if (!ng_pool)
+		ng_pool = std::make_unique<cgv::pointcloud::utility::WorkerPool>(std::max(std::thread::hardware_concurrency(), 1u) - 1);
+	ng.build(pc.get_nr_points(), k, *tree_ds, *ng_pool, &he_stats);
 	if (do_symmetrize)
 		ng.symmetrize();
 	on_point_cloud_change_callback(PCC_NEIGHBORGRAPH_CREATE);
@@ -390,6 +393,12 @@ bool point_cloud_interactable::self_reflect(cgv::reflect::reflection_handler& sr
 		srh.reflect_member("do_symmetrize", do_symmetrize) &&
 		srh.reflect_member("reorient_normals", reorient_normals);
 }
+
+/// all reflected members including the render styles have fixed addresses, such that properties are set through the reflection schema
+bool point_cloud_interactable::use_reflection_schema() const
+{
+	return true;
+}
 void point_cloud_interactable::stream_help(std::ostream& os)
 {
 	os << "PC: open (Ctrl-O), append (Ctrl-A), toggle <p>oints, <n>ormals, <b>ox, <g>graph, <i>llum" << std::endl;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <cgv/base/group.h>
 #include <cgv/gui/provider.h>
 #include <cgv/gui/event_handler.h>
@@ -131,6 +132,8 @@ protected:
 	bool do_symmetrize;
 	/// knn-neighbor graph built with tree_ds
 	neighbor_graph ng;
+	/// worker threads used to build the neighbor graph, created on first use and kept for later builds
+	std::unique_ptr<cgv::pointcloud::utility::WorkerPool> ng_pool;
 	/// build the neighbor graph
 	void build_neighbor_graph();
 	/// build the neighbor graph
@@ -170,6 +173,8 @@ public:
 	std::string get_type_name() const;
 	/// describe members
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// look up reflected members in the cached reflection schema
+	bool use_reflection_schema() const;
 	/// stream out textual statistical information shown with F8
 	void stream_stats(std::ostream&);
 	/// stream out textual help information shown with F1
@@ -0,0 +1,191 @@
+#include "point_depth_sorter.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+/// number of bits per radix sort digit, such that 32 bit keys are sorted in three passes
+const unsigned radix_bits = 11;
+const unsigned radix_size = 1 << radix_bits;
+
+point_depth_sorter::point_depth_sorter(int _nr_pool_threads)
+{
+	nr_pool_threads = _nr_pool_threads < 0 ? std::max(std::thread::hardware_concurrency(), 1u) - 1 : unsigned(_nr_pool_threads);
+	max_moves_per_point = 4.0f;
+	min_points_per_thread = 65536;
+	last_sort_incremental = false;
+}
+
+point_depth_sorter::~point_depth_sorter()
+{
+}
+
+unsigned point_depth_sorter::get_nr_threads(size_t n) const
+{
+	size_t nr_threads = n / std::max(min_points_per_thread, size_t(1));
+	return unsigned(std::max(size_t(1), std::min(nr_threads, size_t(nr_pool_threads) + 1)));
+}
+
+template <typename F>
+void point_depth_sorter::run(unsigned nr_threads, F f)
+{
+	if (nr_threads == 1) {
+		f(0u);
+		return;
+	}
+	if (!pool)
+		pool.reset(new cgv::pointcloud::utility::WorkerPool(nr_pool_threads));
+	pool->run([nr_threads, &f](int thread_id) {
+		if (unsigned(thread_id) < nr_threads)
+			f(unsigned(thread_id));
+	});
+}
+
+uint32_t point_depth_sorter::depth_to_key(Crd depth)
+{
+	uint32_t u;
+	std::memcpy(&u, &depth, sizeof(uint32_t));
+	// flip all bits of positive values and none of negative values to reverse the float order
+	return (u & 0x80000000u) ? u : (~u & 0x7fffffffu);
+}
+
+void point_depth_sorter::compute_keys(const Pnt* points, const uint32_t* indices, size_t n, const Dir& view_dir, unsigned nr_threads)
+{
+	keys.resize(n);
+	uint32_t* K = &keys[0];
+	run(nr_threads, [=, &view_dir](unsigned t) {
+		for (size_t i = n * t / nr_threads; i < n * (t + 1) / nr_threads; ++i)
+			K[i] = depth_to_key(dot(points[indices[i]], view_dir));
+	});
+}
+
+bool point_depth_sorter::insertion_sort(uint32_t* indices, size_t n, unsigned nr_threads)
+{
+	uint32_t* K = &keys[0];
+	// the budget grows with the number of processed points such that large view changes are detected early
+	const size_t slack = 1024;
+	size_t max_nr_moves = size_t(max_moves_per_point * n);
+	// first sort the range of each thread independently
+	std::atomic<bool> exceeded(false);
+	run(nr_threads, [&](unsigned t) {
+		size_t begin = n * t / nr_threads, end = n * (t + 1) / nr_threads;
+		size_t nr_moves = 0;
+		for (size_t j = begin + 1; j < end; ++j) {
+			uint32_t k = K[j];
+			if (k >= K[j - 1])
+				continue;
+			uint32_t idx = indices[j];
+			size_t i = j;
+			do {
+				K[i] = K[i - 1];
+				indices[i] = indices[i - 1];
+				--i;
+			} while (i > begin && K[i - 1] > k);
+			K[i] = k;
+			indices[i] = idx;
+			nr_moves += j - i;
+			if (nr_moves > max_moves_per_point * (j - begin + slack)) {
+				exceeded = true;
+				return;
+			}
+			if ((j & 1023) == 0 && exceeded)
+				return;
+		}
+	});
+	if (exceeded)
+		return false;
+	// then insert the elements at the start of each range that are smaller than the largest key in front of the range
+	size_t nr_moves = 0;
+	for (unsigned t = 1; t < nr_threads; ++t) {
+		size_t begin = n * t / nr_threads, end = n * (t + 1) / nr_threads;
+		for (size_t j = begin; j < end && K[j] < K[j - 1]; ++j) {
+			uint32_t k = K[j];
+			uint32_t idx = indices[j];
+			size_t i = j;
+			do {
+				K[i] = K[i - 1];
+				indices[i] = indices[i - 1];
+				--i;
+			} while (i > 0 && K[i - 1] > k);
+			K[i] = k;
+			indices[i] = idx;
+			nr_moves += j - i;
+			if (nr_moves > max_nr_moves)
+				return false;
+		}
+	}
+	return true;
+}
+
+void point_depth_sorter::radix_sort(std::vector<uint32_t>& indices, unsigned nr_threads)
+{
+	size_t n = keys.size();
+	tmp_keys.resize(n);
+	tmp_indices.resize(n);
+	histograms.resize(nr_threads * radix_size);
+	uint32_t* src_keys = &keys[0];
+	uint32_t* src_indices = &indices[0];
+	uint32_t* dst_keys = &tmp_keys[0];
+	uint32_t* dst_indices = &tmp_indices[0];
+	size_t* H = &histograms[0];
+	bool result_in_tmp = false;
+	for (unsigned shift = 0; shift < 32; shift += radix_bits) {
+		// per thread histograms of digit
+		run(nr_threads, [=](unsigned t) {
+			size_t* h = H + t * radix_size;
+			std::fill(h, h + radix_size, size_t(0));
+			for (size_t i = n * t / nr_threads; i < n * (t + 1) / nr_threads; ++i)
+				++h[(src_keys[i] >> shift) & (radix_size - 1)];
+		});
+		// skip pass if all keys share the same digit
+		bool skip = false;
+		for (unsigned d = 0; d < radix_size && !skip; ++d) {
+			size_t count = 0;
+			for (unsigned t = 0; t < nr_threads; ++t)
+				count += H[t * radix_size + d];
+			skip = count == n;
+		}
+		if (skip)
+			continue;
+		// convert histograms to start positions of digits per thread
+		size_t sum = 0;
+		for (unsigned d = 0; d < radix_size; ++d) {
+			for (unsigned t = 0; t < nr_threads; ++t) {
+				size_t count = H[t * radix_size + d];
+				H[t * radix_size + d] = sum;
+				sum += count;
+			}
+		}
+		// stable scatter
+		run(nr_threads, [=](unsigned t) {
+			size_t* h = H + t * radix_size;
+			for (size_t i = n * t / nr_threads; i < n * (t + 1) / nr_threads; ++i) {
+				size_t pos = h[(src_keys[i] >> shift) & (radix_size - 1)]++;
+				dst_keys[pos] = src_keys[i];
+				dst_indices[pos] = src_indices[i];
+			}
+		});
+		std::swap(src_keys, dst_keys);
+		std::swap(src_indices, dst_indices);
+		result_in_tmp = !result_in_tmp;
+	}
+	if (result_in_tmp) {
+		keys.swap(tmp_keys);
+		indices.swap(tmp_indices);
+	}
+}
+
+void point_depth_sorter::sort_back_to_front(const Pnt* points, std::vector<uint32_t>& indices, const Dir& view_dir, bool reuse_order)
+{
+	last_sort_incremental = false;
+	size_t n = indices.size();
+	if (n == 0)
+		return;
+	unsigned nr_threads = get_nr_threads(n);
+	compute_keys(points, &indices[0], n, view_dir, nr_threads);
+	if (reuse_order && insertion_sort(&indices[0], n, nr_threads)) {
+		last_sort_incremental = true;
+		return;
+	}
+	radix_sort(indices, nr_threads);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "point_cloud.h"
+#include "concurrency.h"
+
+#include "lib_begin.h"
+
+/** sorts point indices back to front along a view direction for blended rendering. Depth keys are computed once per
+    point and mapped to unsigned integers, which are sorted with a multithreaded least significant digit radix sort.
+	If the order of the previous frame is passed in again, the keys are recomputed in this order and the indices are
+	fixed up with an insertion sort, which is cheap for small view changes. If the fix up exceeds its budget of moves,
+	the radix sort is used instead. */
+class CGV_API point_depth_sorter : public point_cloud_types
+{
+protected:
+	/// number of threads used in addition to the calling thread
+	unsigned nr_pool_threads;
+	/// lazily constructed pool of worker threads
+	std::unique_ptr<cgv::pointcloud::utility::WorkerPool> pool;
+	/// depth keys in the order of the sorted indices
+	std::vector<uint32_t> keys;
+	/// ping pong buffers of radix sort
+	std::vector<uint32_t> tmp_keys, tmp_indices;
+	/// per thread histograms of radix sort
+	std::vector<size_t> histograms;
+	/// whether the last sort was done incrementally
+	bool last_sort_incremental;
+	/// number of participating threads for n elements
+	unsigned get_nr_threads(size_t n) const;
+	/// call f(t) for each participating thread t in [0,nr_threads)
+	template <typename F>
+	void run(unsigned nr_threads, F f);
+	/// compute keys of points in the order given by indices
+	void compute_keys(const Pnt* points, const uint32_t* indices, size_t n, const Dir& view_dir, unsigned nr_threads);
+	/// try to sort nearly sorted keys and indices with insertion sort and return false if budget was exceeded
+	bool insertion_sort(uint32_t* indices, size_t n, unsigned nr_threads);
+	/// sort keys and indices with least significant digit radix sort
+	void radix_sort(std::vector<uint32_t>& indices, unsigned nr_threads);
+public:
+	/// maximum number of element moves per point in incremental sorting before falling back to the radix sort
+	float max_moves_per_point;
+	/// minimum number of points processed by each thread
+	size_t min_points_per_thread;
+	/// construct with given number of threads used in addition to the calling thread, where -1 uses all hardware threads
+	point_depth_sorter(int _nr_pool_threads = -1);
+	/// destruct pool
+	~point_depth_sorter();
+	/// map depth to unsigned key, such that larger depths come first in ascending key order
+	static uint32_t depth_to_key(Crd depth);
+	/// sort indices into points such that dot(points[indices[i]], view_dir) is decreasing; if reuse_order is true, indices are assumed to be sorted for a similar view direction
+	void sort_back_to_front(const Pnt* points, std::vector<uint32_t>& indices, const Dir& view_dir, bool reuse_order = false);
+	/// return whether the last sort succeeded incrementally
+	bool was_last_sort_incremental() const { return last_sort_incremental; }
+};
+
+#include <cgv/config/lib_end.h>
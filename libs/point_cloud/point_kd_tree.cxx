@@ -0,0 +1,142 @@
+#include "point_kd_tree.h"
+#include <algorithm>
+
+void point_kd_tree::knn_candidates::insert(Idx i, Crd d)
+{
+	Cnt j;
+	if (count < k)
+		j = count++;
+	else if (d < sqr_dists[k - 1])
+		j = k - 1;
+	else
+		return;
+	while (j > 0 && sqr_dists[j - 1] > d) {
+		sqr_dists[j] = sqr_dists[j - 1];
+		indices[j] = indices[j - 1];
+		--j;
+	}
+	sqr_dists[j] = d;
+	indices[j] = i;
+}
+
+point_kd_tree::point_kd_tree(Cnt _bucket_size) : source(0), bucket_size(std::max(_bucket_size, Cnt(1)))
+{
+}
+
+void point_kd_tree::clear()
+{
+	nodes.clear();
+	points.clear();
+	indices.clear();
+	source = 0;
+}
+
+bool point_kd_tree::is_empty() const
+{
+	return nodes.empty();
+}
+
+void point_kd_tree::build(const point_cloud& pc)
+{
+	build(pc.get_nr_points() > 0 ? &pc.pnt(0) : 0, pc.get_nr_points());
+}
+
+void point_kd_tree::build(const Pnt* pnts, Cnt n)
+{
+	clear();
+	if (n == 0)
+		return;
+	source = pnts;
+	indices.resize(n);
+	for (Cnt i = 0; i < n; ++i)
+		indices[i] = Idx(i);
+	nodes.reserve(2 * (n / bucket_size + 1));
+	build_node(0, n);
+	// copy points in leaf order such that leaves are traversed linearly in memory
+	points.resize(n);
+	for (Cnt i = 0; i < n; ++i)
+		points[i] = source[indices[i]];
+}
+
+cgv::type::uint32_type point_kd_tree::build_node(Cnt begin, Cnt end)
+{
+	cgv::type::uint32_type ni = cgv::type::uint32_type(nodes.size());
+	nodes.push_back(node());
+	Cnt count = end - begin;
+	if (count <= bucket_size) {
+		node& leaf = nodes[ni];
+		leaf.split = 0;
+		leaf.axis = 3;
+		leaf.first = begin;
+		leaf.count = count;
+		return ni;
+	}
+	// split at median of axis with largest extent
+	Box box;
+	for (Cnt i = begin; i < end; ++i)
+		box.add_point(source[indices[i]]);
+	unsigned axis = box.get_max_extent_coord_index();
+	Cnt mid = begin + count / 2;
+	std::nth_element(indices.begin() + begin, indices.begin() + mid, indices.begin() + end,
+		[this, axis](Idx i, Idx j) { return source[i][axis] < source[j][axis]; });
+	nodes[ni].split = source[indices[mid]][axis];
+	nodes[ni].axis = axis;
+	nodes[ni].count = 0;
+	build_node(begin, mid);
+	// nodes can be reallocated during recursion, so only access by index
+	cgv::type::uint32_type right = build_node(mid, end);
+	nodes[ni].first = right;
+	return ni;
+}
+
+void point_kd_tree::search_knn(cgv::type::uint32_type ni, const Pnt& q, knn_candidates& candidates, Idx exclude) const
+{
+	const node& nd = nodes[ni];
+	if (nd.axis == 3) {
+		const Pnt* p = &points[nd.first];
+		const Idx* pi = &indices[nd.first];
+		for (Cnt j = 0; j < nd.count; ++j) {
+			Crd d = sqr_length(p[j] - q);
+			if (d < candidates.bound() && pi[j] != exclude)
+				candidates.insert(pi[j], d);
+		}
+		return;
+	}
+	Crd diff = q[nd.axis] - nd.split;
+	cgv::type::uint32_type near_child = diff < 0 ? ni + 1 : nd.first;
+	cgv::type::uint32_type far_child = diff < 0 ? nd.first : ni + 1;
+	search_knn(near_child, q, candidates, exclude);
+	if (diff * diff < candidates.bound())
+		search_knn(far_child, q, candidates, exclude);
+}
+
+void point_kd_tree::extract_neighbors(Idx i, Idx k, std::vector<Idx>& N) const
+{
+	if (is_empty() || k <= 0) {
+		N.clear();
+		return;
+	}
+	thread_local std::vector<Crd> dists;
+	N.resize(k);
+	dists.resize(k);
+	knn_candidates candidates = { &N[0], &dists[0], Cnt(k), 0 };
+	search_knn(0, source[i], candidates, i);
+	N.resize(candidates.count);
+}
+
+point_kd_tree::Cnt point_kd_tree::find_closest_points(const Pnt& p, Idx k, Idx* knn_indices, Crd* knn_sqr_dists) const
+{
+	if (is_empty() || k <= 0)
+		return 0;
+	knn_candidates candidates = { knn_indices, knn_sqr_dists, Cnt(k), 0 };
+	search_knn(0, p, candidates, -1);
+	return candidates.count;
+}
+
+point_kd_tree::Idx point_kd_tree::find_closest(const Pnt& p) const
+{
+	Idx i = -1;
+	Crd d;
+	find_closest_points(p, 1, &i, &d);
+	return i;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include "point_cloud.h"
+
+#include "lib_begin.h"
+
+/** native kd-tree over the positions of a point cloud that can be used instead of ann_tree to build a knn neighbor graph.
+    Points are copied into leaf order during construction such that all points of a leaf are contiguous in memory
+    and nodes are stored in depth first order in a single array. All queries are const and can be issued
+    concurrently from several threads. */
+class CGV_API point_kd_tree : public point_cloud_types
+{
+protected:
+	/// node of the kd-tree, the left child of an inner node directly follows it in the node array
+	struct node
+	{
+		/// splitting coordinate of inner nodes
+		Crd split;
+		/// splitting axis of inner nodes or 3 for leaves
+		cgv::type::uint32_type axis;
+		/// index of right child for inner nodes or index of first point for leaves
+		cgv::type::uint32_type first;
+		/// number of points of leaves
+		cgv::type::uint32_type count;
+	};
+	/// k nearest neighbor candidates sorted by increasing squared distance
+	struct knn_candidates
+	{
+		Idx* indices;
+		Crd* sqr_dists;
+		Cnt k;
+		Cnt count;
+		/// return squared distance that a new candidate needs to undercut
+		Crd bound() const { return count < k ? std::numeric_limits<Crd>::max() : sqr_dists[k - 1]; }
+		/// insert candidate if it is closer than the current k-th candidate
+		void insert(Idx i, Crd d);
+	};
+	/// nodes in depth first order
+	std::vector<node> nodes;
+	/// points in leaf order
+	std::vector<Pnt> points;
+	/// original point index of each point in leaf order
+	std::vector<Idx> indices;
+	/// points the tree was built from, used to look up query points in extract_neighbors
+	const Pnt* source;
+	/// maximum number of points per leaf
+	Cnt bucket_size;
+	/// recursively build subtree over indices[begin, end) and return its node index
+	cgv::type::uint32_type build_node(Cnt begin, Cnt end);
+	/// recursively collect k nearest neighbors to q in the subtree rooted at node ni, skipping the point with original index exclude
+	void search_knn(cgv::type::uint32_type ni, const Pnt& q, knn_candidates& candidates, Idx exclude) const;
+public:
+	/// construct empty tree with given maximum number of points per leaf
+	point_kd_tree(Cnt _bucket_size = 16);
+	/// clear the used memory
+	void clear();
+	/// check whether the tree has been built
+	bool is_empty() const;
+	/// build from complete point cloud
+	void build(const point_cloud& pc);
+	/// build from n points, which need to stay valid as long as extract_neighbors is used
+	void build(const Pnt* pnts, Cnt n);
+	/// provide necessary method for building a neighbor graph, the query point itself is not reported
+	void extract_neighbors(Idx i, Idx k, std::vector<Idx>& N) const;
+	/// find up to k nearest neighbors of p, store their indices and squared distances in increasing distance order and return the number of found neighbors
+	Cnt find_closest_points(const Pnt& p, Idx k, Idx* knn_indices, Crd* knn_sqr_dists) const;
+	/// addition query method to find the closest neighbor
+	Idx find_closest(const Pnt& p) const;
+};
+
+#include <cgv/config/lib_end.h>
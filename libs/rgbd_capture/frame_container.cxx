@@ -0,0 +1,443 @@
+#include "frame_container.h"
+#include <cstring>
+#include <iostream>
+
+#pragma warning(disable:4996)
+
+using namespace std;
+
+namespace rgbd {
+	/// magic string at the beginning of frame container files
+	static const char container_magic[8] = { 'c', 'g', 'v', '_', 'r', 'g', 'b', 'd' };
+	/// version of the container format
+	static const uint32_t container_version = 1;
+	/// compression schemes of frame records
+	enum ContainerCompression { CC_NONE, CC_DEPTH_DELTA_VARINT };
+
+	/// header written in front of the data of each frame
+	struct frame_record_header
+	{
+		uint32_t stream;
+		uint32_t protocol_index;
+		uint32_t compression;
+		uint32_t stored_size;
+		frame_info info;
+	};
+
+	/// copy frame info member by member such that padding bytes of a cleared destination stay zero
+	static void copy_frame_info(frame_info& dst, const frame_info& src)
+	{
+		dst.width = src.width;
+		dst.height = src.height;
+		dst.pixel_format = src.pixel_format;
+		dst.nr_bits_per_pixel = src.nr_bits_per_pixel;
+		dst.buffer_size = src.buffer_size;
+		dst.frame_index = src.frame_index;
+		dst.time = src.time;
+		dst.system_time_stamp = src.system_time_stamp;
+		dst.device_time_stamp = src.device_time_stamp;
+	}
+
+	/// copy emulator parameters member by member such that padding bytes of a cleared destination stay zero
+	static void copy_emulator_parameters(emulator_parameters& dst, const emulator_parameters& src)
+	{
+		dst.intrinsics.fx = src.intrinsics.fx;
+		dst.intrinsics.fy = src.intrinsics.fy;
+		dst.intrinsics.cx = src.intrinsics.cx;
+		dst.intrinsics.cy = src.intrinsics.cy;
+		dst.intrinsics.sk = src.intrinsics.sk;
+		dst.intrinsics.image_width = src.intrinsics.image_width;
+		dst.intrinsics.image_height = src.intrinsics.image_height;
+		dst.depth_scale = src.depth_scale;
+	}
+
+	static bool seek_file(FILE* fp, uint64_t pos)
+	{
+		return
+#ifdef _WIN32
+			_fseeki64
+#else
+			fseeko64
+#endif
+			(fp, pos, SEEK_SET) == 0;
+	}
+
+	static uint64_t tell_file(FILE* fp)
+	{
+		return
+#ifdef _WIN32
+			_ftelli64
+#else
+			ftello64
+#endif
+			(fp);
+	}
+
+	template <typename T>
+	static bool write_values(FILE* fp, const T* values, size_t n)
+	{
+		return fwrite(values, sizeof(T), n, fp) == n;
+	}
+
+	template <typename T>
+	static bool read_values(FILE* fp, T* values, size_t n)
+	{
+		return fread(values, sizeof(T), n, fp) == n;
+	}
+
+	/// check whether frame can be compressed with the depth codec
+	static bool is_compressible_depth(const frame_type& frame)
+	{
+		return (frame.pixel_format == PF_DEPTH || frame.pixel_format == PF_DEPTH_AND_PLAYER) &&
+			frame.nr_bits_per_pixel == 16 && frame.frame_data.size() % 2 == 0;
+	}
+
+	/// encode differences of successive 16 bit values as zigzag variable length integers, which needs one byte for smooth surfaces and invalid regions
+	static void encode_depth(const char* data, size_t size, vector<char>& encoded)
+	{
+		encoded.resize(size / 2 * 3);
+		const uint16_t* values = reinterpret_cast<const uint16_t*>(data);
+		uint8_t* dst = reinterpret_cast<uint8_t*>(encoded.data());
+		int prev = 0;
+		for (size_t i = 0; i < size / 2; ++i) {
+			int d = int(values[i]) - prev;
+			prev = values[i];
+			uint32_t z = (uint32_t(d) << 1) ^ uint32_t(d >> 31);
+			while (z >= 0x80) {
+				*dst++ = uint8_t(z | 0x80);
+				z >>= 7;
+			}
+			*dst++ = uint8_t(z);
+		}
+		encoded.resize(dst - reinterpret_cast<uint8_t*>(encoded.data()));
+	}
+
+	/// inverse of encode_depth, return false on corrupt data
+	static bool decode_depth(const char* encoded, size_t encoded_size, char* data, size_t size)
+	{
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(encoded), *e = p + encoded_size;
+		uint16_t* values = reinterpret_cast<uint16_t*>(data);
+		int prev = 0;
+		for (size_t i = 0; i < size / 2; ++i) {
+			uint32_t z = 0;
+			unsigned shift = 0;
+			do {
+				if (p == e || shift > 28)
+					return false;
+				z |= uint32_t(*p & 0x7F) << shift;
+				shift += 7;
+			} while (*p++ & 0x80);
+			prev += int(z >> 1) ^ -int(z & 1);
+			values[i] = uint16_t(prev);
+		}
+		return p == e;
+	}
+
+	frame_container_writer::frame_container_writer()
+	{
+		fp = 0;
+	}
+
+	frame_container_writer::~frame_container_writer()
+	{
+		if (fp)
+			close();
+	}
+
+	bool frame_container_writer::open(const std::string& file_name, const std::vector<stream_format>& streams, const emulator_parameters* parameters_ptr)
+	{
+		if (fp)
+			close();
+		fp = fopen(file_name.c_str(), "wb");
+		if (!fp) {
+			cerr << "frame_container_writer::open: could not open " << file_name << endl;
+			return false;
+		}
+		index.clear();
+		uint32_t nr_streams = (uint32_t)streams.size();
+		uint32_t has_parameters = parameters_ptr ? 1 : 0;
+		// clear padding bytes before structures are written as a whole
+		emulator_parameters parameters;
+		memset(&parameters, 0, sizeof(emulator_parameters));
+		if (parameters_ptr)
+			copy_emulator_parameters(parameters, *parameters_ptr);
+		uint64_t index_offset = 0;
+		if (!write_values(fp, container_magic, 8) ||
+			!write_values(fp, &container_version, 1) ||
+			!write_values(fp, &nr_streams, 1) ||
+			!write_values(fp, streams.data(), streams.size()) ||
+			!write_values(fp, &has_parameters, 1) ||
+			!write_values(fp, &parameters, 1)) {
+			fclose(fp);
+			fp = 0;
+			return false;
+		}
+		index_offset_position = tell_file(fp);
+		if (!write_values(fp, &index_offset, 1)) {
+			fclose(fp);
+			fp = 0;
+			return false;
+		}
+		return true;
+	}
+
+	bool frame_container_writer::is_open() const
+	{
+		return fp != 0;
+	}
+
+	bool frame_container_writer::write_frame(uint32_t stream, uint32_t protocol_index, const frame_type& frame, bool compress_depth)
+	{
+		if (!fp)
+			return false;
+		frame_record_header rh;
+		memset(&rh, 0, sizeof(frame_record_header));
+		rh.stream = stream;
+		rh.protocol_index = protocol_index;
+		rh.compression = CC_NONE;
+		copy_frame_info(rh.info, frame);
+		rh.info.buffer_size = (unsigned)frame.frame_data.size();
+		const char* data = frame.frame_data.data();
+		size_t size = frame.frame_data.size();
+		if (compress_depth && is_compressible_depth(frame)) {
+			encode_depth(data, size, encoded_data);
+			if (encoded_data.size() < size) {
+				rh.compression = CC_DEPTH_DELTA_VARINT;
+				data = encoded_data.data();
+				size = encoded_data.size();
+			}
+		}
+		rh.stored_size = (uint32_t)size;
+		frame_container_entry entry;
+		memset(&entry, 0, sizeof(frame_container_entry));
+		entry.offset = tell_file(fp);
+		entry.stream = stream;
+		entry.protocol_index = protocol_index;
+		entry.time = frame.time;
+		if (!write_values(fp, &rh, 1) || !write_values(fp, data, size)) {
+			cerr << "frame_container_writer::write_frame: could not write frame " << protocol_index << endl;
+			return false;
+		}
+		index.push_back(entry);
+		return true;
+	}
+
+	bool frame_container_writer::close()
+	{
+		if (!fp)
+			return false;
+		uint64_t index_offset = tell_file(fp);
+		uint64_t nr_entries = index.size();
+		bool success =
+			write_values(fp, &nr_entries, 1) &&
+			write_values(fp, index.data(), index.size()) &&
+			seek_file(fp, index_offset_position) &&
+			write_values(fp, &index_offset, 1);
+		if (fclose(fp) != 0)
+			success = false;
+		fp = 0;
+		index.clear();
+		return success;
+	}
+
+	frame_container_reader::frame_container_reader()
+	{
+		fp = 0;
+		has_params = false;
+	}
+
+	frame_container_reader::~frame_container_reader()
+	{
+		close();
+	}
+
+	bool frame_container_reader::open(const std::string& file_name)
+	{
+		close();
+		fp = fopen(file_name.c_str(), "rb");
+		if (!fp)
+			return false;
+		char magic[8];
+		uint32_t version, nr_streams, has_parameters;
+		uint64_t index_offset;
+		if (!read_values(fp, magic, 8) || memcmp(magic, container_magic, 8) != 0 ||
+			!read_values(fp, &version, 1) || version != container_version ||
+			!read_values(fp, &nr_streams, 1)) {
+			cerr << "frame_container_reader::open: " << file_name << " is no frame container" << endl;
+			close();
+			return false;
+		}
+		streams.resize(nr_streams);
+		if (!read_values(fp, streams.data(), streams.size()) ||
+			!read_values(fp, &has_parameters, 1) ||
+			!read_values(fp, &parameters, 1) ||
+			!read_values(fp, &index_offset, 1)) {
+			cerr << "frame_container_reader::open: could not read header of " << file_name << endl;
+			close();
+			return false;
+		}
+		has_params = has_parameters != 0;
+		uint64_t records_offset = tell_file(fp);
+		uint64_t nr_entries;
+		if (index_offset != 0 && seek_file(fp, index_offset) && read_values(fp, &nr_entries, 1)) {
+			index.resize(nr_entries);
+			if (read_values(fp, index.data(), index.size()))
+				return true;
+		}
+		// recording has not been closed properly
+		index.clear();
+		return scan_records(records_offset);
+	}
+
+	bool frame_container_reader::scan_records(uint64_t offset)
+	{
+		frame_record_header rh;
+		while (seek_file(fp, offset) && read_values(fp, &rh, 1)) {
+			frame_container_entry entry;
+			entry.offset = offset;
+			entry.stream = rh.stream;
+			entry.protocol_index = rh.protocol_index;
+			entry.time = rh.info.time;
+			offset += sizeof(frame_record_header) + rh.stored_size;
+			// skip truncated last record
+			if (!seek_file(fp, offset - 1) || fgetc(fp) == EOF)
+				break;
+			index.push_back(entry);
+		}
+		return true;
+	}
+
+	bool frame_container_reader::is_open() const
+	{
+		return fp != 0;
+	}
+
+	void frame_container_reader::close()
+	{
+		if (fp) {
+			fclose(fp);
+			fp = 0;
+		}
+		streams.clear();
+		index.clear();
+		has_params = false;
+	}
+
+	bool frame_container_reader::read_frame(size_t i, frame_type& frame)
+	{
+		if (!fp || i >= index.size())
+			return false;
+		frame_record_header rh;
+		if (!seek_file(fp, index[i].offset) || !read_values(fp, &rh, 1))
+			return false;
+		static_cast<frame_info&>(frame) = rh.info;
+		frame.frame_data.resize(rh.info.buffer_size);
+		if (rh.compression == CC_NONE)
+			return rh.stored_size == rh.info.buffer_size && read_values(fp, frame.frame_data.data(), frame.frame_data.size());
+		encoded_data.resize(rh.stored_size);
+		return rh.compression == CC_DEPTH_DELTA_VARINT &&
+			read_values(fp, encoded_data.data(), encoded_data.size()) &&
+			decode_depth(encoded_data.data(), encoded_data.size(), frame.frame_data.data(), frame.frame_data.size());
+	}
+
+	frame_recorder::frame_recorder()
+	{
+		queue_capacity = 16;
+		nr_dropped_frames = 0;
+		compress_depth = true;
+		stop_requested = false;
+		write_failed = false;
+	}
+
+	frame_recorder::~frame_recorder()
+	{
+		stop();
+		for (job* j : free_jobs)
+			delete j;
+	}
+
+	bool frame_recorder::start(const std::string& file_name, const std::vector<stream_format>& streams, const emulator_parameters* parameters_ptr,
+		size_t _queue_capacity, bool _compress_depth)
+	{
+		stop();
+		if (!writer.open(file_name, streams, parameters_ptr))
+			return false;
+		queue_capacity = _queue_capacity;
+		compress_depth = _compress_depth;
+		nr_dropped_frames = 0;
+		stop_requested = false;
+		write_failed = false;
+		writer_thread = std::thread(&frame_recorder::write_loop, this);
+		return true;
+	}
+
+	bool frame_recorder::is_started() const
+	{
+		return writer_thread.joinable();
+	}
+
+	bool frame_recorder::push_frame(uint32_t stream, uint32_t protocol_index, const frame_type& frame)
+	{
+		job* j = 0;
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			if (!writer_thread.joinable())
+				return false;
+			if (queue.size() >= queue_capacity) {
+				++nr_dropped_frames;
+				return false;
+			}
+			if (free_jobs.empty())
+				j = new job;
+			else {
+				j = free_jobs.back();
+				free_jobs.pop_back();
+			}
+		}
+		// copy outside of lock, assign reuses the capacity of recycled buffers
+		j->stream = stream;
+		j->protocol_index = protocol_index;
+		static_cast<frame_info&>(j->frame) = frame;
+		j->frame.frame_data.assign(frame.frame_data.begin(), frame.frame_data.end());
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			queue.push_back(j);
+		}
+		cv.notify_one();
+		return true;
+	}
+
+	void frame_recorder::write_loop()
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		while (true) {
+			cv.wait(lock, [this] { return stop_requested || !queue.empty(); });
+			if (queue.empty())
+				break;
+			job* j = queue.front();
+			queue.pop_front();
+			lock.unlock();
+			bool success = writer.write_frame(j->stream, j->protocol_index, j->frame, compress_depth);
+			lock.lock();
+			if (!success)
+				write_failed = true;
+			free_jobs.push_back(j);
+		}
+	}
+
+	bool frame_recorder::stop()
+	{
+		if (!writer_thread.joinable())
+			return true;
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			stop_requested = true;
+		}
+		cv.notify_one();
+		writer_thread.join();
+		bool success = writer.close() && !write_failed;
+		if (nr_dropped_frames > 0)
+			cerr << "frame_recorder::stop: dropped " << nr_dropped_frames << " frames due to full queue" << endl;
+		return success;
+	}
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "rgbd_device.h"
+#include <cstdio>
+#include <cstdint>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "lib_begin.h"
+
+namespace rgbd {
+	/// flag or-ed to the stream of a container entry to mark color frames warped to the depth image
+	const uint32_t CONTAINER_WARPED_FLAG = 0x100;
+
+	/// index entry of a frame stored in a frame container file
+	struct frame_container_entry
+	{
+		/// file offset of the frame record
+		uint64_t offset;
+		/// input stream of the frame, optionally or-ed with CONTAINER_WARPED_FLAG
+		uint32_t stream;
+		/// protocol index of the frame, which is shared by a color frame and its warped version
+		uint32_t protocol_index;
+		/// time stamp of the frame
+		double time;
+	};
+
+	/** writer for frame container files, which store all frames of a protocol in one append-only file.
+	    The file starts with the stream formats and emulator parameters followed by one record per frame.
+		On close an index of all frames is appended; files of interrupted recordings stay readable
+		as the reader rebuilds the index by scanning the records. Depth frames with 16 bits per pixel
+		can optionally be compressed losslessly by delta and variable length encoding. */
+	class CGV_API frame_container_writer
+	{
+	protected:
+		FILE* fp;
+		/// file position of the index offset in the file header
+		uint64_t index_offset_position;
+		std::vector<frame_container_entry> index;
+		std::vector<char> encoded_data;
+	public:
+		///
+		frame_container_writer();
+		/// close file if still open
+		~frame_container_writer();
+		/// create container file for the given streams and optional emulator parameters
+		bool open(const std::string& file_name, const std::vector<stream_format>& streams, const emulator_parameters* parameters_ptr = 0);
+		/// return whether file is open
+		bool is_open() const;
+		/// append a frame of the given stream
+		bool write_frame(uint32_t stream, uint32_t protocol_index, const frame_type& frame, bool compress_depth = true);
+		/// append index and close file
+		bool close();
+	};
+
+	/// random access reader for frame container files
+	class CGV_API frame_container_reader
+	{
+	protected:
+		FILE* fp;
+		std::vector<stream_format> streams;
+		bool has_params;
+		emulator_parameters parameters;
+		std::vector<frame_container_entry> index;
+		std::vector<char> encoded_data;
+		/// rebuild index of a file without index by scanning all records
+		bool scan_records(uint64_t offset);
+	public:
+		///
+		frame_container_reader();
+		/// close file
+		~frame_container_reader();
+		/// open container file and read or reconstruct the frame index
+		bool open(const std::string& file_name);
+		///
+		bool is_open() const;
+		///
+		void close();
+		/// return the recorded stream formats
+		const std::vector<stream_format>& get_stream_formats() const { return streams; }
+		/// return whether emulator parameters have been recorded
+		bool has_parameters() const { return has_params; }
+		/// return recorded emulator parameters
+		const emulator_parameters& get_parameters() const { return parameters; }
+		/// return the number of frames in all streams
+		size_t get_nr_frames() const { return index.size(); }
+		/// return the index entry of the i-th frame
+		const frame_container_entry& get_entry(size_t i) const { return index[i]; }
+		/// read and decompress the i-th frame
+		bool read_frame(size_t i, frame_type& frame);
+	};
+
+	/** asynchronous frame recorder that copies frames into a bounded queue from which a writer thread
+	    appends them to a frame container file. Frame buffers are recycled such that recording does
+		not allocate after the first frames. If the queue is full, push_frame drops the frame and returns
+		false instead of stalling the capture thread. */
+	class CGV_API frame_recorder
+	{
+	protected:
+		/// queued frame together with its container meta data
+		struct job
+		{
+			uint32_t stream;
+			uint32_t protocol_index;
+			frame_type frame;
+		};
+		frame_container_writer writer;
+		std::thread writer_thread;
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::deque<job*> queue;
+		std::vector<job*> free_jobs;
+		size_t queue_capacity;
+		/// incremented under the lock but atomic such that it can be queried from other threads
+		std::atomic<size_t> nr_dropped_frames;
+		bool compress_depth;
+		bool stop_requested;
+		bool write_failed;
+		/// writer thread function
+		void write_loop();
+	public:
+		///
+		frame_recorder();
+		/// stop recording and free buffers
+		~frame_recorder();
+		/// open container file and start writer thread
+		bool start(const std::string& file_name, const std::vector<stream_format>& streams, const emulator_parameters* parameters_ptr = 0,
+			size_t _queue_capacity = 16, bool _compress_depth = true);
+		/// return whether recorder has been started
+		bool is_started() const;
+		/// enqueue a copy of the frame, return false if frame has been dropped
+		bool push_frame(uint32_t stream, uint32_t protocol_index, const frame_type& frame);
+		/// write all queued frames, append index and close file; return false if a write failed
+		bool stop();
+		/// return number of frames dropped due to a full queue
+		size_t get_nr_dropped_frames() const { return nr_dropped_frames.load(); }
+	};
+}
+
+#include <cgv/config/lib_end.h>
@@ -35,10 +35,25 @@ namespace rgbd {
 		return false;
 	}
 
+	/// return the position of a stream in the per stream container frame lists or -1 if not supported
+	static int get_container_stream_index(uint32_t stream)
+	{
+		switch (stream) {
+		case IS_COLOR: return 0;
+		case IS_DEPTH: return 1;
+		case IS_INFRARED: return 2;
+		case IS_MESH: return 3;
+		default: return -1;
+		}
+	}
+
 	rgbd_emulation::rgbd_emulation(const std::string& fn):device_is_running(false)
 	{
 		path_name = fn;
 		flags = idx = 0;
+		replay_speed = 1;
+		next_warped_container_frame = size_t(-1);
+		std::fill(container_cursor, container_cursor + 4, 0);
 		//init frame timers
 		last_color_frame_time = 0;
 		last_depth_frame_time = 0;
@@ -56,18 +71,45 @@ namespace rgbd {
 		has_ir_stream = find_stream_info(path_name, ir_exts, ir_stream);
 		has_mesh_stream = find_stream_info(path_name, mesh_exts, mesh_stream);
 
-		//find first frame file
-		void* file = cgv::utils::file::find_first(path_name + "/kinect_*");
-		
-		if (file == nullptr) {
-			cerr << "rgbd_emulation::rgbd_emulation: no frame files found for the prefix:" << fn << endl;
+		//prefer frame container of asynchronous protocols
+		string container_file_name = rgbd_input::get_protocol_container_file_name(path_name);
+		if (cgv::utils::file::exists(container_file_name) && container.open(container_file_name)) {
+			for (const stream_format& sf : container.get_stream_formats()) {
+				switch (sf.pixel_format) {
+				case PF_I: ir_stream = sf; has_ir_stream = true; break;
+				case PF_DEPTH:
+				case PF_DEPTH_AND_PLAYER: depth_stream = sf; has_depth_stream = true; break;
+				case PF_POINTS_AND_TRIANGLES: mesh_stream = sf; has_mesh_stream = true; break;
+				case PF_CONFIDENCE: break;
+				default: color_stream = sf; has_color_stream = true; break;
+				}
+			}
+			for (size_t i = 0; i < container.get_nr_frames(); ++i) {
+				const frame_container_entry& entry = container.get_entry(i);
+				if ((entry.stream & CONTAINER_WARPED_FLAG) != 0)
+					container_warped_frames[entry.protocol_index] = i;
+				else {
+					int si = get_container_stream_index(entry.stream);
+					if (si != -1)
+						container_frames[si].push_back(i);
+				}
+			}
+			number_of_files = container.get_nr_frames();
 		}
-		size_t file_count = 0;
-		while(file != nullptr) {
-			++file_count;
-			file = cgv::utils::file::find_next(file);
+		else {
+			//find first frame file
+			void* file = cgv::utils::file::find_first(path_name + "/kinect_*");
+
+			if (file == nullptr) {
+				cerr << "rgbd_emulation::rgbd_emulation: no frame files found for the prefix:" << fn << endl;
+			}
+			size_t file_count = 0;
+			while(file != nullptr) {
+				++file_count;
+				file = cgv::utils::file::find_next(file);
+			}
+			number_of_files = file_count;
 		}
-		number_of_files = file_count;
 		
 		//find camera parameters
 		static emulator_parameters default_intrinsics;
@@ -91,7 +133,8 @@ namespace rgbd {
 		} else {
 			parameters = default_intrinsics;
 		}
-
+		if (container.is_open() && container.has_parameters())
+			parameters = container.get_parameters();
 	}
 
 	bool rgbd_emulation::attach(const std::string& fn)
@@ -303,7 +346,7 @@ namespace rgbd {
 			return false;
 		}
 
-		double inv_fps = 1000.f / stream->fps;
+		double inv_fps = replay_speed > 0 ? 1000.0 / (stream->fps * replay_speed) : 0.0;
 		double current_frame_time = (double)chrono::duration_cast<milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
 		
 		//limit fps
@@ -312,6 +355,13 @@ namespace rgbd {
 		}
 		*last_frame_time = current_frame_time;
 
+		if (container.is_open()) {
+			if (!get_container_frame(is, frame))
+				return false;
+			frame.time = current_frame_time;
+			return true;
+		}
+
 		//check index
 		if (idx >= number_of_files) idx = 0;
 		frame.frame_index = idx;
@@ -349,9 +399,36 @@ namespace rgbd {
 		return true;
 	}
 
+	bool rgbd_emulation::get_container_frame(InputStreams is, frame_type& frame)
+	{
+		int si = get_container_stream_index(is);
+		if (si == -1 || container_frames[si].empty())
+			return false;
+		size_t& cursor = container_cursor[si];
+		if (cursor >= container_frames[si].size())
+			cursor = 0;
+		size_t fi = container_frames[si][cursor];
+		if (!container.read_frame(fi, frame)) {
+			cerr << "rgbd_emulation: could not read frame " << fi << " from frame container" << endl;
+			return false;
+		}
+		frame.frame_index = (unsigned)cursor;
+		++cursor;
+		if (is == IS_COLOR) {
+			auto it = container_warped_frames.find(container.get_entry(fi).protocol_index);
+			next_warped_container_frame = it == container_warped_frames.end() ? size_t(-1) : it->second;
+		}
+		return true;
+	}
+
 	void rgbd_emulation::map_color_to_depth(const frame_type& depth_frame, const frame_type& color_frame,
 		frame_type& warped_color_frame) const
 	{
+		if (container.is_open()) {
+			if (next_warped_container_frame == size_t(-1) || !container.read_frame(next_warped_container_frame, warped_color_frame))
+				std::cerr << "map_color_to_depth() no warped frames saved" << std::endl;
+			return;
+		}
 		if (next_warped_file_name.empty()) {
 			std::cerr << "map_color_to_depth() no warped frames saved" << std::endl;
 			return;
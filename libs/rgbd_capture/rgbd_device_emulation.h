@@ -1,5 +1,7 @@
 #include "rgbd_device.h"
+#include "frame_container.h"
 #include <chrono>
+#include <map>
 
 using namespace std;
 
@@ -13,6 +15,8 @@ public:
 	mutable string next_warped_file_name;
 	unsigned idx;
 	unsigned flags;
+	/// factor applied to the recorded frame rates during replay, 0 replays as fast as possible
+	double replay_speed;
 
 
 	/*fn : filename prefix of the files used to create an instance of the emulator
@@ -56,6 +60,19 @@ private:
 	//frame_type next_color_frame, next_depth_frame, next_ir_frame,next_mesh_frame;
 	size_t number_of_files;
 	emulator_parameters parameters;
+
+	/// read a frame from the frame container of an asynchronous protocol
+	bool get_container_frame(InputStreams is, frame_type& frame);
+	/// reader of the frame container if the protocol has been written asynchronously
+	mutable frame_container_reader container;
+	/// per stream lists of container frame indices in the order color, depth, infrared, mesh
+	std::vector<size_t> container_frames[4];
+	/// per stream position in container_frames
+	size_t container_cursor[4];
+	/// map from protocol index to container frame index of warped color frames
+	std::map<uint32_t, size_t> container_warped_frames;
+	/// container frame index of the warped version of the last color frame or -1
+	mutable size_t next_warped_container_frame;
 };
 
 }
\ No newline at end of file
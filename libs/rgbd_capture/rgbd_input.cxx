@@ -1,6 +1,5 @@
 #include <iostream>
 #include <algorithm>
-#include <future>
 #include "rgbd_input.h"
 #include "rgbd_device_emulation.h"
 #include <cgv/utils/file.h>
@@ -82,12 +81,16 @@ rgbd_input::rgbd_input()
 	rgbd = 0;
 	started = false;
 	protocol_write_async = true;
+	protocol_compress_depth = true;
+	protocol_queue_capacity = 16;
 	protocol_idx = 0;
 	protocol_flags = 0;
+	next_warped_protocol_idx = -1;
 }
 
 rgbd_input::~rgbd_input()
 {
+	recorder.stop();
 	if (started)
 		stop();
 	if (is_attached())
@@ -98,6 +101,12 @@ rgbd_input::rgbd_input(const string& serial)
 {
 	rgbd = 0;
 	started = false;
+	protocol_write_async = true;
+	protocol_compress_depth = true;
+	protocol_queue_capacity = 16;
+	protocol_idx = 0;
+	protocol_flags = 0;
+	next_warped_protocol_idx = -1;
 	attach(serial);
 }
 
@@ -200,8 +209,15 @@ void write_protocol_headers(vector<stream_format> streams,std::string path) {
 	}
 }
 
+std::string rgbd_input::get_protocol_container_file_name(const std::string& path)
+{
+	return path + "/protocol.rgbd";
+}
+
 void rgbd_input::enable_protocol(const std::string& path)
 {
+	recorder.stop();
+	next_warped_protocol_idx = -1;
 	protocol_path = path;
 	protocol_idx  = 0;
 	protocol_flags = 0;
@@ -220,6 +236,9 @@ void rgbd_input::enable_protocol(const std::string& path)
 /// disable protocolation
 void rgbd_input::disable_protocol()
 {
+	if (!recorder.stop())
+		cerr << "rgbd_input::disable_protocol: could not complete protocol " << get_protocol_container_file_name(protocol_path) << endl;
+	next_warped_protocol_idx = -1;
 	protocol_path = "";
 	protocol_idx  = 0;
 	protocol_flags = 0;
@@ -229,6 +248,7 @@ void rgbd::rgbd_input::clear_protocol(const string& path)
 {
 	cout << "rgbd::rgbd_input::clear_protocol: removing old protocol\n";
 	cgv::utils::file::remove(path + "/emulator_parameters");
+	cgv::utils::file::remove(get_protocol_container_file_name(path));
 	static const char* exts[] = {
 	"ir", "rgb", "bgr", "rgba", "bgra", "byr", "dep", "d_p", "p_tri"
 	};
@@ -392,26 +412,19 @@ bool rgbd_input::set_near_mode(bool on)
 	return rgbd->set_near_mode(on);
 }
 
-bool write_protocol_frame(const std::string& fn, frame_type* frame_ptr)
-{
-	bool success = cgv::utils::file::write(fn, &frame_ptr->frame_data.front(), frame_ptr->frame_data.size(), false);
-	delete frame_ptr;
-	return success;
-}
-
-bool rgbd_input::write_protocol_frame_async(const std::string& fn, const frame_type& frame) const
+bool rgbd_input::write_protocol_frame(const std::string& fn, const frame_type& frame) const
 {
-	static future<bool> fu;
 	if (frame.frame_data.size() == 0)
 		return false;
-	if (!protocol_write_async)
-		return cgv::utils::file::write(fn, &frame.frame_data.front(), frame.frame_data.size(), false);
+	return cgv::utils::file::write(fn, &frame.frame_data.front(), frame.frame_data.size(), false);
+}
 
-	if (fu.valid()) {
-		fu.wait();
-	}
-	//fu = std::async(std::launch::async, cgv::utils::file::write, fn, &frame.frame_data.front(), frame.frame_data.size(), false);
-	return true;
+bool rgbd_input::start_protocol_recorder()
+{
+	emulator_parameters parameters;
+	bool has_parameters = rgbd->get_emulator_configuration(parameters);
+	return recorder.start(get_protocol_container_file_name(protocol_path), streams,
+		has_parameters ? &parameters : 0, protocol_queue_capacity, protocol_compress_depth);
 }
 
 bool rgbd_input::get_frame(InputStreams is, frame_type& frame, int timeOut)
@@ -425,12 +438,23 @@ bool rgbd_input::get_frame(InputStreams is, frame_type& frame, int timeOut)
 		return false;
 	}
 	if (rgbd->get_frame(is, frame, timeOut)) {
-		if (!protocol_path.empty()) {
+		if (!protocol_path.empty() && protocol_write_async && !recorder.is_started() && !start_protocol_recorder()) {
+			std::cerr << "rgbd_input::get_frame: could not start asynchronous protocol, falling back to synchronous writing" << std::endl;
+			protocol_write_async = false;
+		}
+		if (!protocol_path.empty() && protocol_write_async) {
+			// frames dropped by the recorder keep their index such that color and warped frames stay associated
+			if ((is & IS_COLOR) != 0)
+				next_warped_protocol_idx = protocol_idx;
+			recorder.push_frame(is, protocol_idx, frame);
+			++protocol_idx;
+		}
+		else if (!protocol_path.empty()) {
 			string fn = compose_file_name(protocol_path + "/kinect_", frame, protocol_idx);
 			if ((is & IS_COLOR) != 0) {
 				next_warped_file_name = compose_file_name(protocol_path + "/warped_", frame, protocol_idx);
 			}
-			if (!write_protocol_frame_async(fn, frame))
+			if (!write_protocol_frame(fn, frame))
 				std::cerr << "rgbd_input::get_frame: could not protocol frame to " << fn << std::endl;
 			else
 				++protocol_idx;
@@ -449,8 +473,12 @@ void rgbd_input::map_color_to_depth(const frame_type& depth_frame, const frame_t
 		return;
 	}
 	rgbd->map_color_to_depth(depth_frame, color_frame, warped_color_frame);
+	if (next_warped_protocol_idx >= 0) {
+		recorder.push_frame(IS_COLOR | CONTAINER_WARPED_FLAG, next_warped_protocol_idx, warped_color_frame);
+		next_warped_protocol_idx = -1;
+	}
 	if (!next_warped_file_name.empty()) {
-		if (!write_protocol_frame_async(next_warped_file_name, warped_color_frame))
+		if (!write_protocol_frame(next_warped_file_name, warped_color_frame))
 			std::cerr << "rgbd_input::map_color_to_depth: could not protocol frame to " << next_warped_file_name << std::endl;
 		next_warped_file_name.clear();
 	}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "rgbd_driver.h"
+#include "frame_container.h"
 
 #include "lib_begin.h"
 
@@ -61,6 +62,8 @@ public:
 	bool attach_path(const std::string& path);
 	/// enable protocolation of all frames acquired by the attached rgbd input device
 	void enable_protocol(const std::string& path);
+	/// return the file name of the frame container used for asynchronous protocols in the given path
+	static std::string get_protocol_container_file_name(const std::string& path);
 	/// disable protocolation
 	void disable_protocol();
 	/// delete recorded protocol
@@ -140,13 +143,23 @@ protected:
 	/// flags used to determine which frames have been saved to file for current index
 	unsigned protocol_flags;
 public:
-	/// whether to write protocol frames asynchronously
+	/// whether to write protocol frames asynchronously into a single frame container file instead of one file per frame
 	bool protocol_write_async;
+	/// whether to compress depth frames losslessly in asynchronously written protocols
+	bool protocol_compress_depth;
+	/// maximum number of frames queued for asynchronous writing before frames are dropped
+	unsigned protocol_queue_capacity;
 protected:
 	/// store filename for protocol of warped frames
 	mutable std::string next_warped_file_name;
-	/// helper function to write protocol frame asynchronously
-	bool write_protocol_frame_async(const std::string& fn, const frame_type& frame) const;
+	/// protocol index of the last color frame whose warped version is recorded asynchronously or -1
+	mutable int next_warped_protocol_idx;
+	/// recorder thread for asynchronous protocols
+	mutable frame_recorder recorder;
+	/// start recorder on the frame container of the protocol path and return whether this was successful
+	bool start_protocol_recorder();
+	/// helper function to write protocol frame synchronously into a separate file
+	bool write_protocol_frame(const std::string& fn, const frame_type& frame) const;
 	/// cached stream formats
 	std::vector<stream_format> streams;
 };
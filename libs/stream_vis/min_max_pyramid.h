@@ -0,0 +1,239 @@
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+
+namespace stream_vis {
+
+	/** min/max pyramid over the samples of a ringbuffer of interleaved components. Ringbuffer locations are grouped
+	    into blocks, which form the leaves of a binary tree storing per node and component the minimum and maximum
+		together with their ringbuffer locations. New samples only update the blocks they fall into and the ancestors
+		of these blocks. Extrema of arbitrary sample ranges are found in O(log n) by combining the partial blocks at
+		the range ends with O(log n) tree nodes, which allows to compute domains and to decimate long histories to the
+		resolution of the viewport. */
+	template <typename T>
+	class min_max_pyramid
+	{
+	protected:
+		unsigned nr_components;
+		size_t window_size;
+		size_t block_size;
+		/// number of leaves, which is a power of two
+		size_t nr_leaves;
+		/// total number of samples added to the ringbuffer
+		size_t nr_samples;
+		/// pointer to ringbuffer passed in last update
+		const T* ring_ptr;
+		/// per node and component minimum and maximum values
+		std::vector<T> min_values, max_values;
+		/// per node and component ringbuffer locations of minimum and maximum
+		std::vector<uint32_t> min_locations, max_locations;
+		/// extrema of a range over all components
+		struct extrema
+		{
+			std::vector<T> min_values, max_values;
+			std::vector<uint32_t> min_locations, max_locations;
+			extrema(unsigned n) : min_values(n, std::numeric_limits<T>::max()), max_values(n, std::numeric_limits<T>::lowest()),
+				min_locations(n, uint32_t(-1)), max_locations(n, uint32_t(-1)) {}
+		};
+		/// reset node to empty
+		void clear_node(size_t ni)
+		{
+			for (unsigned c = 0; c < nr_components; ++c) {
+				min_values[ni * nr_components + c] = std::numeric_limits<T>::max();
+				max_values[ni * nr_components + c] = std::numeric_limits<T>::lowest();
+				min_locations[ni * nr_components + c] = max_locations[ni * nr_components + c] = uint32_t(-1);
+			}
+		}
+		/// merge extrema of node nj into node ni
+		void merge_node(size_t ni, size_t nj)
+		{
+			for (unsigned c = 0; c < nr_components; ++c) {
+				size_t i = ni * nr_components + c, j = nj * nr_components + c;
+				if (min_values[j] < min_values[i]) {
+					min_values[i] = min_values[j];
+					min_locations[i] = min_locations[j];
+				}
+				if (max_values[j] > max_values[i]) {
+					max_values[i] = max_values[j];
+					max_locations[i] = max_locations[j];
+				}
+			}
+		}
+		/// merge extrema of node into given extrema
+		void merge_node(extrema& e, size_t ni, unsigned c0, unsigned c1) const
+		{
+			for (unsigned c = c0; c < c1; ++c) {
+				size_t i = ni * nr_components + c;
+				if (min_values[i] < e.min_values[c]) {
+					e.min_values[c] = min_values[i];
+					e.min_locations[c] = min_locations[i];
+				}
+				if (max_values[i] > e.max_values[c]) {
+					e.max_values[c] = max_values[i];
+					e.max_locations[c] = max_locations[i];
+				}
+			}
+		}
+		/// merge samples of ringbuffer locations [l0,l1) into given extrema; nan values are ignored
+		void merge_samples(extrema& e, size_t l0, size_t l1, unsigned c0, unsigned c1) const
+		{
+			for (size_t l = l0; l < l1; ++l) {
+				const T* s = ring_ptr + l * nr_components;
+				for (unsigned c = c0; c < c1; ++c) {
+					if (s[c] < e.min_values[c]) {
+						e.min_values[c] = s[c];
+						e.min_locations[c] = uint32_t(l);
+					}
+					if (s[c] > e.max_values[c]) {
+						e.max_values[c] = s[c];
+						e.max_locations[c] = uint32_t(l);
+					}
+				}
+			}
+		}
+		/// recompute leaf of block bi from ringbuffer
+		void compute_leaf(size_t bi)
+		{
+			size_t ni = nr_leaves + bi;
+			clear_node(ni);
+			size_t nr_valid = std::min(nr_samples, window_size);
+			T* mins = &min_values[ni * nr_components];
+			T* maxs = &max_values[ni * nr_components];
+			uint32_t* min_locs = &min_locations[ni * nr_components];
+			uint32_t* max_locs = &max_locations[ni * nr_components];
+			for (size_t l = bi * block_size; l < std::min((bi + 1) * block_size, nr_valid); ++l) {
+				const T* s = ring_ptr + l * nr_components;
+				for (unsigned c = 0; c < nr_components; ++c) {
+					if (s[c] < mins[c]) {
+						mins[c] = s[c];
+						min_locs[c] = uint32_t(l);
+					}
+					if (s[c] > maxs[c]) {
+						maxs[c] = s[c];
+						max_locs[c] = uint32_t(l);
+					}
+				}
+			}
+		}
+		/// recompute leaves of blocks [b0,b1] and their ancestors
+		void update_blocks(size_t b0, size_t b1)
+		{
+			for (size_t bi = b0; bi <= b1; ++bi)
+				compute_leaf(bi);
+			for (size_t n0 = (nr_leaves + b0) / 2, n1 = (nr_leaves + b1) / 2; n0 > 0; n0 /= 2, n1 /= 2) {
+				for (size_t ni = n0; ni <= n1; ++ni) {
+					clear_node(ni);
+					merge_node(ni, 2 * ni);
+					merge_node(ni, 2 * ni + 1);
+				}
+			}
+		}
+		/// merge extrema of ringbuffer locations [l0,l1) into e
+		void query_locations(extrema& e, size_t l0, size_t l1, unsigned c0, unsigned c1) const
+		{
+			if (l0 >= l1)
+				return;
+			size_t b0 = (l0 + block_size - 1) / block_size;
+			size_t b1 = l1 / block_size;
+			// last block might be incomplete
+			if (l1 == window_size)
+				b1 = (window_size + block_size - 1) / block_size;
+			if (b0 >= b1) {
+				merge_samples(e, l0, l1, c0, c1);
+				return;
+			}
+			merge_samples(e, l0, b0 * block_size, c0, c1);
+			merge_samples(e, std::min(b1 * block_size, l1), l1, c0, c1);
+			for (size_t n0 = b0 + nr_leaves, n1 = b1 + nr_leaves; n0 < n1; n0 /= 2, n1 /= 2) {
+				if (n0 & 1)
+					merge_node(e, n0++, c0, c1);
+				if (n1 & 1)
+					merge_node(e, --n1, c0, c1);
+			}
+		}
+		/// compute extrema of sample index range [si0,si1) clamped to the samples in the ringbuffer and return ringbuffer location of si0
+		size_t query(extrema& e, size_t& si0, size_t& si1, unsigned c0, unsigned c1) const
+		{
+			si0 = std::max(si0, get_first_sample_index());
+			si1 = std::min(si1, nr_samples);
+			if (si0 >= si1)
+				return 0;
+			size_t l0 = si0 % window_size;
+			size_t n = si1 - si0;
+			if (l0 + n <= window_size)
+				query_locations(e, l0, l0 + n, c0, c1);
+			else {
+				query_locations(e, l0, window_size, c0, c1);
+				query_locations(e, 0, l0 + n - window_size, c0, c1);
+			}
+			return l0;
+		}
+		/// convert ringbuffer location found in range starting at si0 with location l0 back to sample index
+		size_t to_sample_index(uint32_t l, size_t si0, size_t l0) const
+		{
+			return l >= l0 ? si0 + (l - l0) : si0 + (window_size - l0) + l;
+		}
+	public:
+		/// construct pyramid for ringbuffer of given size and number of components
+		min_max_pyramid(size_t _window_size, unsigned _nr_components, size_t _block_size = 16)
+			: nr_components(_nr_components), window_size(_window_size), block_size(_block_size), nr_samples(0), ring_ptr(0)
+		{
+			nr_leaves = 1;
+			while (nr_leaves * block_size < window_size)
+				nr_leaves *= 2;
+			min_values.resize(2 * nr_leaves * nr_components);
+			max_values.resize(2 * nr_leaves * nr_components);
+			min_locations.resize(2 * nr_leaves * nr_components);
+			max_locations.resize(2 * nr_leaves * nr_components);
+			for (size_t ni = 0; ni < 2 * nr_leaves; ++ni)
+				clear_node(ni);
+		}
+		/// return total number of samples
+		size_t get_nr_samples() const { return nr_samples; }
+		/// return sample index of oldest sample still in ringbuffer
+		size_t get_first_sample_index() const { return nr_samples > window_size ? nr_samples - window_size : 0; }
+		/// update pyramid after count new samples have been written to the ringbuffer
+		void add_samples(const T* _ring_ptr, size_t count)
+		{
+			ring_ptr = _ring_ptr;
+			if (count == 0)
+				return;
+			size_t l0 = nr_samples % window_size;
+			nr_samples += count;
+			size_t nr_blocks = (window_size + block_size - 1) / block_size;
+			if (count >= window_size)
+				update_blocks(0, nr_blocks - 1);
+			else if (l0 + count <= window_size)
+				update_blocks(l0 / block_size, (l0 + count - 1) / block_size);
+			else {
+				update_blocks(l0 / block_size, nr_blocks - 1);
+				update_blocks(0, (l0 + count - window_size - 1) / block_size);
+			}
+		}
+		/// put minimum and maximum of all components over sample index range [si0,si1) into bounds[c] and bounds[nr_components+c]; return false if range is empty
+		bool put_bounds(size_t si0, size_t si1, T* bounds) const
+		{
+			extrema e(nr_components);
+			query(e, si0, si1, 0, nr_components);
+			if (si0 >= si1)
+				return false;
+			std::copy(e.min_values.begin(), e.min_values.end(), bounds);
+			std::copy(e.max_values.begin(), e.max_values.end(), bounds + nr_components);
+			return true;
+		}
+		/// find sample indices of minimum and maximum of component c over sample index range [si0,si1); return false if range is empty or contains only nan values
+		bool find_extrema(size_t si0, size_t si1, unsigned c, size_t& si_min, size_t& si_max) const
+		{
+			extrema e(nr_components);
+			size_t l0 = query(e, si0, si1, c, c + 1);
+			if (si0 >= si1 || e.min_locations[c] == uint32_t(-1))
+				return false;
+			si_min = to_sample_index(e.min_locations[c], si0, l0);
+			si_max = to_sample_index(e.max_locations[c], si0, l0);
+			return true;
+		}
+	};
+}
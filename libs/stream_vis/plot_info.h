@@ -34,6 +34,12 @@ namespace stream_vis {
 	{
 		std::vector<attribute_definition> attribute_definitions;
 		std::vector<component_reference> ringbuffer_references;
+		/// whether subplot currently draws from decimated samples instead of storage buffer
+		bool is_decimated = false;
+		/// number of samples and columns from which decimated samples were computed
+		size_t decimated_nr_samples = 0, decimated_nr_columns = 0;
+		/// interleaved attributes of samples selected by min/max decimation
+		std::vector<float> decimated_samples;
 	};
 
 	enum DomainAdjustment
@@ -63,6 +69,8 @@ namespace stream_vis {
 		uint16_t domain_bound_ts_index[2][8];
 		/// pointer to plot instance
 		cgv::plot::plot_base* plot_ptr;
+		/// extent of plot in pixels as announced by view overlay, which defines level of detail
+		vec2 pixel_extent = vec2(0.0f);
 		/// subplot information
 		std::vector<subplot_info> subplot_infos;
 	};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+namespace stream_vis {
+
+	/** lock free queue for exactly one producer and one consumer thread used to hand new samples from the thread
+	    delivering values to the rendering thread. The capacity is rounded up to a power of two. push() never
+		waits and fails if the queue is full, which is counted. The consumer drains all queued samples in one batch
+		with consume(), such that the atomic read and write positions are touched only once per batch. Calls to
+		consume() can come from different threads if they are serialized, for example by a mutex. Concurrent calls
+		to push() are not supported and detected by an assertion in debug builds. */
+	template <typename T>
+	class sample_queue
+	{
+	protected:
+		/// storage of queued elements
+		std::vector<T> elements;
+		/// capacity minus one used to wrap positions
+		size_t mask;
+		/// write position only written by producer
+		alignas(64) std::atomic<size_t> write_pos;
+		/// producer side copy of read position to avoid touching consumer cache line on each push
+		size_t cached_read_pos;
+		/// number of calls to push() that failed because queue was full
+		std::atomic<size_t> nr_failed_pushes;
+#ifndef NDEBUG
+		/// whether push() is in progress, used to detect several producer threads
+		std::atomic<bool> pushing;
+#endif
+		/// read position only written by consumer
+		alignas(64) std::atomic<size_t> read_pos;
+	public:
+		/// construct queue with capacity rounded up to a power of two
+		sample_queue(size_t capacity = 16384) : write_pos(0), cached_read_pos(0), nr_failed_pushes(0), read_pos(0)
+		{
+#ifndef NDEBUG
+			pushing = false;
+#endif
+			set_capacity(capacity);
+		}
+		/// reallocate queue, which must only be called while neither producer nor consumer access the queue
+		void set_capacity(size_t capacity)
+		{
+			size_t c = 2;
+			while (c < capacity)
+				c *= 2;
+			elements.resize(c);
+			mask = c - 1;
+			write_pos = read_pos = 0;
+			cached_read_pos = 0;
+		}
+		/// return capacity
+		size_t get_capacity() const { return mask + 1; }
+		/// return number of queued elements, which is only exact if called by producer or consumer
+		size_t size() const { return write_pos.load(std::memory_order_acquire) - read_pos.load(std::memory_order_acquire); }
+		/// return number of calls to push() that failed because the queue was full
+		size_t get_nr_failed_pushes() const { return nr_failed_pushes.load(std::memory_order_relaxed); }
+		/// append element from producer thread and return false if queue was full
+		bool push(const T& element)
+		{
+#ifndef NDEBUG
+			bool was_pushing = pushing.exchange(true, std::memory_order_acquire);
+			assert(!was_pushing && "sample_queue::push() called concurrently from several threads");
+#endif
+			size_t wp = write_pos.load(std::memory_order_relaxed);
+			bool full = wp - cached_read_pos > mask && wp - (cached_read_pos = read_pos.load(std::memory_order_acquire)) > mask;
+			if (full)
+				nr_failed_pushes.fetch_add(1, std::memory_order_relaxed);
+			else {
+				elements[wp & mask] = element;
+				write_pos.store(wp + 1, std::memory_order_release);
+			}
+#ifndef NDEBUG
+			pushing.store(false, std::memory_order_release);
+#endif
+			return !full;
+		}
+		/// from consumer thread call f(const T* ptr, size_t count) on at most two contiguous ranges of all queued elements, release them and return their number
+		template <typename F>
+		size_t consume(F f)
+		{
+			size_t rp = read_pos.load(std::memory_order_relaxed);
+			size_t count = write_pos.load(std::memory_order_acquire) - rp;
+			if (count == 0)
+				return 0;
+			size_t begin = rp & mask;
+			size_t first_count = std::min(count, mask + 1 - begin);
+			f(&elements[begin], first_count);
+			if (first_count < count)
+				f(&elements[0], count - first_count);
+			read_pos.store(rp + count, std::memory_order_release);
+			return count;
+		}
+	};
+}
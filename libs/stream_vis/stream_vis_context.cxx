@@ -76,6 +76,15 @@ namespace stream_vis {
 
 		}
 	}
+	void stream_vis_context::construct_min_max_pyramids()
+	{
+		for (auto& tsrb : time_series_ringbuffers) {
+			delete tsrb.pyramid;
+			tsrb.pyramid = 0;
+			if (tsrb.time_series_ringbuffer_size > 0)
+				tsrb.pyramid = new min_max_pyramid<float>(tsrb.time_series_ringbuffer_size, tsrb.nr_time_series_components);
+		}
+	}
 	void stream_vis_context::construct_storage_buffer()
 	{
 		// initialize component references to point to themselves
@@ -159,6 +168,7 @@ namespace stream_vis {
 			time_series_ringbuffers.back().nr_time_series_components = nr_storage_components;
 			time_series_ringbuffers.back().time_series_ringbuffer_size = (uint16_t)typed_time_series[i]->series().get_ringbuffer_size();
 			time_series_ringbuffers.back().streaming_aabb = 0;
+			time_series_ringbuffers.back().pyramid = 0;
 			storage_buffer_offset += nr_storage_components * typed_time_series[i]->series().get_ringbuffer_size();
 		}
 		// add ringbuffer entries for non referenced but accessed remaining non composed time series
@@ -224,6 +234,7 @@ namespace stream_vis {
 		show_ringbuffers();
 
 		construct_streaming_aabbs();
+		construct_min_max_pyramids();
 
 	}
 	stream_vis_context::stream_vis_context(const std::string& name) : application_plugin(name)
@@ -232,11 +243,14 @@ namespace stream_vis {
 		sleep_ms = 20;
 		outofdate = true;
 		last_use_vbo = use_vbo = false;
+		use_lod = true;
 		plot_attributes_initialized = false;
 		aabb_mode = last_aabb_mode = AM_BRUTE_FORCE;
 	}
 	stream_vis_context::~stream_vis_context()
 	{
+		for (auto& tsrb : time_series_ringbuffers)
+			delete tsrb.pyramid;
 		for (auto& tsp : typed_time_series)
 			delete tsp;
 	}
@@ -394,8 +408,9 @@ namespace stream_vis {
 						continue;
 				}
 			}
-			// go through all time series and set offset
+			// go through all time series and set offset while render thread cannot drain samples
 			for (auto* ts_ptr : typed_time_series) {
+				ts_ptr->ref_lock().lock();
 				// check for time offset
 				if (oi.accessors.size() > 0 && oi.accessors.front() == TSA_TIME) {
 					ts_ptr->series().set_time_offset(oi.offset_value);
@@ -443,6 +458,7 @@ namespace stream_vis {
 						}
 					}
 				}
+				ts_ptr->ref_lock().unlock();
 			}
 			oi.initialized = true;
 			--nr_uninitialized_offsets;
@@ -551,6 +567,24 @@ namespace stream_vis {
 		for (auto& pl : plot_pool)
 			pl.plot_ptr->clear(ctx);
 	}
+	void stream_vis_context::set_subplot_attributes(plot_info& pl, unsigned i)
+	{
+		subplot_info& spi = pl.subplot_infos[i];
+		for (size_t ai = 0; ai < spi.ringbuffer_references.size(); ++ai) {
+			// define attribute storage location based on ringbuffer reference
+			const auto& rr = spi.ringbuffer_references[ai];
+			const auto& tsr = time_series_ringbuffers[rr.index];
+			if (use_vbo)
+				pl.plot_ptr->set_sub_plot_attribute(
+					i, (unsigned)ai, storage_vbos[tsr.storage_buffer_index],
+					(tsr.storage_buffer_offset + rr.component_index) * sizeof(GLfloat),
+					tsr.time_series_ringbuffer_size, tsr.nr_time_series_components * sizeof(GLfloat));
+			else
+				pl.plot_ptr->set_sub_plot_attribute(i, (unsigned)ai,
+					&storage_buffers[tsr.storage_buffer_index][tsr.storage_buffer_offset + rr.component_index],
+					tsr.time_series_ringbuffer_size, tsr.nr_time_series_components * sizeof(float));
+		}
+	}
 	void stream_vis_context::update_plot_samples(cgv::render::context& ctx)
 	{
 		// ensure construction of sorage buffers and vbos
@@ -563,29 +597,19 @@ namespace stream_vis {
 		}
 		// define subplot attribute array pointers
 		if (!plot_attributes_initialized || use_vbo != last_use_vbo) {
-			// iterate all plots, subplots and attributes
+			// iterate all plots and subplots
 			for (auto& pl : plot_pool) {
-				for (size_t i = 0; i < pl.subplot_infos.size(); ++i) {
-					subplot_info& spi = pl.subplot_infos[i];
-					for (size_t ai = 0; ai < spi.ringbuffer_references.size(); ++ai) {
-						// define attribute storage location based on ringbuffer reference
-						const auto& rr = spi.ringbuffer_references[ai];
-						const auto& tsr = time_series_ringbuffers[rr.index];
-						if (use_vbo)
-							pl.plot_ptr->set_sub_plot_attribute(
-								(unsigned)i, (unsigned)ai, storage_vbos[tsr.storage_buffer_index],
-								(tsr.storage_buffer_offset + rr.component_index) * sizeof(GLfloat),
-								tsr.time_series_ringbuffer_size, tsr.nr_time_series_components * sizeof(GLfloat));
-						else
-							pl.plot_ptr->set_sub_plot_attribute((unsigned)i, (unsigned)ai,
-								&storage_buffers[tsr.storage_buffer_index][tsr.storage_buffer_offset + rr.component_index],
-								tsr.time_series_ringbuffer_size, tsr.nr_time_series_components * sizeof(float));
-					}
+				for (unsigned i = 0; i < pl.subplot_infos.size(); ++i) {
+					set_subplot_attributes(pl, i);
+					pl.subplot_infos[i].decimated_nr_samples = 0;
 				}
 			}
 			last_use_vbo = use_vbo;
 			plot_attributes_initialized = true;
 		}
+		// move samples queued by the thread delivering values into the sample caches in one batch per time series
+		for (auto* tts : typed_time_series)
+			tts->drain_samples();
 		// update time series ringbuffers
 		int i = 0;
 		for (auto& tsrr : time_series_ringbuffers) {
@@ -603,6 +627,8 @@ namespace stream_vis {
 				if (tsrr.streaming_aabb)
 					tsrr.streaming_aabb->add_samples_base(storage_ptr + tsrr.nr_time_series_components * csi, 1);
 			}
+			if (tsrr.pyramid)
+				tsrr.pyramid->add_samples(storage_ptr, count);
 			// three cases exist for the upload of the new samples to GPU:
 
 			// first check for case when complete ringbuffer needs to be replaces
@@ -741,9 +767,15 @@ namespace stream_vis {
 						if ((compute[0][ai] && !has_bound[0]) || (compute[1][ai] && !has_bound[1])) {
 							const auto& rbr = spi.ringbuffer_references[ai];
 							const auto& tsrb = time_series_ringbuffers[rbr.index];
-							// and a streaming aabb is available
-							if (tsrb.streaming_aabb) {
+							// and a min/max pyramid or a streaming aabb is available
+							bool has_aabb = false;
+							if (tsrb.pyramid)
+								has_aabb = tsrb.pyramid->put_bounds(0, tsrb.nr_samples, flt_ptr);
+							else if (tsrb.streaming_aabb) {
 								tsrb.streaming_aabb->put_aabb(flt_ptr);
+								has_aabb = true;
+							}
+							if (has_aabb) {
 								for (int j = 0; j < 2; ++j) {
 									if (!compute[j][ai] || has_bound[j])
 										continue;
@@ -781,6 +813,111 @@ namespace stream_vis {
 			pl.plot_ptr->adjust_tick_marks();
 		}
 	}
+	void stream_vis_context::handle_view2d_update(int pi, const vec2& pixel_scales)
+	{
+		if (pi >= 0 && pi < (int)plot_pool.size())
+			plot_pool[pi].pixel_extent = pixel_scales;
+	}
+	bool stream_vis_context::decimate_subplot(plot_info& pl, unsigned i, size_t nr_columns)
+	{
+		subplot_info& spi = pl.subplot_infos[i];
+		const auto& rr_time = spi.ringbuffer_references[0];
+		const auto& rr_value = spi.ringbuffer_references[1];
+		const auto& tsrb_time = time_series_ringbuffers[rr_time.index];
+		const auto& tsrb_value = time_series_ringbuffers[rr_value.index];
+		if (!tsrb_value.pyramid)
+			return false;
+		// determine range of samples available in all attributes
+		size_t nr_samples = std::numeric_limits<size_t>::max();
+		for (const auto& rr : spi.ringbuffer_references)
+			nr_samples = std::min(nr_samples, time_series_ringbuffers[rr.index].nr_samples);
+		size_t si_begin = nr_samples > tsrb_time.time_series_ringbuffer_size ? nr_samples - tsrb_time.time_series_ringbuffer_size : 0;
+		// decimation only pays off if at least four samples fall into each pixel column
+		if (nr_samples - si_begin <= 4 * nr_columns)
+			return false;
+		auto attribute_value = [this](const component_reference& rr, size_t si) {
+			const auto& tsrb = time_series_ringbuffers[rr.index];
+			return storage_buffers[tsrb.storage_buffer_index][tsrb.storage_buffer_offset +
+				(si % tsrb.time_series_ringbuffer_size) * tsrb.nr_time_series_components + rr.component_index];
+		};
+		// restrict columns to part of domain covered by samples
+		float t_begin = attribute_value(rr_time, si_begin);
+		float t_end = attribute_value(rr_time, nr_samples - 1);
+		float domain_extent = pl.plot_ptr->get_domain_config_ptr()->axis_configs[0].get_attribute_extent();
+		if (domain_extent > 0 && t_end > t_begin)
+			nr_columns = std::max(size_t(1), std::min(nr_columns, size_t(ceil(nr_columns * (t_end - t_begin) / domain_extent))));
+		// recompute selected samples only if new samples arrived or resolution changed
+		if (!spi.is_decimated || spi.decimated_nr_samples != nr_samples || spi.decimated_nr_columns != nr_columns) {
+			std::vector<size_t> sample_indices;
+			sample_indices.reserve(4 * nr_columns);
+			size_t si0 = si_begin;
+			for (size_t ci = 0; ci < nr_columns && si0 < nr_samples; ++ci) {
+				// find first sample of next column by binary search over time
+				size_t si1 = nr_samples;
+				if (ci + 1 < nr_columns) {
+					float t = t_begin + (t_end - t_begin) * (ci + 1) / nr_columns;
+					size_t lo = si0, hi = nr_samples;
+					while (lo < hi) {
+						size_t mid = (lo + hi) / 2;
+						if (attribute_value(rr_time, mid) < t)
+							lo = mid + 1;
+						else
+							hi = mid;
+					}
+					si1 = lo;
+				}
+				if (si1 == si0)
+					continue;
+				// select first, minimum, maximum and last sample of column in order of time
+				size_t si[4] = { si0, si0, si0, si1 - 1 };
+				tsrb_value.pyramid->find_extrema(si0, si1, rr_value.component_index, si[1], si[2]);
+				std::sort(si, si + 4);
+				for (int k = 0; k < 4; ++k)
+					if (sample_indices.empty() || sample_indices.back() != si[k])
+						sample_indices.push_back(si[k]);
+				si0 = si1;
+			}
+			// gather attributes of selected samples
+			size_t nr_attributes = spi.ringbuffer_references.size();
+			spi.decimated_samples.resize(nr_attributes * sample_indices.size());
+			float* sample_ptr = &spi.decimated_samples.front();
+			for (size_t si : sample_indices)
+				for (const auto& rr : spi.ringbuffer_references)
+					*sample_ptr++ = attribute_value(rr, si);
+			for (size_t ai = 0; ai < nr_attributes; ++ai)
+				pl.plot_ptr->set_sub_plot_attribute(i, (unsigned)ai, &spi.decimated_samples[ai], sample_indices.size(), nr_attributes * sizeof(float));
+			spi.decimated_nr_samples = nr_samples;
+			spi.decimated_nr_columns = nr_columns;
+			spi.is_decimated = true;
+		}
+		// sample range has been set to ringbuffer in update_plot_domains()
+		auto& cfg = pl.plot_ptr->ref_sub_plot_config(i);
+		cfg.begin_sample = 0;
+		cfg.end_sample = spi.decimated_samples.size() / spi.ringbuffer_references.size();
+		return true;
+	}
+	void stream_vis_context::update_plot_lod()
+	{
+		for (auto& pl : plot_pool) {
+			// determine number of pixel columns from plot extent or from size of view overlay
+			size_t nr_columns = size_t(pl.pixel_extent[0]);
+			if (nr_columns == 0 && pl.view_index < (int)view_overlays.size())
+				nr_columns = view_overlays[pl.view_index]->get_overlay_size()[0];
+			for (unsigned i = 0; i < pl.subplot_infos.size(); ++i) {
+				subplot_info& spi = pl.subplot_infos[i];
+				// decimate 2d subplots over time
+				bool decimate = use_lod && pl.dim == 2 && nr_columns > 0 && spi.ringbuffer_references.size() >= 2 &&
+					spi.attribute_definitions[0].accessor == TSA_TIME;
+				if (decimate && decimate_subplot(pl, i, nr_columns))
+					continue;
+				// switch back to drawing all samples from ringbuffers
+				if (spi.is_decimated) {
+					set_subplot_attributes(pl, i);
+					spi.is_decimated = false;
+				}
+			}
+		}
+	}
 	void stream_vis_context::init_frame(cgv::render::context& ctx)
 	{
 		if (!view_ptr) {
@@ -792,8 +929,14 @@ namespace stream_vis {
 //		else {
 //			if (view_ptr->get_y_extent_at_focus() )
 //		}
+		// the thread delivering values drains full sample queues into the sample caches, which are read in the following updates
+		for (auto* tts : typed_time_series)
+			tts->ref_lock().lock();
 		update_plot_samples(ctx);
 		update_plot_domains();
+		for (auto* tts : typed_time_series)
+			tts->ref_lock().unlock();
+		update_plot_lod();
 		for (auto& pl : plot_pool)
 			pl.plot_ptr->init_frame(ctx);
 	}
@@ -820,6 +963,7 @@ namespace stream_vis {
 		add_member_control(this, "pause", paused, "toggle");
 		add_member_control(this, "sleep_ms", sleep_ms, "value_slider", "min=0;max=1000;log=true;ticks=true");
 		add_member_control(this, "use_vbo", use_vbo, "check");
+		add_member_control(this, "use_lod", use_lod, "check");
 		if (begin_tree_node("Plots", plot_pool, true)) {
 			align("\a");
 			for (auto& pl : plot_pool) {
@@ -6,6 +6,7 @@
 #include "view_overlay.h"
 #include "streaming_time_series.h"
 #include "streaming_aabb.h"
+#include "min_max_pyramid.h"
 #include <cgv/base/node.h>
 #include <cgv/os/thread.h>
 #include <cgv/os/mutex.h>
@@ -33,6 +34,7 @@ namespace stream_vis {
 		uint16_t storage_buffer_index;
 		size_t   storage_buffer_offset;
 		streaming_aabb_base<float>* streaming_aabb;
+		min_max_pyramid<float>* pyramid;
 	};
 
 	struct time_series_info
@@ -50,6 +52,8 @@ namespace stream_vis {
 		std::vector<view_overlay_ptr> view_overlays;
 		std::atomic<bool> outofdate;
 		bool use_vbo, last_use_vbo, plot_attributes_initialized;
+		/// whether to decimate long time series of 2d plots to min/max samples per pixel column
+		bool use_lod;
 		AABBMode aabb_mode, last_aabb_mode;
 		/// maps name to time series indices
 		std::map<std::string, uint16_t> name2index;
@@ -84,13 +88,19 @@ namespace stream_vis {
 		static size_t get_component_index(TimeSeriesAccessor accessor, TimeSeriesAccessor accessors);
 
 		void construct_streaming_aabbs();
+		void construct_min_max_pyramids();
 		void construct_storage_buffer();
+		/// let attributes of subplot point to time series ringbuffers in storage buffers or vbos
+		void set_subplot_attributes(plot_info& pl, unsigned i);
+		/// select first, last, minimum and maximum sample per column and return false if subplot does not need decimation
+		bool decimate_subplot(plot_info& pl, unsigned i, size_t nr_columns);
 		bool is_paused() const { return paused; }
 		unsigned get_sleep_ms() const { return sleep_ms; }
 	public:
 		stream_vis_context(const std::string& name);
 		~stream_vis_context();
 		virtual size_t get_first_composed_index() const = 0;
+		/// deliver new values to the time series, which must not be called concurrently from several threads
 		void announce_values(uint16_t num_values, indexed_value* values, double timestamp, const uint16_t* val_idx_from_ts_idx);
 		void on_set(void* member_ptr);
 		std::string get_type_name() const { return "stream_vis_context"; }
@@ -106,6 +116,10 @@ namespace stream_vis {
 		void clear(cgv::render::context& ctx);
 		void update_plot_samples(cgv::render::context& ctx);
 		void update_plot_domains();
+		/// decimate subplots of 2d plots over time to resolution of viewport
+		void update_plot_lod();
+		/// store pixel extent of plot for level of detail selection; derived classes overriding this should call it
+		void handle_view2d_update(int pi, const vec2& pixel_scales);
 		void init_frame(cgv::render::context& ctx);
 		void draw(cgv::render::context& ctx);
 		void create_gui();
@@ -50,6 +50,18 @@ namespace stream_vis {
 	{
 		return outofdate;
 	}
+	size_t streaming_time_series::drain_samples()
+	{
+		// reset flag before draining such that samples pushed concurrently mark series out of date again
+		outofdate = false;
+		return series().drain_sample_queue();
+	}
+	void streaming_time_series::drain_full_sample_queue()
+	{
+		lock.lock();
+		series().drain_sample_queue();
+		lock.unlock();
+	}
 	bool streaming_time_series::is_resample() const
 	{
 		return false;
@@ -79,10 +91,9 @@ namespace stream_vis {
 		uint16_t vi = val_idx_from_ts_idx[index];
 		if (vi == uint16_t(-1))
 			return false;
-		lock.lock();
-		append_sample(timestamp, reinterpret_cast<const double&>(values[vi].value[0]));
+		while (!push_sample(timestamp, reinterpret_cast<const double&>(values[vi].value[0])))
+			drain_full_sample_queue();
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 	streaming_time_series* float_time_series::construct_resampled_time_series(const std::string& name, streaming_time_series* sampling_ts) const
@@ -121,10 +132,9 @@ namespace stream_vis {
 		// if no value is sampled
 		if (!float_time_series::extract_from_values(num_values, values, timestamp, val_idx_from_ts_idx)) {
 			// either store cached new value or nan value 
-			lock.lock();
-			append_sample(timestamp, have_new_value ? new_value : nan_value);
+			while (!push_sample(timestamp, have_new_value ? new_value : nan_value))
+				drain_full_sample_queue();
 			outofdate = true;
-			lock.unlock();
 		}
 		// always clear cache
 		have_new_value = false;
@@ -141,10 +151,9 @@ namespace stream_vis {
 		uint16_t vi = val_idx_from_ts_idx[index];
 		if (vi == uint16_t(-1))
 			return false;
-		lock.lock();
-		append_sample(timestamp, reinterpret_cast<const int64_t&>(values[vi].value[0]));
+		while (!push_sample(timestamp, reinterpret_cast<const int64_t&>(values[vi].value[0])))
+			drain_full_sample_queue();
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 	streaming_time_series* int_time_series::construct_resampled_time_series(const std::string& name, streaming_time_series* sampling_ts) const
@@ -183,10 +192,9 @@ namespace stream_vis {
 		// if no value is sampled
 		if (!int_time_series::extract_from_values(num_values, values, timestamp, val_idx_from_ts_idx)) {
 			// either store cached new value or nan value 
-			lock.lock();
-			append_sample(timestamp, have_new_value ? new_value : int32_t(nan_value));
+			while (!push_sample(timestamp, have_new_value ? new_value : int32_t(nan_value)))
+				drain_full_sample_queue();
 			outofdate = true;
-			lock.unlock();
 		}
 		// always clear cache
 		have_new_value = false;
@@ -203,10 +211,9 @@ namespace stream_vis {
 		uint16_t vi = val_idx_from_ts_idx[index];
 		if (vi == uint16_t(-1))
 			return false;
-		lock.lock();
-		append_sample(timestamp, reinterpret_cast<const uint64_t&>(values[vi].value[0]));
+		while (!push_sample(timestamp, reinterpret_cast<const uint64_t&>(values[vi].value[0])))
+			drain_full_sample_queue();
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 	streaming_time_series* uint_time_series::construct_resampled_time_series(const std::string& name, streaming_time_series* sampling_ts) const
@@ -245,10 +252,9 @@ namespace stream_vis {
 		// if no value is sampled
 		if (!uint_time_series::extract_from_values(num_values, values, timestamp, val_idx_from_ts_idx)) {
 			// either store cached new value or nan value 
-			lock.lock();
-			append_sample(timestamp, have_new_value ? new_value : uint32_t(nan_value));
+			while (!push_sample(timestamp, have_new_value ? new_value : uint32_t(nan_value)))
+				drain_full_sample_queue();
 			outofdate = true;
-			lock.unlock();
 		}
 		// always clear cache
 		have_new_value = false;
@@ -263,10 +269,9 @@ namespace stream_vis {
 		uint16_t vi = val_idx_from_ts_idx[index];
 		if (vi == uint16_t(-1))
 			return false;
-		lock.lock();
-		append_sample(timestamp, reinterpret_cast<const bool&>(values[vi].value[0]));
+		while (!push_sample(timestamp, reinterpret_cast<const bool&>(values[vi].value[0])))
+			drain_full_sample_queue();
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 	streaming_time_series* bool_time_series::construct_resampled_time_series(const std::string& name, streaming_time_series* sampling_ts) const
@@ -307,21 +312,9 @@ namespace stream_vis {
 		if (bool_time_series::extract_from_values(num_values, values, timestamp, val_idx_from_ts_idx))
 			return true;
 		// otherwise store cached or nan value
-		lock.lock();
-		if (!this->initialized) {
-			this->time_offset = timestamp;
-			this->initialized = true;
-			if (this->has_ringbuffer())
-				sample_cache.reserve(this->get_ringbuffer_size());
-		}
-		stored_sample_type s(this->construct_stored_time(timestamp), uint8_t(have_new_value ? new_value : nan_value));
-		if (this->has_ringbuffer() && this->get_nr_samples() >= this->ringbuffer_size)
-			sample_cache[this->get_cached_sample_index(this->get_nr_samples())] = s;
-		else
-			sample_cache.push_back(s);
-		++this->nr_samples;
+		while (!push_sample(timestamp, uint8_t(have_new_value ? new_value : nan_value)))
+			drain_full_sample_queue();
 		outofdate = true;
-		lock.unlock();
 		have_new_value = false;
 		return true;
 	}
@@ -347,10 +340,9 @@ namespace stream_vis {
 				return false;
 			q[ci] = reinterpret_cast<const double&>(values[vi].value[0]);
 		}
-		lock.lock();
-		append_sample(timestamp, q);
+		while (!push_sample(timestamp, q))
+			drain_full_sample_queue();
 		outofdate = true;
-		lock.unlock();
 		return true;
 	}
 }
@@ -44,10 +44,12 @@ namespace stream_vis {
 	class CGV_API streaming_time_series : public cgv::render::render_types
 	{
 	protected:
-		/// mutex used to support parallel appending of new values
+		/// mutex that protects the sample cache while queued samples are drained or offsets are changed
 		mutable cgv::os::mutex lock;
 		/// keep track whether time series is out of date due to new sample
-		mutable bool outofdate;
+		mutable std::atomic<bool> outofdate;
+		/// called by the thread delivering values if the sample queue is full to drain it under the lock, which only waits while samples are read
+		void drain_full_sample_queue();
 		/// store id of value type
 		cgv::type::info::TypeId type_id;
 		/// store name of streaming time series
@@ -114,9 +116,14 @@ namespace stream_vis {
 		virtual time_series_base& series() = 0;
 		/// return whether time series is out of date
 		bool is_outofdate() const;
+		/// return mutex that needs to be locked when offsets are changed while samples are drained concurrently
+		cgv::os::mutex& ref_lock() const { return lock; }
+		/// append samples queued in extract_from_values() to the sample cache and return their number; must be called from the thread reading the samples while it holds ref_lock() during the reads
+		size_t drain_samples();
 		/// append all cached samples converted to float at end of given samples container
 		//void append_cached_samples(std::vector<vec2>& samples, unsigned component_index = 0) const;
-		/// extract new sample and return whether new value was provided in given values
+		//! extract new sample into lock free queue of time series and return whether new value was provided in given values
+		/*! Only one thread at a time must deliver values to a time series. If the queue is full, it is drained into the sample cache under the lock. */
 		virtual bool extract_from_values(uint16_t num_values, indexed_value* values, double timestamp, const uint16_t* val_idx_from_ts_idx) = 0;
 	};
 
@@ -268,10 +275,9 @@ namespace stream_vis {
 			}
 				break;
 			}
-			lock.lock();
-			this->append_sample(timestamp, pos);
+			while (!this->push_sample(timestamp, pos))
+				drain_full_sample_queue();
 			outofdate = true;
-			lock.unlock();
 			return true;
 		}
 		const time_series_base& series() const { return *this; }
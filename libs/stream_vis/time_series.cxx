@@ -110,5 +110,5 @@ namespace stream_vis {
 	template class time_series<float, int32_t, int64_t>;
 	template class time_series<float, uint32_t, uint64_t>;
 	template class time_series<float, cgv::math::fvec<float, 3>, cgv::math::fvec<double, 3>>;
-	template class time_series<float, cgv::math::quaternion<float>, cgv::math::quaternion<double>>;
+	template class time_series<float, cgv::math::quaternion<float>, cgv::math::quaternion<double>, false>;
 }
@@ -5,6 +5,7 @@
 #include <atomic>
 #include <cgv/math/fvec.h>
 #include <cgv/math/quaternion.h>
+#include "sample_queue.h"
 
 #include "lib_begin.h"
 
@@ -84,6 +85,12 @@ namespace stream_vis {
 		virtual void set_ringbuffer_size(size_t rbs);
 		/// access sample of given sample index and store components specified in tsa in passed float array that must have sufficient space
 		virtual bool put_sample_as_float(size_t sample_index, float* output, TimeSeriesAccessor tsa = TSA_ALL) const = 0;
+		/// append all samples queued with push_sample() to the sample cache and return their number; calls must be serialized with all reads of the sample cache
+		virtual size_t drain_sample_queue() = 0;
+		/// return number of times the sample queue was full, such that the thread delivering values had to drain it itself
+		virtual size_t get_nr_sample_queue_overflows() const = 0;
+		/// set capacity of sample queue (only directly after construction!!)
+		virtual void set_sample_queue_capacity(size_t capacity) = 0;
 	};
 
 	/// template class that optionally allows to subtract value offset from stored values
@@ -94,6 +101,8 @@ namespace stream_vis {
 		mutable bool value_offset_initialized;
 		mutable Value value_offset;
 	public:
+		/// values are queued before the offset is subtracted as the offset can change until the queue is drained
+		typedef Value queued_value_type;
 		time_series_value_offset(size_t _ringbuffer_size = 0) : time_series_base(_ringbuffer_size), value_offset_initialized(false) {}
 		/// return value offset
 		Value get_value_offset() const { return value_offset; }
@@ -120,6 +129,8 @@ namespace stream_vis {
 			}
 			return Store(value - value_offset);
 		}
+		/// contruct stored value from queued value
+		Store construct_stored_value_from_queued(const queued_value_type& value) const { return construct_stored_value(value); }
 	};
 	
 	/// specialization of time_series_value_offset for case where no offset is used
@@ -127,11 +138,15 @@ namespace stream_vis {
 	class time_series_value_offset<Time,Store,Value,false> : public time_series_base
 	{
 	public:
+		/// without offset values are converted to the stored type already before queueing
+		typedef Store queued_value_type;
 		time_series_value_offset(size_t _ringbuffer_size = 0) : time_series_base(_ringbuffer_size) {}
 		/// reconstruct value from stored value
 		Value reconstruct_value(const Store& stored_value) const { return stored_value; }
 		/// contruct stored value from value and in case of first value, set the value offset
 		Store construct_stored_value(const Value& value) const { return Store(value); }
+		/// contruct stored value from queued value
+		Store construct_stored_value_from_queued(const queued_value_type& value) const { return value; }
 	};
 
 	/// time series stores (time,value)-pairs of type (double,Value) in vectors optionally organized in ring buffers of type (Time,Store) relative to time- and value-offset extracted from first sample
@@ -144,8 +159,20 @@ namespace stream_vis {
 		typedef Store stored_type;
 		typedef typename std::pair<double, Value> sample_type;
 		typedef typename std::pair<Time, Store> stored_sample_type;
+		typedef typename time_series_value_offset<Time, Store, Value, use_value_offset>::queued_value_type queued_value_type;
+		typedef typename std::pair<double, queued_value_type> queued_sample_type;
 	protected:
 		std::vector<stored_sample_type> sample_cache;
+		/// samples pushed by the thread delivering values and not yet appended to the sample cache
+		sample_queue<queued_sample_type> queue;
+		/// initialize time offset from first sample
+		void init_time_offset(double time)
+		{
+			this->time_offset = time;
+			this->initialized = true;
+			if (this->has_ringbuffer())
+				sample_cache.reserve(this->get_ringbuffer_size());
+		}
 	public:
 		/// construct time series - ring buffering is turned of if size parameter is 0
 		time_series_cache(size_t _ringbuffer_size = 0) : time_series_value_offset<Time, Store, Value, use_value_offset>(_ringbuffer_size) {}
@@ -185,12 +212,8 @@ namespace stream_vis {
 		/// append a new sample by conversion to internal types
 		void append_sample(double time, const Value& value)
 		{
-			if (!this->initialized) {
-				this->time_offset = time;
-				this->initialized = true;
-				if (this->has_ringbuffer())
-					sample_cache.reserve(this->get_ringbuffer_size());
-			}
+			if (!this->initialized)
+				init_time_offset(time);
 			stored_sample_type s(this->construct_stored_time(time), this->construct_stored_value(value));
 			if (this->has_ringbuffer() && this->get_nr_samples() >= this->ringbuffer_size)
 				sample_cache[this->get_cached_sample_index(this->get_nr_samples())] = s;
@@ -198,11 +221,43 @@ namespace stream_vis {
 				sample_cache.push_back(s);
 			++this->nr_samples;
 		}
+		/// append a batch of queued samples and update the sample count only once
+		void append_queued_samples(const queued_sample_type* samples, size_t count)
+		{
+			if (count == 0)
+				return;
+			if (!this->initialized)
+				init_time_offset(samples[0].first);
+			size_t si = this->get_nr_samples();
+			size_t rbs = this->ringbuffer_size;
+			for (size_t i = 0; i < count; ++i, ++si) {
+				stored_sample_type s(this->construct_stored_time(samples[i].first), this->construct_stored_value_from_queued(samples[i].second));
+				if (rbs > 0 && si >= rbs)
+					sample_cache[si % rbs] = s;
+				else
+					sample_cache.push_back(s);
+			}
+			this->nr_samples = si;
+		}
+		/// queue a new sample from the single thread delivering values without blocking and return false if the queue was full
+		bool push_sample(double time, const queued_value_type& value) { return queue.push(queued_sample_type(time, value)); }
+		/// append all queued samples to the sample cache and return their number
+		size_t drain_sample_queue()
+		{
+			return queue.consume([this](const queued_sample_type* samples, size_t count) { append_queued_samples(samples, count); });
+		}
+		/// return number of times the sample queue was full
+		size_t get_nr_sample_queue_overflows() const { return queue.get_nr_failed_pushes(); }
+		/// set capacity of sample queue
+		void set_sample_queue_capacity(size_t capacity) { queue.set_capacity(capacity); }
 		void set_ringbuffer_size(size_t rbs)
 		{
 			time_series_base::set_ringbuffer_size(rbs);
 			if (this->ringbuffer_size > 0)
 				sample_cache.reserve(this->ringbuffer_size);
+			// allow to queue a complete ringbuffer between two drains
+			if (this->ringbuffer_size > queue.get_capacity())
+				queue.set_capacity(this->ringbuffer_size);
 		}
 	};
 
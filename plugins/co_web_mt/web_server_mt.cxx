@@ -0,0 +1,541 @@
+#include <cgv/os/web_server.h>
+#include <cgv/os/socket.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#ifdef CGV_OS_WEB_EXPORTS
+#	define CGV_EXPORTS
+#endif
+
+#include <cgv/config/lib_begin.h>
+
+using namespace cgv::os;
+
+/** portable web server provider that serves HTTP/1.1 with keep alive connections and pipelined requests.
+    The thread that starts the web server accepts connections and distributes them over a pool of worker
+	threads, each of which multiplexes its connections with a socket_select. Requests of one connection are
+	handled in order by the same worker, while handle_request of the web_server is called concurrently
+	from different workers. */
+struct CGV_API web_server_provider_mt : public web_server_provider
+{
+	void start_web_server(web_server* instance);
+	void stop_web_server(web_server* instance);
+};
+
+#include <cgv/config/lib_end.h>
+
+/// maximum size of request line and header fields
+static const size_t max_header_size = 65536;
+/// maximum size of request body
+static const size_t max_body_size = 64 << 20;
+/// number of seconds after which idle connections are closed
+static const int idle_timeout_seconds = 60;
+/// number of unsent bytes up to which further chunks of a streamed answer are generated
+static const size_t max_unsent_chunk_bytes = 256 << 10;
+
+/// worker thread with the connections handed over by the accepting thread
+struct worker
+{
+	socket_select sel;
+	/// accepted connections that have not been registered yet, where socket_ptr copies are only made under the mutex as reference counting is not thread safe
+	std::mutex pending_mutex;
+	std::vector<socket_ptr> pending;
+	/// number of connections served by the worker
+	std::atomic<unsigned> nr_connections;
+	std::thread thread;
+	worker() : nr_connections(0) {}
+};
+
+/// state of a running server shared by the serving threads and stop_web_server
+struct server_state
+{
+	web_server* instance;
+	std::vector<std::unique_ptr<worker> > workers;
+	std::atomic<bool> stop_requested;
+	/// socket_select of the accepting thread
+	socket_select* accept_select;
+	std::mutex finish_mutex;
+	std::condition_variable finish_condition;
+	bool finished;
+	server_state(web_server* _instance) : instance(_instance), stop_requested(false), accept_select(0), finished(false) {}
+};
+
+/// connection served by a worker
+struct connection
+{
+	socket_ptr sock;
+	/// received data of which the part starting at parse_pos has not been parsed yet
+	std::string input;
+	size_t parse_pos = 0;
+	/// no further requests are parsed and the connection is closed once the output has been sent
+	bool closing = false;
+	/// generator of the chunked answer that is currently streamed, during which no further requests are parsed
+	std::function<bool(std::string& chunk)> chunk_generator;
+	/// whether the streamed answer is sent without chunked framing and delimited by closing the connection, which is used for HTTP/1.0 clients
+	bool close_delimited = false;
+	std::chrono::steady_clock::time_point last_activity;
+};
+
+static std::string to_lower(std::string s)
+{
+	for (char& c : s)
+		if (c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+	return s;
+}
+
+static int hex_digit(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	return -1;
+}
+
+/// replace '+' by space and decode %xy notation
+static std::string url_decode(const std::string& s)
+{
+	std::string r;
+	r.reserve(s.size());
+	for (size_t i = 0; i < s.size(); ++i) {
+		if (s[i] == '+')
+			r += ' ';
+		else if (s[i] == '%' && i + 2 < s.size() && hex_digit(s[i + 1]) >= 0 && hex_digit(s[i + 2]) >= 0) {
+			r += char(16 * hex_digit(s[i + 1]) + hex_digit(s[i + 2]));
+			i += 2;
+		}
+		else
+			r += s[i];
+	}
+	return r;
+}
+
+/// split request target into path and decoded parameters
+static void split_target(const std::string& target, std::string& path, std::map<std::string, std::string>& params)
+{
+	size_t qm = target.find('?');
+	path = target.substr(0, qm);
+	if (qm == std::string::npos)
+		return;
+	for (size_t pos = qm + 1; pos <= target.size(); ) {
+		size_t amp = std::min(target.find('&', pos), target.size());
+		size_t eq = target.find('=', pos);
+		if (eq >= amp)
+			params[url_decode(target.substr(pos, amp - pos))] = "";
+		else
+			params[url_decode(target.substr(pos, eq - pos))] = url_decode(target.substr(eq + 1, amp - eq - 1));
+		pos = amp + 1;
+	}
+}
+
+static std::string base64_decode(const std::string& s)
+{
+	std::string r;
+	unsigned bits = 0, nr_bits = 0;
+	for (char c : s) {
+		int v;
+		if (c >= 'A' && c <= 'Z') v = c - 'A';
+		else if (c >= 'a' && c <= 'z') v = c - 'a' + 26;
+		else if (c >= '0' && c <= '9') v = c - '0' + 52;
+		else if (c == '+') v = 62;
+		else if (c == '/') v = 63;
+		else continue;
+		bits = (bits << 6) | unsigned(v);
+		nr_bits += 6;
+		if (nr_bits >= 8) {
+			nr_bits -= 8;
+			r += char((bits >> nr_bits) & 255);
+		}
+	}
+	return r;
+}
+
+/// return current time in the format of the Date header
+static std::string http_date()
+{
+	time_t t = time(0);
+	tm gmt;
+#ifdef WIN32
+	gmtime_s(&gmt, &t);
+#else
+	gmtime_r(&t, &gmt);
+#endif
+	char buffer[64];
+	strftime(buffer, sizeof(buffer), "%a, %d %b %Y %H:%M:%S GMT", &gmt);
+	return buffer;
+}
+
+/// parse request line and header fields from [begin,end) and extract the http version of the request, return false for malformed requests
+static bool parse_header(const char* begin, const char* end, http_request& req, std::string& version, bool& keep_alive, size_t& content_length)
+{
+	const char* line_end = std::find(begin, end, '\n');
+	std::string request_line(begin, line_end);
+	if (!request_line.empty() && request_line.back() == '\r')
+		request_line.pop_back();
+	size_t sp0 = request_line.find(' ');
+	size_t sp1 = sp0 == std::string::npos ? sp0 : request_line.find(' ', sp0 + 1);
+	if (sp1 == std::string::npos)
+		return false;
+	req.method = request_line.substr(0, sp0);
+	split_target(request_line.substr(sp0 + 1, sp1 - sp0 - 1), req.path, req.params);
+	version = request_line.substr(sp1 + 1);
+	keep_alive = version == "HTTP/1.1";
+	content_length = 0;
+	for (const char* p = line_end + 1; p < end; ) {
+		const char* e = std::find(p, end, '\n');
+		const char* colon = std::find(p, e, ':');
+		if (colon != e) {
+			std::string name = to_lower(std::string(p, colon));
+			const char* v = colon + 1;
+			while (v < e && (*v == ' ' || *v == '\t'))
+				++v;
+			const char* ve = e;
+			while (ve > v && (ve[-1] == '\r' || ve[-1] == ' '))
+				--ve;
+			std::string value(v, ve);
+			if (name == "connection") {
+				std::string c = to_lower(value);
+				if (c.find("close") != std::string::npos)
+					keep_alive = false;
+				else if (c.find("keep-alive") != std::string::npos)
+					keep_alive = true;
+			}
+			else if (name == "content-length")
+				content_length = size_t(strtoull(value.c_str(), 0, 10));
+			else if (name == "authorization" && to_lower(value.substr(0, 6)) == "basic ") {
+				std::string decoded = base64_decode(value.substr(6));
+				size_t pos_colon = decoded.find(':');
+				req.authentication_given = true;
+				req.username = decoded.substr(0, pos_colon);
+				req.password = pos_colon == std::string::npos ? std::string() : decoded.substr(pos_colon + 1);
+			}
+			else if (name == "accept")
+				req.accept = value;
+			else if (name == "accept-language")
+				req.accept_language = value;
+			else if (name == "accept-encoding")
+				req.accept_encoding = value;
+			else if (name == "user-agent")
+				req.user_agent = value;
+			req.headers[name] = value;
+		}
+		p = e + 1;
+	}
+	return true;
+}
+
+/// append chunk in chunked transfer encoding or without framing to output of socket, return false if sending failed
+static bool write_chunk(socket_ptr sock, const std::string& chunk, bool close_delimited)
+{
+	if (chunk.empty())
+		return true;
+	if (close_delimited)
+		return sock->write_data(chunk);
+	char size[32];
+	snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+	return sock->write_data(size, strlen(size)) && sock->write_data(chunk) && sock->write_data("\r\n", 2);
+}
+
+/// generate chunks of the streamed answer while less than max_unsent_chunk_bytes wait for being sent
+static void stream_chunks(connection& con)
+{
+	std::string chunk;
+	while (con.chunk_generator && con.sock->get_nr_of_unsent_bytes() < max_unsent_chunk_bytes) {
+		if (!con.chunk_generator(chunk)) {
+			con.chunk_generator = nullptr;
+			// close delimited answers end with closing the connection
+			if (con.close_delimited)
+				con.closing = true;
+			else
+				con.sock->write_data("0\r\n\r\n", 5);
+		}
+		else if (!write_chunk(con.sock, chunk, con.close_delimited)) {
+			// the peer does not receive any more data
+			con.chunk_generator = nullptr;
+			con.closing = true;
+		}
+		chunk.clear();
+	}
+}
+
+/// write response to request of given http version to output of socket, where chunked answers are streamed from the connection.
+/// As HTTP/1.0 clients do not support chunked transfer encoding, streamed answers to them are delimited by closing the connection
+/// and keep_alive is reset.
+static void write_response(connection& con, http_request& req, const std::string& version, bool& keep_alive)
+{
+	socket_ptr sock = con.sock;
+	con.close_delimited = req.chunk_generator && version != "HTTP/1.1";
+	if (con.close_delimited)
+		keep_alive = false;
+	std::string head = "HTTP/1.1 ";
+	if (!req.auth_realm.empty())
+		head += "401 Unauthorized\r\nWWW-Authenticate: Basic realm=\"" + req.auth_realm + "\"\r\n";
+	else
+		head += req.status + "\r\n";
+	head += "Date: " + http_date() + "\r\nServer: cgv web server\r\n";
+	head += keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n";
+	head += "Content-Type: " + (req.content_type.empty() ? std::string("text/html; charset=ISO-8859-1") : req.content_type) + "\r\n";
+	bool with_body = req.method != "HEAD";
+	if (req.chunk_generator) {
+		head += con.close_delimited ? "\r\n" : "Transfer-Encoding: chunked\r\n\r\n";
+		sock->write_data(head);
+		if (!with_body)
+			return;
+		write_chunk(sock, req.answer, con.close_delimited);
+		con.chunk_generator = std::move(req.chunk_generator);
+		stream_chunks(con);
+		return;
+	}
+	head += "Content-Length: " + std::to_string(req.answer.size()) + "\r\n\r\n";
+	if (!with_body)
+		sock->write_data(head);
+	else if (head.size() + req.answer.size() < 16384) {
+		sock->write_data(head);
+		sock->write_data(req.answer);
+	}
+	else {
+		// send large answers without copying them to the output buffer
+		socket_buffer buffers[2] = { { head.data(), head.size() }, { req.answer.data(), req.answer.size() } };
+		sock->send_buffers(buffers, 2);
+	}
+}
+
+/// write error response and stop parsing further requests
+static void write_error(connection& con, const char* status)
+{
+	std::string head = std::string("HTTP/1.1 ") + status + "\r\nDate: " + http_date() +
+		"\r\nServer: cgv web server\r\nConnection: close\r\nContent-Length: 0\r\n\r\n";
+	con.sock->write_data(head);
+	con.closing = true;
+}
+
+/// handle all complete requests in the input of a connection until an answer is streamed
+static void process_requests(server_state& state, connection& con)
+{
+	while (!con.closing && !con.chunk_generator && con.parse_pos < con.input.size()) {
+		const char* begin = con.input.data() + con.parse_pos;
+		const char* end = con.input.data() + con.input.size();
+		// find end of header, tolerating bare newlines
+		const char* header_end = 0;
+		size_t separator_size = 0;
+		for (const char* p = begin; (p = static_cast<const char*>(memchr(p, '\n', end - p))) != 0; ++p) {
+			if (p + 1 < end && p[1] == '\n') {
+				header_end = p + 1;
+				separator_size = 1;
+				break;
+			}
+			if (p + 2 < end && p[1] == '\r' && p[2] == '\n') {
+				header_end = p + 1;
+				separator_size = 2;
+				break;
+			}
+		}
+		if (!header_end) {
+			if (size_t(end - begin) > max_header_size)
+				write_error(con, "431 Request Header Fields Too Large");
+			return;
+		}
+		http_request req;
+		req.authentication_given = false;
+		req.status = "200 OK";
+		std::string version;
+		bool keep_alive;
+		size_t content_length;
+		if (!parse_header(begin, header_end, req, version, keep_alive, content_length)) {
+			write_error(con, "400 Bad Request");
+			return;
+		}
+		if (content_length > max_body_size) {
+			write_error(con, "413 Payload Too Large");
+			return;
+		}
+		const char* body = header_end + separator_size;
+		if (size_t(end - body) < content_length)
+			return;
+		req.body.assign(body, content_length);
+		req.request.assign(begin, body + content_length);
+		con.parse_pos = body + content_length - con.input.data();
+		state.instance->handle_request(req);
+		write_response(con, req, version, keep_alive);
+		if (!keep_alive)
+			con.closing = true;
+	}
+}
+
+/// serve connections handed over to the worker until a stop is requested
+static void serve(server_state& state, worker& w)
+{
+	std::unordered_map<socket*, connection> connections;
+	auto close_connection = [&](socket_ptr sock) {
+		w.sel.remove(sock);
+		sock->close();
+		connections.erase(sock.operator->());
+		--w.nr_connections;
+	};
+	auto handle_connection = [&](socket_ptr sock, int events) {
+		connection& con = connections[sock.operator->()];
+		con.last_activity = std::chrono::steady_clock::now();
+		// continue a streamed answer, after which the requests that arrived meanwhile are processed
+		if (con.chunk_generator)
+			stream_chunks(con);
+		if (!con.closing && !con.chunk_generator) {
+			sock->try_receive_data(con.input);
+			process_requests(state, con);
+			if (con.parse_pos == con.input.size()) {
+				con.input.clear();
+				con.parse_pos = 0;
+			}
+			else if (con.parse_pos > max_header_size) {
+				con.input.erase(0, con.parse_pos);
+				con.parse_pos = 0;
+			}
+		}
+		sock->flush();
+		// no further requests arrive on connections closed by the peer
+		if (sock->is_closed())
+			con.closing = true;
+		// streamed answers are continued once the socket is writable, which applies back pressure to the generator
+		if (con.chunk_generator)
+			w.sel.modify(sock, SE_WRITE);
+		else if (!con.closing)
+			w.sel.modify(sock, SE_READ);
+		else if (sock->get_nr_of_unsent_bytes() == 0)
+			close_connection(sock);
+		else
+			w.sel.modify(sock, SE_WRITE);
+	};
+	std::vector<socket_ptr> accepted;
+	auto last_sweep = std::chrono::steady_clock::now();
+	while (!state.stop_requested) {
+		{
+			std::lock_guard<std::mutex> lock(w.pending_mutex);
+			accepted = w.pending;
+			w.pending.clear();
+		}
+		for (auto& sock : accepted) {
+			connection& con = connections[sock.operator->()];
+			con.sock = sock;
+			con.last_activity = std::chrono::steady_clock::now();
+			if (!w.sel.add(sock, SE_READ, handle_connection))
+				close_connection(sock);
+		}
+		accepted.clear();
+		if (w.sel.wait(1000) < 0)
+			break;
+		// close idle connections
+		auto now = std::chrono::steady_clock::now();
+		if (now - last_sweep > std::chrono::seconds(1)) {
+			last_sweep = now;
+			std::vector<socket_ptr> idle;
+			for (auto& c : connections)
+				if (now - c.second.last_activity > std::chrono::seconds(idle_timeout_seconds))
+					idle.push_back(c.second.sock);
+			for (auto& sock : idle)
+				close_connection(sock);
+		}
+	}
+	for (auto& c : connections)
+		c.second.sock->close();
+	std::lock_guard<std::mutex> lock(w.pending_mutex);
+	for (auto& sock : w.pending)
+		sock->close();
+	w.pending.clear();
+}
+
+/// socket select of the accepting thread that stops the workers and reports the end of serving on any exit of start_web_server
+struct accept_scope
+{
+	std::shared_ptr<server_state> state;
+	socket_server_ptr server;
+	socket_select sel;
+	accept_scope(std::shared_ptr<server_state> _state, socket_server_ptr _server) : state(_state), server(_server) {}
+	~accept_scope()
+	{
+		state->stop_requested = true;
+		for (auto& w : state->workers) {
+			w->sel.wake_up();
+			if (w->thread.joinable())
+				w->thread.join();
+		}
+		sel.remove(server);
+		server->close();
+		std::lock_guard<std::mutex> lock(state->finish_mutex);
+		state->accept_select = 0;
+		state->finished = true;
+		state->finish_condition.notify_all();
+	}
+};
+
+void web_server_provider_mt::start_web_server(web_server* instance)
+{
+	std::shared_ptr<server_state> state(new server_state(instance));
+	socket_server_ptr server = create_socket_server();
+	if (!server->bind_and_listen(instance->get_port(), 128)) {
+		std::cerr << "could not start web server on port " << instance->get_port() << ": " << server->get_last_error() << std::endl;
+		return;
+	}
+	accept_scope scope(state, server);
+	socket_select& sel = scope.sel;
+	unsigned nr_workers = std::max(std::thread::hardware_concurrency(), 1u);
+	for (unsigned i = 0; i < nr_workers; ++i) {
+		state->workers.push_back(std::unique_ptr<worker>(new worker()));
+		worker& w = *state->workers.back();
+		w.thread = std::thread([state, &w]() { serve(*state, w); });
+	}
+	// hand accepted connections over to the worker with the fewest connections
+	sel.add(server, SE_READ, [&](socket_ptr, int) {
+		for (socket_ptr sock = server->check_for_connection(); sock; sock = server->check_for_connection()) {
+			worker* w = state->workers.front().get();
+			for (auto& wi : state->workers)
+				if (wi->nr_connections < w->nr_connections)
+					w = wi.get();
+			++w->nr_connections;
+			{
+				std::lock_guard<std::mutex> lock(w->pending_mutex);
+				w->pending.push_back(sock);
+				sock.clear();
+			}
+			w->sel.wake_up();
+		}
+	});
+	{
+		std::lock_guard<std::mutex> lock(state->finish_mutex);
+		state->accept_select = &sel;
+		ref_user_data(instance) = new std::shared_ptr<server_state>(state);
+	}
+	while (!state->stop_requested)
+		if (sel.wait() < 0)
+			break;
+}
+
+/// must not be called from handle_request, as the workers are joined before the accepting thread finishes
+void web_server_provider_mt::stop_web_server(web_server* instance)
+{
+	std::shared_ptr<server_state>* state_ptr = (std::shared_ptr<server_state>*)ref_user_data(instance);
+	if (!state_ptr)
+		return;
+	std::shared_ptr<server_state> state = *state_ptr;
+	ref_user_data(instance) = 0;
+	delete state_ptr;
+	// the accepting select is only accessed under the mutex, under which it is reset before it is destructed
+	std::unique_lock<std::mutex> lock(state->finish_mutex);
+	state->stop_requested = true;
+	if (state->accept_select)
+		state->accept_select->wake_up();
+	state->finish_condition.wait(lock, [&]() { return state->finished; });
+}
+
+web_server_provider_registration<web_server_provider_mt> web_server_mt_registration;
@@ -1677,6 +1677,12 @@ bool holo_view_interactor::self_reflect(cgv::reflect::reflection_handler& srh)
 		srh.reflect_member("quilt_interpolate", quilt_interpolate);
 }
 
+/// all reflected members have fixed addresses, such that the many view and display properties are set through the reflection schema
+bool holo_view_interactor::use_reflection_schema() const
+{
+	return true;
+}
+
 #ifdef REGISTER_SHADER_FILES
 #include <cgv/base/register.h>
 #include <crg_holo_view_shader_inc.h>
@@ -184,6 +184,8 @@ protected:
 	///
 	void draw_focus();
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// look up reflected members in the cached reflection schema
+	bool use_reflection_schema() const;
 	void on_set(void* m);
 	void on_rotation_change();
 
@@ -1707,6 +1707,12 @@ bool stereo_view_interactor::self_reflect(cgv::reflect::reflection_handler& srh)
 		srh.reflect_member("clip_relative_to_extent", clip_relative_to_extent);
 }
 
+/// all reflected members have fixed addresses, such that the many view properties are set through the reflection schema
+bool stereo_view_interactor::use_reflection_schema() const
+{
+	return true;
+}
+
 
 #ifndef NO_STEREO_VIEW_INTERACTOR
 
@@ -104,6 +104,8 @@ protected:
 	///
 	void draw_focus();
 	bool self_reflect(cgv::reflect::reflection_handler& srh);
+	/// look up reflected members in the cached reflection schema
+	bool use_reflection_schema() const;
 	std::string get_property_declarations();
 	bool set_void(const std::string& property, const std::string& value_type, const void* value_ptr);
 	bool get_void(const std::string& property, const std::string& value_type, void* value_ptr);
@@ -565,6 +565,7 @@ void rgbd_control::create_gui()
 		align("\a");
 		add_gui("record_path", record_path, "directory", "w=150");
 		add_member_control(this, "write_async", rgbd_inp.protocol_write_async, "toggle");
+		add_member_control(this, "compress_depth", rgbd_inp.protocol_compress_depth, "toggle");
 		add_member_control(this, "record", do_recording, "toggle");
 		connect_copy(add_button("clear record")->click, rebind(this, &rgbd_control::on_clear_protocol_cb));
 		connect_copy(add_button("save", "w=108", " ")->click, rebind(this, &rgbd_control::on_save_cb));
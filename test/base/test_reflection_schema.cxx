@@ -0,0 +1,152 @@
+#include <cgv/base/base.h>
+#include <cgv/base/register.h>
+#include <cgv/base/reflection_schema.h>
+#include <cgv/reflect/reflect_enum.h>
+#include <cgv/type/info/type_name.h>
+#include <string>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::reflect;
+
+enum SchemaTestMode { STM_POINTS, STM_LINES, STM_SURFACE };
+
+enum_reflection_traits<SchemaTestMode> get_reflection_traits(const SchemaTestMode&)
+{
+	return enum_reflection_traits<SchemaTestMode>("STM_POINTS, STM_LINES, STM_SURFACE");
+}
+
+// structure reflected as nested group, whose members are accessed with dotted path names
+struct schema_test_style : public self_reflection_tag
+{
+	float size;
+	bool blend;
+	int nr_samples;
+	schema_test_style() : size(1.0f), blend(false), nr_samples(4) {}
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			rh.reflect_member("size", size) &&
+			rh.reflect_member("blend", blend) &&
+			rh.reflect_member("nr_samples", nr_samples);
+	}
+};
+
+// node whose instances either use the schema or the reflection handlers for property access
+struct schema_test_node : public base
+{
+	bool use_schema;
+	unsigned nr_on_set;
+	int n;
+	unsigned u;
+	float f;
+	double d;
+	bool b;
+	std::string s;
+	SchemaTestMode mode;
+	schema_test_style style;
+	schema_test_node(bool _use_schema) : use_schema(_use_schema), nr_on_set(0),
+		n(1), u(2), f(3.0f), d(4.0), b(false), s("five"), mode(STM_POINTS) {}
+	std::string get_type_name() const { return "schema_test_node"; }
+	bool use_reflection_schema() const { return use_schema; }
+	void on_set(void*) { ++nr_on_set; }
+	bool self_reflect(reflection_handler& rh)
+	{
+		return
+			rh.reflect_member("n", n) &&
+			rh.reflect_member("u", u) &&
+			rh.reflect_member("f", f) &&
+			rh.reflect_member("d", d) &&
+			rh.reflect_member("b", b) &&
+			rh.reflect_member("s", s) &&
+			rh.reflect_member("mode", mode) &&
+			rh.reflect_member("style", style);
+	}
+	bool operator == (const schema_test_node& o) const
+	{
+		return nr_on_set == o.nr_on_set && n == o.n && u == o.u && f == o.f && d == o.d && b == o.b && s == o.s &&
+			mode == o.mode && style.size == o.style.size && style.blend == o.style.blend && style.nr_samples == o.style.nr_samples;
+	}
+};
+
+/// compare the string representation of a property read through the schema and through the reflection handlers
+bool equal_property(schema_test_node& a, schema_test_node& b, const std::string& property)
+{
+	std::string sa, sb;
+	bool ra = a.get_void(property, "string", &sa);
+	bool rb = b.get_void(property, "string", &sb);
+	return ra == rb && sa == sb;
+}
+
+bool test_reflection_schema()
+{
+	// the same instance type provides both access paths, such that results can be compared one to one
+	schema_test_node a(true), b(false);
+	const reflection_schema& schema = get_reflection_schema(&a);
+	TEST_ASSERT_EQ(schema.get_nr_entries(), size_t(11));
+	TEST_ASSERT(schema.find("style.nr_samples") != 0);
+	TEST_ASSERT(schema.find("unknown") == 0);
+
+	int i_val = -7;
+	unsigned u_val = 9;
+	double d_val = 2.75;
+	float f_val = 0.5f;
+	bool b_val = true;
+	std::string s_num = "12", s_text = "text", s_mode = "STM_SURFACE", s_bool = "true";
+	std::vector<base::property_assignment> assignments = {
+		{ "n", "int32", &i_val },
+		{ "n", "flt64", &d_val },
+		{ "u", "int32", &i_val },
+		{ "u", "uint32", &u_val },
+		{ "f", "flt64", &d_val },
+		{ "d", "flt32", &f_val },
+		{ "d", "string", &s_num },
+		{ "b", "bool", &b_val },
+		{ "b", "int32", &i_val },
+		{ "s", "string", &s_text },
+		{ "s", "flt64", &d_val },
+		{ "mode", "string", &s_mode },
+		{ "mode", "int32", &i_val },
+		{ "style.size", "flt64", &d_val },
+		{ "style.blend", "string", &s_bool },
+		{ "style.nr_samples", "uint32", &u_val },
+		{ "style", "string", &s_text },
+		{ "unknown", "int32", &i_val }
+	};
+	// single assignments with set_void
+	for (const auto& as : assignments) {
+		bool ra = a.set_void(as.property, as.value_type, as.value_ptr);
+		bool rb = b.set_void(as.property, as.value_type, as.value_ptr);
+		TEST_ASSERT_EQ(ra, rb);
+		TEST_ASSERT(a == b);
+		TEST_ASSERT(equal_property(a, b, as.property));
+	}
+	TEST_ASSERT_EQ(a.mode, STM_SURFACE);
+	TEST_ASSERT_EQ(a.style.size, 2.75f);
+
+	// reads into other value types
+	TEST_ASSERT_EQ(a.get<double>("n"), b.get<double>("n"));
+	TEST_ASSERT_EQ(a.get<int>("style.nr_samples"), b.get<int>("style.nr_samples"));
+	TEST_ASSERT_EQ(a.get<std::string>("mode"), "STM_SURFACE");
+	TEST_ASSERT_EQ(a.get<std::string>("mode"), b.get<std::string>("mode"));
+
+	// batch assignment
+	schema_test_node c(true), e(false);
+	unsigned nr_c = c.set_properties(assignments);
+	unsigned nr_e = e.set_properties(assignments);
+	TEST_ASSERT_EQ(nr_c, nr_e);
+	TEST_ASSERT(c == e);
+	TEST_ASSERT(c == a);
+
+	// member pointers and their types
+	std::string type_a, type_b;
+	TEST_ASSERT(a.find_member_ptr("style.blend", &type_a) == &a.style.blend);
+	TEST_ASSERT(b.find_member_ptr("style.blend", &type_b) == &b.style.blend);
+	TEST_ASSERT_EQ(type_a, type_b);
+	TEST_ASSERT(a.find_member_ptr("unknown") == 0);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_reflection_schema_reg("cgv::base::test_reflection_schema", test_reflection_schema);
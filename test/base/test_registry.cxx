@@ -0,0 +1,125 @@
+#include <cgv/base/named.h>
+#include <cgv/base/register.h>
+#include <cgv/utils/convert.h>
+#include <string>
+#include <vector>
+
+using namespace cgv::base;
+
+// named object with one of several type names
+struct registry_test_object : public named
+{
+	std::string type_name;
+	registry_test_object(const std::string& _name, const std::string& _type_name) : named(_name), type_name(_type_name) {}
+	std::string get_type_name() const { return type_name; }
+};
+
+// object without name
+struct registry_test_unnamed : public base
+{
+	std::string get_type_name() const { return "registry_test_unnamed"; }
+};
+
+/// linear search over the permanently registered objects as reference for find_object_by_name
+named_ptr find_object_by_name_reference(const std::string& name)
+{
+	for (unsigned oi = 0; oi < get_nr_permanently_registered_objects(); ++oi) {
+		named_ptr np = get_permanently_registered_object(oi)->cast<named>();
+		if (np && np->get_name() == name)
+			return np;
+	}
+	return named_ptr();
+}
+
+/// linear search over the permanently registered objects as reference for find_object_by_type
+base_ptr find_object_by_type_reference(const std::string& type_name)
+{
+	for (unsigned oi = 0; oi < get_nr_permanently_registered_objects(); ++oi) {
+		base_ptr bp = get_permanently_registered_object(oi);
+		if (bp->get_type_name() == type_name)
+			return bp;
+	}
+	return base_ptr();
+}
+
+std::string registry_test_name(unsigned i) { return std::string("registry_test_object_") + cgv::utils::to_string(i); }
+std::string registry_test_type(unsigned t) { return std::string("registry_test_type_") + cgv::utils::to_string(t); }
+
+/// check that indexed lookups agree with the reference for all test names and types
+bool check_registry_lookups(unsigned nr_objects, unsigned nr_types)
+{
+	for (unsigned i = 0; i < nr_objects; ++i)
+		if (find_object_by_name(registry_test_name(i)) != find_object_by_name_reference(registry_test_name(i)))
+			return false;
+	for (unsigned t = 0; t < nr_types; ++t)
+		if (find_object_by_type(registry_test_type(t)) != find_object_by_type_reference(registry_test_type(t)))
+			return false;
+	return find_object_by_type("registry_test_unnamed") == find_object_by_type_reference("registry_test_unnamed");
+}
+
+bool test_registry()
+{
+	// lookups need permanent registration of objects
+	TEST_ASSERT(is_registration_enabled() && is_permanent_registration_enabled());
+	if (!is_registration_enabled() || !is_permanent_registration_enabled())
+		return false;
+
+	const unsigned nr_objects = 60, nr_types = 4;
+	unsigned nr_before = get_nr_permanently_registered_objects();
+	std::vector<base_ptr> objects;
+	for (unsigned i = 0; i < nr_objects; ++i)
+		objects.push_back(new registry_test_object(registry_test_name(i), registry_test_type(i % nr_types)));
+	base_ptr unnamed(new registry_test_unnamed());
+	for (unsigned i = 0; i < nr_objects; ++i) {
+		register_object(objects[i]);
+		if (i == nr_objects / 2)
+			register_object(unnamed);
+	}
+	TEST_ASSERT_EQ(get_nr_permanently_registered_objects(), nr_before + nr_objects + 1);
+	TEST_ASSERT(check_registry_lookups(nr_objects, nr_types));
+	// the first registered object of a type is found
+	TEST_ASSERT(find_object_by_type(registry_test_type(1)) == objects[1]);
+	TEST_ASSERT(find_object_by_name(registry_test_name(17)) == objects[17]->cast<named>());
+	TEST_ASSERT(find_object_by_type("registry_test_unnamed") == unnamed);
+	TEST_ASSERT(!find_object_by_name("registry_test_object_unknown"));
+	TEST_ASSERT(!find_object_by_type("registry_test_type_unknown"));
+
+	// objects renamed after registration are found under their new name only
+	objects[5]->cast<named>()->set_name("registry_test_renamed");
+	TEST_ASSERT(find_object_by_name("registry_test_renamed") == objects[5]->cast<named>());
+	TEST_ASSERT(!find_object_by_name(registry_test_name(5)));
+	objects[5]->cast<named>()->set_name(registry_test_name(5));
+	TEST_ASSERT(find_object_by_name(registry_test_name(5)) == objects[5]->cast<named>());
+	TEST_ASSERT(!find_object_by_name("registry_test_renamed"));
+
+	// unregistering removes all registrations of an object
+	register_object(objects[2]);
+	TEST_ASSERT_EQ(get_nr_permanently_registered_objects(), nr_before + nr_objects + 2);
+	unregister_object(objects[2]);
+	TEST_ASSERT_EQ(get_nr_permanently_registered_objects(), nr_before + nr_objects);
+	TEST_ASSERT(!find_object_by_name(registry_test_name(2)));
+	TEST_ASSERT(find_object_by_type(registry_test_type(2)) == objects[6]);
+	// unregistering an object that is not registered has no effect
+	unregister_object(objects[2]);
+	TEST_ASSERT_EQ(get_nr_permanently_registered_objects(), nr_before + nr_objects);
+
+	// remove all objects of type 0 and the unnamed object
+	for (unsigned i = 0; i < nr_objects; i += nr_types)
+		unregister_object(objects[i]);
+	unregister_object(unnamed);
+	TEST_ASSERT(!find_object_by_type(registry_test_type(0)));
+	TEST_ASSERT(!find_object_by_type("registry_test_unnamed"));
+	TEST_ASSERT(check_registry_lookups(nr_objects, nr_types));
+
+	// remove the remaining objects in reverse order of registration
+	for (unsigned i = nr_objects; i > 0; --i)
+		unregister_object(objects[i - 1]);
+	TEST_ASSERT_EQ(get_nr_permanently_registered_objects(), nr_before);
+	TEST_ASSERT(check_registry_lookups(nr_objects, nr_types));
+	TEST_ASSERT(!find_object_by_type(registry_test_type(3)));
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_registry_reg("cgv::base::test_registry", test_registry);
@@ -1,10 +1,14 @@
-#include <cgv/base/signal.h>
+#include <cgv/signal/signal.h>
+#include <cgv/signal/rebind.h>
+#include <cgv/signal/bool_signal.h>
 #include <cgv/base/register.h>
-#include <cgv/base/rebind.h>
-#include <cgv/base/bool_signal.h>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 using namespace cgv::base;
+using namespace cgv::signal;
 
 void test_func(int i, const std::string& s)
 {
@@ -119,4 +123,125 @@ bool test_signal()
 	return true;
 }
 
-test_registration test_cb_signal_reg("cgv::base::test_signal", test_signal);
\ No newline at end of file
+// receiver that counts its calls
+struct counting_receiver : public tacker
+{
+	std::atomic<long>* nr_calls;
+	counting_receiver(std::atomic<long>* _nr_calls = 0) : nr_calls(_nr_calls) {}
+	void on_value(double) { ++*nr_calls; }
+};
+
+// receiver that checks in each call that it has not been destroyed, it disconnects in its own destructor as it is called from another thread
+struct checking_receiver : public tacker
+{
+	static const unsigned alive_magic = 0xA11BE;
+	std::atomic<long>* nr_calls;
+	std::atomic<long>* nr_dead_calls;
+	unsigned magic;
+	checking_receiver(std::atomic<long>* _nr_calls, std::atomic<long>* _nr_dead_calls) : nr_calls(_nr_calls), nr_dead_calls(_nr_dead_calls), magic(alive_magic) {}
+	~checking_receiver() { untack_all(); magic = 0; }
+	void on_value(double)
+	{
+		if (magic != alive_magic)
+			++*nr_dead_calls;
+		++*nr_calls;
+	}
+};
+
+// receiver that reconnects another receiver to another signal in each call
+struct reconnecting_receiver : public tacker
+{
+	std::atomic<long>* nr_calls;
+	signal<double>* other_signal;
+	reconnecting_receiver* other_receiver;
+	void on_value(double)
+	{
+		++*nr_calls;
+		disconnect(*other_signal, other_receiver, &reconnecting_receiver::on_value);
+		connect(*other_signal, other_receiver, &reconnecting_receiver::on_value);
+	}
+};
+
+// receiver that disconnects itself during emission
+struct self_disconnecting_receiver : public tacker
+{
+	signal<double>* s;
+	void on_value(double) { disconnect(*s, this, &self_disconnecting_receiver::on_value); }
+};
+
+/// emit signals from several threads while functors are connected and disconnected, which should be run with a sanitizer
+bool test_signal_threads()
+{
+	const long nr_emissions = 200000;
+	std::atomic<long> nr_calls(0);
+	signal<double> s;
+	counting_receiver permanent(&nr_calls);
+	connect(s, &permanent, &counting_receiver::on_value);
+
+	// connect and disconnect receivers while another thread emits, where receivers are destroyed right after
+	// disconnection because disconnecting waits for the emissions that are active in other threads
+	std::atomic<bool> stop(false);
+	std::thread emitter([&]() {
+		for (long i = 0; i < nr_emissions; ++i)
+			s(1.0);
+		stop = true;
+	});
+	while (!stop) {
+		counting_receiver* r = new counting_receiver(&nr_calls);
+		connect(s, r, &counting_receiver::on_value);
+		disconnect(s, r, &counting_receiver::on_value);
+		delete r;
+	}
+	emitter.join();
+	TEST_ASSERT_EQ(s.get_nr_functors(), 1u);
+	TEST_ASSERT(nr_calls >= nr_emissions);
+
+	// destroying a receiver disconnects it via its tacker, after which it is no longer called by the emitting thread
+	std::atomic<long> nr_dead_calls(0);
+	stop = false;
+	std::thread checked_emitter([&]() {
+		for (long i = 0; i < nr_emissions; ++i)
+			s(1.0);
+		stop = true;
+	});
+	while (!stop) {
+		checking_receiver* r = new checking_receiver(&nr_calls, &nr_dead_calls);
+		connect(s, r, &checking_receiver::on_value);
+		std::this_thread::yield();
+		delete r;
+	}
+	checked_emitter.join();
+	TEST_ASSERT_EQ(nr_dead_calls, 0);
+	TEST_ASSERT_EQ(s.get_nr_functors(), 1u);
+
+	// callbacks that disconnect from the signal emitted by the other thread must not dead lock
+	nr_calls = 0;
+	signal<double> a, b;
+	reconnecting_receiver ra, rb;
+	ra.nr_calls = rb.nr_calls = &nr_calls;
+	ra.other_signal = &b;
+	ra.other_receiver = &rb;
+	rb.other_signal = &a;
+	rb.other_receiver = &ra;
+	connect(a, &ra, &reconnecting_receiver::on_value);
+	connect(b, &rb, &reconnecting_receiver::on_value);
+	std::thread emitter_a([&]() { for (long i = 0; i < nr_emissions / 10; ++i) a(1.0); });
+	std::thread emitter_b([&]() { for (long i = 0; i < nr_emissions / 10; ++i) b(1.0); });
+	emitter_a.join();
+	emitter_b.join();
+	TEST_ASSERT_EQ(a.get_nr_functors(), 1u);
+	TEST_ASSERT_EQ(b.get_nr_functors(), 1u);
+
+	// disconnecting from within an emission of the same signal keeps the emitted functors alive
+	self_disconnecting_receiver sd;
+	sd.s = &s;
+	connect(s, &sd, &self_disconnecting_receiver::on_value);
+	nr_calls = 0;
+	s(1.0);
+	TEST_ASSERT_EQ(nr_calls, 1);
+	TEST_ASSERT_EQ(s.get_nr_functors(), 1u);
+	return true;
+}
+
+test_registration test_cb_signal_reg("cgv::base::test_signal", test_signal);
+test_registration test_cb_signal_threads_reg("cgv::base::test_signal_threads", test_signal_threads);
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include <point_cloud/point_cloud.h>
+#include <point_cloud/mapped_point_cloud.h>
+#include <cgv/utils/stopwatch.h>
+#include <cgv/utils/file.h>
+#include <iostream>
+#include <cstdlib>
+
+/// return number of points whose position, normal or color differ between the fread based and the mapped reader
+size_t count_mismatches(const point_cloud& pc, const mapped_point_cloud& mpc)
+{
+	if (pc.get_nr_points() != mpc.get_nr_points() || pc.has_normals() != mpc.has_normals() || pc.has_colors() != mpc.has_colors())
+		return pc.get_nr_points() + mpc.get_nr_points();
+	size_t nr_mismatches = 0;
+	for (size_t i = 0; i < pc.get_nr_points(); ++i)
+		if (pc.pnt(i) != mpc.pnt(i) || (pc.has_normals() && pc.nml(i) != mpc.nml(i)) || (pc.has_colors() && !(pc.clr(i) == mpc.clr(i))))
+			++nr_mismatches;
+	return nr_mismatches;
+}
+
+/// write a bpc file, read it with point_cloud::read and with mapped_point_cloud, check that both agree and report timings
+int main(int argc, char** argv)
+{
+	size_t nr_points = argc > 1 ? (size_t)atoll(argv[1]) : 10000000;
+	std::string file_name = argc > 2 ? argv[2] : "bpc_load_benchmark.bpc";
+	{
+		point_cloud pc;
+		pc.create_normals();
+		pc.create_colors();
+		pc.resize(nr_points);
+		for (size_t i = 0; i < nr_points; ++i) {
+			float x = float(i % 1000), y = float(i / 1000 % 1000), z = float(i / 1000000);
+			pc.pnt(i) = point_cloud::Pnt(x, y, z);
+			pc.nml(i) = normalize(point_cloud::Nml(x + 1.0f, y, 1.0f));
+			pc.clr(i) = point_cloud::Clr(point_cloud::ClrComp(i % 256), point_cloud::ClrComp(128), point_cloud::ClrComp(64));
+		}
+		if (!pc.write(file_name)) {
+			std::cerr << "could not write " << file_name << std::endl;
+			return 1;
+		}
+	}
+	std::cout << nr_points << " points (" << cgv::utils::file::size(file_name) / (1024 * 1024) << " MB)" << std::endl;
+	double t_read = 0, t_open = 0, t_extract = 0;
+	point_cloud pc;
+	{
+		cgv::utils::stopwatch s(&t_read, true);
+		pc.read(file_name);
+	}
+	size_t nr_mismatches = 0, nr_extract_mismatches = 0;
+	{
+		mapped_point_cloud mpc;
+		{
+			cgv::utils::stopwatch s(&t_open, true);
+			mpc.open(file_name);
+		}
+		nr_mismatches = count_mismatches(pc, mpc);
+		point_cloud extracted;
+		{
+			cgv::utils::stopwatch s(&t_extract, true);
+			mpc.extract(extracted);
+		}
+		nr_extract_mismatches = count_mismatches(extracted, mpc);
+	}
+	cgv::utils::file::remove(file_name);
+	std::cout << "fread read " << t_read << "s, mapped open " << t_open << "s, extract " << t_extract << "s" << std::endl;
+	if (nr_mismatches + nr_extract_mismatches > 0) {
+		std::cerr << nr_mismatches << " mapped and " << nr_extract_mismatches << " extracted points differ from fread result" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,91 @@
+#include <point_cloud/octree.h>
+#include <cgv/utils/stopwatch.h>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <tuple>
+
+using namespace cgv::pointcloud;
+
+/// sort points by position
+void sort_by_position(std::vector<SimpleLODPoint>& points)
+{
+	std::sort(points.begin(), points.end(), [](const SimpleLODPoint& a, const SimpleLODPoint& b) {
+		return std::tie(a.position()[0], a.position()[1], a.position()[2]) < std::tie(b.position()[0], b.position()[1], b.position()[2]);
+	});
+}
+
+/// measures throughput of octree_lod_generator::generate_lods for increasing numbers of threads and checks that the streamed generation keeps all points
+int main(int argc, char** argv)
+{
+	size_t nr_points = argc > 1 ? (size_t)atoll(argv[1]) : 10000000;
+	unsigned max_nr_threads = argc > 2 ? (unsigned)atoi(argv[2]) : std::max(std::thread::hardware_concurrency(), 1u);
+
+	// random points on a noisy height field with a few dense clusters
+	std::vector<SimpleLODPoint> points(nr_points);
+	{
+		std::default_random_engine E;
+		std::uniform_real_distribution<float> D(0.0f, 100.0f);
+		std::normal_distribution<float> N(0.0f, 1.0f);
+		for (size_t i = 0; i < nr_points; ++i) {
+			SimpleLODPoint& p = points[i];
+			float x = D(E), y = D(E);
+			if (i % 4 == 0) {
+				x = 25.0f + 2.0f * N(E);
+				y = 75.0f + 2.0f * N(E);
+			}
+			p.position() = cgv::render::render_types::vec3(x, y, 5.0f * std::sin(0.1f * x) * std::cos(0.1f * y) + 0.1f * N(E));
+			p.color() = cgv::render::render_types::rgb8(128, 128, 128);
+			p.level() = 0;
+		}
+	}
+	std::cout << "lod generation of " << nr_points << " points" << std::endl;
+	octree_lod_generator<SimpleLODPoint> generator(false);
+	double t_single = 0;
+	// powers of two followed by the maximum number of threads
+	std::vector<unsigned> thread_counts;
+	for (unsigned nr_threads = 1; nr_threads < max_nr_threads; nr_threads *= 2)
+		thread_counts.push_back(nr_threads);
+	thread_counts.push_back(max_nr_threads);
+	for (unsigned nr_threads : thread_counts) {
+		generator.init(nr_threads);
+		double t = 0;
+		size_t nr_out;
+		{
+			cgv::utils::stopwatch s(&t);
+			nr_out = generator.generate_lods(points).size();
+		}
+		if (nr_threads == 1)
+			t_single = t;
+		std::cout << nr_threads << " threads: " << t << "s, " << nr_out / t * 1e-6 << " Mpoints/s, speedup " << t_single / t << std::endl;
+	}
+	// streamed generation through temporary files
+	std::string input_file_name = "lod_generation_benchmark.bin", lod_file_name = "lod_generation_benchmark.lod";
+	FILE* fp = fopen(input_file_name.c_str(), "wb");
+	if (!fp || fwrite(points.data(), sizeof(SimpleLODPoint), points.size(), fp) != points.size()) {
+		std::cerr << "could not write " << input_file_name << std::endl;
+		return 1;
+	}
+	fclose(fp);
+	std::vector<SimpleLODPoint> streamed;
+	double t = 0;
+	bool success;
+	{
+		FilePointSource<SimpleLODPoint> source(input_file_name);
+		cgv::utils::stopwatch s(&t);
+		success = generator.generate_lods_streamed(source, lod_file_name, ".") &&
+			octree_lod_generator<SimpleLODPoint>::read_lod_file(lod_file_name, streamed);
+	}
+	remove(input_file_name.c_str());
+	remove(lod_file_name.c_str());
+	sort_by_position(points);
+	sort_by_position(streamed);
+	bool same_points = success && streamed.size() == points.size();
+	for (size_t i = 0; same_points && i < points.size(); ++i)
+		same_points = points[i].position() == streamed[i].position();
+	std::cout << "streamed: " << t << "s, " << (same_points ? "all points kept" : "POINTS DIFFER") << std::endl;
+	return same_points ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+#include <point_cloud/point_depth_sorter.h>
+#include <cgv/utils/stopwatch.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+
+typedef point_cloud_types::Pnt Pnt;
+typedef point_cloud_types::Dir Dir;
+
+/// compares std::sort with a comparator computing depths against radix sort and incremental sorting for small view rotations, where correctness is checked in test_point_depth_sorter
+int main(int argc, char** argv)
+{
+	size_t nr_points = argc > 1 ? (size_t)atoll(argv[1]) : 20000000;
+	float degrees_per_frame = argc > 2 ? (float)atof(argv[2]) : 0.5f;
+	unsigned nr_frames = argc > 3 ? (unsigned)atoi(argv[3]) : 10;
+	std::vector<Pnt> points(nr_points);
+	std::default_random_engine E;
+	std::uniform_real_distribution<float> D(-10.0f, 10.0f);
+	for (auto& p : points)
+		p = Pnt(D(E), D(E), D(E));
+	std::vector<uint32_t> indices(nr_points);
+	Dir view_dir(0.0f, 0.0f, -1.0f);
+	double t_std = 0, t_radix = 0, t_reuse = 0;
+	// comparator based sort as previously done in gl_point_cloud_drawable
+	for (size_t i = 0; i < nr_points; ++i)
+		indices[i] = uint32_t(i);
+	{
+		cgv::utils::stopwatch s(&t_std, true);
+		std::sort(indices.begin(), indices.end(), [&](uint32_t i, uint32_t j) { return dot(points[i], view_dir) > dot(points[j], view_dir); });
+	}
+	point_depth_sorter sorter;
+	for (size_t i = 0; i < nr_points; ++i)
+		indices[i] = uint32_t(i);
+	{
+		cgv::utils::stopwatch s(&t_radix, true);
+		sorter.sort_back_to_front(&points[0], indices, view_dir);
+	}
+	// rotate view around y-axis and reuse order of previous frame
+	float angle = degrees_per_frame * 3.14159265f / 180.0f;
+	unsigned nr_incremental = 0;
+	for (unsigned f = 1; f <= nr_frames; ++f) {
+		view_dir = Dir(std::sin(f * angle), 0.0f, -std::cos(f * angle));
+		cgv::utils::stopwatch s(&t_reuse, true);
+		sorter.sort_back_to_front(&points[0], indices, view_dir, true);
+		if (sorter.was_last_sort_incremental())
+			++nr_incremental;
+	}
+	std::cout << "back to front sorting of " << nr_points << " points: std::sort " << t_std << "s, radix sort " << t_radix << "s, reused order "
+		<< t_reuse / nr_frames << "s per frame for " << degrees_per_frame << " degrees per frame with " << nr_incremental << " of " << nr_frames << " frames incremental" << std::endl;
+	return 0;
+}
@@ -0,0 +1,103 @@
+#include <cgv/base/register.h>
+#include <point_cloud/ann_tree.h>
+#include <point_cloud/ICP.h>
+#include <algorithm>
+#include <random>
+
+using namespace cgv::base;
+
+typedef point_cloud_types::Pnt Pnt;
+typedef point_cloud_types::Idx Idx;
+typedef point_cloud_types::Crd Crd;
+typedef point_cloud_types::Cnt Cnt;
+
+bool test_ann_tree()
+{
+	std::default_random_engine E(9);
+	std::uniform_real_distribution<float> D(-1.0f, 1.0f);
+	point_cloud pc;
+	pc.resize(5000);
+	for (Idx i = 0; i < (Idx)pc.get_nr_points(); ++i)
+		pc.pnt(i) = Pnt(D(E), D(E), D(E));
+	ann_tree tree;
+	tree.build(pc);
+	// more queries than one chunk of the batched queries, some outside of the cloud
+	std::vector<Pnt> queries(3000);
+	for (auto& q : queries)
+		q = Pnt(1.2f * D(E), 1.2f * D(E), 1.2f * D(E));
+	Cnt n = Cnt(queries.size());
+	cgv::pointcloud::utility::WorkerPool pool(3);
+
+	// batched closest point queries match sequential ones
+	std::vector<Idx> closest(n, -1);
+	tree.find_closest(&queries[0], n, &closest[0], pool);
+	for (Cnt i = 0; i < n; ++i)
+		TEST_ASSERT_EQ(closest[i], tree.find_closest(queries[i]));
+
+	// batched knn queries match sequential ones with and without distance output
+	const Idx k = 7;
+	std::vector<Idx> knn_indices(n * k, -1), knn_indices_no_dists(n * k, -1);
+	std::vector<Crd> knn_sqr_dists(n * k, -1.0f);
+	tree.find_closest_points(&queries[0], n, k, &knn_indices[0], &knn_sqr_dists[0], pool);
+	tree.find_closest_points(&queries[0], n, k, &knn_indices_no_dists[0], 0, pool);
+	TEST_ASSERT(knn_indices == knn_indices_no_dists);
+	std::vector<const Pnt*> knn;
+	for (Cnt i = 0; i < n; ++i) {
+		tree.find_closest_points(queries[i], k, knn);
+		for (Idx j = 0; j < k; ++j) {
+			const Pnt& p = pc.pnt(knn_indices[i * k + j]);
+			TEST_ASSERT(p == *knn[j]);
+			TEST_ASSERT(std::abs(knn_sqr_dists[i * k + j] - sqr_length(p - queries[i])) < 1e-5f);
+		}
+	}
+
+	// batched radius queries match sequential ones, including queries without points in range
+	std::vector<size_t> offsets;
+	std::vector<Idx> indices, seq_indices;
+	tree.find_points_in_radius(&queries[0], n, 0.1f, offsets, indices, pool);
+	TEST_ASSERT_EQ(offsets.size(), size_t(n) + 1);
+	TEST_ASSERT_EQ(offsets[n], indices.size());
+	Cnt nr_empty = 0;
+	for (Cnt i = 0; i < n; ++i) {
+		Cnt c = tree.find_points_in_radius(queries[i], 0.1f, seq_indices);
+		TEST_ASSERT_EQ(offsets[i + 1] - offsets[i], size_t(c));
+		if (c == 0)
+			++nr_empty;
+		else {
+			std::vector<Idx> batch_indices(indices.begin() + offsets[i], indices.begin() + offsets[i + 1]);
+			std::sort(batch_indices.begin(), batch_indices.end());
+			std::sort(seq_indices.begin(), seq_indices.end());
+			TEST_ASSERT(batch_indices == seq_indices);
+		}
+	}
+	TEST_ASSERT(nr_empty > 0 && nr_empty < n);
+
+	// empty batches leave outputs untouched
+	tree.find_closest(&queries[0], 0, &closest[0], pool);
+	tree.find_points_in_radius(&queries[0], 0, 0.1f, offsets, indices, pool);
+	TEST_ASSERT(offsets.size() == 1 && indices.empty());
+
+	// icp with an empty source keeps the given transformation and aligning a cloud with itself yields the identity
+	cgv::pointcloud::ICP icp;
+	point_cloud empty;
+	icp.set_target_cloud(pc);
+	icp.set_source_cloud(empty);
+	point_cloud_types::Mat R;
+	R.identity();
+	point_cloud_types::Dir t(0.0f);
+	icp.reg_icp(R, t);
+	TEST_ASSERT(R(0, 0) == 1.0f && R(0, 1) == 0.0f && t == point_cloud_types::Dir(0.0f));
+	icp.set_source_cloud(pc);
+	icp.set_iterations(5);
+	icp.reg_icp(R, t);
+	for (int i = 0; i < 3; ++i) {
+		TEST_ASSERT(std::abs(t(i)) < 1e-4f);
+		for (int j = 0; j < 3; ++j)
+			TEST_ASSERT(std::abs(R(i, j) - (i == j ? 1.0f : 0.0f)) < 1e-4f);
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_ann_tree_reg("point_cloud::ann_tree", test_ann_tree);
@@ -0,0 +1,189 @@
+#include <cgv/base/register.h>
+#include <point_cloud/point_cloud.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace cgv::base;
+
+typedef point_cloud_types::Pnt Pnt;
+typedef point_cloud_types::Nml Nml;
+typedef point_cloud_types::Clr Clr;
+typedef point_cloud_types::PixCrd PixCrd;
+typedef point_cloud_types::Idx Idx;
+
+/// gives access to the sizes of the attribute vectors that are filled by parse_ascii_columns
+struct test_ascii_point_cloud : public point_cloud
+{
+	size_t get_nr_normals() const { return N.size(); }
+	size_t get_nr_colors() const { return C.size(); }
+	size_t get_nr_pixel_coordinates() const { return I.size(); }
+	void set_no_normals_contained(bool value) { no_normals_contained = value; }
+};
+
+/// point with attributes as expected after parsing
+struct ascii_test_point
+{
+	Pnt p;
+	Nml n;
+	int c[3];
+	PixCrd i;
+};
+
+/// return color from byte components
+Clr byte_color(const int* c)
+{
+	return Clr(point_cloud::byte_to_color_component(c[0]), point_cloud::byte_to_color_component(c[1]), point_cloud::byte_to_color_component(c[2]));
+}
+
+/// parse text with several chunk sizes and numbers of chunks and check against the expected points
+bool check_ascii_parsing(const std::string& text, const point_cloud::ascii_layout& layout, const std::vector<ascii_test_point>& expected)
+{
+	size_t min_chunk_sizes[] = { 1, 7, 64, size_t(1) << 20 };
+	unsigned max_nr_chunks[] = { 1, 2, 3, 8 };
+	for (size_t min_chunk_size : min_chunk_sizes)
+		for (unsigned nr_chunks : max_nr_chunks) {
+			test_ascii_point_cloud pc;
+			pc.parse_ascii_columns(text.data(), text.data() + text.size(), layout, min_chunk_size, nr_chunks);
+			if (pc.get_nr_points() != expected.size())
+				return false;
+			if (pc.get_nr_normals() != (layout.nml_col >= 0 ? expected.size() : 0) ||
+				pc.get_nr_colors() != (layout.clr_col >= 0 || layout.gray_col >= 0 ? expected.size() : 0) ||
+				pc.get_nr_pixel_coordinates() != (layout.pix_col >= 0 ? expected.size() : 0))
+				return false;
+			for (size_t i = 0; i < expected.size(); ++i) {
+				if (pc.pnt(i) != expected[i].p)
+					return false;
+				if (layout.nml_col >= 0 && pc.nml(i) != expected[i].n)
+					return false;
+				if ((layout.clr_col >= 0 || layout.gray_col >= 0) && !(pc.clr(i) == byte_color(expected[i].c)))
+					return false;
+				if (layout.pix_col >= 0 && pc.pixcrd(i) != expected[i].i)
+					return false;
+			}
+		}
+	return true;
+}
+
+bool test_ascii_point_cloud_reader()
+{
+	std::default_random_engine E(3);
+	std::uniform_int_distribution<int> B(0, 255);
+	std::uniform_int_distribution<int> D(-1000, 1000);
+	point_cloud::ascii_layout layout;
+	test_ascii_point_cloud detector;
+
+	// <x y z r g b I> with comments, invalid and empty lines, crlf, different separators and a last line without newline
+	std::vector<ascii_test_point> expected;
+	std::stringstream ss;
+	const char* separators[] = { " ", "\t", ", ", ";", " \t " };
+	for (int i = 0; i < 400; ++i) {
+		if (i % 13 == 0)
+			ss << "# comment line 1 2 3\n";
+		if (i % 17 == 0)
+			ss << "\n1 2\r\n";
+		ascii_test_point q;
+		q.p = Pnt(D(E) * 0.25f, D(E) * 0.5f, float(D(E)));
+		for (int c = 0; c < 3; ++c)
+			q.c[c] = B(E);
+		const char* s = separators[i % 5];
+		ss << q.p[0] << s << q.p[1] << s << q.p[2] << s << q.c[0] << s << q.c[1] << s << q.c[2] << s << D(E) * 0.01 + 0.5;
+		if (i + 1 < 400)
+			ss << (i % 3 == 0 ? "\r\n" : "\n");
+		expected.push_back(q);
+	}
+	std::string text = ss.str();
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout, "xyz"));
+	TEST_ASSERT(layout.nr_columns == 7 && layout.clr_col == 3 && layout.color_scale == 1.0 && layout.nml_col == -1);
+	TEST_ASSERT(check_ascii_parsing(text, layout, expected));
+	// an empty text and a text without valid lines give no points
+	TEST_ASSERT(check_ascii_parsing("", layout, {}));
+	TEST_ASSERT(check_ascii_parsing("# only\n1 2\n\nx y z\n", layout, {}));
+
+	// <x y z I r g b> where the intensity is no byte
+	ss.str("");
+	for (auto& q : expected)
+		ss << q.p[0] << ' ' << q.p[1] << ' ' << q.p[2] << ' ' << D(E) * 3 + 0.25 << ' ' << q.c[0] << ' ' << q.c[1] << ' ' << q.c[2] << '\n';
+	text = ss.str();
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout, "xyz"));
+	TEST_ASSERT(layout.nr_columns == 7 && layout.clr_col == 4);
+	TEST_ASSERT(check_ascii_parsing(text, layout, expected));
+	// if intensity and colors are bytes the format hint decides
+	ss.str("");
+	for (auto& q : expected)
+		ss << q.p[0] << ' ' << q.p[1] << ' ' << q.p[2] << ' ' << q.c[0] << ' ' << q.c[1] << ' ' << q.c[2] << ' ' << q.c[0] << '\n';
+	text = ss.str();
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout, "xyz"));
+	TEST_ASSERT(layout.clr_col == 3);
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout, "txt"));
+	TEST_ASSERT(layout.clr_col == 4);
+
+	// <x y z nx ny nz> with unit length normals against <x y z r g b> with byte and unit colors
+	std::uniform_real_distribution<float> U(-1.0f, 1.0f);
+	ss.str("");
+	for (auto& q : expected) {
+		q.n = normalize(Nml(U(E), U(E), U(E) + 2.0f));
+		ss << q.p[0] << ' ' << q.p[1] << ' ' << q.p[2] << ' ' << q.n[0] << ' ' << q.n[1] << ' ' << q.n[2] << '\n';
+	}
+	text = ss.str();
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout));
+	TEST_ASSERT(layout.nr_columns == 6 && layout.nml_col == 3 && layout.clr_col == -1);
+	ss.str("");
+	for (auto& q : expected)
+		ss << q.p[0] << ' ' << q.p[1] << ' ' << q.p[2] << ' ' << q.c[0] << ' ' << q.c[1] << ' ' << q.c[2] << '\n';
+	text = ss.str();
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout));
+	TEST_ASSERT(layout.nr_columns == 6 && layout.nml_col == -1 && layout.clr_col == 3 && layout.color_scale == 1.0);
+	TEST_ASSERT(check_ascii_parsing(text, layout, expected));
+	ss.str("");
+	for (auto& q : expected)
+		ss << q.p[0] << ' ' << q.p[1] << ' ' << q.p[2] << ' ' << q.c[0] / 255.0 << ' ' << q.c[1] / 255.0 << ' ' << q.c[2] / 255.0 << '\n';
+	text = ss.str();
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout));
+	TEST_ASSERT(layout.clr_col == 3 && layout.color_scale == 255.0);
+	TEST_ASSERT(check_ascii_parsing(text, layout, expected));
+	// points files contain normals unless the reader is told otherwise
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout, "points"));
+	TEST_ASSERT(layout.nml_col == 3 && layout.clr_col == -1);
+	detector.set_no_normals_contained(true);
+	TEST_ASSERT(detector.detect_ascii_layout(text.data(), text.data() + text.size(), layout, "points"));
+	TEST_ASSERT(layout.nml_col == -1 && layout.clr_col == 3);
+
+	// pct files with lines <i j z x y I>, where the intensity is optional and the header line is skipped
+	const std::string file_name = "test_ascii_point_cloud.pct";
+	{
+		std::ofstream os(file_name.c_str());
+		os << "1 2 3 4 5 6\n";
+		for (int i = 0; i < 300; ++i) {
+			ascii_test_point& q = expected[i];
+			q.i = PixCrd(i % 20, i / 20);
+			if (i % 7 == 0)
+				os << "0 0 1\n";
+			os << q.i[0] << ' ' << q.i[1] << ' ' << q.p[2] << ' ' << q.p[0] << ' ' << q.p[1];
+			if (i % 4 == 0)
+				q.c[0] = q.c[1] = q.c[2] = 0;
+			else {
+				q.c[1] = q.c[2] = q.c[0];
+				os << ' ' << q.c[0];
+			}
+			os << "\r\n";
+		}
+	}
+	expected.resize(300);
+	point_cloud pc;
+	TEST_ASSERT(pc.read(file_name));
+	TEST_ASSERT(pc.has_colors() && pc.has_pixel_coordinates() && !pc.has_normals());
+	TEST_ASSERT_EQ(size_t(pc.get_nr_points()), expected.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		TEST_ASSERT(pc.pnt(i) == expected[i].p);
+		TEST_ASSERT(pc.pixcrd(i) == expected[i].i);
+		TEST_ASSERT(pc.clr(i) == byte_color(expected[i].c));
+	}
+	std::remove(file_name.c_str());
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_ascii_point_cloud_reg("point_cloud::ascii_reader", test_ascii_point_cloud_reader);
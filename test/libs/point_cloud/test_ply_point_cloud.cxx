@@ -0,0 +1,149 @@
+#include <cgv/base/register.h>
+#include <point_cloud/point_cloud.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+using namespace cgv::base;
+
+typedef point_cloud_types::Pnt Pnt;
+typedef point_cloud_types::Nml Nml;
+typedef point_cloud_types::Clr Clr;
+
+/// gives access to the ply reader and writer
+struct ply_test_point_cloud : public point_cloud
+{
+	using point_cloud::read_ply_fast;
+	using point_cloud::read_ply;
+	using point_cloud::write_ply;
+};
+
+/// property of a generated ply file
+struct ply_test_property
+{
+	const char* type;
+	const char* name;
+};
+
+/// write the same vertex values as binary little endian ply and as ascii ply, where values are converted to the property types
+void write_ply_test_files(const std::string& binary_file_name, const std::string& ascii_file_name,
+	const std::vector<ply_test_property>& props, const std::vector<std::vector<double> >& values)
+{
+	std::ostringstream header;
+	header << "element vertex " << values.size() << "\n";
+	for (const auto& p : props)
+		header << "property " << p.type << " " << p.name << "\n";
+	header << "element face 0\nproperty list uchar int vertex_indices\nend_header\n";
+	std::ofstream bos(binary_file_name.c_str(), std::ios::binary);
+	std::ofstream aos(ascii_file_name.c_str());
+	bos << "ply\nformat binary_little_endian 1.0\ncomment generated by test\n" << header.str();
+	aos << "ply\nformat ascii 1.0\n" << header.str();
+	aos.precision(17);
+	for (const auto& v : values) {
+		for (size_t j = 0; j < props.size(); ++j) {
+			std::string t = props[j].type;
+			char bytes[8];
+			size_t size;
+			if (t == "uchar") { uint8_t x = uint8_t(v[j]); memcpy(bytes, &x, size = 1); }
+			else if (t == "short") { int16_t x = int16_t(v[j]); memcpy(bytes, &x, size = 2); }
+			else if (t == "uint") { uint32_t x = uint32_t(v[j]); memcpy(bytes, &x, size = 4); }
+			else if (t == "float") { float x = float(v[j]); memcpy(bytes, &x, size = 4); }
+			else { memcpy(bytes, &v[j], size = 8); }
+			bos.write(bytes, size);
+			aos << (j > 0 ? " " : "") << v[j];
+		}
+		aos << "\n";
+	}
+}
+
+/// check that two point clouds have the same attributes
+bool equal_point_clouds(const point_cloud& a, const point_cloud& b)
+{
+	if (a.get_nr_points() != b.get_nr_points() || a.has_normals() != b.has_normals() || a.has_colors() != b.has_colors())
+		return false;
+	for (size_t i = 0; i < a.get_nr_points(); ++i) {
+		if (a.pnt(i) != b.pnt(i))
+			return false;
+		if (a.has_normals() && a.nml(i) != b.nml(i))
+			return false;
+		if (a.has_colors() && !(a.clr(i) == b.clr(i)))
+			return false;
+	}
+	return true;
+}
+
+bool test_ply_point_cloud()
+{
+	const std::string binary_file_name = "test_ply_point_cloud_binary.ply", ascii_file_name = "test_ply_point_cloud_ascii.ply";
+	std::default_random_engine E(11);
+	std::uniform_int_distribution<int> B(0, 255), S(-3000, 3000);
+	std::uniform_real_distribution<double> U(-1.0, 1.0);
+
+	// positions of mixed types that are no consecutive floats, unused properties and byte colors
+	std::vector<ply_test_property> props = {
+		{ "double", "x" }, { "float", "y" }, { "short", "z" }, { "uchar", "flags" }, { "float", "nx" }, { "float", "ny" }, { "float", "nz" },
+		{ "uint", "id" }, { "uchar", "red" }, { "uchar", "green" }, { "uchar", "blue" }, { "uchar", "alpha" } };
+	std::vector<std::vector<double> > values(2000);
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = { 100 * U(E), float(U(E)), double(S(E)), double(B(E)), float(U(E)), float(U(E)), float(U(E)), double(i), double(B(E)), double(B(E)), double(B(E)), double(B(E)) };
+	write_ply_test_files(binary_file_name, ascii_file_name, props, values);
+	ply_test_point_cloud fast, reference;
+	TEST_ASSERT(fast.read_ply_fast(binary_file_name));
+	TEST_ASSERT(!reference.read_ply_fast(ascii_file_name));
+	TEST_ASSERT(reference.read_ply(ascii_file_name));
+	TEST_ASSERT(fast.has_normals() && fast.has_colors());
+	TEST_ASSERT(equal_point_clouds(fast, reference));
+	TEST_ASSERT(fast.pnt(7) == Pnt(float(values[7][0]), float(values[7][1]), float(values[7][2])));
+	TEST_ASSERT(fast.clr(7) == Clr(point_cloud::byte_to_color_component(uint8_t(values[7][8])),
+		point_cloud::byte_to_color_component(uint8_t(values[7][9])), point_cloud::byte_to_color_component(uint8_t(values[7][10]))));
+
+	// intensity without colors is stored as gray color
+	props = { { "float", "x" }, { "float", "y" }, { "float", "z" }, { "uchar", "intensity" } };
+	for (auto& v : values)
+		v = { U(E), U(E), U(E), double(B(E)) };
+	write_ply_test_files(binary_file_name, ascii_file_name, props, values);
+	TEST_ASSERT(fast.read_ply_fast(binary_file_name));
+	TEST_ASSERT(reference.read_ply(ascii_file_name));
+	TEST_ASSERT(fast.has_colors() && !fast.has_normals());
+	TEST_ASSERT(equal_point_clouds(fast, reference));
+	TEST_ASSERT(fast.clr(3)[0] == fast.clr(3)[2] && fast.clr(3)[0] == point_cloud::byte_to_color_component(uint8_t(values[3][3])));
+
+	// truncated files and files without complete positions are rejected by the fast path
+	std::filesystem::resize_file(binary_file_name, std::filesystem::file_size(binary_file_name) - 1);
+	TEST_ASSERT(!fast.read_ply_fast(binary_file_name));
+	props = { { "float", "x" }, { "float", "y" } };
+	for (auto& v : values)
+		v = { U(E), U(E) };
+	write_ply_test_files(binary_file_name, ascii_file_name, props, values);
+	TEST_ASSERT(!fast.read_ply_fast(binary_file_name));
+
+	// round trip of write_ply with more points than one chunk of the parallel conversion, with and without attributes
+	ply_test_point_cloud pc;
+	pc.resize(70000);
+	pc.create_normals();
+	pc.create_colors();
+	for (size_t i = 0; i < pc.get_nr_points(); ++i) {
+		pc.pnt(i) = Pnt(float(U(E)), float(U(E)), float(U(E)));
+		pc.nml(i) = Nml(float(U(E)), float(U(E)), float(U(E)));
+		pc.clr(i) = Clr(point_cloud::byte_to_color_component(uint8_t(B(E))), point_cloud::byte_to_color_component(uint8_t(B(E))), point_cloud::byte_to_color_component(uint8_t(B(E))));
+	}
+	TEST_ASSERT(pc.write_ply(binary_file_name));
+	TEST_ASSERT(fast.read_ply(binary_file_name));
+	TEST_ASSERT(equal_point_clouds(pc, fast));
+	pc.destruct_normals();
+	pc.destruct_colors();
+	TEST_ASSERT(pc.write_ply(binary_file_name));
+	TEST_ASSERT(fast.read_ply(binary_file_name));
+	TEST_ASSERT(!fast.has_normals() && !fast.has_colors());
+	TEST_ASSERT(equal_point_clouds(pc, fast));
+	std::remove(binary_file_name.c_str());
+	std::remove(ascii_file_name.c_str());
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_ply_point_cloud_reg("point_cloud::ply_reader", test_ply_point_cloud);
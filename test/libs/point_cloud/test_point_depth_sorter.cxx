@@ -0,0 +1,102 @@
+#include <cgv/base/register.h>
+#include <point_cloud/point_depth_sorter.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+using namespace cgv::base;
+
+typedef point_cloud_types::Pnt Pnt;
+typedef point_cloud_types::Dir Dir;
+
+/// check that indices are a permutation of all points sorted back to front, where equal depths keep increasing indices if stable is true
+bool is_sorted_back_to_front(const std::vector<Pnt>& points, const std::vector<uint32_t>& indices, const Dir& view_dir, bool stable)
+{
+	if (indices.size() != points.size())
+		return false;
+	std::vector<bool> found(points.size(), false);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		if (indices[i] >= points.size() || found[indices[i]])
+			return false;
+		found[indices[i]] = true;
+		if (i == 0)
+			continue;
+		uint32_t k0 = point_depth_sorter::depth_to_key(dot(points[indices[i - 1]], view_dir));
+		uint32_t k1 = point_depth_sorter::depth_to_key(dot(points[indices[i]], view_dir));
+		if (k0 > k1 || (stable && k0 == k1 && indices[i - 1] > indices[i]))
+			return false;
+	}
+	return true;
+}
+
+/// return identity permutation of n indices
+std::vector<uint32_t> identity_indices(size_t n)
+{
+	std::vector<uint32_t> indices(n);
+	for (size_t i = 0; i < n; ++i)
+		indices[i] = uint32_t(i);
+	return indices;
+}
+
+bool test_point_depth_sorter()
+{
+	// keys decrease with increasing depth
+	float depths[] = { -std::numeric_limits<float>::infinity(), -1e30f, -1.0f, -1e-30f, 0.0f, 1e-30f, 1.0f, 1e30f, std::numeric_limits<float>::infinity() };
+	for (size_t i = 1; i < sizeof(depths) / sizeof(float); ++i)
+		TEST_ASSERT(point_depth_sorter::depth_to_key(depths[i - 1]) > point_depth_sorter::depth_to_key(depths[i]));
+
+	// points on a coarse grid such that many depths are equal
+	std::default_random_engine E(11);
+	std::uniform_int_distribution<int> G(-8, 8);
+	std::vector<Pnt> points(50000);
+	for (auto& p : points)
+		p = Pnt(float(G(E)), float(G(E)), float(G(E)));
+	// several threads with small ranges, such that radix passes and insertion sort fix ups cross thread ranges
+	point_depth_sorter sorter(3);
+	sorter.min_points_per_thread = 1000;
+	Dir view_dir(0.0f, 0.0f, -1.0f);
+	size_t sizes[] = { 0, 1, 999, 5000, 50000 };
+	for (size_t n : sizes) {
+		std::vector<Pnt> P(points.begin(), points.begin() + n);
+		std::vector<uint32_t> indices = identity_indices(n);
+		sorter.sort_back_to_front(n > 0 ? &P[0] : 0, indices, view_dir);
+		TEST_ASSERT(!sorter.was_last_sort_incremental());
+		TEST_ASSERT(is_sorted_back_to_front(P, indices, view_dir, true));
+	}
+
+	// reusing the order of an unchanged view keeps the order
+	std::vector<uint32_t> indices = identity_indices(points.size());
+	sorter.sort_back_to_front(&points[0], indices, view_dir);
+	std::vector<uint32_t> sorted_indices = indices;
+	sorter.sort_back_to_front(&points[0], indices, view_dir, true);
+	TEST_ASSERT(sorter.was_last_sort_incremental());
+	TEST_ASSERT(indices == sorted_indices);
+
+	// small view rotations with random points are fixed up incrementally if the budget allows it
+	std::uniform_real_distribution<float> D(-10.0f, 10.0f);
+	for (auto& p : points)
+		p = Pnt(D(E), D(E), D(E));
+	indices = identity_indices(points.size());
+	sorter.sort_back_to_front(&points[0], indices, view_dir);
+	sorter.max_moves_per_point = 1e6f;
+	for (int f = 1; f <= 3; ++f) {
+		float angle = 0.2f * f * 3.14159265f / 180.0f;
+		view_dir = Dir(std::sin(angle), 0.0f, -std::cos(angle));
+		sorter.sort_back_to_front(&points[0], indices, view_dir, true);
+		TEST_ASSERT(sorter.was_last_sort_incremental());
+		TEST_ASSERT(is_sorted_back_to_front(points, indices, view_dir, false));
+	}
+
+	// large view changes exceed a small budget and fall back to the radix sort
+	sorter.max_moves_per_point = 0.5f;
+	view_dir = Dir(1.0f, 0.0f, 0.0f);
+	sorter.sort_back_to_front(&points[0], indices, view_dir, true);
+	TEST_ASSERT(!sorter.was_last_sort_incremental());
+	TEST_ASSERT(is_sorted_back_to_front(points, indices, view_dir, false));
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_point_depth_sorter_reg("point_cloud::point_depth_sorter", test_point_depth_sorter);
@@ -0,0 +1,134 @@
+#include <cgv/base/register.h>
+#include <point_cloud/point_kd_tree.h>
+#include <point_cloud/neighbor_graph.h>
+#include <algorithm>
+#include <random>
+
+using namespace cgv::base;
+
+typedef point_cloud_types::Pnt Pnt;
+typedef point_cloud_types::Idx Idx;
+typedef point_cloud_types::Crd Crd;
+
+/// return squared distances of the k nearest neighbors of q in increasing order by brute force, skipping the point with index exclude
+std::vector<Crd> brute_force_knn_dists(const std::vector<Pnt>& points, const Pnt& q, Idx k, Idx exclude)
+{
+	std::vector<Crd> dists;
+	for (Idx j = 0; j < (Idx)points.size(); ++j)
+		if (j != exclude)
+			dists.push_back(sqr_length(points[j] - q));
+	std::sort(dists.begin(), dists.end());
+	dists.resize(std::min(dists.size(), size_t(k)));
+	return dists;
+}
+
+/// check that N are k distinct nearest neighbors of point i, where ties may be reported in any order
+bool is_knn(const std::vector<Pnt>& points, Idx i, Idx k, const Idx* N, size_t n)
+{
+	std::vector<Crd> expected = brute_force_knn_dists(points, points[i], k, i);
+	if (n != expected.size())
+		return false;
+	std::vector<Idx> sorted_N(N, N + n);
+	std::sort(sorted_N.begin(), sorted_N.end());
+	if (std::adjacent_find(sorted_N.begin(), sorted_N.end()) != sorted_N.end())
+		return false;
+	std::vector<Crd> dists;
+	for (size_t j = 0; j < n; ++j) {
+		if (N[j] < 0 || N[j] >= (Idx)points.size() || N[j] == i)
+			return false;
+		dists.push_back(sqr_length(points[N[j]] - points[i]));
+	}
+	std::sort(dists.begin(), dists.end());
+	return dists == expected;
+}
+
+bool test_point_kd_tree()
+{
+	// points on a coarse grid produce many equal distances and many points on splitting planes
+	std::default_random_engine E(5);
+	std::uniform_int_distribution<int> G(-6, 6);
+	std::uniform_real_distribution<float> D(-1.0f, 1.0f);
+	std::vector<Pnt> points(3000);
+	for (size_t i = 0; i < points.size(); ++i)
+		points[i] = i % 2 == 0 ? Pnt(float(G(E)), float(G(E)), float(G(E))) : Pnt(D(E), D(E), D(E));
+
+	point_kd_tree tree(4);
+	TEST_ASSERT(tree.is_empty());
+	std::vector<Idx> N(3, 0);
+	tree.extract_neighbors(0, 5, N);
+	TEST_ASSERT(N.empty());
+	tree.build(&points[0], points.size());
+	TEST_ASSERT(!tree.is_empty());
+
+	// k <= 0 reports no neighbors and k larger than the number of other points reports all of them
+	N.resize(3);
+	tree.extract_neighbors(0, 0, N);
+	TEST_ASSERT(N.empty());
+	point_kd_tree small_tree;
+	small_tree.build(&points[0], 5);
+	small_tree.extract_neighbors(2, 10, N);
+	TEST_ASSERT(is_knn(std::vector<Pnt>(points.begin(), points.begin() + 5), 2, 10, N.data(), N.size()));
+
+	// knn of every 7th point against brute force
+	Idx ks[] = { 1, 6, 17 };
+	for (Idx k : ks)
+		for (Idx i = 0; i < (Idx)points.size(); i += 7) {
+			tree.extract_neighbors(i, k, N);
+			TEST_ASSERT(is_knn(points, i, k, N.data(), N.size()));
+		}
+
+	// closest point queries at arbitrary positions
+	for (int i = 0; i < 200; ++i) {
+		Pnt q(7 * D(E), 7 * D(E), 7 * D(E));
+		Idx knn_indices[8];
+		Crd knn_sqr_dists[8];
+		TEST_ASSERT_EQ(tree.find_closest_points(q, 8, knn_indices, knn_sqr_dists), 8u);
+		std::vector<Crd> expected = brute_force_knn_dists(points, q, 8, -1);
+		TEST_ASSERT(std::vector<Crd>(knn_sqr_dists, knn_sqr_dists + 8) == expected);
+		TEST_ASSERT_EQ(sqr_length(points[tree.find_closest(q)] - q), expected[0]);
+	}
+
+	// neighbor graphs built in parallel contain the same neighbor lists as sequentially built ones
+	const Idx k = 6;
+	cgv::pointcloud::utility::WorkerPool pool(3);
+	neighbor_graph ng_seq, ng_par;
+	ng_seq.build(Idx(points.size()), k, tree);
+	ng_par.build(Idx(points.size()), k, tree, pool);
+	TEST_ASSERT(ng_par == ng_seq);
+	TEST_ASSERT_EQ(ng_par.nr_half_edges, points.size() * k);
+	for (Idx i = 0; i < (Idx)points.size(); i += 11)
+		TEST_ASSERT(is_knn(points, i, k, ng_par[i].data(), ng_par[i].size()));
+
+	// the compact graph stores the same lists, also if fewer than k neighbors exist
+	compact_neighbor_graph cng;
+	cng.build(Idx(points.size()), k, tree, pool);
+	TEST_ASSERT_EQ(cng.get_nr_vertices(), points.size());
+	TEST_ASSERT_EQ(cng.get_nr_half_edges(), points.size() * k);
+	for (Idx i = 0; i < (Idx)points.size(); ++i)
+		TEST_ASSERT(std::vector<Idx>(cng.begin_neighbors(i), cng.end_neighbors(i)) == ng_seq[i]);
+	compact_neighbor_graph small_cng;
+	small_cng.build(5, k, small_tree, pool);
+	TEST_ASSERT_EQ(small_cng.get_nr_half_edges(), 20u);
+	for (Idx i = 0; i < 5; ++i)
+		TEST_ASSERT_EQ(small_cng.get_nr_neighbors(i), 4u);
+
+	// symmetrization adds exactly the missing reverse edges
+	neighbor_graph ng_sym = ng_seq;
+	ng_sym.symmetrize();
+	cng.symmetrize(pool);
+	neighbor_graph cng_sym;
+	cng.extract(cng_sym);
+	for (Idx i = 0; i < (Idx)points.size(); ++i) {
+		for (Idx j : ng_seq[i])
+			TEST_ASSERT(cng.is_directed_edge(i, j) && cng.is_directed_edge(j, i));
+		std::vector<Idx> a = ng_sym[i], b = cng_sym[i];
+		std::sort(a.begin(), a.end());
+		std::sort(b.begin(), b.end());
+		TEST_ASSERT(a == b);
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_point_kd_tree_reg("point_cloud::point_kd_tree", test_point_kd_tree);
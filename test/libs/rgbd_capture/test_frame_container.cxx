@@ -0,0 +1,126 @@
+#include <cgv/base/register.h>
+#include <rgbd_capture/frame_container.h>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+
+using namespace cgv::base;
+using namespace rgbd;
+
+/// construct frame of given format, where depth frames contain a smooth surface with invalid regions and color frames random bytes
+void construct_test_frame(frame_type& frame, const stream_format& sf, unsigned frame_index, std::default_random_engine& E)
+{
+	static_cast<frame_format&>(frame) = sf;
+	frame.frame_index = frame_index;
+	frame.time = 0.033 * frame_index;
+	frame.system_time_stamp = 1000 + frame_index;
+	frame.device_time_stamp = 2000 + frame_index;
+	frame.compute_buffer_size();
+	frame.frame_data.resize(frame.buffer_size);
+	if (sf.pixel_format == PF_DEPTH) {
+		uint16_t* depths = reinterpret_cast<uint16_t*>(frame.frame_data.data());
+		for (int y = 0; y < sf.height; ++y)
+			for (int x = 0; x < sf.width; ++x)
+				depths[y * sf.width + x] = (x + y) % 17 == 0 ? 0 : uint16_t(1000 + 3 * x + y + frame_index);
+		// include extreme jumps
+		depths[1] = 65535;
+		depths[2] = 0;
+	}
+	else {
+		std::uniform_int_distribution<int> D(0, 255);
+		for (auto& c : frame.frame_data)
+			c = char(D(E));
+	}
+}
+
+/// check that frame info and data of both frames agree
+bool equal_frames(const frame_type& a, const frame_type& b)
+{
+	return a.width == b.width && a.height == b.height && a.pixel_format == b.pixel_format &&
+		a.nr_bits_per_pixel == b.nr_bits_per_pixel && a.buffer_size == b.buffer_size && a.frame_index == b.frame_index &&
+		a.time == b.time && a.system_time_stamp == b.system_time_stamp && a.device_time_stamp == b.device_time_stamp &&
+		a.frame_data == b.frame_data;
+}
+
+bool test_frame_container()
+{
+	const std::string file_name = "test_frame_container.rgbd";
+	std::vector<stream_format> streams = { stream_format(64, 48, PF_DEPTH, 30, 16), stream_format(32, 24, PF_RGBA, 30, 32) };
+	emulator_parameters parameters = { { 500.0, 501.0, 32.0, 24.0, 0.0, 64, 48 }, 0.001 };
+	std::default_random_engine E(23);
+	std::vector<frame_type> frames;
+	for (unsigned i = 0; i < 6; ++i) {
+		frames.push_back(frame_type());
+		construct_test_frame(frames.back(), streams[i % 2], i / 2, E);
+	}
+
+	// write and replay with and without depth compression
+	for (int compress = 0; compress < 2; ++compress) {
+		frame_container_writer writer;
+		TEST_ASSERT(writer.open(file_name, streams, &parameters));
+		for (unsigned i = 0; i < frames.size(); ++i)
+			TEST_ASSERT(writer.write_frame(i % 2, i / 2, frames[i], compress != 0));
+		TEST_ASSERT(writer.close());
+		TEST_ASSERT(!writer.is_open());
+		if (compress)
+			TEST_ASSERT(std::filesystem::file_size(file_name) < 6 * 64 * 48 * 2);
+
+		frame_container_reader reader;
+		TEST_ASSERT(reader.open(file_name));
+		TEST_ASSERT(reader.get_stream_formats() == streams);
+		TEST_ASSERT(reader.has_parameters());
+		TEST_ASSERT(reader.get_parameters().intrinsics.fy == 501.0 && reader.get_parameters().depth_scale == 0.001);
+		TEST_ASSERT_EQ(reader.get_nr_frames(), frames.size());
+		frame_type frame;
+		// replay in reverse order to check random access
+		for (size_t i = frames.size(); i-- > 0; ) {
+			TEST_ASSERT_EQ(reader.get_entry(i).stream, uint32_t(i % 2));
+			TEST_ASSERT_EQ(reader.get_entry(i).protocol_index, uint32_t(i / 2));
+			TEST_ASSERT_EQ(reader.get_entry(i).time, frames[i].time);
+			TEST_ASSERT(reader.read_frame(i, frame));
+			TEST_ASSERT(equal_frames(frame, frames[i]));
+		}
+		TEST_ASSERT(!reader.read_frame(frames.size(), frame));
+	}
+
+	// files of interrupted recordings are indexed by scanning the records, skipping a truncated last record
+	{
+		std::filesystem::resize_file(file_name, std::filesystem::file_size(file_name) - 8 * 6 * 3 - 8 - 10);
+		frame_container_reader reader;
+		TEST_ASSERT(reader.open(file_name));
+		TEST_ASSERT(reader.has_parameters() && reader.get_parameters().intrinsics.fx == 500.0);
+		TEST_ASSERT_EQ(reader.get_nr_frames(), frames.size() - 1);
+		frame_type frame;
+		for (size_t i = 0; i + 1 < frames.size(); ++i) {
+			TEST_ASSERT(reader.read_frame(i, frame));
+			TEST_ASSERT(equal_frames(frame, frames[i]));
+		}
+	}
+
+	// asynchronous recording writes all frames in push order if the queue does not overflow
+	{
+		frame_recorder recorder;
+		TEST_ASSERT(!recorder.push_frame(0, 0, frames[0]));
+		TEST_ASSERT(recorder.start(file_name, streams, 0, frames.size()));
+		TEST_ASSERT(recorder.is_started());
+		for (unsigned i = 0; i < frames.size(); ++i)
+			TEST_ASSERT(recorder.push_frame(i % 2, i / 2, frames[i]));
+		TEST_ASSERT(recorder.stop());
+		TEST_ASSERT_EQ(recorder.get_nr_dropped_frames(), size_t(0));
+		frame_container_reader reader;
+		TEST_ASSERT(reader.open(file_name));
+		TEST_ASSERT(!reader.has_parameters());
+		TEST_ASSERT_EQ(reader.get_nr_frames(), frames.size());
+		frame_type frame;
+		for (size_t i = 0; i < frames.size(); ++i) {
+			TEST_ASSERT(reader.read_frame(i, frame));
+			TEST_ASSERT(equal_frames(frame, frames[i]));
+		}
+	}
+	std::remove(file_name.c_str());
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_frame_container_reg("rgbd::frame_container", test_frame_container);
@@ -0,0 +1,112 @@
+#include <cgv/base/register.h>
+#include <stream_vis/min_max_pyramid.h>
+#include <cmath>
+#include <random>
+
+using namespace cgv::base;
+
+/// ringbuffer of interleaved components together with the full history of samples, which serves as brute force reference
+struct min_max_test_stream
+{
+	size_t window_size;
+	unsigned nr_components;
+	std::vector<float> ring, history;
+	stream_vis::min_max_pyramid<float> pyramid;
+	min_max_test_stream(size_t _window_size, unsigned _nr_components, size_t block_size)
+		: window_size(_window_size), nr_components(_nr_components), ring(_window_size * _nr_components), pyramid(_window_size, _nr_components, block_size) {}
+	/// append samples to history and ringbuffer and update the pyramid
+	void add_samples(const std::vector<float>& samples)
+	{
+		size_t count = samples.size() / nr_components;
+		for (size_t i = 0; i < count; ++i) {
+			size_t si = history.size() / nr_components;
+			std::copy(samples.begin() + i * nr_components, samples.begin() + (i + 1) * nr_components, ring.begin() + (si % window_size) * nr_components);
+			history.insert(history.end(), samples.begin() + i * nr_components, samples.begin() + (i + 1) * nr_components);
+		}
+		pyramid.add_samples(ring.data(), count);
+	}
+	/// return value of component c of sample si
+	float value(size_t si, unsigned c) const { return history[si * nr_components + c]; }
+	/// check put_bounds and find_extrema for sample range [si0,si1) against brute force
+	bool check_range(size_t si0, size_t si1) const
+	{
+		size_t nr_samples = history.size() / nr_components;
+		size_t first = nr_samples > window_size ? nr_samples - window_size : 0;
+		size_t s0 = std::max(si0, first), s1 = std::min(si1, nr_samples);
+		std::vector<float> bounds(2 * nr_components);
+		bool has_bounds = pyramid.put_bounds(si0, si1, bounds.data());
+		if (has_bounds != (s0 < s1))
+			return false;
+		for (unsigned c = 0; c < nr_components; ++c) {
+			float min_value = std::numeric_limits<float>::max(), max_value = std::numeric_limits<float>::lowest();
+			for (size_t si = s0; si < s1; ++si) {
+				float v = value(si, c);
+				if (v < min_value)
+					min_value = v;
+				if (v > max_value)
+					max_value = v;
+			}
+			if (has_bounds && (bounds[c] != min_value || bounds[nr_components + c] != max_value))
+				return false;
+			// the reported sample indices lie in the range and hold the extrema, where ties may be resolved arbitrarily
+			size_t si_min, si_max;
+			bool found = pyramid.find_extrema(si0, si1, c, si_min, si_max);
+			if (found != (min_value <= max_value))
+				return false;
+			if (found && (si_min < s0 || si_min >= s1 || si_max < s0 || si_max >= s1 || value(si_min, c) != min_value || value(si_max, c) != max_value))
+				return false;
+		}
+		return true;
+	}
+};
+
+bool test_min_max_pyramid()
+{
+	std::default_random_engine E(29);
+	std::uniform_int_distribution<int> V(-20, 20);
+	std::uniform_int_distribution<int> P(0, 99);
+	// window sizes that are no multiple of the block size produce a partial last block, block sizes of one have no partial blocks
+	size_t window_sizes[] = { 1, 5, 16, 17, 100, 257 };
+	size_t block_sizes[] = { 1, 3, 16 };
+	for (size_t window_size : window_sizes)
+		for (size_t block_size : block_sizes) {
+			min_max_test_stream S(window_size, 2, block_size);
+			TEST_ASSERT(S.check_range(0, 10));
+			for (int iteration = 0; iteration < 40; ++iteration) {
+				// batches of random size, including batches exceeding the window, such that the ringbuffer wraps around
+				size_t count = P(E) < 5 ? window_size + 3 : std::uniform_int_distribution<size_t>(0, window_size / 2 + 1)(E);
+				std::vector<float> samples(2 * count);
+				for (size_t i = 0; i < samples.size(); ++i) {
+					// the second component is nan in whole runs and the integer values produce many ties
+					if (i % 2 == 1 && P(E) < 30)
+						samples[i] = std::nanf("");
+					else
+						samples[i] = float(V(E));
+				}
+				S.add_samples(samples);
+				TEST_ASSERT_EQ(S.pyramid.get_nr_samples(), S.history.size() / 2);
+				size_t nr_samples = S.pyramid.get_nr_samples();
+				// full window, all single samples and random ranges partly before the ringbuffer and behind the last sample
+				TEST_ASSERT(S.check_range(0, nr_samples));
+				for (size_t si = S.pyramid.get_first_sample_index(); si < nr_samples; ++si)
+					TEST_ASSERT(S.check_range(si, si + 1));
+				for (int r = 0; r < 20; ++r) {
+					size_t si0 = std::uniform_int_distribution<size_t>(0, nr_samples + 2)(E);
+					size_t si1 = std::uniform_int_distribution<size_t>(si0, nr_samples + 2)(E);
+					TEST_ASSERT(S.check_range(si0, si1));
+				}
+			}
+		}
+	// ranges containing only nan values have no extrema
+	min_max_test_stream S(8, 1, 2);
+	S.add_samples({ 1.0f, std::nanf(""), std::nanf(""), std::nanf(""), 2.0f });
+	size_t si_min, si_max;
+	TEST_ASSERT(!S.pyramid.find_extrema(1, 4, 0, si_min, si_max));
+	TEST_ASSERT(S.pyramid.find_extrema(1, 5, 0, si_min, si_max) && si_min == 4 && si_max == 4);
+	TEST_ASSERT(S.pyramid.find_extrema(0, 5, 0, si_min, si_max) && si_min == 0 && si_max == 4);
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_min_max_pyramid_reg("stream_vis::min_max_pyramid", test_min_max_pyramid);
@@ -0,0 +1,115 @@
+#include <cgv/math/mat.h>
+#include <cgv/math/svd.h>
+#include <cgv/math/qr.h>
+#include <cgv/math/lu.h>
+#include <cgv/math/chol.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+using namespace cgv::math;
+
+/// matrix product with the scalar triple loop formerly used by mat<T>::operator*
+mat<double> loop_product(const mat<double>& a, const mat<double>& b)
+{
+	mat<double> r(a.nrows(), b.ncols(), 0.0);
+	for (unsigned i = 0; i < a.nrows(); i++)
+		for (unsigned j = 0; j < b.ncols(); j++)
+			for (unsigned k = 0; k < a.ncols(); k++)
+				r(i, j) += a(i, k) * b(k, j);
+	return r;
+}
+
+/// A^T*A with the scalar loops formerly used by AtA
+mat<double> loop_AtA(const mat<double>& a)
+{
+	mat<double> ata(a.ncols(), a.ncols(), 0.0);
+	for (unsigned r = 0; r < a.nrows(); r++)
+		for (unsigned i = 0; i < a.ncols(); i++)
+			for (unsigned j = 0; j < a.ncols(); j++)
+				ata(i, j) += a(r, i)*a(r, j);
+	return ata;
+}
+
+mat<double> random_mat(unsigned n, unsigned m, std::default_random_engine& E)
+{
+	std::uniform_real_distribution<double> D(-1.0, 1.0);
+	mat<double> a(n, m);
+	for (unsigned j = 0; j < m; ++j)
+		for (unsigned i = 0; i < n; ++i)
+			a(i, j) = D(E);
+	return a;
+}
+
+/// compares the dense kernels against the scalar loops and measures the decompositions for increasing numbers of threads
+int main(int argc, char** argv)
+{
+	unsigned max_n = argc > 1 ? (unsigned)atoi(argv[1]) : 1024;
+	unsigned max_nr_threads = argc > 2 ? (unsigned)atoi(argv[2]) : std::max(std::thread::hardware_concurrency(), 1u);
+	// powers of two followed by the maximum number of threads
+	std::vector<unsigned> thread_counts;
+	for (unsigned nr_threads = 1; nr_threads < max_nr_threads; nr_threads *= 2)
+		thread_counts.push_back(nr_threads);
+	thread_counts.push_back(max_nr_threads);
+	std::default_random_engine E;
+	for (unsigned n = 64; n <= max_n; n *= 2) {
+		mat<double> a = random_mat(n, n, E), b = random_mat(n, n, E);
+		double t_loop = 0, t_loop_ata = 0;
+		mat<double> c_loop, ata_loop;
+		{
+			cgv::utils::stopwatch s(&t_loop);
+			c_loop = loop_product(a, b);
+		}
+		{
+			cgv::utils::stopwatch s(&t_loop_ata);
+			ata_loop = loop_AtA(a);
+		}
+		double gflop = 2.0*n*n*n*1e-9;
+		std::cout << "n = " << n << ": loops a*b " << t_loop << "s (" << gflop / t_loop << " GFlop/s), AtA " << t_loop_ata << "s" << std::endl;
+		for (unsigned nr_threads : thread_counts) {
+			set_mat_kernel_nr_threads(nr_threads);
+			double t_mul = 0, t_ata = 0, t_svd = 0, t_qr = 0, t_lu = 0, t_chol = 0;
+			mat<double> c, ata;
+			{
+				cgv::utils::stopwatch s(&t_mul);
+				c = a*b;
+			}
+			{
+				cgv::utils::stopwatch s(&t_ata);
+				AtA(a, ata);
+			}
+			{
+				mat<double> u, v;
+				diag_mat<double> w;
+				cgv::utils::stopwatch s(&t_svd);
+				svd(a, u, w, v);
+			}
+			{
+				mat<double> q;
+				up_tri_mat<double> r;
+				cgv::utils::stopwatch s(&t_qr);
+				qr(a, q, r);
+			}
+			{
+				perm_mat p;
+				low_tri_mat<double> l;
+				up_tri_mat<double> u;
+				cgv::utils::stopwatch s(&t_lu);
+				lu(a, p, l, u);
+			}
+			for (unsigned i = 0; i < n; ++i)
+				ata(i, i) += 1.0;
+			{
+				low_tri_mat<double> l;
+				cgv::utils::stopwatch s(&t_chol);
+				chol(ata, l);
+			}
+			std::cout << "  " << nr_threads << " threads: a*b " << t_mul << "s (" << gflop / t_mul << " GFlop/s, speedup " << t_loop / t_mul
+				<< ", error " << frobenius_norm(c - c_loop) << "), AtA " << t_ata << "s (speedup " << t_loop_ata / t_ata
+				<< "), svd " << t_svd << "s, qr " << t_qr << "s, lu " << t_lu << "s, chol " << t_chol << "s" << std::endl;
+		}
+	}
+	return 0;
+}
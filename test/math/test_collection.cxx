@@ -1,5 +1,7 @@
 #include <cgv/base/base.h>
 #include <test/math/test_chol.h>
+#include <test/math/test_sparse_les_csr.h>
+#include <test/math/test_mat_kernels.h>
 #include <test/math/test_det.h>
 #include <test/math/test_align.h>
 #include <test/math/test_inv.h>
@@ -38,6 +40,8 @@ bool test_collection()
 
 	test_quat();
 	test_chol();//complete
+	test_sparse_les_csr();
+	test_mat_kernels();
 	test_det();//complete
 	test_inv();//complete	
 	test_lu();//complete
@@ -0,0 +1,63 @@
+#pragma once
+#include <cgv/math/mat.h>
+#include <cgv/math/mat_kernels.h>
+#include <cgv/math/random.h>
+
+/// return op(a)*op(b) computed with the scalar triple loop
+inline cgv::math::mat<double> loop_product(const cgv::math::mat<double>& a, bool trans_a, const cgv::math::mat<double>& b, bool trans_b)
+{
+	unsigned m = trans_a ? a.ncols() : a.nrows(), k = trans_a ? a.nrows() : a.ncols(), n = trans_b ? b.nrows() : b.ncols();
+	cgv::math::mat<double> c(m, n, 0.0);
+	for (unsigned i = 0; i < m; i++)
+		for (unsigned j = 0; j < n; j++)
+			for (unsigned p = 0; p < k; p++)
+				c(i, j) += (trans_a ? a(p, i) : a(i, p)) * (trans_b ? b(j, p) : b(p, j));
+	return c;
+}
+
+/// compare gemm, gemv and ger kernels for matrix sizes below and above the blocking and threading thresholds against scalar loops
+void test_mat_kernels()
+{
+	using namespace cgv::math;
+	cgv::math::random rng(5);
+	// sizes cover plain loops, blocked products with partial register blocks and products large enough for threads
+	unsigned sizes[][3] = { { 3, 5, 7 }, { 37, 29, 41 }, { 130, 67, 259 }, { 517, 515, 133 } };
+	unsigned nr_threads_before = get_mat_kernel_nr_threads();
+	for (unsigned nr_threads = 1; nr_threads <= 3; nr_threads += 2) {
+		set_mat_kernel_nr_threads(nr_threads);
+		for (auto& s : sizes) {
+			unsigned m = s[0], n = s[1], k = s[2];
+			for (int trans = 0; trans < 4; ++trans) {
+				bool trans_a = (trans & 1) != 0, trans_b = (trans & 2) != 0;
+				mat<double> a(trans_a ? k : m, trans_a ? m : k), b(trans_b ? n : k, trans_b ? k : n), c(m, n);
+				rng.uniform(-1.0, 1.0, a);
+				rng.uniform(-1.0, 1.0, b);
+				rng.uniform(-1.0, 1.0, c);
+				// C = 2*op(A)*op(B) - C
+				mat<double> expected = 2.0*loop_product(a, trans_a, b, trans_b) - c;
+				gemm_kernel(trans_a, trans_b, m, n, k, 2.0, &a(0, 0), a.nrows(), &b(0, 0), b.nrows(), -1.0, &c(0, 0), m);
+				assert(frobenius_norm(c - expected) < 1e-10 * m * n);
+			}
+			// y = op(A)*x + 0.5*y
+			mat<double> a(m, n);
+			rng.uniform(-1.0, 1.0, a);
+			for (int trans_a = 0; trans_a < 2; ++trans_a) {
+				unsigned nx = trans_a ? m : n, ny = trans_a ? n : m;
+				mat<double> x(nx, 1), y(ny, 1);
+				rng.uniform(-1.0, 1.0, x);
+				rng.uniform(-1.0, 1.0, y);
+				mat<double> expected = loop_product(a, trans_a != 0, x, false) + 0.5*y;
+				gemv_kernel(trans_a != 0, m, n, 1.0, &a(0, 0), m, &x(0, 0), 0.5, &y(0, 0));
+				assert(frobenius_norm(y - expected) < 1e-10 * ny);
+			}
+			// A += 3*x*y^T
+			mat<double> x(m, 1), y(n, 1);
+			rng.uniform(-1.0, 1.0, x);
+			rng.uniform(-1.0, 1.0, y);
+			mat<double> expected = a + 3.0*loop_product(x, false, y, true);
+			ger_kernel(m, n, 3.0, &x(0, 0), &y(0, 0), &a(0, 0), m);
+			assert(frobenius_norm(a - expected) < 1e-10 * m * n);
+		}
+	}
+	set_mat_kernel_nr_threads(nr_threads_before);
+}
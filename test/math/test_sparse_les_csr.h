@@ -0,0 +1,105 @@
+#pragma once
+#include <cgv/math/sparse_les_csr.h>
+#include <cgv/math/chol.h>
+#include <cgv/math/lin_solve.h>
+#include <cgv/math/random.h>
+
+/// fill symmetric positive definite matrix of an n x n grid laplacian with random couplings to distant unknowns into a dense matrix
+inline void create_sparse_spd_matrix(int n, cgv::math::mat<double>& m)
+{
+	cgv::math::random rng(17);
+	int N = n*n;
+	m.resize(N, N);
+	m.zeros();
+	for (int y = 0; y < n; ++y) {
+		for (int x = 0; x < n; ++x) {
+			int i = y*n + x;
+			m(i, i) = 4.5;
+			if (x + 1 < n)
+				m(i, i + 1) = m(i + 1, i) = -1.0;
+			if (y + 1 < n)
+				m(i, i + n) = m(i + n, i) = -1.0;
+		}
+	}
+	for (int k = 0; k < N / 4; ++k) {
+		unsigned i, j;
+		rng.uniform(0, N - 1, i);
+		rng.uniform(0, N - 1, j);
+		if (i == j)
+			continue;
+		double v;
+		rng.uniform(-0.2, 0.2, v);
+		m(i, j) += v;
+		m(j, i) += v;
+		m(i, i) += 0.2;
+		m(j, j) += 0.2;
+	}
+}
+
+/// solve system with the given csr solver, where only the lower triangle is set, and return maximum deviation from x
+inline double test_csr_solver(cgv::math::csr_sparse_les& les, const cgv::math::mat<double>& m, const cgv::math::mat<double>& b, const cgv::math::mat<double>& x)
+{
+	for (unsigned i = 0; i < m.nrows(); ++i)
+		for (unsigned j = 0; j <= i; ++j)
+			if (m(i, j) != 0)
+				les.set_mat_entry(i, j, m(i, j));
+	for (unsigned j = 0; j < b.ncols(); ++j)
+		for (unsigned i = 0; i < b.nrows(); ++i)
+			les.set_b_entry(i, j, b(i, j));
+	if (!les.solve())
+		return 1e10;
+	double max_error = 0;
+	for (unsigned j = 0; j < x.ncols(); ++j)
+		for (unsigned i = 0; i < x.nrows(); ++i)
+			max_error = std::max(max_error, std::abs(les.get_x_entry(i, j) - x(i, j)));
+	return max_error;
+}
+
+void test_sparse_les_csr()
+{
+	using namespace cgv::math;
+	// dense reference solution with cholesky decomposition
+	mat<double> m, b(144, 2), x(144, 2);
+	create_sparse_spd_matrix(12, m);
+	for (unsigned i = 0; i < b.nrows(); ++i) {
+		b(i, 0) = 1.0;
+		b(i, 1) = double(i % 7) - 3.0;
+	}
+	low_tri_mat<double> l;
+	bool is_spd = chol(m, l);
+	assert(is_spd);
+	mat<double> y;
+	solve(l, b, y);
+	solve(transpose(l), y, x);
+
+	cholesky_sparse_les cholesky(m.nrows(), 2);
+	assert(test_csr_solver(cholesky, m, b, x) < 1e-10);
+	// factor must be sparser than dense lower triangle thanks to the fill reducing ordering
+	assert(cholesky.get_nr_factor_non_zeros() < int(m.nrows()*(m.nrows() + 1) / 2));
+
+	// update values with same sparsity pattern, which reuses the symbolic analysis
+	m *= 2.0;
+	x *= 0.5;
+	assert(test_csr_solver(cholesky, m, b, x) < 1e-10);
+
+	// pcg with one and several threads, where the small system needs a low threshold on the work per thread to be split into several blocks
+	for (unsigned nr_threads = 1; nr_threads <= 4; nr_threads *= 4) {
+		pcg_sparse_les pcg(m.nrows(), 2);
+		pcg.set_tolerance(1e-12);
+		pcg.set_nr_threads(nr_threads);
+		pcg.set_min_nr_non_zeros_per_thread(64);
+		assert(test_csr_solver(pcg, m, b, x) < 1e-8);
+		assert(pcg.get_nr_used_threads() == nr_threads);
+	}
+	// with the default threshold the small system is solved by a single thread
+	pcg_sparse_les pcg(m.nrows(), 2);
+	pcg.set_nr_threads(4);
+	pcg.set_tolerance(1e-12);
+	assert(test_csr_solver(pcg, m, b, x) < 1e-8);
+	assert(pcg.get_nr_used_threads() == 1);
+
+	// a matrix that is not positive definite has to be rejected
+	m(5, 5) = -1.0;
+	cholesky_sparse_les indefinite(m.nrows(), 2);
+	assert(test_csr_solver(indefinite, m, b, x) == 1e10);
+}
@@ -0,0 +1,84 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/marching_cubes.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef cgv::math::fvec<float, 3> mc_test_pnt;
+typedef std::array<float, 9> mc_test_triangle;
+
+/// collect vertices and triangles of a streaming mesh and check that only vertices are used that have not been dropped
+struct mc_test_collector : public streaming_mesh_callback_handler
+{
+	streaming_mesh<float>* mesh = 0;
+	std::vector<mc_test_pnt> pnts;
+	std::vector<mc_test_triangle> triangles;
+	unsigned nr_dropped = 0;
+	bool valid = true;
+	void new_vertex(unsigned int vertex_index) {
+		valid = valid && vertex_index == pnts.size();
+		pnts.push_back(mesh->vertex_location(vertex_index));
+	}
+	void new_polygon(const std::vector<unsigned int>& vertex_indices) {
+		mc_test_triangle t;
+		for (unsigned c = 0; c < 3; ++c) {
+			valid = valid && vertex_indices[c] >= nr_dropped && vertex_indices[c] < pnts.size();
+			for (unsigned i = 0; i < 3; ++i)
+				t[3 * c + i] = pnts[vertex_indices[c]](i);
+		}
+		// rotate such that the lexicographically smallest corner comes first
+		unsigned c_min = 0;
+		for (unsigned c = 1; c < 3; ++c)
+			if (std::lexicographical_compare(&t[3 * c], &t[3 * c + 3], &t[3 * c_min], &t[3 * c_min + 3]))
+				c_min = c;
+		std::rotate(t.begin(), t.begin() + 3 * c_min, t.end());
+		triangles.push_back(t);
+	}
+	void before_drop_vertex(unsigned int vertex_index) {
+		valid = valid && vertex_index == nr_dropped;
+		++nr_dropped;
+	}
+};
+
+/// smooth function that depends on the evaluated z-coordinate, such that a slice at a different location changes the surface
+struct mc_test_function
+{
+	float operator () (unsigned i, unsigned j, unsigned k, const mc_test_pnt& p) const {
+		return std::sin(3 * p(0)) * std::cos(2 * p(1)) + std::sin(7.3f * p(2)) + 0.3f * p(2) * p(2);
+	}
+};
+
+bool test_marching_cubes()
+{
+	// a z-extent and resolution whose slice distance is not exactly representable
+	cgv::media::axis_aligned_box<float, 3> box(mc_test_pnt(-1.0f, -1.0f, -0.7f), mc_test_pnt(1.0f, 1.0f, 1.3f));
+	unsigned res = 43;
+	mc_test_collector sequential;
+	marching_cubes_base<float, float> mc_sequential(&sequential, 0.05f);
+	sequential.mesh = &mc_sequential;
+	mc_sequential.extract_impl(0.1f, box, res, res, res, mc_test_function(), always_valid<float>());
+	TEST_ASSERT(sequential.valid);
+	TEST_ASSERT(sequential.triangles.size() > 1000);
+	std::sort(sequential.triangles.begin(), sequential.triangles.end());
+	// numbers of threads that split the slices evenly and unevenly
+	unsigned thread_counts[] = { 2, 5, 7, 42 };
+	for (unsigned nr_threads : thread_counts) {
+		mc_test_collector parallel;
+		marching_cubes_base<float, float> mc_parallel(&parallel, 0.05f);
+		parallel.mesh = &mc_parallel;
+		mc_parallel.extract_impl_parallel(0.1f, box, res, res, res, mc_test_function(), always_valid<float>(), false, nr_threads);
+		TEST_ASSERT(parallel.valid);
+		// vertices on slab boundaries are merged and all positions agree exactly
+		TEST_ASSERT_EQ(parallel.pnts.size(), sequential.pnts.size());
+		std::sort(parallel.triangles.begin(), parallel.triangles.end());
+		TEST_ASSERT(parallel.triangles == sequential.triangles);
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_marching_cubes_reg("cgv::media::mesh::marching_cubes", test_marching_cubes);
@@ -0,0 +1,130 @@
+#include <cgv/base/register.h>
+#include <cgv/media/mesh/dynamic_mesh_deformer.h>
+#include <cgv/math/ftransform.h>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::media::mesh;
+
+typedef dynamic_mesh<float> deform_test_mesh;
+
+/// construct mesh with random positions, blend shapes of all modes and skinning weights, where every 50th vertex has no weights
+void construct_deform_test_mesh(deform_test_mesh& M, deform_test_mesh::vertex_weight_mode weight_mode, unsigned nr_vertices, unsigned nr_joints)
+{
+	typedef deform_test_mesh::vec3 vec3;
+	std::default_random_engine E(3);
+	std::uniform_real_distribution<float> D(-1.0f, 1.0f);
+	for (unsigned vi = 0; vi < nr_vertices; ++vi)
+		M.new_position(vec3(D(E), D(E), D(E)));
+	M.store_in_reference_positions();
+	unsigned region_size = nr_vertices / 10;
+	std::uniform_int_distribution<unsigned> V(0, nr_vertices - 1);
+	for (unsigned bi = 0; bi < 9; ++bi) {
+		switch (bi % 3) {
+		case 0:
+			M.add_blend_shape(deform_test_mesh::blend_shape_mode::direct, nr_vertices);
+			for (unsigned vi = 0; vi < nr_vertices; ++vi)
+				M.add_blend_shape_data(0.1f * vec3(D(E), D(E), D(E)));
+			break;
+		case 1:
+			M.add_blend_shape(deform_test_mesh::blend_shape_mode::indexed, region_size, region_size);
+			for (unsigned i = 0; i < region_size; ++i) {
+				M.add_blend_shape_data(0.1f * vec3(D(E), D(E), D(E)));
+				M.add_blend_shape_index(V(E));
+			}
+			break;
+		case 2: {
+			// two ranges, of which the second crosses a block boundary
+			unsigned b0 = bi * 100, e0 = b0 + region_size / 2, b1 = 1000, e1 = b1 + region_size;
+			M.add_blend_shape(deform_test_mesh::blend_shape_mode::range_indexed, (e0 - b0) + (e1 - b1), 4);
+			for (unsigned i = b0; i < e0; ++i)
+				M.add_blend_shape_data(0.1f * vec3(D(E), D(E), D(E)));
+			for (unsigned i = b1; i < e1; ++i)
+				M.add_blend_shape_data(0.1f * vec3(D(E), D(E), D(E)));
+			M.add_blend_shape_index(b0);
+			M.add_blend_shape_index(e0);
+			M.add_blend_shape_index(b1);
+			M.add_blend_shape_index(e1);
+			break;
+		}
+		}
+	}
+	// one to four normalized weights per vertex
+	M.ref_joint_parents().resize(nr_joints, -1);
+	M.set_vertex_weight_mode(weight_mode);
+	std::uniform_int_distribution<unsigned> J(0, nr_joints - 1);
+	std::uniform_real_distribution<float> W(0.1f, 1.0f);
+	for (unsigned vi = 0; vi < nr_vertices; ++vi) {
+		M.begin_vertex_weight_vertex();
+		if (vi % 50 == 0)
+			continue;
+		unsigned nr_weights = 1 + vi % 4;
+		float w[4], sum = 0;
+		for (unsigned k = 0; k < nr_weights; ++k)
+			sum += (w[k] = W(E));
+		for (unsigned k = 0; k < nr_weights; ++k) {
+			M.add_vertex_weight_data(w[k] / sum);
+			M.add_vertex_weight_index(J(E));
+		}
+	}
+}
+
+/// return maximum distance between deformed positions and the positions of the mesh
+float max_deform_error(const dynamic_mesh_deformer<float>& deformer, const deform_test_mesh& M)
+{
+	float max_error = 0;
+	for (unsigned vi = 0; vi < M.get_nr_positions(); ++vi)
+		max_error = std::max(max_error, (deformer.get_positions()[vi] - M.position(vi)).length());
+	return max_error;
+}
+
+bool test_dynamic_mesh_deformer()
+{
+	typedef deform_test_mesh::vec3 vec3;
+	typedef deform_test_mesh::mat4 mat4;
+	// several blocks of 1024 vertices with a partial last block
+	const unsigned nr_vertices = 3000, nr_joints = 12;
+	std::default_random_engine E(7);
+	std::uniform_real_distribution<float> D(-1.0f, 1.0f);
+	// zero weights deactivate blend shapes
+	std::vector<float> weights(9);
+	for (unsigned bi = 0; bi < weights.size(); ++bi)
+		weights[bi] = bi % 4 == 3 ? 0.0f : D(E);
+	std::vector<mat4> joint_matrices;
+	for (unsigned ji = 0; ji < nr_joints; ++ji)
+		joint_matrices.push_back(cgv::math::translate4<float>(0.5f * vec3(D(E), D(E), D(E))) *
+			cgv::math::rotate4<float>(90.0f * D(E), vec3(D(E), D(E), 1.0f)));
+
+	deform_test_mesh::vertex_weight_mode weight_modes[] = { deform_test_mesh::vertex_weight_mode::sparse, deform_test_mesh::vertex_weight_mode::fixed };
+	for (auto weight_mode : weight_modes) {
+		deform_test_mesh M;
+		construct_deform_test_mesh(M, weight_mode, nr_vertices, nr_joints);
+		for (unsigned nr_threads = 1; nr_threads <= 3; nr_threads += 2) {
+			for (int quantize = 0; quantize < 2; ++quantize) {
+				float tolerance = quantize ? 1e-3f : 1e-4f;
+				dynamic_mesh_deformer<float> deformer(nr_threads);
+				deformer.prepare(M, quantize != 0);
+				TEST_ASSERT_EQ(deformer.get_nr_vertices(), nr_vertices);
+				// blend shapes only
+				M.apply_blend_shapes(weights);
+				deformer.deform(weights, {});
+				TEST_ASSERT(max_deform_error(deformer, M) < tolerance);
+				// blend shapes followed by skinning, where vertices without weights end up in the origin
+				M.lbs(joint_matrices, deform_test_mesh::lbs_source_mode::position);
+				deformer.deform(weights, joint_matrices);
+				TEST_ASSERT(max_deform_error(deformer, M) < tolerance);
+				TEST_ASSERT(deformer.get_positions()[50] == vec3(0.0f));
+				// skinning only
+				deformer.deform({}, joint_matrices);
+				M.apply_blend_shapes(std::vector<float>());
+				M.lbs(joint_matrices, deform_test_mesh::lbs_source_mode::position);
+				TEST_ASSERT(max_deform_error(deformer, M) < 1e-4f);
+			}
+		}
+	}
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_dynamic_mesh_deformer_reg("cgv::media::mesh::dynamic_mesh_deformer", test_dynamic_mesh_deformer);
@@ -0,0 +1,165 @@
+#include <cgv/base/register.h>
+#include <cgv/media/volume/bricked_volume.h>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+
+using namespace cgv::base;
+using namespace cgv::media::volume;
+
+/// gives access to the brick cache to check which bricks are kept
+struct test_ooc_bricked_volume : public ooc_bricked_volume
+{
+	test_ooc_bricked_volume(size_t max_cache_size) : ooc_bricked_volume(max_cache_size) {}
+	bool is_cached(size_t bi) const { return cache.find(bi) != cache.end(); }
+};
+
+/// construct volume of given type, format and dimensions with random values
+template <typename T>
+void construct_test_volume(volume& V, cgv::type::info::TypeId type_id, cgv::data::ComponentFormat cf, const volume::dimension_type& dims, T min_value, T max_value)
+{
+	V.set_component_type(type_id);
+	V.set_component_format(cf);
+	V.resize(dims);
+	std::default_random_engine E(17);
+	std::uniform_int_distribution<long long> D((long long)min_value, (long long)max_value);
+	T* values = V.get_data_ptr<T>();
+	for (size_t i = 0; i < V.get_size() / sizeof(T); ++i)
+		values[i] = T(D(E));
+}
+
+/// check that the voxels of the sub box of V starting at min_idx equal the voxels of S
+bool equals_sub_volume(const volume& V, const volume::index_type& min_idx, const volume& S)
+{
+	volume::dimension_type dims = S.get_dimensions();
+	size_t run = size_t(dims(0)) * V.get_voxel_size();
+	for (int k = 0; k < dims(2); ++k)
+		for (int j = 0; j < dims(1); ++j)
+			if (std::memcmp(V.get_voxel_ptr<uint8_t>(min_idx(0), min_idx(1) + j, min_idx(2) + k), S.get_voxel_ptr<uint8_t>(0, j, k), run) != 0)
+				return false;
+	return true;
+}
+
+/// return whether all bricks of the opened file are stored compressed
+bool are_all_bricks_compressed(const ooc_bricked_volume& B)
+{
+	const bricked_volume_header& h = B.get_header();
+	volume::dimension_type bc = h.get_brick_counts();
+	volume::index_type b;
+	for (b(2) = 0; b(2) < bc(2); ++b(2))
+		for (b(1) = 0; b(1) < bc(1); ++b(1))
+			for (b(0) = 0; b(0) < bc(0); ++b(0)) {
+				volume::dimension_type bd = h.get_brick_dimensions(b);
+				if (B.get_brick_info(h.get_brick_index(b)).size >= size_t(bd(0)) * bd(1) * bd(2) * h.get_voxel_size())
+					return false;
+			}
+	return true;
+}
+
+bool test_bricked_volume()
+{
+	const std::string file_name = "test_bricked_volume.bvol";
+	// dimensions that are no multiple of the brick size, such that bricks at the upper borders are clipped
+	volume::dimension_type dims(37, 23, 19), brick_size(8, 8, 8);
+	volume V, S;
+
+	// round trip of a two component volume with and without compression
+	construct_test_volume<int16_t>(V, cgv::type::info::TI_INT16, cgv::data::CF_LA, dims, -20, 20);
+	BrickCompression compressions[] = { BC_NONE, BC_DELTA_VARINT };
+	for (BrickCompression compression : compressions) {
+		TEST_ASSERT(write_bricked_volume(file_name, V, brick_size, compression));
+		ooc_bricked_volume B;
+		TEST_ASSERT(B.open_read(file_name));
+		TEST_ASSERT(B.get_dimensions() == dims);
+		TEST_ASSERT_EQ(B.get_header().get_nr_bricks(), size_t(5 * 3 * 3));
+		TEST_ASSERT_EQ(are_all_bricks_compressed(B), compression == BC_DELTA_VARINT);
+		TEST_ASSERT(B.read_sub_volume(volume::index_type(0, 0, 0), dims, S));
+		TEST_ASSERT(S.get_dimensions() == dims);
+		TEST_ASSERT(S.get_component_type() == cgv::type::info::TI_INT16 && S.get_component_format() == cgv::data::CF_LA);
+		TEST_ASSERT(std::memcmp(S.get_data_ptr<uint8_t>(), V.get_data_ptr<uint8_t>(), V.get_size()) == 0);
+		// sub boxes inside one brick, across brick borders and including clipped border bricks
+		volume::index_type min_indices[] = { volume::index_type(1, 2, 3), volume::index_type(5, 6, 7), volume::index_type(0, 7, 0), volume::index_type(30, 15, 12) };
+		volume::dimension_type sub_dims[] = { volume::dimension_type(4, 4, 4), volume::dimension_type(12, 10, 9), volume::dimension_type(37, 2, 1), volume::dimension_type(7, 8, 7) };
+		for (unsigned i = 0; i < 4; ++i) {
+			TEST_ASSERT(B.read_sub_volume(min_indices[i], sub_dims[i], S));
+			TEST_ASSERT(S.get_dimensions() == sub_dims[i]);
+			TEST_ASSERT(equals_sub_volume(V, min_indices[i], S));
+		}
+		// sub boxes exceeding the volume are rejected
+		TEST_ASSERT(!B.read_sub_volume(volume::index_type(30, 0, 0), volume::dimension_type(8, 1, 1), S));
+		TEST_ASSERT(!B.read_sub_volume(volume::index_type(-1, 0, 0), volume::dimension_type(1, 1, 1), S));
+	}
+
+	// zigzag varint coding of deltas between extreme values of signed and unsigned types, where most
+	// voxels are zero such that bricks are still stored compressed
+	{
+		construct_test_volume<int64_t>(V, cgv::type::info::TI_INT64, cgv::data::CF_L, dims, 0, 0);
+		int64_t* values = V.get_data_ptr<int64_t>();
+		int64_t extremes[] = { std::numeric_limits<int64_t>::min(), std::numeric_limits<int64_t>::max(), -1, 1, std::numeric_limits<int64_t>::min() + 1 };
+		for (size_t i = 0; i < V.get_nr_voxels(); i += 37)
+			values[i] = extremes[(i / 37) % 5];
+		TEST_ASSERT(write_bricked_volume(file_name, V, brick_size));
+		ooc_bricked_volume B;
+		TEST_ASSERT(B.open_read(file_name));
+		TEST_ASSERT(are_all_bricks_compressed(B));
+		TEST_ASSERT(B.read_sub_volume(volume::index_type(0, 0, 0), dims, S));
+		TEST_ASSERT(std::memcmp(S.get_data_ptr<uint8_t>(), V.get_data_ptr<uint8_t>(), V.get_size()) == 0);
+		std::vector<size_t> brick_indices;
+		B.find_bricks(double(std::numeric_limits<int64_t>::max()), double(std::numeric_limits<int64_t>::max()), brick_indices);
+		TEST_ASSERT(!brick_indices.empty());
+	}
+	{
+		construct_test_volume<uint64_t>(V, cgv::type::info::TI_UINT64, cgv::data::CF_L, dims, 0, 0);
+		uint64_t* values = V.get_data_ptr<uint64_t>();
+		for (size_t i = 0; i < V.get_nr_voxels(); i += 29)
+			values[i] = i % 2 == 0 ? std::numeric_limits<uint64_t>::max() : (uint64_t(1) << 63);
+		TEST_ASSERT(write_bricked_volume(file_name, V, brick_size));
+		ooc_bricked_volume B;
+		TEST_ASSERT(B.open_read(file_name));
+		TEST_ASSERT(are_all_bricks_compressed(B));
+		TEST_ASSERT(B.read_sub_volume(volume::index_type(0, 0, 0), dims, S));
+		TEST_ASSERT(std::memcmp(S.get_data_ptr<uint8_t>(), V.get_data_ptr<uint8_t>(), V.get_size()) == 0);
+	}
+	{
+		// full range of signed bytes in three components
+		construct_test_volume<int8_t>(V, cgv::type::info::TI_INT8, cgv::data::CF_RGB, dims, -128, 127);
+		TEST_ASSERT(write_bricked_volume(file_name, V, brick_size));
+		ooc_bricked_volume B;
+		TEST_ASSERT(B.open_read(file_name));
+		TEST_ASSERT(B.read_sub_volume(volume::index_type(3, 3, 3), volume::dimension_type(20, 20, 16), S));
+		TEST_ASSERT(equals_sub_volume(V, volume::index_type(3, 3, 3), S));
+	}
+
+	// least recently used bricks are evicted once the cache exceeds its size
+	{
+		construct_test_volume<uint16_t>(V, cgv::type::info::TI_UINT16, cgv::data::CF_L, volume::dimension_type(32, 8, 8), 0, 1000);
+		TEST_ASSERT(write_bricked_volume(file_name, V, brick_size));
+		const size_t brick_bytes = 8 * 8 * 8 * 2;
+		test_ooc_bricked_volume B(2 * brick_bytes);
+		TEST_ASSERT(B.open_read(file_name));
+		TEST_ASSERT(B.get_brick(0) != 0 && B.get_brick(1) != 0);
+		TEST_ASSERT_EQ(B.get_cache_size(), 2 * brick_bytes);
+		// touching brick 0 makes brick 1 the least recently used one
+		const uint8_t* brick_0 = B.get_brick(0);
+		TEST_ASSERT(B.get_brick(2) != 0);
+		TEST_ASSERT(B.is_cached(0) && !B.is_cached(1) && B.is_cached(2));
+		TEST_ASSERT_EQ(B.get_cache_size(), 2 * brick_bytes);
+		TEST_ASSERT(B.get_brick(0) == brick_0);
+		// evicted bricks are reloaded with the same content
+		const uint8_t* brick_1 = B.get_brick(1);
+		TEST_ASSERT(brick_1 != 0 && std::memcmp(brick_1, V.get_voxel_ptr<uint8_t>(8, 0, 0), 16) == 0);
+		TEST_ASSERT(B.is_cached(0) && B.is_cached(1) && !B.is_cached(2));
+		// the most recently used brick is kept even if it exceeds the cache size
+		B.set_max_cache_size(0);
+		TEST_ASSERT(B.is_cached(1) && !B.is_cached(0));
+		TEST_ASSERT_EQ(B.get_cache_size(), brick_bytes);
+		TEST_ASSERT(B.get_brick(4) == 0);
+	}
+	std::remove(file_name.c_str());
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_bricked_volume_reg("cgv::media::volume::bricked_volume", test_bricked_volume);
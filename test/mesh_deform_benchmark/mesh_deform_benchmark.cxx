@@ -0,0 +1,131 @@
+#include <cgv/media/mesh/dynamic_mesh_deformer.h>
+#include <cgv/math/ftransform.h>
+#include <cgv/utils/stopwatch.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <thread>
+
+using namespace cgv::media::mesh;
+
+typedef dynamic_mesh<float> mesh_type;
+typedef mesh_type::vec3 vec3;
+typedef mesh_type::mat4 mat4;
+
+/// construct mesh with random positions, blend shapes of all modes and sparse skinning weights
+void construct_mesh(mesh_type& M, unsigned nr_vertices, unsigned nr_blend_shapes, unsigned nr_joints, std::default_random_engine& E)
+{
+	std::uniform_real_distribution<float> D(-1.0f, 1.0f);
+	for (unsigned vi = 0; vi < nr_vertices; ++vi)
+		M.new_position(vec3(D(E), D(E), D(E)));
+	M.store_in_reference_positions();
+	// every tenth blend shape affects all vertices, the others local regions as in facial animation
+	unsigned region_size = std::max(nr_vertices / 20, 1u);
+	std::uniform_int_distribution<unsigned> R(0, nr_vertices - region_size);
+	std::uniform_int_distribution<unsigned> V(0, nr_vertices - 1);
+	for (unsigned bi = 0; bi < nr_blend_shapes; ++bi) {
+		if (bi % 10 == 0) {
+			M.add_blend_shape(mesh_type::blend_shape_mode::direct, nr_vertices);
+			for (unsigned vi = 0; vi < nr_vertices; ++vi)
+				M.add_blend_shape_data(0.01f * vec3(D(E), D(E), D(E)));
+		}
+		else if (bi % 2 == 0) {
+			M.add_blend_shape(mesh_type::blend_shape_mode::indexed, region_size, region_size);
+			for (unsigned i = 0; i < region_size; ++i) {
+				M.add_blend_shape_data(0.01f * vec3(D(E), D(E), D(E)));
+				M.add_blend_shape_index(V(E));
+			}
+		}
+		else {
+			unsigned b0 = R(E), b1 = R(E);
+			if (b0 > b1)
+				std::swap(b0, b1);
+			unsigned e0 = std::min(b0 + region_size / 2, b1);
+			unsigned e1 = b1 + region_size / 2;
+			M.add_blend_shape(mesh_type::blend_shape_mode::range_indexed, (e0 - b0) + (e1 - b1), 4);
+			for (unsigned i = b0; i < e0; ++i)
+				M.add_blend_shape_data(0.01f * vec3(D(E), D(E), D(E)));
+			for (unsigned i = b1; i < e1; ++i)
+				M.add_blend_shape_data(0.01f * vec3(D(E), D(E), D(E)));
+			M.add_blend_shape_index(b0);
+			M.add_blend_shape_index(e0);
+			M.add_blend_shape_index(b1);
+			M.add_blend_shape_index(e1);
+		}
+	}
+	// four weights per vertex
+	M.ref_joint_parents().resize(nr_joints, -1);
+	M.set_vertex_weight_mode(mesh_type::vertex_weight_mode::sparse);
+	std::uniform_int_distribution<unsigned> J(0, nr_joints - 1);
+	std::uniform_real_distribution<float> W(0.0f, 1.0f);
+	for (unsigned vi = 0; vi < nr_vertices; ++vi) {
+		M.begin_vertex_weight_vertex();
+		float w[4], sum = 0;
+		for (unsigned k = 0; k < 4; ++k)
+			sum += (w[k] = W(E));
+		for (unsigned k = 0; k < 4; ++k) {
+			M.add_vertex_weight_data(w[k] / sum);
+			M.add_vertex_weight_index(J(E));
+		}
+	}
+}
+
+/// compares dynamic_mesh_deformer against apply_blend_shapes followed by lbs for increasing numbers of threads
+int main(int argc, char** argv)
+{
+	unsigned nr_vertices = argc > 1 ? (unsigned)atoi(argv[1]) : 1000000;
+	unsigned nr_blend_shapes = argc > 2 ? (unsigned)atoi(argv[2]) : 100;
+	unsigned max_nr_threads = argc > 3 ? (unsigned)atoi(argv[3]) : std::max(std::thread::hardware_concurrency(), 1u);
+	unsigned nr_joints = 50, nr_frames = 10;
+	std::default_random_engine E;
+	mesh_type M;
+	construct_mesh(M, nr_vertices, nr_blend_shapes, nr_joints, E);
+	std::uniform_real_distribution<float> D(-1.0f, 1.0f);
+	std::vector<float> weights(nr_blend_shapes);
+	for (auto& w : weights)
+		w = D(E);
+	std::vector<mat4> joint_matrices;
+	for (unsigned ji = 0; ji < nr_joints; ++ji)
+		joint_matrices.push_back(cgv::math::translate4<float>(0.1f * vec3(D(E), D(E), D(E))) *
+			cgv::math::rotate4<float>(30.0f * D(E), vec3(D(E), D(E), 1.0f)));
+
+	// reference implementation
+	double t_ref = 0;
+	{
+		cgv::utils::stopwatch s(&t_ref, true);
+		for (unsigned f = 0; f < nr_frames; ++f) {
+			M.apply_blend_shapes(weights);
+			M.lbs(joint_matrices, mesh_type::lbs_source_mode::position);
+		}
+	}
+	std::vector<vec3> P_ref = M.get_positions();
+	std::cout << nr_vertices << " vertices, " << nr_blend_shapes << " blend shapes, " << nr_joints << " joints: apply_blend_shapes+lbs "
+		<< 1000 * t_ref / nr_frames << "ms per frame" << std::endl;
+
+	std::vector<unsigned> thread_counts;
+	for (unsigned nr_threads = 1; nr_threads < max_nr_threads; nr_threads *= 2)
+		thread_counts.push_back(nr_threads);
+	thread_counts.push_back(max_nr_threads);
+	for (int quantize = 0; quantize < 2; ++quantize) {
+		for (unsigned nr_threads : thread_counts) {
+			dynamic_mesh_deformer<float> deformer(nr_threads);
+			double t_prepare = 0, t_deform = 0;
+			{
+				cgv::utils::stopwatch s(&t_prepare, true);
+				deformer.prepare(M, quantize != 0);
+			}
+			{
+				cgv::utils::stopwatch s(&t_deform, true);
+				for (unsigned f = 0; f < nr_frames; ++f)
+					deformer.deform(weights, joint_matrices);
+			}
+			float max_error = 0;
+			const auto& P = deformer.get_positions();
+			for (unsigned vi = 0; vi < nr_vertices; ++vi)
+				max_error = std::max(max_error, (P[vi] - P_ref[vi]).length());
+			std::cout << "  " << (quantize ? "quantized, " : "") << nr_threads << " threads: prepare " << 1000 * t_prepare << "ms, deform "
+				<< 1000 * t_deform / nr_frames << "ms per frame (speedup " << t_ref / t_deform << "), max error " << max_error << std::endl;
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,78 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/stopwatch.h>
+#include <cgv/utils/convert.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace cgv::base;
+
+/// named object with one of several type names
+struct benchmark_object : public named
+{
+	std::string type_name;
+	benchmark_object(const std::string& _name, const std::string& _type_name) : named(_name), type_name(_type_name) {}
+	std::string get_type_name() const { return type_name; }
+};
+
+/// lookup by name with the linear search formerly used by find_object_by_name
+named_ptr find_object_by_name_linear(const std::string& name)
+{
+	for (unsigned oi = 0; oi < get_nr_permanently_registered_objects(); ++oi) {
+		named_ptr np = get_permanently_registered_object(oi)->cast<named>();
+		if (np && np->get_name() == name)
+			return np;
+	}
+	return named_ptr();
+}
+
+/// measures registration, lookup by name and type as well as unregistration of many objects
+int main(int argc, char** argv)
+{
+	unsigned nr_objects = argc > 1 ? (unsigned)atoi(argv[1]) : 10000;
+	unsigned nr_types = argc > 2 ? (unsigned)atoi(argv[2]) : 100;
+	unsigned nr_lookups = argc > 3 ? (unsigned)atoi(argv[3]) : 10000;
+
+	std::vector<base_ptr> objects;
+	for (unsigned i = 0; i < nr_objects; ++i)
+		objects.push_back(new benchmark_object(std::string("object_") + cgv::utils::to_string(i), std::string("type_") + cgv::utils::to_string(i % nr_types)));
+
+	enable_registration_event_cleanup();
+	enable_registration();
+
+	double t_register = 0, t_name = 0, t_type = 0, t_linear = 0, t_unregister = 0;
+	{
+		cgv::utils::stopwatch s(&t_register);
+		for (auto& o : objects)
+			register_object(o);
+	}
+	unsigned nr_found = 0, nr_found_linear = 0;
+	{
+		cgv::utils::stopwatch s(&t_name);
+		for (unsigned i = 0; i < nr_lookups; ++i)
+			if (find_object_by_name(std::string("object_") + cgv::utils::to_string((i * 7919) % nr_objects)))
+				++nr_found;
+	}
+	{
+		cgv::utils::stopwatch s(&t_type);
+		for (unsigned i = 0; i < nr_lookups; ++i)
+			if (find_object_by_type(std::string("type_") + cgv::utils::to_string(i % nr_types)))
+				++nr_found;
+	}
+	unsigned nr_linear_lookups = nr_lookups / 100 + 1;
+	{
+		cgv::utils::stopwatch s(&t_linear);
+		for (unsigned i = 0; i < nr_linear_lookups; ++i)
+			if (find_object_by_name_linear(std::string("object_") + cgv::utils::to_string((i * 7919) % nr_objects)))
+				++nr_found_linear;
+	}
+	t_linear *= double(nr_lookups) / nr_linear_lookups;
+	{
+		cgv::utils::stopwatch s(&t_unregister);
+		unregister_all_objects();
+	}
+	std::cout << nr_objects << " objects of " << nr_types << " types: register " << t_register << "s, unregister " << t_unregister << "s" << std::endl;
+	std::cout << nr_lookups << " lookups: by name " << t_name << "s, by type " << t_type << "s, found " << nr_found << " of " << 2 * nr_lookups
+		<< ", by name with linear search " << t_linear << "s (extrapolated from " << nr_linear_lookups << " lookups)" << std::endl;
+	return 0;
+}
@@ -0,0 +1,122 @@
+#include <stream_vis/streaming_time_series.h>
+#include <cgv/utils/stopwatch.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace stream_vis;
+
+/// result of one benchmark run
+struct ingest_result
+{
+	double seconds;
+	size_t nr_stored, nr_overflows, nr_frames, nr_wrong;
+	double max_push_us, max_frame_ms;
+};
+
+/** one producer thread announces nr_samples values to all time series with the given rate per second (as fast as
+    possible if rate is 0) while a render thread converts new samples into a float storage buffer every frame_ms
+	milliseconds and counts converted samples whose time or value differ from the announced ones. The render thread
+	holds the mutex of each time series while converting. In locked mode the time series are appended under the
+	mutex; otherwise the lock free sample queues are drained once per frame. */
+ingest_result run(unsigned nr_series, size_t nr_samples, double rate, unsigned frame_ms, bool locked)
+{
+	std::vector<float_time_series*> series;
+	std::vector<uint16_t> val_idx_from_ts_idx(nr_series);
+	std::vector<indexed_value> values(nr_series);
+	for (unsigned i = 0; i < nr_series; ++i) {
+		series.push_back(new float_time_series(uint16_t(i)));
+		series.back()->set_ringbuffer_size(1 << 16);
+		val_idx_from_ts_idx[i] = uint16_t(i);
+		values[i].index = uint16_t(i);
+	}
+	std::atomic<bool> done(false);
+	ingest_result result = { 0, 0, 0, 0, 0, 0, 0 };
+	// render thread
+	std::thread render_thread([&]() {
+		std::vector<size_t> nr_converted(nr_series, 0);
+		std::vector<float> storage(2 << 16);
+		for (bool last = false; !last; ) {
+			last = done;
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned i = 0; i < nr_series; ++i) {
+				auto& ts = *series[i];
+				ts.ref_lock().lock();
+				if (!locked)
+					ts.drain_samples();
+				for (size_t si = std::max(nr_converted[i], ts.get_sample_index_of_first_cached_sample()); si < ts.get_nr_samples(); ++si) {
+					float* sample = &storage[2 * (si & 0xffff)];
+					if (!ts.put_sample_as_float(si, sample, TSA_ALL))
+						continue;
+					// sample index equals index of announcement, where values are stored relative to the first value
+					double timestamp = 1e-5 * si;
+					if (std::abs(sample[0] - timestamp) > 1e-5 || std::abs(sample[1] - (sin(timestamp + i) - ts.get_value_offset())) > 1e-5)
+						++result.nr_wrong;
+				}
+				nr_converted[i] = ts.get_nr_samples();
+				ts.ref_lock().unlock();
+			}
+			result.max_frame_ms = std::max(result.max_frame_ms, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			++result.nr_frames;
+			if (!last)
+				std::this_thread::sleep_for(std::chrono::milliseconds(frame_ms));
+		}
+	});
+	// producer thread is the main thread
+	{
+		cgv::utils::stopwatch s(&result.seconds, true);
+		auto begin = std::chrono::steady_clock::now();
+		for (size_t k = 0; k < nr_samples; ++k) {
+			// sleep in batches of 1024 samples to approximate rate
+			if (rate > 0 && (k & 1023) == 0)
+				std::this_thread::sleep_until(begin + std::chrono::duration<double>(k / rate));
+			double timestamp = 1e-5 * k;
+			auto start = std::chrono::steady_clock::now();
+			for (unsigned i = 0; i < nr_series; ++i)
+				reinterpret_cast<double&>(values[i].value[0]) = sin(timestamp + i);
+			for (auto* ts : series) {
+				if (locked) {
+					ts->ref_lock().lock();
+					ts->append_sample(timestamp, reinterpret_cast<const double&>(values[ts->index].value[0]));
+					ts->ref_lock().unlock();
+				}
+				else
+					ts->extract_from_values(uint16_t(nr_series), &values[0], timestamp, &val_idx_from_ts_idx[0]);
+			}
+			if ((k & 1023) == 0)
+				result.max_push_us = std::max(result.max_push_us, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+		}
+	}
+	done = true;
+	render_thread.join();
+	for (auto* ts : series) {
+		result.nr_stored += ts->get_nr_samples();
+		result.nr_overflows += ts->get_nr_sample_queue_overflows();
+		delete ts;
+	}
+	return result;
+}
+
+/// compares locked appending of samples against lock free sample queues drained by the render thread and fails if samples are lost or wrong
+int main(int argc, char** argv)
+{
+	unsigned nr_series = argc > 1 ? (unsigned)atoi(argv[1]) : 16;
+	size_t nr_samples = argc > 2 ? (size_t)atoll(argv[2]) : 1000000;
+	double rate = argc > 3 ? atof(argv[3]) : 100000.0;
+	unsigned frame_ms = argc > 4 ? (unsigned)atoi(argv[4]) : 16;
+	bool ok = true;
+	for (int locked = 1; locked >= 0; --locked) {
+		ingest_result r = run(nr_series, nr_samples, rate, frame_ms, locked != 0);
+		std::cout << (locked ? "mutex      : " : "lock free  : ") << nr_series << " series x " << nr_samples << " samples in " << r.seconds << "s = "
+			<< nr_series * nr_samples / r.seconds / 1e6 << " M samples/s (target " << nr_series * rate / 1e6 << "), " << r.nr_stored << " stored, " << r.nr_wrong << " wrong, " << r.nr_overflows << " queue overflows, "
+			<< r.nr_frames << " frames, max frame " << r.max_frame_ms << "ms, max announce " << r.max_push_us << "us" << std::endl;
+		if (r.nr_stored != nr_series * nr_samples || r.nr_wrong > 0)
+			ok = false;
+	}
+	return ok ? 0 : 1;
+}
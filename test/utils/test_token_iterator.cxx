@@ -0,0 +1,140 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/token_iterator.h>
+#include <cgv/utils/scan.h>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+/// collect all lines of the given text
+std::vector<std::string> collect_lines(const std::string& text)
+{
+	std::vector<std::string> lines;
+	line_iterator li(text);
+	token line;
+	while (li.next(line))
+		lines.push_back(to_string(line));
+	return lines;
+}
+
+/// collect all tokens of the given text
+std::vector<std::string> collect_tokens(const std::string& text, const delimiter_set& delims)
+{
+	std::vector<std::string> tokens;
+	token_iterator ti(token(text), delims);
+	token tok;
+	while (ti.next(tok))
+		tokens.push_back(to_string(tok));
+	return tokens;
+}
+
+bool test_token_iterator()
+{
+	typedef std::vector<std::string> strings;
+
+	// empty text has no lines and the last line needs no newline
+	TEST_ASSERT(collect_lines("").empty());
+	TEST_ASSERT(collect_lines("a\nbc") == strings({ "a", "bc" }));
+	TEST_ASSERT(collect_lines("a\nbc\n") == strings({ "a", "bc" }));
+	TEST_ASSERT(collect_lines("\n\na\n") == strings({ "", "", "a" }));
+	// carriage returns are only removed in front of a newline or at the end of the text
+	TEST_ASSERT(collect_lines("a\r\n\r\nb c\r\nd\r") == strings({ "a", "", "b c", "d" }));
+	TEST_ASSERT(collect_lines("a\rb\r\n") == strings({ "a\rb" }));
+
+	// token separation by sequences of delimiters at the begin, in the middle and at the end
+	const delimiter_set& blanks = get_blank_delimiters();
+	TEST_ASSERT(collect_tokens("", blanks).empty());
+	TEST_ASSERT(collect_tokens(" \t ", blanks).empty());
+	TEST_ASSERT(collect_tokens("\t 1.5 \t-2  x\t", blanks) == strings({ "1.5", "-2", "x" }));
+	// delimiters found in the vectorized search at all positions of texts longer than 16 characters
+	std::string long_token(40, 'a');
+	for (size_t i = 0; i < long_token.size(); ++i) {
+		std::string text = long_token;
+		text[i] = ',';
+		strings tokens = collect_tokens(text, delimiter_set(",;"));
+		size_t nr_tokens = (i == 0 || i + 1 == text.size()) ? 1 : 2;
+		TEST_ASSERT_EQ(tokens.size(), nr_tokens);
+		TEST_ASSERT_EQ(tokens[0].size(), i == 0 ? text.size() - 1 : i);
+	}
+	// more than eight delimiters are searched without vectorization and non ascii characters are no delimiters
+	delimiter_set many(",;:|/!?#=");
+	TEST_ASSERT(many.contains('=') && !many.contains('a') && !many.contains(char(0xE4)));
+	TEST_ASSERT(collect_tokens(long_token + "=\xE4\xE4" + long_token + "#,", many) == strings({ long_token, "\xE4\xE4" + long_token }));
+	delimiter_set none("");
+	TEST_ASSERT(collect_tokens(" a b ", none) == strings({ " a b " }));
+
+	// scanning consecutive numbers with leading blanks and signs
+	std::string numbers = " \t+12 -7 +3.5e2 -1.25E-1 .5 4";
+	const char* p = numbers.data(), *end = numbers.data() + numbers.size();
+	int i;
+	double d;
+	float f;
+	TEST_ASSERT(scan_integer(p, end, i) && i == 12);
+	TEST_ASSERT(scan_integer(p, end, i) && i == -7);
+	TEST_ASSERT(scan_double(p, end, d) && d == 350.0);
+	TEST_ASSERT(scan_float(p, end, f) && f == -0.125f);
+	TEST_ASSERT(scan_double(p, end, d) && d == 0.5);
+	TEST_ASSERT(scan_integer(p, end, i) && i == 4);
+	TEST_ASSERT(p == end);
+	TEST_ASSERT(!scan_integer(p, end, i));
+	// the position is not advanced if no number is found
+	std::string invalid[] = { "", "  ", "x1", "+", "+-1", "--1", "- 1" };
+	for (const std::string& s : invalid) {
+		p = s.data();
+		TEST_ASSERT(!scan_integer(p, s.data() + s.size(), i));
+		TEST_ASSERT(!scan_double(p, s.data() + s.size(), d));
+		TEST_ASSERT(p == s.data());
+	}
+	// integers stop at a decimal point and numbers end at the first invalid character
+	std::string mixed = "3.75,1e3x";
+	p = mixed.data();
+	end = mixed.data() + mixed.size();
+	TEST_ASSERT(scan_integer(p, end, i) && i == 3 && *p == '.');
+	p = mixed.data();
+	TEST_ASSERT(scan_double(p, end, d) && d == 3.75 && *p == ',');
+	++p;
+	TEST_ASSERT(scan_float(p, end, f) && f == 1000.0f && *p == 'x');
+	// numbers exceeding the range of the type are rejected
+	std::string overflow[] = { "2147483648", "-2147483649", "99999999999999999999" };
+	for (const std::string& s : overflow) {
+		p = s.data();
+		TEST_ASSERT(!scan_integer(p, s.data() + s.size(), i));
+		TEST_ASSERT(p == s.data());
+	}
+	std::string limits = "2147483647 -2147483648 1e39 1e400";
+	p = limits.data();
+	end = limits.data() + limits.size();
+	TEST_ASSERT(scan_integer(p, end, i) && i == std::numeric_limits<int>::max());
+	TEST_ASSERT(scan_integer(p, end, i) && i == std::numeric_limits<int>::min());
+	const char* q = p;
+	TEST_ASSERT(!scan_float(p, end, f) && p == q);
+	TEST_ASSERT(scan_double(p, end, d) && d == 1e39);
+	TEST_ASSERT(!scan_double(p, end, d) && p != end);
+	// nan and infinity are read as by std::from_chars
+	std::string special = "nan -inf +infinity";
+	p = special.data();
+	end = special.data() + special.size();
+	TEST_ASSERT(scan_float(p, end, f) && std::isnan(f));
+	TEST_ASSERT(scan_double(p, end, d) && std::isinf(d) && d < 0);
+	TEST_ASSERT(scan_double(p, end, d) && std::isinf(d) && d > 0 && p == end);
+
+	// the fast paths of is_integer and is_double give the same results as before
+	TEST_ASSERT(is_integer("+42", i) && i == 42);
+	TEST_ASSERT(is_integer("  -42", i) && i == -42);
+	TEST_ASSERT(is_integer("0x1F", i) && i == 31);
+	TEST_ASSERT(!is_integer("", i) && !is_integer("4 2", i) && !is_integer("1.0", i));
+	TEST_ASSERT(!is_integer("2147483648", i) && !is_integer("-2147483649", i));
+	TEST_ASSERT(is_double("+1.5e3", d) && d == 1500.0);
+	TEST_ASSERT(is_double(".5", d) && d == 0.5);
+	TEST_ASSERT(is_double("-2E-2", d) && d == -0.02);
+	TEST_ASSERT(is_double("7", d) && d == 7.0);
+	TEST_ASSERT(!is_double("", d) && !is_double("1.2.3", d) && !is_double("1x", d));
+	TEST_ASSERT(!is_double("nan", d) && !is_double("inf", d));
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_token_iterator_reg("cgv::utils::token_iterator", test_token_iterator);
@@ -0,0 +1,68 @@
+#include <cgv/base/register.h>
+#include <cgv/utils/zone_profiler.h>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace cgv::base;
+using namespace cgv::utils;
+
+bool test_zone_profiler()
+{
+	enable_zone_profiling(false);
+	clear_zone_events();
+	size_t nr_threads = get_nr_zone_profiling_threads();
+
+	// naming threads and passing zones while profiling is disabled allocates no event buffers
+	std::vector<std::thread> threads;
+	for (int i = 0; i < 4; ++i)
+		threads.push_back(std::thread([i]() {
+			set_zone_profiling_thread_name("idle thread " + std::to_string(i));
+			CGV_PROFILE_ZONE("not recorded");
+		}));
+	for (auto& t : threads)
+		t.join();
+	threads.clear();
+	TEST_ASSERT_EQ(get_nr_zone_profiling_threads(), nr_threads);
+	TEST_ASSERT_EQ(get_nr_zone_events(), size_t(0));
+
+	// the name set before the first zone is kept until the buffer is allocated and can be changed afterwards
+	enable_zone_profiling();
+	for (int i = 0; i < 3; ++i)
+		threads.push_back(std::thread([i]() {
+			set_zone_profiling_thread_name("worker \"" + std::to_string(i) + "\"");
+			for (int j = 0; j < 5; ++j) {
+				CGV_PROFILE_ZONE_CAT("outer", "test");
+				CGV_PROFILE_ZONE_CAT("inner", "test");
+			}
+			if (i == 2)
+				set_zone_profiling_thread_name("renamed worker");
+		}));
+	for (auto& t : threads)
+		t.join();
+	threads.clear();
+	TEST_ASSERT_EQ(get_nr_zone_profiling_threads(), nr_threads + 3);
+	TEST_ASSERT_EQ(get_nr_zone_events(), size_t(30));
+	std::stringstream ss;
+	write_chrome_trace(ss);
+	std::string trace = ss.str();
+	TEST_ASSERT(trace.find("\"worker \\\"0\\\"\"") != std::string::npos);
+	TEST_ASSERT(trace.find("\"worker \\\"1\\\"\"") != std::string::npos);
+	TEST_ASSERT(trace.find("\"renamed worker\"") != std::string::npos);
+	TEST_ASSERT(trace.find("idle thread") == std::string::npos);
+	TEST_ASSERT(trace.find("\"depth\":1") != std::string::npos);
+
+	// zones entered while profiling is enabled are recorded even if profiling is disabled before they are left
+	{
+		CGV_PROFILE_ZONE("disabled inside");
+		enable_zone_profiling(false);
+	}
+	TEST_ASSERT_EQ(get_nr_zone_events(), size_t(31));
+	clear_zone_events();
+	TEST_ASSERT_EQ(get_nr_zone_events(), size_t(0));
+	return true;
+}
+
+#include <test/lib_begin.h>
+
+extern CGV_API test_registration test_cb_zone_profiler_reg("cgv::utils::zone_profiler", test_zone_profiler);
@@ -0,0 +1,182 @@
+#include <cgv/base/register.h>
+#include <cgv/os/web_server.h>
+#include <cgv/os/socket.h>
+#include <cgv/utils/stopwatch.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace cgv::os;
+
+/// server thread answering /metrics with a small text, /binary?size=n with n bytes and /chunked?nr=n with n chunks
+class load_test_server : public web_server_thread
+{
+public:
+	load_test_server(unsigned port) : web_server_thread(port) {}
+	void handle_request(http_request& r)
+	{
+		if (r.path == "/binary") {
+			size_t size = size_t(atoll(r.params["size"].c_str()));
+			r.answer.resize(size);
+			for (size_t i = 0; i < size; ++i)
+				r.answer[i] = char(i);
+			r.content_type = "application/octet-stream";
+		}
+		else if (r.path == "/chunked") {
+			auto nr = std::make_shared<int>(atoi(r.params["nr"].c_str()));
+			r.content_type = "text/plain";
+			r.chunk_generator = [nr](std::string& chunk) {
+				if (*nr == 0)
+					return false;
+				chunk = "chunk " + std::to_string((*nr)--) + "\n";
+				return true;
+			};
+		}
+		else
+			r.answer = "frame_time_ms 16.6\nnr_points 1000000\n";
+	}
+};
+
+/// read one response from a blocking socket and return its body, or return false on failure
+bool receive_response(socket_ptr s, std::string& body)
+{
+	std::string status = s->receive_line();
+	if (status.compare(0, 12, "HTTP/1.1 200") != 0)
+		return false;
+	size_t content_length = 0;
+	bool chunked = false, has_content_length = false, close = false;
+	for (std::string line = s->receive_line(); line != "\r\n"; line = s->receive_line()) {
+		if (line.empty())
+			return false;
+		if (line.compare(0, 16, "Content-Length: ") == 0) {
+			content_length = size_t(atoll(line.c_str() + 16));
+			has_content_length = true;
+		}
+		else if (line == "Transfer-Encoding: chunked\r\n")
+			chunked = true;
+		else if (line == "Connection: close\r\n")
+			close = true;
+	}
+	// answers without length and chunked framing are delimited by closing the connection
+	if (!chunked && !has_content_length) {
+		if (!close)
+			return false;
+		body.clear();
+		while (!s->is_closed())
+			body += s->receive_data(1 << 16);
+		body += s->receive_data();
+		return true;
+	}
+	if (!chunked) {
+		body = s->receive_data(unsigned(content_length));
+		return body.size() == content_length;
+	}
+	body.clear();
+	for (;;) {
+		size_t size = size_t(strtoull(s->receive_line().c_str(), 0, 16));
+		if (size == 0)
+			return s->receive_line() == "\r\n";
+		body += s->receive_data(unsigned(size));
+		s->receive_line();
+	}
+}
+
+/// measure request throughput and latency with keep alive connections, each sending batches of pipelined requests
+int main(int argc, char** argv)
+{
+	unsigned nr_connections = argc > 1 ? (unsigned)atoi(argv[1]) : 64;
+	unsigned nr_requests = argc > 2 ? (unsigned)atoi(argv[2]) : 2000;
+	unsigned pipeline_depth = argc > 3 ? (unsigned)atoi(argv[3]) : 8;
+	std::string host = argc > 4 ? argv[4] : "localhost";
+	unsigned port = argc > 5 ? (unsigned)atoi(argv[5]) : 8089;
+	// start server in this process if no host is given, which is stopped by the destructor of the server thread
+	std::unique_ptr<load_test_server> server;
+	if (argc <= 4) {
+		if (!cgv::base::load_plugin("co_web_mt"))
+			return 1;
+		server.reset(new load_test_server(port));
+		server->start();
+		std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	}
+	// check binary and chunked answers
+	{
+		socket_client_ptr c = create_socket_client();
+		if (!c->connect(host, port)) {
+			std::cerr << "could not connect to " << host << ":" << port << std::endl;
+			return 1;
+		}
+		std::string body;
+		c->send_data("GET /binary?size=1000000 HTTP/1.1\r\nHost: " + host + "\r\n\r\nGET /chunked?nr=3 HTTP/1.1\r\nHost: " + host + "\r\n\r\n");
+		bool binary_ok = receive_response(c, body) && body.size() == 1000000 && body[999999] == char(999999);
+		bool chunked_ok = receive_response(c, body) && body == "chunk 3\nchunk 2\nchunk 1\n";
+		// a streamed answer larger than the socket buffers followed by a pipelined request, where the client only reads after a pause
+		std::string expected;
+		for (int i = 200000; i > 0; --i)
+			expected += "chunk " + std::to_string(i) + "\n";
+		c->send_data("GET /chunked?nr=200000 HTTP/1.1\r\nHost: " + host + "\r\n\r\nGET /metrics HTTP/1.1\r\nHost: " + host + "\r\n\r\n");
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+		bool streamed_ok = receive_response(c, body) && body == expected && receive_response(c, body) && body.compare(0, 13, "frame_time_ms") == 0;
+		std::cout << "binary answer " << (binary_ok ? "ok" : "failed") << ", chunked answer " << (chunked_ok ? "ok" : "failed")
+			<< ", streamed answer " << (streamed_ok ? "ok" : "failed") << std::endl;
+		if (!binary_ok || !chunked_ok || !streamed_ok)
+			return 1;
+	}
+	// streamed answers to HTTP/1.0 clients are delimited by closing the connection
+	{
+		socket_client_ptr c = create_socket_client();
+		if (!c->connect(host, port))
+			return 1;
+		std::string body;
+		c->send_data("GET /chunked?nr=3 HTTP/1.0\r\nHost: " + host + "\r\nConnection: keep-alive\r\n\r\n");
+		bool close_delimited_ok = receive_response(c, body) && body == "chunk 3\nchunk 2\nchunk 1\n" && c->is_closed();
+		std::cout << "close delimited answer " << (close_delimited_ok ? "ok" : "failed") << std::endl;
+		if (!close_delimited_ok)
+			return 1;
+	}
+	std::atomic<unsigned> nr_ok(0), nr_failed(0);
+	std::vector<std::vector<double> > latencies(nr_connections);
+	std::vector<std::thread> clients;
+	double t = 0;
+	{
+		cgv::utils::stopwatch s(&t, true);
+		for (unsigned ci = 0; ci < nr_connections; ++ci)
+			clients.push_back(std::thread([&, ci]() {
+				socket_client_ptr c = create_socket_client();
+				if (!c->connect(host, port)) {
+					nr_failed += nr_requests;
+					return;
+				}
+				std::string body;
+				for (unsigned ri = 0; ri < nr_requests; ri += pipeline_depth) {
+					unsigned n = std::min(pipeline_depth, nr_requests - ri);
+					auto start = std::chrono::steady_clock::now();
+					for (unsigned i = 0; i < n; ++i)
+						c->write_data("GET /metrics HTTP/1.1\r\nHost: " + host + "\r\n\r\n");
+					c->flush();
+					for (unsigned i = 0; i < n; ++i) {
+						if (receive_response(c, body))
+							++nr_ok;
+						else
+							++nr_failed;
+					}
+					latencies[ci].push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+				}
+			}));
+		for (auto& c : clients)
+			c.join();
+	}
+	std::vector<double> all;
+	for (const auto& l : latencies)
+		all.insert(all.end(), l.begin(), l.end());
+	std::sort(all.begin(), all.end());
+	std::cout << nr_connections << " connections, " << nr_requests << " requests each, pipeline depth " << pipeline_depth << ": "
+		<< nr_ok << " ok, " << nr_failed << " failed in " << t << "s = " << nr_ok / t << " requests/s" << std::endl;
+	if (!all.empty())
+		std::cout << "batch latency p50 " << all[all.size() / 2] << "ms, p99 " << all[all.size() * 99 / 100] << "ms, max " << all.back() << "ms" << std::endl;
+	return nr_failed > 0 ? 1 : 0;
+}